@@ -2,3 +2,8 @@ option(${${PROJECT_NAME}_UPPER}_ENABLE_TESTS
   "Build and run the ${PROJECT_NAME} unit tests."
   OFF
   )
+
+option(${${PROJECT_NAME}_UPPER}_ENABLE_USDT
+  "Emit USDT probes (requires sys/sdt.h) in the hot paths of ${PROJECT_NAME}."
+  OFF
+  )
@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_AUDIO_SUPERFRAME
+#define DABCOMMON_AUDIO_SUPERFRAME
+
+#include "dab/fec/crc.h"
+#include "dab/types/byte_view.h"
+#include "dab/types/parse_status.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief The maximum number of access units in a DAB+ audio superframe
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kMaximumAccessUnits{6};
+
+  /**
+   * @brief The generator polynomial of the Fire code protecting the DAB+ superframe header
+   *
+   * x^16 + x^14 + x^13 + x^12 + x^11 + x^5 + x^3 + x^2 + x + 1
+   *
+   * @since 1.0.3
+   */
+  std::uint16_t constexpr kFirecodePolynomial{0x782F};
+
+  /**
+   * @brief The audio parameters signalled in the header of a DAB+ audio superframe
+   *
+   * @since 1.0.3
+   */
+  struct superframe_header
+    {
+    bool dac_rate; ///< Whether the AAC core sampling rate is based on 48 kHz instead of 32 kHz
+    bool sbr; ///< Whether spectral band replication is used
+    bool stereo; ///< Whether the AAC channel mode is stereo
+    bool parametric_stereo; ///< Whether parametric stereo is used
+    std::uint8_t mpeg_surround; ///< The MPEG surround configuration
+
+    /**
+     * @brief Get the number of access units in the superframe
+     */
+    constexpr std::size_t access_units() const
+      {
+      return dac_rate ? (sbr ? 3 : 6) : (sbr ? 2 : 4);
+      }
+
+    /**
+     * @brief Get the sampling rate of the decoded audio in Hz
+     */
+    constexpr std::uint32_t sample_rate() const
+      {
+      return dac_rate ? 48000 : 32000;
+      }
+    };
+
+  /**
+   * @brief An access unit of a DAB+ audio superframe
+   *
+   * @since 1.0.3
+   */
+  struct access_unit
+    {
+    parse_status status; ///< dab::parse_status::ok if the CRC of the access unit is valid, dab::parse_status::invalid_crc otherwise
+    byte_view data; ///< The access unit without its CRC, pointing into the superframe
+    };
+
+  namespace internal
+    {
+
+    /**
+     * @internal
+     *
+     * @brief Calculate the Fire code over the 9 header bytes following the Fire code in a superframe
+     */
+    inline std::uint16_t firecode(std::uint8_t const * const data)
+      {
+      auto code = std::uint16_t{};
+
+      for(std::size_t index{}; index < 9; ++index)
+        {
+        for(auto bit = 7; bit >= 0; --bit)
+          {
+          auto const feedback = ((data[index] >> bit) & 1) ^ (code >> 15);
+          code = static_cast<std::uint16_t>(code << 1);
+          if(feedback)
+            {
+            code ^= kFirecodePolynomial;
+            }
+          }
+        }
+
+      return code;
+      }
+
+    }
+
+  /**
+   * @brief Parse a Reed-Solomon corrected DAB+ audio superframe and locate its access units
+   *
+   * The header is checked using the Fire code and the CRC of every access unit is checked separately, so that an AAC
+   * decoder can skip corrupted access units and conceal them. The access units are views into @p superframe, no bytes
+   * are copied. @p units is cleared and refilled, so its storage can be reused from superframe to superframe.
+   *
+   * @param superframe The audio superframe of 110 bytes per 8 kbit/s of sub-channel bit rate, without the Reed-Solomon
+   *        parity bytes
+   * @param header Receives the audio parameters of the superframe
+   * @param units Receives the access units
+   * @return dab::parse_status::incomplete if the superframe is too short to contain a header,
+   *         dab::parse_status::invalid_crc if the Fire code of the header is invalid, dab::parse_status::invalid_address
+   *         if the access unit start addresses are inconsistent, dab::parse_status::ok otherwise
+   *
+   * @since 1.0.3
+   */
+  inline parse_status extract_access_units(byte_view const superframe, superframe_header & header, std::vector<access_unit> & units)
+    {
+    units.clear();
+
+    if(superframe.size() < 11)
+      {
+      return parse_status::incomplete;
+      }
+
+    if(internal::firecode(superframe.data() + 2) != ((superframe[0] << 8) | superframe[1]))
+      {
+      return parse_status::invalid_crc;
+      }
+
+    header.dac_rate = superframe[2] & 0x40;
+    header.sbr = superframe[2] & 0x20;
+    header.stereo = superframe[2] & 0x10;
+    header.parametric_stereo = superframe[2] & 0x08;
+    header.mpeg_surround = superframe[2] & 0x07;
+
+    auto const count = header.access_units();
+    auto starts = std::array<std::size_t, kMaximumAccessUnits + 1>{};
+    starts[0] = 3 + ((count - 1) * 12 + 7) / 8;
+    starts[count] = superframe.size();
+
+    for(std::size_t index{1}; index < count; ++index)
+      {
+      auto const bit = (index - 1) * 12;
+      auto const word = (superframe[3 + bit / 8] << 8) | superframe[4 + bit / 8];
+      starts[index] = bit % 8 ? word & 0x0FFF : word >> 4;
+      }
+
+    for(std::size_t index{}; index < count; ++index)
+      {
+      if(starts[index + 1] <= starts[index] + 2 || starts[index + 1] > superframe.size())
+        {
+        return parse_status::invalid_address;
+        }
+      }
+
+    for(std::size_t index{}; index < count; ++index)
+      {
+      auto const size = starts[index + 1] - starts[index];
+      auto const valid = crc16_valid(superframe.data() + starts[index], size);
+      units.push_back({valid ? parse_status::ok : parse_status::invalid_crc, superframe.subview(starts[index], size - 2)});
+      }
+
+    return parse_status::ok;
+    }
+
+  }
+
+#endif
@@ -32,10 +32,48 @@
 #ifndef DABCOMMON_COMMON
 #define DABCOMMON_COMMON
 
+#include "dab/audio/superframe.h"
+#include "dab/constants/band_iii.h"
 #include "dab/constants/sample_rate.h"
 #include "dab/constants/transmission_modes.h"
+#include "dab/ensemble/ensemble_snapshot.h"
+#include "dab/fec/block_viterbi.h"
+#include "dab/fec/crc.h"
+#include "dab/fec/energy_dispersal.h"
+#include "dab/fec/fic_combiner.h"
+#include "dab/fec/selective_deinterleaver.h"
+#include "dab/fec/viterbi.h"
 #include "dab/literals/binary_literal.h"
+#include "dab/monitoring/metrics.h"
+#include "dab/monitoring/metrics_server.h"
+#include "dab/monitoring/signal_quality.h"
+#include "dab/monitoring/spectrum_monitor.h"
+#include "dab/ofdm/channel_estimator.h"
+#include "dab/ofdm/fft.h"
+#include "dab/ofdm/fixed_point.h"
+#include "dab/ofdm/signal_detector.h"
+#include "dab/ofdm/sync_state.h"
+#include "dab/ofdm/tii_decoder.h"
+#include "dab/pad/dynamic_label.h"
+#include "dab/pad/xpad.h"
+#include "dab/pipeline/overload_controller.h"
+#include "dab/pipeline/pipeline.h"
+#include "dab/pipeline/stage.h"
+#include "dab/pipeline/task_pool.h"
+#include "dab/scan/band_scanner.h"
+#include "dab/system/memory.h"
+#include "dab/system/numa.h"
+#include "dab/system/perf_counters.h"
+#include "dab/system/scheduling.h"
+#include "dab/system/timeline.h"
+#include "dab/system/tracing.h"
+#include "dab/types/byte_view.h"
 #include "dab/types/common_types.h"
+#include "dab/types/double_buffer.h"
+#include "dab/types/frame_arena.h"
 #include "dab/types/parse_status.h"
+#include "dab/types/reorder_buffer.h"
+#include "dab/types/seqlock.h"
+#include "dab/types/subscription_set.h"
 
 #endif
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_CONSTANTS_BAND_III
+#define DABCOMMON_CONSTANTS_BAND_III
+
+#include <array>
+#include <cstdint>
+
+namespace dab
+  {
+
+  /**
+   * @brief A frequency block of VHF Band III
+   *
+   * @since 1.0.3
+   */
+  struct band_iii_block
+    {
+    char const * label; ///< The block label, e.g. "12C"
+    std::uint32_t frequency; ///< The center frequency in kHz
+    };
+
+  /**
+   * @brief The 38 frequency blocks of VHF Band III, in ascending order of frequency
+   *
+   * @since 1.0.3
+   */
+  std::array<band_iii_block, 38> constexpr kBandIIIBlocks{{
+    {"5A", 174928}, {"5B", 176640}, {"5C", 178352}, {"5D", 180064},
+    {"6A", 181936}, {"6B", 183648}, {"6C", 185360}, {"6D", 187072},
+    {"7A", 188928}, {"7B", 190640}, {"7C", 192352}, {"7D", 194064},
+    {"8A", 195936}, {"8B", 197648}, {"8C", 199360}, {"8D", 201072},
+    {"9A", 202928}, {"9B", 204640}, {"9C", 206352}, {"9D", 208064},
+    {"10A", 209936}, {"10B", 211648}, {"10C", 213360}, {"10D", 215072},
+    {"11A", 216928}, {"11B", 218640}, {"11C", 220352}, {"11D", 222064},
+    {"12A", 223936}, {"12B", 225648}, {"12C", 227360}, {"12D", 229072},
+    {"13A", 230784}, {"13B", 232496}, {"13C", 234208}, {"13D", 235776}, {"13E", 237488}, {"13F", 239200},
+  }};
+
+  }
+
+#endif
@@ -32,8 +32,11 @@
 #ifndef DABCOMMON_CONSTANTS_TRANSMISSION_MODES
 #define DABCOMMON_CONSTANTS_TRANSMISSION_MODES
 
+#include "dab/constants/sample_rate.h"
 #include "dab/types/transmission_mode.h"
 
+#include <chrono>
+
 namespace dab
   {
 
@@ -69,6 +72,28 @@ namespace dab
    */
   internal::types::transmission_mode constexpr kTransmissionMode4{4, 768,  76, 3,  6, 2, 98304, 252, 1024, 1328};
 
+  /**
+   * @brief Get the duration of a transmission frame in the given mode
+   *
+   * @since 1.0.3
+   */
+  constexpr std::chrono::microseconds frame_duration(internal::types::transmission_mode const & mode)
+    {
+    return std::chrono::microseconds{mode.frame_duration * 1000000ull / kDefaultSampleRate};
+    }
+
+  /**
+   * @brief Get the duration of a Common Interleaved Frame (CIF) in the given mode
+   *
+   * @note The CIF duration is 24ms in all transmission modes.
+   *
+   * @since 1.0.3
+   */
+  constexpr std::chrono::microseconds cif_duration(internal::types::transmission_mode const & mode)
+    {
+    return std::chrono::microseconds{mode.frame_duration / mode.frame_cifs * 1000000ull / kDefaultSampleRate};
+    }
+
   }
 
 #endif
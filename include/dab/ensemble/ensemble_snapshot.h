@@ -0,0 +1,576 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_ENSEMBLE_ENSEMBLE_SNAPSHOT
+#define DABCOMMON_ENSEMBLE_ENSEMBLE_SNAPSHOT
+
+#include "dab/fec/crc.h"
+#include "dab/fec/selective_deinterleaver.h"
+#include "dab/types/common_types.h"
+#include "dab/types/little_endian.h"
+#include "dab/types/parse_status.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define DABCOMMON_HAS_MMAP 1
+#endif
+
+/**
+ * @file
+ *
+ * @brief This file contains a compact, persistable snapshot of an ensemble
+ *
+ * Rebuilding the ensemble information from the FIC takes seconds after every retune or restart. A receiver can instead
+ * store a snapshot of the ensemble, load it on startup, start decoding the selected sub-channels right away and then
+ * confirm the snapshot against the incoming FIGs.
+ *
+ * The binary format consists of fixed-size little-endian records, so a memory-mapped snapshot can be read in place:
+ *
+ * | Offset | Size | Content                                                                          |
+ * |-------:|-----:|----------------------------------------------------------------------------------|
+ * |      0 |   40 | Header: magic "DABS", version, EId, frequency, record counts, ensemble label      |
+ * |     40 | 24·S | Services: SId, label mask, label                                                  |
+ * |      … |  8·N | Sub-channels: SubChId, protection, start address, size                            |
+ * |      … |  8·C | Service components: SId, SubChId, component type, flags                           |
+ * |      … |    2 | Complemented CRC16 over all preceding bytes, most significant byte first          |
+ *
+ * @since 1.0.3
+ */
+
+namespace dab
+  {
+
+  /**
+   * @brief The number of characters in a DAB label
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kLabelLength{16};
+
+  /**
+   * @brief A DAB label, with the character flag field selecting the characters of the short label
+   *
+   * @since 1.0.3
+   */
+  struct label
+    {
+    std::array<char, kLabelLength> text; ///< The label, padded with spaces
+    std::uint16_t short_mask; ///< The character flag field, bit 15 representing the first character
+    };
+
+  /**
+   * @brief A service of an ensemble
+   *
+   * @since 1.0.3
+   */
+  struct service_record
+    {
+    std::uint32_t id; ///< The service identifier
+    dab::label label; ///< The service label
+    };
+
+  /**
+   * @brief A sub-channel of the multiplex configuration
+   *
+   * @since 1.0.3
+   */
+  struct subchannel_record
+    {
+    std::uint8_t id; ///< The sub-channel identifier
+    std::uint8_t protection; ///< The protection as signalled in FIG 0/1: bit 7 for the long form, the level and option below
+    std::uint16_t start; ///< The address of the first Capacity Unit
+    std::uint16_t size; ///< The number of Capacity Units
+    };
+
+  /**
+   * @brief A service component carried in a sub-channel
+   *
+   * @since 1.0.3
+   */
+  struct component_record
+    {
+    std::uint32_t service; ///< The identifier of the service the component belongs to
+    std::uint8_t subchannel; ///< The identifier of the sub-channel carrying the component
+    std::uint8_t type; ///< The audio or data service component type
+    bool primary; ///< Whether this is the primary component of the service
+    };
+
+  /**
+   * @brief A snapshot of the ensemble information needed to start decoding
+   *
+   * @since 1.0.3
+   */
+  struct ensemble_snapshot
+    {
+    std::uint32_t frequency; ///< The center frequency in kHz
+    std::uint16_t eid; ///< The ensemble identifier
+    dab::label label; ///< The ensemble label
+    std::vector<service_record> services; ///< The services of the ensemble
+    std::vector<subchannel_record> subchannels; ///< The sub-channel organization
+    std::vector<component_record> components; ///< The service components
+
+    /**
+     * @brief Get the sub-channel organization in the form expected by dab::selective_deinterleaver::configure
+     */
+    std::vector<subchannel_descriptor> subchannel_descriptors() const
+      {
+      auto descriptors = std::vector<subchannel_descriptor>{};
+      for(auto const & subchannel : subchannels)
+        {
+        descriptors.push_back({subchannel.id, subchannel.start, subchannel.size});
+        }
+
+      return descriptors;
+      }
+    };
+
+  namespace internal
+    {
+
+    std::uint16_t constexpr kSnapshotVersion{1};
+    std::size_t constexpr kSnapshotHeaderBytes{40};
+    std::size_t constexpr kSnapshotServiceBytes{24};
+    std::size_t constexpr kSnapshotSubchannelBytes{8};
+    std::size_t constexpr kSnapshotComponentBytes{8};
+
+    inline void put_label(byte_vector_t & bytes, std::size_t const offset, label const & value)
+      {
+      store_little_endian(bytes.data() + offset, value.short_mask, 2);
+      std::copy(value.text.begin(), value.text.end(), bytes.begin() + offset + 2);
+      }
+
+    inline label get_label(std::uint8_t const * const bytes)
+      {
+      auto value = label{};
+      value.short_mask = static_cast<std::uint16_t>(load_little_endian(bytes, 2));
+      std::copy(bytes + 2, bytes + 2 + kLabelLength, value.text.begin());
+      return value;
+      }
+
+    }
+
+  /**
+   * @brief A read-only view of a serialized snapshot, decoding records in place
+   *
+   * The view does not own the bytes. It is typically created over a memory-mapped snapshot file.
+   *
+   * @since 1.0.3
+   */
+  struct snapshot_view
+    {
+    /**
+     * @brief Check and wrap a serialized snapshot
+     *
+     * @return dab::parse_status::ok for a valid snapshot, dab::parse_status::incomplete if the bytes are truncated,
+     *         dab::parse_status::invalid_address if the bytes are not a snapshot of a supported version and
+     *         dab::parse_status::invalid_crc if the snapshot is corrupted
+     */
+    parse_status open(std::uint8_t const * const data, std::size_t const size)
+      {
+      m_data = nullptr;
+
+      if(size < internal::kSnapshotHeaderBytes + 2)
+        {
+        return parse_status::incomplete;
+        }
+
+      if(!std::equal(data, data + 4, "DABS") || internal::load_little_endian(data + 4, 2) != internal::kSnapshotVersion)
+        {
+        return parse_status::invalid_address;
+        }
+
+      m_services = internal::load_little_endian(data + 12, 2);
+      m_subchannels = internal::load_little_endian(data + 14, 2);
+      m_components = internal::load_little_endian(data + 16, 2);
+
+      if(size != bytes())
+        {
+        return parse_status::incomplete;
+        }
+
+      if(!crc16_valid(data, size))
+        {
+        return parse_status::invalid_crc;
+        }
+
+      m_data = data;
+      return parse_status::ok;
+      }
+
+    std::uint16_t eid() const
+      {
+      return static_cast<std::uint16_t>(internal::load_little_endian(m_data + 6, 2));
+      }
+
+    std::uint32_t frequency() const
+      {
+      return static_cast<std::uint32_t>(internal::load_little_endian(m_data + 8, 4));
+      }
+
+    dab::label label() const
+      {
+      return internal::get_label(m_data + 18);
+      }
+
+    std::size_t services() const
+      {
+      return m_services;
+      }
+
+    std::size_t subchannels() const
+      {
+      return m_subchannels;
+      }
+
+    std::size_t components() const
+      {
+      return m_components;
+      }
+
+    service_record service(std::size_t const index) const
+      {
+      auto const record = m_data + internal::kSnapshotHeaderBytes + index * internal::kSnapshotServiceBytes;
+      return {static_cast<std::uint32_t>(internal::load_little_endian(record, 4)), internal::get_label(record + 4)};
+      }
+
+    subchannel_record subchannel(std::size_t const index) const
+      {
+      auto const record = subchannels_begin() + index * internal::kSnapshotSubchannelBytes;
+      return {record[0], record[1], static_cast<std::uint16_t>(internal::load_little_endian(record + 2, 2)), static_cast<std::uint16_t>(internal::load_little_endian(record + 4, 2))};
+      }
+
+    component_record component(std::size_t const index) const
+      {
+      auto const record = subchannels_begin() + m_subchannels * internal::kSnapshotSubchannelBytes + index * internal::kSnapshotComponentBytes;
+      return {static_cast<std::uint32_t>(internal::load_little_endian(record, 4)), record[4], record[5], (record[6] & 1) != 0};
+      }
+
+    /**
+     * @brief Decode the complete snapshot
+     */
+    ensemble_snapshot snapshot() const
+      {
+      auto result = ensemble_snapshot{frequency(), eid(), label(), {}, {}, {}};
+
+      for(std::size_t index{}; index < m_services; ++index)
+        {
+        result.services.push_back(service(index));
+        }
+
+      for(std::size_t index{}; index < m_subchannels; ++index)
+        {
+        result.subchannels.push_back(subchannel(index));
+        }
+
+      for(std::size_t index{}; index < m_components; ++index)
+        {
+        result.components.push_back(component(index));
+        }
+
+      return result;
+      }
+
+    private:
+      std::size_t bytes() const
+        {
+        return internal::kSnapshotHeaderBytes + m_services * internal::kSnapshotServiceBytes +
+               m_subchannels * internal::kSnapshotSubchannelBytes + m_components * internal::kSnapshotComponentBytes + 2;
+        }
+
+      std::uint8_t const * subchannels_begin() const
+        {
+        return m_data + internal::kSnapshotHeaderBytes + m_services * internal::kSnapshotServiceBytes;
+        }
+
+      std::uint8_t const * m_data{};
+      std::size_t m_services{};
+      std::size_t m_subchannels{};
+      std::size_t m_components{};
+    };
+
+  /**
+   * @brief Serialize a snapshot into the binary snapshot format
+   *
+   * @since 1.0.3
+   */
+  inline byte_vector_t serialize(ensemble_snapshot const & snapshot)
+    {
+    auto const subchannels = internal::kSnapshotHeaderBytes + snapshot.services.size() * internal::kSnapshotServiceBytes;
+    auto const components = subchannels + snapshot.subchannels.size() * internal::kSnapshotSubchannelBytes;
+    auto const end = components + snapshot.components.size() * internal::kSnapshotComponentBytes;
+    auto bytes = byte_vector_t(end + 2);
+
+    std::copy_n("DABS", 4, bytes.begin());
+    internal::store_little_endian(bytes.data() + 4, internal::kSnapshotVersion, 2);
+    internal::store_little_endian(bytes.data() + 6, snapshot.eid, 2);
+    internal::store_little_endian(bytes.data() + 8, snapshot.frequency, 4);
+    internal::store_little_endian(bytes.data() + 12, snapshot.services.size(), 2);
+    internal::store_little_endian(bytes.data() + 14, snapshot.subchannels.size(), 2);
+    internal::store_little_endian(bytes.data() + 16, snapshot.components.size(), 2);
+    internal::put_label(bytes, 18, snapshot.label);
+
+    for(std::size_t index{}; index < snapshot.services.size(); ++index)
+      {
+      auto const offset = internal::kSnapshotHeaderBytes + index * internal::kSnapshotServiceBytes;
+      internal::store_little_endian(bytes.data() + offset, snapshot.services[index].id, 4);
+      internal::put_label(bytes, offset + 4, snapshot.services[index].label);
+      }
+
+    for(std::size_t index{}; index < snapshot.subchannels.size(); ++index)
+      {
+      auto const & subchannel = snapshot.subchannels[index];
+      auto const offset = subchannels + index * internal::kSnapshotSubchannelBytes;
+      bytes[offset] = subchannel.id;
+      bytes[offset + 1] = subchannel.protection;
+      internal::store_little_endian(bytes.data() + offset + 2, subchannel.start, 2);
+      internal::store_little_endian(bytes.data() + offset + 4, subchannel.size, 2);
+      }
+
+    for(std::size_t index{}; index < snapshot.components.size(); ++index)
+      {
+      auto const & component = snapshot.components[index];
+      auto const offset = components + index * internal::kSnapshotComponentBytes;
+      internal::store_little_endian(bytes.data() + offset, component.service, 4);
+      bytes[offset + 4] = component.subchannel;
+      bytes[offset + 5] = component.type;
+      bytes[offset + 6] = component.primary;
+      }
+
+    auto const crc = static_cast<std::uint16_t>(~crc16(bytes.data(), end));
+    bytes[end] = static_cast<std::uint8_t>(crc >> 8);
+    bytes[end + 1] = static_cast<std::uint8_t>(crc & 0xFF);
+    return bytes;
+    }
+
+  /**
+   * @brief Get the file name of the snapshot of an ensemble in a cache directory
+   *
+   * Snapshots are keyed by frequency and EId, e.g. "227360-10E1.ensemble" for ensemble 0x10E1 on block 12C.
+   *
+   * @since 1.0.3
+   */
+  inline std::string snapshot_path(std::string const & directory, std::uint32_t const frequency, std::uint16_t const eid)
+    {
+    auto path = std::ostringstream{};
+    path << directory << '/' << frequency << '-' << std::uppercase << std::hex << std::setw(4) << std::setfill('0') << eid << ".ensemble";
+    return path.str();
+    }
+
+  /**
+   * @brief Store a snapshot in a cache directory, atomically replacing an existing one
+   *
+   * @return @p true iff the snapshot was written
+   *
+   * @since 1.0.3
+   */
+  inline bool store_snapshot(std::string const & directory, ensemble_snapshot const & snapshot)
+    {
+    auto const path = snapshot_path(directory, snapshot.frequency, snapshot.eid);
+    auto const temporary = path + ".tmp";
+    auto const bytes = serialize(snapshot);
+
+      {
+      auto file = std::ofstream{temporary, std::ios::binary | std::ios::trunc};
+      file.write(reinterpret_cast<char const *>(bytes.data()), bytes.size());
+      if(!file)
+        {
+        return false;
+        }
+      }
+
+    return !std::rename(temporary.c_str(), path.c_str());
+    }
+
+  /**
+   * @brief A snapshot file mapped into memory
+   *
+   * Where memory mapping is not available, the file is read into memory instead.
+   *
+   * @since 1.0.3
+   */
+  struct mapped_snapshot
+    {
+    /**
+     * @brief Map the snapshot of an ensemble from a cache directory
+     */
+    mapped_snapshot(std::string const & directory, std::uint32_t const frequency, std::uint16_t const eid)
+      {
+      auto const path = snapshot_path(directory, frequency, eid);
+
+#ifdef DABCOMMON_HAS_MMAP
+      auto const file = ::open(path.c_str(), O_RDONLY);
+      if(file < 0)
+        {
+        return;
+        }
+
+      struct stat status{};
+      if(!fstat(file, &status) && status.st_size > 0)
+        {
+        auto const mapping = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        if(mapping != MAP_FAILED)
+          {
+          m_data = static_cast<std::uint8_t const *>(mapping);
+          m_size = static_cast<std::size_t>(status.st_size);
+          }
+        }
+
+      ::close(file);
+#else
+      auto file = std::ifstream{path, std::ios::binary};
+      m_bytes.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+      m_data = m_bytes.data();
+      m_size = m_bytes.size();
+#endif
+
+      m_status = m_data ? m_view.open(m_data, m_size) : parse_status::incomplete;
+      }
+
+    mapped_snapshot(mapped_snapshot const &) = delete;
+    mapped_snapshot & operator=(mapped_snapshot const &) = delete;
+
+    ~mapped_snapshot()
+      {
+#ifdef DABCOMMON_HAS_MMAP
+      if(m_data)
+        {
+        munmap(const_cast<std::uint8_t *>(m_data), m_size);
+        }
+#endif
+      }
+
+    /**
+     * @brief Get the result of checking the mapped snapshot
+     *
+     * @return dab::parse_status::incomplete if the file does not exist, otherwise the result of dab::snapshot_view::open
+     */
+    parse_status status() const
+      {
+      return m_status;
+      }
+
+    /**
+     * @brief Access the mapped snapshot, which is only valid if dab::mapped_snapshot::status is dab::parse_status::ok
+     */
+    snapshot_view const & view() const
+      {
+      return m_view;
+      }
+
+    private:
+      std::uint8_t const * m_data{};
+      std::size_t m_size{};
+#ifndef DABCOMMON_HAS_MMAP
+      byte_vector_t m_bytes{};
+#endif
+      snapshot_view m_view{};
+      parse_status m_status{parse_status::incomplete};
+    };
+
+  /**
+   * @brief Confirms a loaded snapshot against the ensemble information decoded from the FIC
+   *
+   * Decoding can start from the snapshot right away. Every sub-channel decoded from FIG 0/1 is then compared against
+   * the snapshot. Once all sub-channels of the snapshot were seen unchanged, the snapshot is confirmed. Any difference
+   * makes it stale, in which case the receiver should switch to the freshly decoded information and store a new
+   * snapshot.
+   *
+   * @since 1.0.3
+   */
+  struct snapshot_validator
+    {
+    explicit snapshot_validator(ensemble_snapshot const & snapshot)
+      : m_subchannels(snapshot.subchannels),
+        m_seen(snapshot.subchannels.size())
+      {
+      }
+
+    /**
+     * @brief Compare a decoded sub-channel against the snapshot
+     *
+     * @return @p true iff the sub-channel matches the snapshot
+     */
+    bool check(subchannel_record const & decoded)
+      {
+      auto const match = std::find_if(m_subchannels.begin(), m_subchannels.end(), [&](subchannel_record const & subchannel){
+        return subchannel.id == decoded.id;
+      });
+
+      if(match == m_subchannels.end() || match->start != decoded.start || match->size != decoded.size || match->protection != decoded.protection)
+        {
+        m_stale = true;
+        return false;
+        }
+
+      m_seen[match - m_subchannels.begin()] = true;
+      return true;
+      }
+
+    /**
+     * @brief Check whether all sub-channels of the snapshot were confirmed
+     */
+    bool confirmed() const
+      {
+      return !m_stale && std::all_of(m_seen.begin(), m_seen.end(), [](bool seen){ return seen; });
+      }
+
+    /**
+     * @brief Check whether the FIC contradicted the snapshot
+     */
+    bool stale() const
+      {
+      return m_stale;
+      }
+
+    private:
+      std::vector<subchannel_record> const m_subchannels;
+      std::vector<bool> m_seen;
+      bool m_stale{};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_FEC_BLOCK_VITERBI
+#define DABCOMMON_FEC_BLOCK_VITERBI
+
+#include "dab/fec/viterbi.h"
+#include "dab/pipeline/task_pool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief The parameters of the block-parallel Viterbi decoder
+   *
+   * Each block is decoded together with a number of preceding warm-up steps and a number of following traceback steps.
+   * During warm-up, the path metrics converge from an unknown start state. During traceback, the survivor paths merge
+   * before reaching the bits of the block. Both lengths should be several times the constraint length of the code.
+   * Longer overlaps lower the error rate penalty at the cost of redundant work.
+   *
+   * @since 1.0.3
+   */
+  struct block_viterbi_parameters
+    {
+    std::size_t block_length; ///< The number of information bits decoded per block
+    std::size_t warm_up; ///< The number of trellis steps decoded in front of each block
+    std::size_t traceback; ///< The number of trellis steps decoded after each block
+    };
+
+  /**
+   * @brief The default parameters of the block-parallel Viterbi decoder
+   *
+   * @since 1.0.3
+   */
+  block_viterbi_parameters constexpr kDefaultBlockViterbiParameters{4096, 64, 64};
+
+  /**
+   * @brief Decode a long terminated codeword by splitting it into overlapping blocks decoded in parallel
+   *
+   * High-bitrate sub-channels produce codewords of tens of thousands of bits per CIF. This function splits such a
+   * codeword into blocks that are decoded concurrently on @p pool. At high SNR, the result matches dab::viterbi_decode.
+   * At low SNR, the overlaps determine how close the error rate comes to that of the serial decoder.
+   *
+   * @param soft The depunctured soft bits of the codeword, including the tail
+   * @param pool The pool executing the blocks
+   * @param parameters The block and overlap lengths
+   * @return The decoded information bits, without the tail bits
+   *
+   * @since 1.0.3
+   */
+  inline std::vector<std::uint8_t> block_parallel_viterbi_decode(std::vector<float> const & soft,
+                                                                 task_pool & pool,
+                                                                 block_viterbi_parameters const parameters = kDefaultBlockViterbiParameters)
+    {
+    auto const steps = soft.size() / kMotherCodeRate;
+    auto const bits = steps > kMotherCodeTailBits ? steps - kMotherCodeTailBits : 0;
+    auto const blockLength = std::max<std::size_t>(parameters.block_length, 1);
+
+    if(bits <= blockLength)
+      {
+      return viterbi_decode(soft);
+      }
+
+    auto decoded = std::vector<std::uint8_t>(bits);
+    task_group blocks{pool};
+
+    for(std::size_t begin{}; begin < bits; begin += blockLength)
+      {
+      blocks.run([&, begin]{
+        auto const end = std::min(begin + blockLength, bits);
+        auto const first = begin > parameters.warm_up ? begin - parameters.warm_up : 0;
+        auto const last = std::min(end + parameters.traceback, steps);
+        auto const data = soft.data() + first * kMotherCodeRate;
+
+        auto decisions = std::vector<std::uint64_t>{};
+        auto metrics = std::vector<float>{};
+        internal::viterbi_search(&data, 1, last - first, first == 0, decisions, metrics);
+
+        auto const state = last == steps ? 0 : internal::best_state(metrics, 1, 0);
+        internal::viterbi_traceback(decisions, 1, 0, last - first, state, begin - first, end - first, &decoded[begin]);
+      });
+      }
+
+    blocks.wait();
+    return decoded;
+    }
+
+  }
+
+#endif
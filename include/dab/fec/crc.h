@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_FEC_CRC
+#define DABCOMMON_FEC_CRC
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace dab
+  {
+
+  /**
+   * @brief The generator polynomial of the CRC16-CCITT used throughout DAB (x^16 + x^12 + x^5 + 1)
+   *
+   * @since 1.0.3
+   */
+  std::uint16_t constexpr kCrc16Polynomial{0x1021};
+
+  /**
+   * @brief The initial register value of the DAB CRC16
+   *
+   * @since 1.0.3
+   */
+  std::uint16_t constexpr kCrc16Initial{0xFFFF};
+
+  namespace internal
+    {
+
+    inline std::array<std::uint16_t, 256> const & crc16_table()
+      {
+      static auto const table = []{
+        auto entries = std::array<std::uint16_t, 256>{};
+        for(std::size_t index{}; index < entries.size(); ++index)
+          {
+          auto value = static_cast<std::uint16_t>(index << 8);
+          for(auto bit = 0; bit < 8; ++bit)
+            {
+            value = static_cast<std::uint16_t>(value & 0x8000 ? (value << 1) ^ kCrc16Polynomial : value << 1);
+            }
+          entries[index] = value;
+          }
+        return entries;
+      }();
+
+      return table;
+      }
+
+    }
+
+  /**
+   * @brief Calculate the CRC16-CCITT of a block of bytes
+   *
+   * @param data The first byte of the block
+   * @param size The number of bytes in the block
+   * @param crc The initial register value, which allows the calculation to be continued over several blocks
+   * @return The register value after the block, not yet complemented
+   *
+   * @since 1.0.3
+   */
+  inline std::uint16_t crc16(std::uint8_t const * data, std::size_t const size, std::uint16_t crc = kCrc16Initial)
+    {
+    auto const & table = internal::crc16_table();
+
+    for(std::size_t index{}; index < size; ++index)
+      {
+      crc = static_cast<std::uint16_t>((crc << 8) ^ table[((crc >> 8) ^ data[index]) & 0xFF]);
+      }
+
+    return crc;
+    }
+
+  /**
+   * @brief Check a block of bytes that is followed by its complemented CRC16, stored most significant byte first
+   *
+   * This is the layout used by FIBs, DAB+ access units and the PAD data groups.
+   *
+   * @param data The first byte of the block
+   * @param size The number of bytes in the block, including the two CRC bytes
+   *
+   * @since 1.0.3
+   */
+  inline bool crc16_valid(std::uint8_t const * data, std::size_t const size)
+    {
+    if(size < 2)
+      {
+      return false;
+      }
+
+    auto const expected = static_cast<std::uint16_t>(~crc16(data, size - 2));
+    return data[size - 2] == (expected >> 8) && data[size - 1] == (expected & 0xFF);
+    }
+
+  }
+
+#endif
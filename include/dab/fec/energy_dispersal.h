@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_FEC_ENERGY_DISPERSAL
+#define DABCOMMON_FEC_ENERGY_DISPERSAL
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief Generate the energy dispersal sequence
+   *
+   * The sequence is produced by the PRBS generator x^9 + x^5 + 1 with all register stages initialized to one. It is
+   * restarted for every FIC codeword and every logical frame of a sub-channel.
+   *
+   * @param size The number of bits to generate
+   * @return One bit per byte
+   *
+   * @since 1.0.3
+   */
+  inline std::vector<std::uint8_t> energy_dispersal_sequence(std::size_t const size)
+    {
+    auto sequence = std::vector<std::uint8_t>(size);
+    auto state = std::uint16_t{0x1FF};
+
+    for(auto & bit : sequence)
+      {
+      bit = ((state >> 4) ^ (state >> 8)) & 1;
+      state = static_cast<std::uint16_t>(((state << 1) | bit) & 0x1FF);
+      }
+
+    return sequence;
+    }
+
+  /**
+   * @brief Apply or remove the energy dispersal of a block of bits
+   *
+   * @param bits The bits to scramble, one bit per byte
+   *
+   * @since 1.0.3
+   */
+  inline void apply_energy_dispersal(std::vector<std::uint8_t> & bits)
+    {
+    auto const sequence = energy_dispersal_sequence(bits.size());
+
+    for(std::size_t index{}; index < bits.size(); ++index)
+      {
+      bits[index] ^= sequence[index];
+      }
+    }
+
+  }
+
+#endif
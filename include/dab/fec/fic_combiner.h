@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_FEC_FIC_COMBINER
+#define DABCOMMON_FEC_FIC_COMBINER
+
+#include "dab/fec/crc.h"
+#include "dab/fec/energy_dispersal.h"
+#include "dab/fec/viterbi.h"
+#include "dab/system/tracing.h"
+#include "dab/types/common_types.h"
+#include "dab/types/parse_status.h"
+#include "dab/types/transmission_mode.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief The number of bytes in a Fast Information Block, including its CRC
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kFibBytes{32};
+
+  /**
+   * @brief The default number of failed codewords combined by a dab::fic_combiner
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kDefaultFicCombiningDepth{4};
+
+  /**
+   * @brief A FIC decoder that combines the soft bits of failed codewords across frames
+   *
+   * The FIG carousel repeats the same content in consecutive frames. When a FIC codeword fails its CRC check, its
+   * depunctured soft bits are added to an accumulator for its CIF position. Each following codeword of that position is
+   * decoded both on its own and combined with the accumulator, in a single pass of the multi-stream Viterbi decoder.
+   * Every FIB takes the first result that passes its CRC check. Once all FIBs of a codeword pass, the accumulator is
+   * cleared, so a combined result never mixes in content older than the last completely decoded codeword. If only some
+   * FIBs pass, the codeword is still accumulated, so that the remaining FIBs can be recovered from later codewords.
+   *
+   * Older contributions are weighted down so that the accumulator covers roughly the last @p depth codewords. A depth
+   * of one disables combining.
+   *
+   * @since 1.0.3
+   */
+  struct fic_combiner
+    {
+    /**
+     * @brief Construct a combiner for the given transmission mode
+     *
+     * @param mode The transmission mode defining the number and size of the FIC codewords
+     * @param depth The number of failed codewords to combine
+     *
+     * @since 1.0.3
+     */
+    explicit fic_combiner(internal::types::transmission_mode const & mode, std::size_t const depth = kDefaultFicCombiningDepth)
+      : m_bits{mode.fib_codeword_bits},
+        m_fibs{mode.fib_codeword_bits / (kFibBytes * 8)},
+        m_forgetting{depth > 1 ? 1.0f - 1.0f / depth : 0.0f},
+        m_slots(mode.frame_cifs),
+        m_dispersal{energy_dispersal_sequence(mode.fib_codeword_bits)}
+      {
+      }
+
+    /**
+     * @brief Decode a FIC codeword
+     *
+     * @param cif The position of the codeword's CIF in its transmission frame
+     * @param soft The depunctured soft bits of the codeword, including the tail
+     * @return The status and bytes of each FIB carried by the codeword
+     *
+     * @throws std::out_of_range if @p cif is not a CIF position of the transmission mode
+     * @throws std::invalid_argument if @p soft does not have the size of a FIC codeword
+     *
+     * @since 1.0.3
+     */
+    std::vector<pair_status_vector_t> decode(std::size_t const cif, std::vector<float> const & soft)
+      {
+      if(cif >= m_slots.size())
+        {
+        throw std::out_of_range{"CIF position outside of the transmission frame"};
+        }
+
+      if(soft.size() != (m_bits + kMotherCodeTailBits) * kMotherCodeRate)
+        {
+        throw std::invalid_argument{"Soft bits do not match the FIC codeword size"};
+        }
+
+      auto & slot = m_slots[cif];
+      auto const combining = slot.count > 0;
+      DABCOMMON_PROBE3(fic_decode, this, cif, combining);
+
+      m_streams.resize(combining ? 2 : 1);
+      m_streams[0].assign(soft.begin(), soft.end());
+      if(combining)
+        {
+        m_streams[1].resize(soft.size());
+        for(std::size_t index{}; index < soft.size(); ++index)
+          {
+          m_streams[1][index] = slot.accumulated[index] + soft[index];
+          }
+        }
+
+      auto const decoded = m_decoder.decode(m_streams);
+      auto fibs = std::vector<pair_status_vector_t>(m_fibs, pair_status_vector_t{parse_status::invalid_crc, {}});
+      auto complete = true;
+
+      for(std::size_t fib{}; fib < m_fibs; ++fib)
+        {
+        for(std::size_t stream{}; stream < decoded.size() && fibs[fib].first != parse_status::ok; ++stream)
+          {
+          auto bytes = pack(decoded[stream], fib);
+          if(crc16_valid(bytes.data(), bytes.size()))
+            {
+            fibs[fib] = {parse_status::ok, std::move(bytes)};
+            m_recovered += stream > 0;
+            }
+          }
+
+        complete &= fibs[fib].first == parse_status::ok;
+        }
+
+      if(complete || m_forgetting == 0.0f)
+        {
+        slot.count = 0;
+        }
+      else
+        {
+        accumulate(slot, soft);
+        }
+
+      return fibs;
+      }
+
+    /**
+     * @brief Get the number of FIBs that were only recovered by combining
+     *
+     * @since 1.0.3
+     */
+    std::size_t recovered() const
+      {
+      return m_recovered;
+      }
+
+    /**
+     * @brief Forget all accumulated soft bits, e.g. after retuning
+     *
+     * @since 1.0.3
+     */
+    void reset()
+      {
+      for(auto & slot : m_slots)
+        {
+        slot.count = 0;
+        }
+      }
+
+    private:
+      struct accumulator
+        {
+        std::size_t count{};
+        std::vector<float> accumulated{};
+        };
+
+      byte_vector_t pack(std::vector<std::uint8_t> const & bits, std::size_t const fib) const
+        {
+        auto bytes = byte_vector_t(kFibBytes);
+
+        for(std::size_t bit{}; bit < kFibBytes * 8; ++bit)
+          {
+          auto const index = fib * kFibBytes * 8 + bit;
+          bytes[bit / 8] |= static_cast<std::uint8_t>((bits[index] ^ m_dispersal[index]) << (7 - bit % 8));
+          }
+
+        return bytes;
+        }
+
+      void accumulate(accumulator & slot, std::vector<float> const & soft)
+        {
+        if(slot.count == 0)
+          {
+          slot.accumulated.assign(soft.begin(), soft.end());
+          }
+        else
+          {
+          for(std::size_t index{}; index < soft.size(); ++index)
+            {
+            slot.accumulated[index] = slot.accumulated[index] * m_forgetting + soft[index];
+            }
+          }
+
+        ++slot.count;
+        }
+
+      std::size_t const m_bits;
+      std::size_t const m_fibs;
+      float const m_forgetting;
+      std::vector<accumulator> m_slots;
+      std::vector<std::uint8_t> const m_dispersal;
+      std::vector<std::vector<float>> m_streams{};
+      multi_stream_viterbi m_decoder{};
+      std::size_t m_recovered{};
+    };
+
+  }
+
+#endif
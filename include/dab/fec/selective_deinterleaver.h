@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_FEC_SELECTIVE_DEINTERLEAVER
+#define DABCOMMON_FEC_SELECTIVE_DEINTERLEAVER
+
+#include "dab/system/tracing.h"
+#include "dab/types/subscription_set.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief The number of bits in a Capacity Unit
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kCapacityUnitBits{64};
+
+  /**
+   * @brief The number of Capacity Units in a Common Interleaved Frame
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kCifCapacityUnits{864};
+
+  /**
+   * @brief The number of CIFs spanned by the time interleaver
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kTimeInterleavingDepth{16};
+
+  namespace internal
+    {
+
+    /**
+     * @internal
+     *
+     * @brief The delay, in CIFs, applied by the time interleaver to each bit position modulo 16
+     */
+    std::array<std::uint8_t, kTimeInterleavingDepth> constexpr kTimeInterleavingDelays{{
+      0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15
+    }};
+
+    }
+
+  /**
+   * @brief The position of a sub-channel within the CIF
+   *
+   * @since 1.0.3
+   */
+  struct subchannel_descriptor
+    {
+    std::size_t id; ///< The sub-channel identifier
+    std::size_t start; ///< The address of the first Capacity Unit of the sub-channel
+    std::size_t size; ///< The number of Capacity Units occupied by the sub-channel
+    };
+
+  /**
+   * @brief A time deinterleaver that only processes subscribed sub-channels
+   *
+   * Instead of keeping deinterleaver state for every sub-channel of the ensemble, this class keeps a history of the
+   * last 16 CIFs. When a CIF is pushed, only the subscribed sub-channels are deinterleaved straight out of the history
+   * and handed to the consumer, so depuncturing and Viterbi decoding are only spent on services that are actually
+   * used. Because the history is shared, a sub-channel subscribed at runtime is fully warmed up at the next CIF.
+   *
+   * Subscriptions may be changed from any thread. Configuration and pushing CIFs must happen on the same thread.
+   *
+   * @since 1.0.3
+   */
+  struct selective_deinterleaver
+    {
+    selective_deinterleaver()
+      : m_history(kTimeInterleavingDepth, std::vector<float>(kCifCapacityUnits * kCapacityUnitBits))
+      {
+      }
+
+    /**
+     * @brief Set the sub-channel organization of the ensemble
+     *
+     * @throws std::out_of_range if a sub-channel exceeds the CIF or has an invalid identifier
+     */
+    void configure(std::vector<subchannel_descriptor> subchannels)
+      {
+      for(auto const & subchannel : subchannels)
+        {
+        if(subchannel.id >= kSubchannelIds || subchannel.start + subchannel.size > kCifCapacityUnits)
+          {
+          throw std::out_of_range{"Sub-channel outside of the CIF"};
+          }
+        }
+
+      m_subchannels = std::move(subchannels);
+      }
+
+    /**
+     * @brief Access the subscriptions of this deinterleaver
+     */
+    subscription_set & subscriptions()
+      {
+      return m_subscriptions;
+      }
+
+    /**
+     * @brief Check whether enough CIFs have been pushed for deinterleaving to yield valid data
+     */
+    bool warm() const
+      {
+      return m_pushed >= kTimeInterleavingDepth;
+      }
+
+    /**
+     * @brief Push the soft bits of a CIF and deinterleave the subscribed sub-channels
+     *
+     * @param cif The soft bits of a complete CIF
+     * @param deliver A callable invoked as deliver(subchannel_descriptor const &, std::vector<float> const &) for each
+     *        subscribed sub-channel once the deinterleaver is warm
+     * @return The number of sub-channels delivered
+     *
+     * @throws std::invalid_argument if @p cif does not have the size of a CIF
+     */
+    template<typename DeliveryFunction>
+    std::size_t push(std::vector<float> const & cif, DeliveryFunction && deliver)
+      {
+      if(cif.size() != kCifCapacityUnits * kCapacityUnitBits)
+        {
+        throw std::invalid_argument{"Soft bits do not match the CIF size"};
+        }
+
+      DABCOMMON_PROBE2(cif_start, this, m_pushed);
+      m_history[m_pushed % kTimeInterleavingDepth].assign(cif.begin(), cif.end());
+      ++m_pushed;
+
+      if(!warm())
+        {
+        return 0;
+        }
+
+      auto const subscribed = m_subscriptions.snapshot();
+      auto delivered = std::size_t{};
+
+      for(auto const & subchannel : m_subchannels)
+        {
+        if(subscribed & (std::uint64_t{1} << subchannel.id))
+          {
+          deinterleave(subchannel);
+          deliver(subchannel, static_cast<std::vector<float> const &>(m_output));
+          ++delivered;
+          }
+        }
+
+      return delivered;
+      }
+
+    private:
+      void deinterleave(subchannel_descriptor const & subchannel)
+        {
+        auto const offset = subchannel.start * kCapacityUnitBits;
+        auto const newest = m_pushed - 1;
+
+        m_output.resize(subchannel.size * kCapacityUnitBits);
+
+        for(std::size_t index{}; index < m_output.size(); ++index)
+          {
+          auto const delay = kTimeInterleavingDepth - 1 - internal::kTimeInterleavingDelays[index % kTimeInterleavingDepth];
+          m_output[index] = m_history[(newest - delay) % kTimeInterleavingDepth][offset + index];
+          }
+        }
+
+      std::vector<std::vector<float>> m_history;
+      std::vector<subchannel_descriptor> m_subchannels{};
+      subscription_set m_subscriptions{};
+      std::vector<float> m_output{};
+      std::size_t m_pushed{};
+    };
+
+  }
+
+#endif
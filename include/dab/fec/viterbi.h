@@ -0,0 +1,529 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_FEC_VITERBI
+#define DABCOMMON_FEC_VITERBI
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <vector>
+
+/**
+ * @file
+ *
+ * @brief This file contains the decoder for the convolutional mother code of DAB
+ *
+ * DAB uses a rate 1/4 convolutional code with constraint length 7 (ETSI EN 300 401, clause 11.1). The decoders in this
+ * file operate on depunctured soft bits: a positive soft bit indicates a 1, a negative soft bit a 0, and 0 marks an
+ * erasure (e.g. a punctured bit). Decoded bits are returned unpacked, one bit per byte.
+ *
+ * @since 1.0.3
+ */
+
+namespace dab
+  {
+
+  /**
+   * @brief The number of coded bits per information bit of the DAB mother code
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kMotherCodeRate{4};
+
+  /**
+   * @brief The number of tail bits terminating a DAB convolutional codeword
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kMotherCodeTailBits{6};
+
+  /**
+   * @brief The number of codewords decoded in lockstep by dab::multi_stream_viterbi
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kViterbiLanes{8};
+
+  namespace internal
+    {
+
+    /**
+     * @internal
+     * @brief The number of states of the DAB mother code trellis
+     */
+    std::size_t constexpr kViterbiStates{64};
+
+    /**
+     * @internal
+     * @brief The generator polynomials of the DAB mother code (octal 133, 171, 145, 133)
+     *
+     * Bit 6 of the shift register holds the current input bit, bit 0 the input bit six steps ago.
+     */
+    std::array<std::uint8_t, kMotherCodeRate> constexpr kMotherCodePolynomials{{0133, 0171, 0145, 0133}};
+
+    /**
+     * @internal
+     * @brief Get the output pattern of the encoder for the given register contents
+     *
+     * @return The coded bits, with coded bit @p i stored in bit @p i of the result
+     */
+    inline std::uint8_t encoder_output(unsigned const shiftRegister)
+      {
+      auto pattern = std::uint8_t{};
+
+      for(std::size_t output{}; output < kMotherCodeRate; ++output)
+        {
+        auto taps = shiftRegister & kMotherCodePolynomials[output];
+        auto parity = 0u;
+
+        while(taps)
+          {
+          parity ^= 1;
+          taps &= taps - 1;
+          }
+
+        pattern |= static_cast<std::uint8_t>(parity << output);
+        }
+
+      return pattern;
+      }
+
+    /**
+     * @internal
+     * @brief The output patterns of the encoder for all 128 register states
+     */
+    inline std::array<std::uint8_t, 2 * kViterbiStates> const & encoder_outputs()
+      {
+      static auto const table = []{
+        auto outputs = std::array<std::uint8_t, 2 * kViterbiStates>{};
+        for(unsigned shiftRegister{}; shiftRegister < outputs.size(); ++shiftRegister)
+          {
+          outputs[shiftRegister] = encoder_output(shiftRegister);
+          }
+        return outputs;
+      }();
+
+      return table;
+      }
+
+    /**
+     * @internal
+     * @brief The trellis search of the Viterbi algorithm, decoding several codewords in lockstep
+     *
+     * The path metrics and branch metrics are stored lane-minor, so that the compiler can vectorize the inner loops
+     * across lanes. Each lane records one decision word (one bit per state) per step.
+     *
+     * @param soft Pointers to the soft bits of each lane
+     * @param lanes The number of lanes
+     * @param steps The number of trellis steps, i.e. information bits including tail bits
+     * @param knownStart Whether the encoder started in state 0. If not, all start states are considered equally likely.
+     * @param decisions Receives steps * lanes decision words
+     * @param metrics Receives the final path metrics (kViterbiStates * lanes)
+     *
+     * @since 1.0.3
+     */
+    inline void viterbi_search(float const * const * const soft,
+                               std::size_t const lanes,
+                               std::size_t const steps,
+                               bool const knownStart,
+                               std::vector<std::uint64_t> & decisions,
+                               std::vector<float> & metrics)
+      {
+      auto constexpr kNormalizationInterval = std::size_t{32};
+      auto constexpr kPatterns = std::size_t{1} << kMotherCodeRate;
+      auto const & outputs = encoder_outputs();
+
+      auto current = std::vector<float>(kViterbiStates * lanes, knownStart ? -1e9f : 0.0f);
+      auto next = std::vector<float>(kViterbiStates * lanes);
+      auto branch = std::vector<float>(kPatterns * lanes);
+
+      if(knownStart)
+        {
+        std::fill(current.begin(), current.begin() + lanes, 0.0f);
+        }
+
+      decisions.assign(steps * lanes, 0);
+
+      for(std::size_t step{}; step < steps; ++step)
+        {
+        for(std::size_t pattern{}; pattern < kPatterns; ++pattern)
+          {
+          auto const target = &branch[pattern * lanes];
+          for(std::size_t lane{}; lane < lanes; ++lane)
+            {
+            auto const bits = soft[lane] + step * kMotherCodeRate;
+            auto sum = 0.0f;
+            for(std::size_t output{}; output < kMotherCodeRate; ++output)
+              {
+              sum += (pattern >> output) & 1 ? bits[output] : -bits[output];
+              }
+            target[lane] = sum;
+            }
+          }
+
+        auto const decision = &decisions[step * lanes];
+
+        for(std::size_t state{}; state < kViterbiStates; ++state)
+          {
+          auto const input = state >> 5;
+          auto const first = (state << 1) & (kViterbiStates - 1);
+          auto const second = first | 1;
+          auto const firstMetrics = &current[first * lanes];
+          auto const secondMetrics = &current[second * lanes];
+          auto const firstBranch = &branch[outputs[input << 6 | first] * lanes];
+          auto const secondBranch = &branch[outputs[input << 6 | second] * lanes];
+          auto const target = &next[state * lanes];
+
+          for(std::size_t lane{}; lane < lanes; ++lane)
+            {
+            auto const viaFirst = firstMetrics[lane] + firstBranch[lane];
+            auto const viaSecond = secondMetrics[lane] + secondBranch[lane];
+            auto const choice = viaSecond > viaFirst;
+            target[lane] = choice ? viaSecond : viaFirst;
+            decision[lane] |= static_cast<std::uint64_t>(choice) << state;
+            }
+          }
+
+        if(step % kNormalizationInterval == kNormalizationInterval - 1)
+          {
+          for(std::size_t state{1}; state < kViterbiStates; ++state)
+            {
+            for(std::size_t lane{}; lane < lanes; ++lane)
+              {
+              next[state * lanes + lane] -= next[lane];
+              }
+            }
+          std::fill(next.begin(), next.begin() + lanes, 0.0f);
+          }
+
+        current.swap(next);
+        }
+
+      metrics = std::move(current);
+      }
+
+    /**
+     * @internal
+     * @brief Trace back the survivor path of a lane
+     *
+     * @param decisions The decision words produced by viterbi_search
+     * @param lanes The number of lanes of the search
+     * @param lane The lane to trace back
+     * @param steps The number of steps of the search
+     * @param state The state to start the traceback in
+     * @param begin The first step whose bit is written to @p output
+     * @param end One past the last step whose bit is written to @p output
+     * @param output Receives end - begin decoded bits
+     *
+     * @since 1.0.3
+     */
+    inline void viterbi_traceback(std::vector<std::uint64_t> const & decisions,
+                                  std::size_t const lanes,
+                                  std::size_t const lane,
+                                  std::size_t const steps,
+                                  std::size_t state,
+                                  std::size_t const begin,
+                                  std::size_t const end,
+                                  std::uint8_t * const output)
+      {
+      for(auto step = steps; step-- > begin;)
+        {
+        if(step < end)
+          {
+          output[step - begin] = static_cast<std::uint8_t>(state >> 5);
+          }
+
+        auto const choice = (decisions[step * lanes + lane] >> state) & 1;
+        state = ((state << 1) & (kViterbiStates - 1)) | choice;
+        }
+      }
+
+    /**
+     * @internal
+     * @brief Find the state with the best path metric of a lane
+     *
+     * @since 1.0.3
+     */
+    inline std::size_t best_state(std::vector<float> const & metrics, std::size_t const lanes, std::size_t const lane)
+      {
+      auto best = std::size_t{};
+
+      for(std::size_t state{1}; state < kViterbiStates; ++state)
+        {
+        if(metrics[state * lanes + lane] > metrics[best * lanes + lane])
+          {
+          best = state;
+          }
+        }
+
+      return best;
+      }
+
+    }
+
+  /**
+   * @brief Encode a sequence of bits using the DAB mother code
+   *
+   * The codeword is terminated using kMotherCodeTailBits zero bits. This function serves as a reference for testing the
+   * decoders.
+   *
+   * @param bits The unpacked information bits
+   * @return The unpacked, unpunctured codeword of size (bits.size() + kMotherCodeTailBits) * kMotherCodeRate
+   *
+   * @since 1.0.3
+   */
+  inline std::vector<std::uint8_t> convolutional_encode(std::vector<std::uint8_t> const & bits)
+    {
+    auto codeword = std::vector<std::uint8_t>{};
+    codeword.reserve((bits.size() + kMotherCodeTailBits) * kMotherCodeRate);
+
+    auto state = 0u;
+    auto const encode = [&](unsigned const bit) {
+      auto const shiftRegister = (bit & 1) << 6 | state;
+      auto const pattern = internal::encoder_output(shiftRegister);
+      for(std::size_t output{}; output < kMotherCodeRate; ++output)
+        {
+        codeword.push_back((pattern >> output) & 1);
+        }
+      state = shiftRegister >> 1;
+    };
+
+    for(auto const bit : bits)
+      {
+      encode(bit);
+      }
+
+    for(std::size_t tail{}; tail < kMotherCodeTailBits; ++tail)
+      {
+      encode(0);
+      }
+
+    return codeword;
+    }
+
+  /**
+   * @brief Decode a terminated DAB mother code codeword
+   *
+   * @param soft The depunctured soft bits of the codeword, including the tail
+   * @return The decoded information bits, without the tail bits
+   *
+   * @since 1.0.3
+   */
+  inline std::vector<std::uint8_t> viterbi_decode(std::vector<float> const & soft)
+    {
+    auto const steps = soft.size() / kMotherCodeRate;
+    auto const bits = steps > kMotherCodeTailBits ? steps - kMotherCodeTailBits : 0;
+    auto const data = soft.data();
+
+    auto decisions = std::vector<std::uint64_t>{};
+    auto metrics = std::vector<float>{};
+    internal::viterbi_search(&data, 1, steps, true, decisions, metrics);
+
+    auto decoded = std::vector<std::uint8_t>(bits);
+    internal::viterbi_traceback(decisions, 1, 0, steps, 0, 0, bits, decoded.data());
+    return decoded;
+    }
+
+  /**
+   * @brief Decode a terminated DAB mother code codeword using hard decisions
+   *
+   * The soft bits are sliced to hard bits and the trellis search uses integer Hamming distances with table lookups,
+   * which is cheaper than the soft decision search of dab::viterbi_decode at the cost of about 2 dB of coding gain.
+   * Erasures (soft bits of 0) do not contribute to the distance. This decoder is meant as a fallback when the CPU is
+   * overloaded.
+   *
+   * @param soft The depunctured soft bits of the codeword, including the tail
+   * @return The decoded information bits, without the tail bits
+   *
+   * @since 1.0.3
+   */
+  inline std::vector<std::uint8_t> viterbi_decode_hard(std::vector<float> const & soft)
+    {
+    auto constexpr kNormalizationInterval = std::size_t{64};
+    auto constexpr kUnreachable = std::uint32_t{1} << 24;
+    auto const steps = soft.size() / kMotherCodeRate;
+    auto const bits = steps > kMotherCodeTailBits ? steps - kMotherCodeTailBits : 0;
+    auto const & outputs = internal::encoder_outputs();
+
+    auto current = std::array<std::uint32_t, internal::kViterbiStates>{};
+    auto next = std::array<std::uint32_t, internal::kViterbiStates>{};
+    auto branch = std::array<std::uint32_t, std::size_t{1} << kMotherCodeRate>{};
+    auto decisions = std::vector<std::uint64_t>(steps);
+
+    current.fill(kUnreachable);
+    current[0] = 0;
+
+    for(std::size_t step{}; step < steps; ++step)
+      {
+      auto received = 0u;
+      auto valid = 0u;
+      for(std::size_t output{}; output < kMotherCodeRate; ++output)
+        {
+        auto const bit = soft[step * kMotherCodeRate + output];
+        received |= static_cast<unsigned>(bit > 0.0f) << output;
+        valid |= static_cast<unsigned>(bit != 0.0f) << output;
+        }
+
+      for(std::size_t pattern{}; pattern < branch.size(); ++pattern)
+        {
+        auto difference = (pattern ^ received) & valid;
+        auto distance = 0u;
+        while(difference)
+          {
+          ++distance;
+          difference &= difference - 1;
+          }
+        branch[pattern] = distance;
+        }
+
+      auto decision = std::uint64_t{};
+      for(std::size_t state{}; state < internal::kViterbiStates; ++state)
+        {
+        auto const input = state >> 5;
+        auto const first = (state << 1) & (internal::kViterbiStates - 1);
+        auto const second = first | 1;
+        auto const viaFirst = current[first] + branch[outputs[input << 6 | first]];
+        auto const viaSecond = current[second] + branch[outputs[input << 6 | second]];
+        auto const choice = viaSecond < viaFirst;
+        next[state] = choice ? viaSecond : viaFirst;
+        decision |= static_cast<std::uint64_t>(choice) << state;
+        }
+
+      decisions[step] = decision;
+
+      if(step % kNormalizationInterval == kNormalizationInterval - 1)
+        {
+        auto const minimum = *std::min_element(next.begin(), next.end());
+        for(auto & metric : next)
+          {
+          metric -= minimum;
+          }
+        }
+
+      current.swap(next);
+      }
+
+    auto decoded = std::vector<std::uint8_t>(bits);
+    internal::viterbi_traceback(decisions, 1, 0, steps, 0, 0, bits, decoded.data());
+    return decoded;
+    }
+
+  /**
+   * @brief A Viterbi decoder processing several independent codewords in lockstep
+   *
+   * With 64 states, a single codeword does not fill the vector units of modern CPUs, and for short codewords, like
+   * those of low-bitrate sub-channels or the FIC, the per-call overhead dominates. This decoder interleaves up to
+   * kViterbiLanes codewords of equal length, so that each operation of the trellis search processes all of them at
+   * once. The traceback of all codewords of a batch is performed in a single pass over the shared decision memory.
+   *
+   * @since 1.0.3
+   */
+  struct multi_stream_viterbi
+    {
+    /**
+     * @brief Decode a number of terminated codewords
+     *
+     * Codewords of equal length are decoded together, codewords of different lengths may be mixed freely.
+     *
+     * @param codewords The depunctured soft bits of each codeword, including the tail
+     * @return The decoded information bits of each codeword, in the order of @p codewords
+     *
+     * @since 1.0.3
+     */
+    std::vector<std::vector<std::uint8_t>> decode(std::vector<std::vector<float>> const & codewords)
+      {
+      auto decoded = std::vector<std::vector<std::uint8_t>>(codewords.size());
+      auto byLength = std::map<std::size_t, std::vector<std::size_t>>{};
+
+      for(std::size_t index{}; index < codewords.size(); ++index)
+        {
+        byLength[codewords[index].size() / kMotherCodeRate].push_back(index);
+        }
+
+      for(auto const & group : byLength)
+        {
+        auto const & members = group.second;
+        for(std::size_t offset{}; offset < members.size(); offset += kViterbiLanes)
+          {
+          auto const lanes = std::min(kViterbiLanes, members.size() - offset);
+          decode_batch(codewords, &members[offset], lanes, group.first, decoded);
+          }
+        }
+
+      return decoded;
+      }
+
+    private:
+      void decode_batch(std::vector<std::vector<float>> const & codewords,
+                        std::size_t const * const members,
+                        std::size_t const lanes,
+                        std::size_t const steps,
+                        std::vector<std::vector<std::uint8_t>> & decoded)
+        {
+        auto const bits = steps > kMotherCodeTailBits ? steps - kMotherCodeTailBits : 0;
+        auto soft = std::array<float const *, kViterbiLanes>{};
+
+        for(std::size_t lane{}; lane < lanes; ++lane)
+          {
+          soft[lane] = codewords[members[lane]].data();
+          decoded[members[lane]].resize(bits);
+          }
+
+        internal::viterbi_search(soft.data(), lanes, steps, true, m_decisions, m_metrics);
+
+        auto states = std::array<std::size_t, kViterbiLanes>{};
+
+        for(auto step = steps; step-- > 0;)
+          {
+          auto const decisions = &m_decisions[step * lanes];
+          for(std::size_t lane{}; lane < lanes; ++lane)
+            {
+            auto & state = states[lane];
+            if(step < bits)
+              {
+              decoded[members[lane]][step] = static_cast<std::uint8_t>(state >> 5);
+              }
+            state = ((state << 1) & (internal::kViterbiStates - 1)) | ((decisions[lane] >> state) & 1);
+            }
+          }
+        }
+
+      std::vector<std::uint64_t> m_decisions{};
+      std::vector<float> m_metrics{};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,845 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_MONITORING_METRICS
+#define DABCOMMON_MONITORING_METRICS
+
+#include "dab/types/parse_status.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @file
+ *
+ * @brief This file contains a registry of metrics that can be rendered in the Prometheus text format
+ *
+ * Counters and histograms are sharded: every thread updates a shard of its own with a single relaxed atomic operation,
+ * and the shards are only summed up when the metrics are rendered. This keeps updates on the hot path free of locks and
+ * of contended cache lines. Registering a metric takes a lock and should happen during setup.
+ *
+ * @code
+ * dab::metrics_registry metrics{};
+ * auto & frames = metrics.counter("dab_frames_decoded_total", "Transmission frames decoded");
+ * auto & losses = metrics.counter("dab_sync_losses_total", "Losses of synchronization");
+ * auto fic = dab::parse_status_metrics{metrics, "dab_fib_total", "FIBs by parse status"};
+ * dab::watch_queue(metrics, samples, {{"queue", "samples"}});
+ * ...
+ * frames.increment();
+ * fic.count(status);
+ * ...
+ * dab::write_metrics_file(metrics, "/var/lib/node_exporter/dab.prom");
+ * @endcode
+ *
+ * See dab::metrics_server for serving the metrics to a scraper.
+ *
+ * @since 1.0.3
+ */
+
+namespace dab
+  {
+
+  /**
+   * @brief The number of shards of sharded metrics
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kMetricShards{16};
+
+  /**
+   * @brief The labels of a metric, as pairs of label name and value
+   *
+   * @since 1.0.3
+   */
+  using metric_labels = std::vector<std::pair<std::string, std::string>>;
+
+  namespace internal
+    {
+
+    /**
+     * @internal
+     * @brief The size of a cache line in bytes
+     *
+     * @since 1.0.3
+     */
+    std::size_t constexpr kCacheLineBytes{64};
+
+    /**
+     * @internal
+     * @brief The number of 64-bit words in a cache line
+     *
+     * @since 1.0.3
+     */
+    std::size_t constexpr kCacheLineWords{kCacheLineBytes / sizeof(std::uint64_t)};
+
+    /**
+     * @internal
+     * @brief A zero-initialized array of atomic 64-bit words starting on a cache line boundary
+     *
+     * Sharded metrics lay out their shards in rows of whole cache lines, so that threads updating different shards
+     * never share a line. Since operator new does not honour over-aligned types before C++17, the array is aligned
+     * within a slightly larger allocation.
+     *
+     * @since 1.0.3
+     */
+    struct cache_aligned_words
+      {
+      using word_type = std::atomic<std::uint64_t>;
+
+      static_assert(sizeof(word_type) == sizeof(std::uint64_t) && alignof(word_type) == sizeof(std::uint64_t),
+                    "Atomic words must be naturally aligned");
+
+      explicit cache_aligned_words(std::size_t const words)
+        : m_storage{new word_type[words + kCacheLineWords - 1]()}
+        , m_words{m_storage.get() + offset(m_storage.get())}
+        {
+
+        }
+
+      word_type & operator[](std::size_t const index)
+        {
+        return m_words[index];
+        }
+
+      word_type const & operator[](std::size_t const index) const
+        {
+        return m_words[index];
+        }
+
+      private:
+        static std::size_t offset(word_type const * const storage)
+          {
+          auto const misalignment = reinterpret_cast<std::uintptr_t>(storage) % kCacheLineBytes;
+          return misalignment ? (kCacheLineBytes - misalignment) / sizeof(word_type) : 0;
+          }
+
+        std::unique_ptr<word_type[]> m_storage;
+        word_type * m_words;
+      };
+
+    /**
+     * @internal
+     * @brief Get the shard of the calling thread
+     *
+     * Threads are assigned shards round-robin on their first update of any metric.
+     *
+     * @since 1.0.3
+     */
+    inline std::size_t metric_shard()
+      {
+      static std::atomic<std::size_t> next{};
+      static thread_local auto const shard = next++ % kMetricShards;
+      return shard;
+      }
+
+    /**
+     * @internal
+     * @brief Reinterpret a double as its bit pattern
+     *
+     * @since 1.0.3
+     */
+    inline std::uint64_t to_bits(double const value)
+      {
+      auto bits = std::uint64_t{};
+      std::memcpy(&bits, &value, sizeof(bits));
+      return bits;
+      }
+
+    /**
+     * @internal
+     * @brief Reinterpret a bit pattern as a double
+     *
+     * @since 1.0.3
+     */
+    inline double from_bits(std::uint64_t const bits)
+      {
+      auto value = double{};
+      std::memcpy(&value, &bits, sizeof(value));
+      return value;
+      }
+
+    /**
+     * @internal
+     * @brief Atomically add to a double stored as its bit pattern
+     *
+     * @since 1.0.3
+     */
+    inline void add_bits(std::atomic<std::uint64_t> & target, double const value)
+      {
+      auto expected = target.load(std::memory_order_relaxed);
+      while(!target.compare_exchange_weak(expected, to_bits(from_bits(expected) + value), std::memory_order_relaxed))
+        {
+        }
+      }
+
+    /**
+     * @internal
+     * @brief Format a sample value as specified by the Prometheus text format
+     *
+     * @since 1.0.3
+     */
+    inline std::string format_metric_value(double const value)
+      {
+      if(std::isnan(value))
+        {
+        return "NaN";
+        }
+
+      if(std::isinf(value))
+        {
+        return value > 0 ? "+Inf" : "-Inf";
+        }
+
+      std::ostringstream stream{};
+      stream.precision(std::numeric_limits<double>::digits10);
+      stream << value;
+      return stream.str();
+      }
+
+    /**
+     * @internal
+     * @brief Check whether a string is a valid Prometheus metric or label name
+     *
+     * @since 1.0.3
+     */
+    inline bool valid_metric_name(std::string const & name, bool const label)
+      {
+      if(name.empty())
+        {
+        return false;
+        }
+
+      for(std::size_t index{}; index < name.size(); ++index)
+        {
+        auto const character = name[index];
+        auto const letter = (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') ||
+                            character == '_' || (!label && character == ':');
+
+        if(!letter && (!index || character < '0' || character > '9'))
+          {
+          return false;
+          }
+        }
+
+      return true;
+      }
+
+    /**
+     * @internal
+     * @brief Render a set of labels, optionally extended by a further label
+     *
+     * @since 1.0.3
+     */
+    inline std::string format_labels(metric_labels const & labels, std::string const & extraName = {},
+                                     std::string const & extraValue = {})
+      {
+      auto all = labels;
+      if(!extraName.empty())
+        {
+        all.emplace_back(extraName, extraValue);
+        }
+
+      if(all.empty())
+        {
+        return {};
+        }
+
+      auto result = std::string{"{"};
+      for(std::size_t index{}; index < all.size(); ++index)
+        {
+        result += (index ? "," : "") + all[index].first + "=\"";
+        for(auto const character : all[index].second)
+          {
+          switch(character)
+            {
+            case '\\': result += "\\\\"; break;
+            case '"': result += "\\\""; break;
+            case '\n': result += "\\n"; break;
+            default: result += character;
+            }
+          }
+        result += '"';
+        }
+
+      return result + '}';
+      }
+
+    /**
+     * @internal
+     * @brief Get the name of a parse status as used in metric labels
+     *
+     * @since 1.0.3
+     */
+    inline char const * parse_status_name(parse_status const status)
+      {
+      switch(status)
+        {
+        case parse_status::invalid_crc: return "invalid_crc";
+        case parse_status::invalid_address: return "invalid_address";
+        case parse_status::incomplete: return "incomplete";
+        case parse_status::segment_lost: return "segment_lost";
+        case parse_status::ok: return "ok";
+        }
+
+      return "unknown";
+      }
+
+    }
+
+  /**
+   * @brief A monotonically increasing counter, sharded per thread
+   *
+   * @since 1.0.3
+   */
+  struct metrics_counter
+    {
+    metrics_counter()
+      : m_cells(kMetricShards * internal::kCacheLineWords)
+      {
+
+      }
+
+    metrics_counter(metrics_counter const &) = delete;
+    metrics_counter & operator=(metrics_counter const &) = delete;
+
+    /**
+     * @brief Increment the counter
+     */
+    void increment(std::uint64_t const amount = 1)
+      {
+      m_cells[internal::metric_shard() * internal::kCacheLineWords].fetch_add(amount, std::memory_order_relaxed);
+      }
+
+    /**
+     * @brief Get the value of the counter, summed over all shards
+     */
+    std::uint64_t value() const
+      {
+      auto sum = std::uint64_t{};
+      for(std::size_t shard{}; shard < kMetricShards; ++shard)
+        {
+        sum += m_cells[shard * internal::kCacheLineWords].load(std::memory_order_relaxed);
+        }
+      return sum;
+      }
+
+    private:
+      internal::cache_aligned_words m_cells;
+    };
+
+  /**
+   * @brief A value that can go up and down
+   *
+   * @note Gauges are not sharded. Updating a gauge from several threads contends on a single cache line.
+   *
+   * @since 1.0.3
+   */
+  struct metrics_gauge
+    {
+    metrics_gauge() = default;
+    metrics_gauge(metrics_gauge const &) = delete;
+    metrics_gauge & operator=(metrics_gauge const &) = delete;
+
+    /**
+     * @brief Set the value of the gauge
+     */
+    void set(double const value)
+      {
+      m_bits.store(internal::to_bits(value), std::memory_order_relaxed);
+      }
+
+    /**
+     * @brief Add to the value of the gauge, which may be negative
+     */
+    void add(double const value)
+      {
+      internal::add_bits(m_bits, value);
+      }
+
+    /**
+     * @brief Get the value of the gauge
+     */
+    double value() const
+      {
+      return internal::from_bits(m_bits.load(std::memory_order_relaxed));
+      }
+
+    private:
+      std::atomic<std::uint64_t> m_bits{internal::to_bits(0.0)};
+    };
+
+  /**
+   * @brief The aggregated state of a dab::metrics_histogram
+   *
+   * @since 1.0.3
+   */
+  struct histogram_snapshot
+    {
+    std::vector<double> bounds; ///< The upper bounds of the buckets, excluding +Inf
+    std::vector<std::uint64_t> buckets; ///< The cumulative counts per bucket, including the +Inf bucket
+    double sum; ///< The sum of all observed values
+    std::uint64_t count; ///< The number of observed values
+    };
+
+  /**
+   * @brief A histogram of observed values with fixed buckets, sharded per thread
+   *
+   * @since 1.0.3
+   */
+  struct metrics_histogram
+    {
+    /**
+     * @brief Construct a histogram
+     *
+     * @param bounds The upper bounds of the buckets. A bucket for +Inf is added implicitly.
+     *
+     * @throws std::invalid_argument if @p bounds is not strictly increasing
+     */
+    explicit metrics_histogram(std::vector<double> bounds)
+      : m_bounds{std::move(bounds)}
+      , m_stride{(m_bounds.size() + 2 + internal::kCacheLineWords - 1) / internal::kCacheLineWords * internal::kCacheLineWords}
+      , m_cells(kMetricShards * m_stride)
+      {
+      for(std::size_t index{1}; index < m_bounds.size(); ++index)
+        {
+        if(!(m_bounds[index - 1] < m_bounds[index]))
+          {
+          throw std::invalid_argument{"Histogram bounds must be strictly increasing"};
+          }
+        }
+
+      for(std::size_t shard{}; shard < kMetricShards; ++shard)
+        {
+        m_cells[shard * m_stride + m_bounds.size() + 1].store(internal::to_bits(0.0), std::memory_order_relaxed);
+        }
+      }
+
+    metrics_histogram(metrics_histogram const &) = delete;
+    metrics_histogram & operator=(metrics_histogram const &) = delete;
+
+    /**
+     * @brief Record an observed value
+     */
+    void observe(double const value)
+      {
+      auto const bucket = static_cast<std::size_t>(std::lower_bound(m_bounds.begin(), m_bounds.end(), value) - m_bounds.begin());
+      auto const row = internal::metric_shard() * m_stride;
+
+      m_cells[row + bucket].fetch_add(1, std::memory_order_relaxed);
+      internal::add_bits(m_cells[row + m_bounds.size() + 1], value);
+      }
+
+    /**
+     * @brief Get the state of the histogram, aggregated over all shards
+     */
+    histogram_snapshot snapshot() const
+      {
+      auto result = histogram_snapshot{m_bounds, std::vector<std::uint64_t>(m_bounds.size() + 1), 0.0, 0};
+
+      for(std::size_t shard{}; shard < kMetricShards; ++shard)
+        {
+        auto const row = shard * m_stride;
+        for(std::size_t bucket{}; bucket <= m_bounds.size(); ++bucket)
+          {
+          result.buckets[bucket] += m_cells[row + bucket].load(std::memory_order_relaxed);
+          }
+        result.sum += internal::from_bits(m_cells[row + m_bounds.size() + 1].load(std::memory_order_relaxed));
+        }
+
+      for(std::size_t bucket{1}; bucket < result.buckets.size(); ++bucket)
+        {
+        result.buckets[bucket] += result.buckets[bucket - 1];
+        }
+
+      result.count = result.buckets.back();
+      return result;
+      }
+
+    private:
+      std::vector<double> const m_bounds;
+      std::size_t const m_stride;
+      internal::cache_aligned_words m_cells;
+    };
+
+  /**
+   * @brief The types of metrics held by a dab::metrics_registry
+   *
+   * @since 1.0.3
+   */
+  enum struct metric_type : std::uint8_t
+    {
+    counter,
+    gauge,
+    histogram,
+    };
+
+  /**
+   * @brief A registry of named metrics
+   *
+   * Metrics are identified by their name and labels. Requesting a metric that already exists returns the existing one,
+   * so independent components can share a metric. References to registered metrics stay valid for the lifetime of the
+   * registry.
+   *
+   * @since 1.0.3
+   */
+  struct metrics_registry
+    {
+    metrics_registry() = default;
+    metrics_registry(metrics_registry const &) = delete;
+    metrics_registry & operator=(metrics_registry const &) = delete;
+
+    /**
+     * @brief Get or register a counter
+     *
+     * @throws std::invalid_argument if a name is invalid or the metric was registered with a different type
+     */
+    metrics_counter & counter(std::string const & name, std::string const & help, metric_labels labels = {})
+      {
+      auto lock = std::unique_lock<std::mutex>{m_mutex};
+      auto & entry = series(name, help, metric_type::counter, std::move(labels));
+      if(!entry.counter)
+        {
+        entry.counter.reset(new metrics_counter{});
+        }
+      return *entry.counter;
+      }
+
+    /**
+     * @brief Get or register a gauge
+     *
+     * @throws std::invalid_argument if a name is invalid or the metric was registered with a different type
+     */
+    metrics_gauge & gauge(std::string const & name, std::string const & help, metric_labels labels = {})
+      {
+      auto lock = std::unique_lock<std::mutex>{m_mutex};
+      auto & entry = series(name, help, metric_type::gauge, std::move(labels));
+      if(!entry.gauge && !entry.read)
+        {
+        entry.gauge.reset(new metrics_gauge{});
+        }
+
+      if(!entry.gauge)
+        {
+        throw std::invalid_argument{"Metric is a gauge callback: " + name};
+        }
+
+      return *entry.gauge;
+      }
+
+    /**
+     * @brief Register a gauge whose value is read from a function whenever the metrics are rendered
+     *
+     * Registering a callback for an existing callback gauge replaces the previous callback.
+     *
+     * @note The function is called while the registry is locked and must not access the registry.
+     *
+     * @throws std::invalid_argument if a name is invalid or the metric was registered with a different type
+     */
+    void gauge_callback(std::string const & name, std::string const & help, std::function<double()> read,
+                        metric_labels labels = {})
+      {
+      auto lock = std::unique_lock<std::mutex>{m_mutex};
+      auto & entry = series(name, help, metric_type::gauge, std::move(labels));
+
+      if(entry.gauge)
+        {
+        throw std::invalid_argument{"Metric is a plain gauge: " + name};
+        }
+
+      entry.read = std::move(read);
+      }
+
+    /**
+     * @brief Get or register a histogram
+     *
+     * @param bounds The upper bounds of the buckets, ignored if the histogram already exists
+     *
+     * @throws std::invalid_argument if a name is invalid, the metric was registered with a different type or
+     *         @p bounds is not strictly increasing
+     */
+    metrics_histogram & histogram(std::string const & name, std::string const & help, std::vector<double> bounds,
+                                  metric_labels labels = {})
+      {
+      auto lock = std::unique_lock<std::mutex>{m_mutex};
+      auto & entry = series(name, help, metric_type::histogram, std::move(labels));
+      if(!entry.histogram)
+        {
+        entry.histogram.reset(new metrics_histogram{std::move(bounds)});
+        }
+      return *entry.histogram;
+      }
+
+    /**
+     * @brief Render all metrics in the Prometheus text exposition format
+     *
+     * Metrics are rendered in order of registration.
+     */
+    void write_prometheus(std::ostream & out) const
+      {
+      auto lock = std::unique_lock<std::mutex>{m_mutex};
+
+      for(auto const & family : m_families)
+        {
+        static char const * const kTypeNames[]{"counter", "gauge", "histogram"};
+
+        out << "# HELP " << family.name << ' ' << escape_help(family.help) << '\n';
+        out << "# TYPE " << family.name << ' ' << kTypeNames[static_cast<std::size_t>(family.type)] << '\n';
+
+        for(auto const & entry : family.series)
+          {
+          write_series(out, family.name, *entry);
+          }
+        }
+      }
+
+    /**
+     * @brief Render all metrics in the Prometheus text exposition format
+     */
+    std::string prometheus() const
+      {
+      std::ostringstream out{};
+      write_prometheus(out);
+      return out.str();
+      }
+
+    private:
+      struct series_entry
+        {
+        metric_labels labels;
+        std::unique_ptr<metrics_counter> counter;
+        std::unique_ptr<metrics_gauge> gauge;
+        std::function<double()> read;
+        std::unique_ptr<metrics_histogram> histogram;
+        };
+
+      struct family_entry
+        {
+        std::string name;
+        std::string help;
+        metric_type type;
+        std::vector<std::unique_ptr<series_entry>> series;
+        };
+
+      series_entry & series(std::string const & name, std::string const & help, metric_type const type,
+                            metric_labels labels)
+        {
+        if(!internal::valid_metric_name(name, false))
+          {
+          throw std::invalid_argument{"Invalid metric name: " + name};
+          }
+
+        for(auto const & label : labels)
+          {
+          if(!internal::valid_metric_name(label.first, true) || label.first.compare(0, 2, "__") == 0 ||
+             (type == metric_type::histogram && label.first == "le"))
+            {
+            throw std::invalid_argument{"Invalid label name: " + label.first};
+            }
+          }
+
+        auto family = std::find_if(m_families.begin(), m_families.end(), [&](family_entry const & candidate) {
+          return candidate.name == name;
+        });
+
+        if(family == m_families.end())
+          {
+          m_families.push_back(family_entry{name, help, type, {}});
+          family = m_families.end() - 1;
+          }
+        else if(family->type != type)
+          {
+          throw std::invalid_argument{"Metric registered with a different type: " + name};
+          }
+
+        for(auto & entry : family->series)
+          {
+          if(entry->labels == labels)
+            {
+            return *entry;
+            }
+          }
+
+        family->series.emplace_back(new series_entry{std::move(labels), nullptr, nullptr, nullptr, nullptr});
+        return *family->series.back();
+        }
+
+      static void write_series(std::ostream & out, std::string const & name, series_entry const & entry)
+        {
+        auto const labels = internal::format_labels(entry.labels);
+
+        if(entry.counter)
+          {
+          out << name << labels << ' ' << entry.counter->value() << '\n';
+          }
+        else if(entry.gauge)
+          {
+          out << name << labels << ' ' << internal::format_metric_value(entry.gauge->value()) << '\n';
+          }
+        else if(entry.read)
+          {
+          out << name << labels << ' ' << internal::format_metric_value(entry.read()) << '\n';
+          }
+        else if(entry.histogram)
+          {
+          auto const snapshot = entry.histogram->snapshot();
+
+          for(std::size_t bucket{}; bucket < snapshot.buckets.size(); ++bucket)
+            {
+            auto const bound = bucket < snapshot.bounds.size() ? snapshot.bounds[bucket]
+                                                               : std::numeric_limits<double>::infinity();
+            out << name << "_bucket" << internal::format_labels(entry.labels, "le", internal::format_metric_value(bound))
+                << ' ' << snapshot.buckets[bucket] << '\n';
+            }
+
+          out << name << "_sum" << labels << ' ' << internal::format_metric_value(snapshot.sum) << '\n';
+          out << name << "_count" << labels << ' ' << snapshot.count << '\n';
+          }
+        }
+
+      static std::string escape_help(std::string const & help)
+        {
+        auto result = std::string{};
+        for(auto const character : help)
+          {
+          if(character == '\\')
+            {
+            result += "\\\\";
+            }
+          else if(character == '\n')
+            {
+            result += "\\n";
+            }
+          else
+            {
+            result += character;
+            }
+          }
+        return result;
+        }
+
+      std::mutex mutable m_mutex{};
+      std::vector<family_entry> m_families{};
+    };
+
+  /**
+   * @brief Counts the results of a parser per dab::parse_status
+   *
+   * @since 1.0.3
+   */
+  struct parse_status_metrics
+    {
+    /**
+     * @brief Register a counter with a @p status label for every parse status
+     */
+    parse_status_metrics(metrics_registry & registry, std::string const & name, std::string const & help,
+                         metric_labels const & labels = {})
+      {
+      for(std::size_t index{}; index < m_counters.size(); ++index)
+        {
+        auto statusLabels = labels;
+        statusLabels.emplace_back("status", internal::parse_status_name(static_cast<parse_status>(index)));
+        m_counters[index] = &registry.counter(name, help, std::move(statusLabels));
+        }
+      }
+
+    /**
+     * @brief Count a parse result
+     */
+    void count(parse_status const status)
+      {
+      m_counters[static_cast<std::size_t>(status)]->increment();
+      }
+
+    private:
+      std::array<metrics_counter *, static_cast<std::size_t>(parse_status::ok) + 1> m_counters{{}};
+    };
+
+  /**
+   * @brief Export the approximate depth of a queue as the gauge @p dab_queue_depth
+   *
+   * @note The queue must outlive the registry.
+   *
+   * @since 1.0.3
+   */
+  template<typename QueueType>
+  void watch_queue(metrics_registry & registry, QueueType const & queue, metric_labels labels)
+    {
+    registry.gauge_callback("dab_queue_depth", "Approximate number of elements in a queue", [&queue]{
+      return static_cast<double>(queue.approximate_size());
+    }, std::move(labels));
+    }
+
+  /**
+   * @brief Write all metrics of a registry to a file, e.g. for the textfile collector of the node exporter
+   *
+   * The metrics are written to a temporary file first, which then replaces @p path. Scrapers thus never observe a
+   * partially written file.
+   *
+   * @return @p true if the file was written, @p false otherwise
+   *
+   * @since 1.0.3
+   */
+  inline bool write_metrics_file(metrics_registry const & registry, std::string const & path)
+    {
+    auto const temporary = path + ".tmp";
+
+      {
+      std::ofstream file{temporary, std::ios::trunc};
+      registry.write_prometheus(file);
+      if(!file)
+        {
+        return false;
+        }
+      }
+
+    return !std::rename(temporary.c_str(), path.c_str());
+    }
+
+  }
+
+#endif
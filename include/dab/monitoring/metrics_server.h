@@ -0,0 +1,320 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_MONITORING_METRICS_SERVER
+#define DABCOMMON_MONITORING_METRICS_SERVER
+
+#include "dab/monitoring/metrics.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define DABCOMMON_HAS_SOCKETS 1
+#endif
+
+/**
+ * @file
+ *
+ * @brief This file contains a minimal server exposing a dab::metrics_registry to scrapers
+ *
+ * @author Felix Morgner
+ * @since  1.0.3
+ */
+
+namespace dab
+  {
+
+  /**
+   * @brief Serves the metrics of a registry over HTTP on a Unix domain socket or a loopback TCP port
+   *
+   * The server answers every connection with the current metrics in the Prometheus text format and closes it. It does
+   * not interpret the request, so it is only meant as a local stand-in for a proper HTTP server, e.g. behind a reverse
+   * proxy or for @p curl @p --unix-socket. Requests are served sequentially on a background thread, so rendering the
+   * metrics never runs on a thread of the receiver. Responses are written without blocking, and a connection is dropped
+   * if its response could not be sent within a few seconds, so clients that stop reading cannot stall later scrapes.
+   *
+   * @note On systems without BSD sockets, the server never listens.
+   *
+   * @author Felix Morgner
+   * @since  1.0.3
+   */
+  struct metrics_server
+    {
+    /**
+     * @brief Serve the metrics on 127.0.0.1
+     *
+     * @param port The TCP port to listen on, or 0 to let the system pick a free port (see port())
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    metrics_server(metrics_registry const & registry, std::uint16_t const port)
+      : m_registry{registry}
+      {
+#ifdef DABCOMMON_HAS_SOCKETS
+      auto address = sockaddr_in{};
+      address.sin_family = AF_INET;
+      address.sin_port = htons(port);
+      address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+      if(listen(AF_INET, reinterpret_cast<sockaddr const *>(&address), sizeof(address)))
+        {
+        auto length = socklen_t{sizeof(address)};
+        getsockname(m_socket, reinterpret_cast<sockaddr *>(&address), &length);
+        m_port = ntohs(address.sin_port);
+        start();
+        }
+#else
+      static_cast<void>(port);
+#endif
+      }
+
+    /**
+     * @brief Serve the metrics on a Unix domain socket
+     *
+     * An existing file at @p path is replaced. The socket file is removed when the server is destroyed.
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    metrics_server(metrics_registry const & registry, std::string const & path)
+      : m_registry{registry}
+      {
+#ifdef DABCOMMON_HAS_SOCKETS
+      auto address = sockaddr_un{};
+      address.sun_family = AF_UNIX;
+
+      if(path.empty() || path.size() >= sizeof(address.sun_path))
+        {
+        return;
+        }
+
+      std::memcpy(address.sun_path, path.c_str(), path.size());
+      ::unlink(path.c_str());
+
+      if(listen(AF_UNIX, reinterpret_cast<sockaddr const *>(&address), sizeof(address)))
+        {
+        m_path = path;
+        start();
+        }
+#endif
+      }
+
+    metrics_server(metrics_server const &) = delete;
+    metrics_server & operator=(metrics_server const &) = delete;
+
+    ~metrics_server()
+      {
+      m_stop = true;
+
+      if(m_thread.joinable())
+        {
+        m_thread.join();
+        }
+
+#ifdef DABCOMMON_HAS_SOCKETS
+      if(m_socket >= 0)
+        {
+        ::close(m_socket);
+        }
+
+      if(!m_path.empty())
+        {
+        ::unlink(m_path.c_str());
+        }
+#endif
+      }
+
+    /**
+     * @brief Check whether the server is listening for connections
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    bool listening() const
+      {
+      return m_thread.joinable();
+      }
+
+    /**
+     * @brief Get the TCP port the server listens on, or 0 if it does not listen on a TCP port
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    std::uint16_t port() const
+      {
+      return m_port;
+      }
+
+    /**
+     * @brief Get the number of scrapes served so far
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    std::uint64_t served() const
+      {
+      return m_served;
+      }
+
+    private:
+#ifdef DABCOMMON_HAS_SOCKETS
+      bool listen(int const family, sockaddr const * const address, socklen_t const length)
+        {
+        m_socket = ::socket(family, SOCK_STREAM, 0);
+        if(m_socket < 0)
+          {
+          return false;
+          }
+
+        auto const reuse = 1;
+        ::setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        if(::bind(m_socket, address, length) || ::listen(m_socket, 8))
+          {
+          ::close(m_socket);
+          m_socket = -1;
+          return false;
+          }
+
+        return true;
+        }
+
+      void start()
+        {
+        m_thread = std::thread{[this]{ run(); }};
+        }
+
+      void run()
+        {
+        while(!m_stop)
+          {
+          auto listener = pollfd{m_socket, POLLIN, 0};
+          if(::poll(&listener, 1, kPollTimeout) <= 0)
+            {
+            continue;
+            }
+
+          auto const connection = ::accept(m_socket, nullptr, nullptr);
+          if(connection < 0)
+            {
+            continue;
+            }
+
+          serve(connection);
+          ::close(connection);
+          }
+        }
+
+      void serve(int const connection)
+        {
+        auto client = pollfd{connection, POLLIN, 0};
+        if(::poll(&client, 1, kRequestTimeout) > 0)
+          {
+          char request[1024];
+          static_cast<void>(::recv(connection, request, sizeof(request), 0));
+          }
+
+        auto const body = m_registry.prometheus();
+        auto const response = "HTTP/1.0 200 OK\r\n"
+                              "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                              "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                              "Connection: close\r\n"
+                              "\r\n" + body;
+
+        auto const deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds{kResponseTimeout};
+        auto sent = std::size_t{};
+        while(sent < response.size())
+          {
+          if(m_stop || std::chrono::steady_clock::now() >= deadline)
+            {
+            return;
+            }
+
+          auto writable = pollfd{connection, POLLOUT, 0};
+          if(::poll(&writable, 1, kPollTimeout) <= 0)
+            {
+            continue;
+            }
+
+          auto const result = ::send(connection, response.data() + sent, response.size() - sent, kSendFlags);
+          if(result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+            {
+            continue;
+            }
+
+          if(result <= 0)
+            {
+            return;
+            }
+
+          sent += static_cast<std::size_t>(result);
+          }
+
+        ++m_served;
+        }
+
+      static int constexpr kPollTimeout{100};
+      static int constexpr kRequestTimeout{1000};
+      static int constexpr kResponseTimeout{2000};
+
+#ifdef MSG_NOSIGNAL
+      static int constexpr kSendFlags{MSG_NOSIGNAL | MSG_DONTWAIT};
+#else
+      static int constexpr kSendFlags{MSG_DONTWAIT};
+#endif
+#endif
+
+      metrics_registry const & m_registry;
+      std::atomic_bool m_stop{};
+      std::atomic<std::uint64_t> m_served{};
+      int m_socket{-1};
+      std::uint16_t m_port{};
+      std::string m_path{};
+      std::thread m_thread{};
+    };
+
+  }
+
+#endif
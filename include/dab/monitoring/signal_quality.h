@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_MONITORING_SIGNAL_QUALITY
+#define DABCOMMON_MONITORING_SIGNAL_QUALITY
+
+#include "dab/constants/sample_rate.h"
+#include "dab/types/common_types.h"
+#include "dab/types/parse_status.h"
+#include "dab/types/seqlock.h"
+#include "dab/types/transmission_mode.h"
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief The number of distinct dab::parse_status values
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kParseStatuses{static_cast<std::size_t>(parse_status::ok) + 1};
+
+  /**
+   * @brief By default, a dab::signal_quality_monitor measures every 16th symbol it is shown
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kDefaultQualitySubsampling{16};
+
+  /**
+   * @brief The origin of a CRC check result recorded by a dab::signal_quality_monitor
+   *
+   * @since 1.0.3
+   */
+  enum struct quality_source : std::uint8_t
+    {
+    fic, ///< A FIB of the Fast Information Channel
+    subchannel, ///< A logical frame or access unit of an MSC sub-channel
+    };
+
+  /**
+   * @brief A snapshot of the signal quality of an ensemble
+   *
+   * @since 1.0.3
+   */
+  struct signal_quality
+    {
+    float mer; ///< The modulation error ratio of the demodulated carriers in dB
+    float snr; ///< The signal to noise ratio of the demodulated carriers in dB
+    float frequency_offset; ///< The residual carrier frequency offset in Hz
+    std::uint64_t symbols; ///< The number of symbols measured
+    std::array<std::uint64_t, kParseStatuses> fic; ///< The number of FIC check results, indexed by dab::parse_status
+    std::array<std::uint64_t, kParseStatuses> subchannels; ///< The number of sub-channel check results, indexed by dab::parse_status
+
+    /**
+     * @brief Get the fraction of FIC check results that were not dab::parse_status::ok
+     */
+    float fic_failure_rate() const
+      {
+      return failure_rate(fic);
+      }
+
+    /**
+     * @brief Get the fraction of sub-channel check results that were not dab::parse_status::ok
+     */
+    float subchannel_failure_rate() const
+      {
+      return failure_rate(subchannels);
+      }
+
+    private:
+      static float failure_rate(std::array<std::uint64_t, kParseStatuses> const & counts)
+        {
+        auto total = std::uint64_t{};
+        for(auto const count : counts)
+          {
+          total += count;
+          }
+
+        return total ? 1.0f - static_cast<float>(counts[static_cast<std::size_t>(parse_status::ok)]) / total : 0.0f;
+        }
+    };
+
+  namespace internal
+    {
+
+    /**
+     * @internal
+     *
+     * @brief The sums needed to estimate the quality of one symbol of differentially demodulated carriers
+     *
+     * The reductions are plain loops over the interleaved real and imaginary parts so that they vectorize.
+     */
+    struct symbol_moments
+      {
+      float amplitude; ///< The mean magnitude of the derotated real and imaginary parts
+      float error; ///< The mean squared deviation of the derotated real and imaginary parts from the ideal QPSK points
+      float second; ///< The mean squared magnitude of the carriers
+      float fourth; ///< The mean fourth power of the magnitude of the carriers
+      float rotation; ///< The common rotation of the constellation in radians
+      };
+
+    inline symbol_moments measure_symbol(std::vector<sample_t> const & carriers)
+      {
+      auto const values = reinterpret_cast<float const *>(carriers.data());
+      auto moments = symbol_moments{};
+
+      if(carriers.empty())
+        {
+        return moments;
+        }
+
+      auto second = 0.0f;
+      auto fourth = 0.0f;
+      auto rotationReal = 0.0f;
+      auto rotationImaginary = 0.0f;
+      for(std::size_t index{}; index < carriers.size(); ++index)
+        {
+        auto const real = values[2 * index];
+        auto const imaginary = values[2 * index + 1];
+        auto const power = real * real + imaginary * imaginary;
+        auto const squareReal = real * real - imaginary * imaginary;
+        auto const squareImaginary = 2 * real * imaginary;
+
+        second += power;
+        fourth += power * power;
+        rotationReal += squareReal * squareReal - squareImaginary * squareImaginary;
+        rotationImaginary += 2 * squareReal * squareImaginary;
+        }
+
+      moments.second = second / carriers.size();
+      moments.fourth = fourth / carriers.size();
+      moments.rotation = std::atan2(-rotationImaginary, -rotationReal) / 4;
+
+      auto const cosine = std::cos(moments.rotation);
+      auto const sine = std::sin(moments.rotation);
+      auto magnitudes = 0.0f;
+      for(std::size_t index{}; index < carriers.size(); ++index)
+        {
+        auto const real = values[2 * index];
+        auto const imaginary = values[2 * index + 1];
+
+        magnitudes += std::fabs(real * cosine + imaginary * sine) + std::fabs(imaginary * cosine - real * sine);
+        }
+
+      moments.amplitude = magnitudes / (2 * carriers.size());
+      moments.error = std::fmax(moments.second / 2 - moments.amplitude * moments.amplitude, 0.0f);
+      return moments;
+      }
+
+    }
+
+  /**
+   * @brief A monitor deriving signal quality metrics from a tap of differentially demodulated symbols
+   *
+   * The demodulator shows each symbol to the monitor, but only every n-th symbol is measured. All other calls return
+   * after incrementing a counter, so the monitor does not slow down the demodulation. Measurements are averaged
+   * exponentially and published through a dab::seqlock, so any number of threads can take snapshots without blocking
+   * the demodulator. Decoders record their CRC check results through relaxed atomic counters.
+   *
+   * The MER is derived from the deviation of the carriers from the ideal QPSK points. The SNR uses the M2M4 moment
+   * estimator, which does not depend on symbol decisions. The residual frequency offset is derived from the common
+   * rotation of the constellation between consecutive symbols.
+   *
+   * @since 1.0.3
+   */
+  struct signal_quality_monitor
+    {
+    /**
+     * @brief Construct a monitor for a transmission mode
+     *
+     * @param mode The transmission mode of the demodulated symbols
+     * @param subsampling The monitor measures every @p subsampling-th symbol
+     * @param smoothing The weight of the newest measurement in the exponential averages
+     */
+    explicit signal_quality_monitor(internal::types::transmission_mode const & mode,
+                                    std::size_t const subsampling = kDefaultQualitySubsampling,
+                                    float const smoothing = 0.1f)
+      : m_rotationToOffset{kDefaultSampleRate / (2 * std::acos(-1.0f) * mode.symbol_duration)},
+        m_subsampling{subsampling ? subsampling : 1},
+        m_smoothing{smoothing}
+      {
+      }
+
+    /**
+     * @brief Show a differentially demodulated symbol to the monitor
+     *
+     * Must only be called from a single thread.
+     */
+    void tap(std::vector<sample_t> const & carriers)
+      {
+      if(m_tapped++ % m_subsampling)
+        {
+        return;
+        }
+
+      auto const moments = internal::measure_symbol(carriers);
+      if(moments.second <= 0.0f)
+        {
+        return;
+        }
+
+      auto const signal = std::sqrt(std::fmax(2 * moments.second * moments.second - moments.fourth, 0.0f));
+      auto const noise = std::fmax(moments.second - signal, 1e-12f);
+      auto const weight = m_measured ? m_smoothing : 1.0f;
+
+      m_errorRatio += weight * (moments.error / (moments.amplitude * moments.amplitude + 1e-12f) - m_errorRatio);
+      m_noiseRatio += weight * (noise / signal - m_noiseRatio);
+      m_offset += weight * (moments.rotation * m_rotationToOffset - m_offset);
+      ++m_measured;
+
+      auto quality = m_published;
+      quality.mer = -10.0f * std::log10(m_errorRatio + 1e-12f);
+      quality.snr = -10.0f * std::log10(m_noiseRatio + 1e-12f);
+      quality.frequency_offset = m_offset;
+      quality.symbols = m_measured;
+      m_published = quality;
+      m_quality.store(quality);
+      }
+
+    /**
+     * @brief Record the result of a CRC check
+     *
+     * May be called from any thread.
+     */
+    void record(quality_source const source, parse_status const status)
+      {
+      auto & counters = source == quality_source::fic ? m_fic : m_subchannels;
+      counters[static_cast<std::size_t>(status)].fetch_add(1, std::memory_order_relaxed);
+      }
+
+    /**
+     * @brief Get a snapshot of the current signal quality
+     *
+     * May be called from any thread.
+     */
+    signal_quality snapshot() const
+      {
+      auto quality = m_quality.load();
+
+      for(std::size_t status{}; status < kParseStatuses; ++status)
+        {
+        quality.fic[status] = m_fic[status].load(std::memory_order_relaxed);
+        quality.subchannels[status] = m_subchannels[status].load(std::memory_order_relaxed);
+        }
+
+      return quality;
+      }
+
+    private:
+      float const m_rotationToOffset;
+      std::size_t const m_subsampling;
+      float const m_smoothing;
+      std::size_t m_tapped{};
+      std::uint64_t m_measured{};
+      float m_errorRatio{};
+      float m_noiseRatio{};
+      float m_offset{};
+      signal_quality m_published{};
+      seqlock<signal_quality> m_quality{};
+      std::array<std::atomic<std::uint64_t>, kParseStatuses> m_fic{};
+      std::array<std::atomic<std::uint64_t>, kParseStatuses> m_subchannels{};
+    };
+
+  }
+
+#endif
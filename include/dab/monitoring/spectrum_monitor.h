@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_MONITORING_SPECTRUM_MONITOR
+#define DABCOMMON_MONITORING_SPECTRUM_MONITOR
+
+#include "dab/constants/sample_rate.h"
+#include "dab/ofdm/fft.h"
+#include "dab/types/common_types.h"
+#include "dab/types/double_buffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief The parameters of a dab::spectrum_monitor
+   *
+   * @since 1.0.3
+   */
+  struct spectrum_parameters
+    {
+    std::size_t fft_length; ///< The number of bins of each spectrum, a power of two
+    std::size_t decimation; ///< The number of input samples averaged into one analyzed sample
+    std::size_t averages; ///< The number of half-overlapping windowed segments averaged into each spectrum
+    float frame_rate; ///< The number of spectra produced per second
+    };
+
+  /**
+   * @brief The default parameters of a dab::spectrum_monitor
+   *
+   * @since 1.0.3
+   */
+  spectrum_parameters constexpr kDefaultSpectrumParameters{1024, 1, 4, 10.0f};
+
+  /**
+   * @brief A tap producing averaged power spectra of a sample stream
+   *
+   * Each spectrum is computed with Welch's method: half-overlapping, Hann-windowed segments are transformed and their
+   * power is averaged. The monitor only looks at the samples needed for the configured number of spectra per second
+   * and skips all others after counting them. With the default parameters and the default sample rate, less than 3%
+   * of the samples are analyzed. The input is decimated by averaging, which both narrows the displayed bandwidth and
+   * reduces the work per analyzed sample.
+   *
+   * The spectra are published in dB, with the zero frequency in the center, through a dab::double_buffer that
+   * user interface or metrics threads read without blocking the tap.
+   *
+   * @since 1.0.3
+   */
+  struct spectrum_monitor
+    {
+    /**
+     * @brief Construct a monitor
+     *
+     * @param parameters The analysis parameters
+     * @param sampleRate The sample rate of the tapped stream
+     *
+     * @throws std::invalid_argument if the FFT length is not a power of two or the parameters are otherwise unusable
+     */
+    explicit spectrum_monitor(spectrum_parameters const parameters = kDefaultSpectrumParameters,
+                              std::size_t const sampleRate = kDefaultSampleRate)
+      : m_parameters(checked(parameters)),
+        m_fft{parameters.fft_length},
+        m_window(parameters.fft_length),
+        m_collected(parameters.fft_length * (parameters.averages + 1) / 2),
+        m_segment(parameters.fft_length),
+        m_power(parameters.fft_length),
+        m_published(parameters.fft_length),
+        m_period{std::max(static_cast<std::size_t>(sampleRate / parameters.frame_rate), m_collected.size() * parameters.decimation)}
+      {
+      auto const step = 2 * std::acos(-1.0) / parameters.fft_length;
+      auto energy = 0.0f;
+
+      for(std::size_t index{}; index < m_window.size(); ++index)
+        {
+        m_window[index] = static_cast<float>(0.5 - 0.5 * std::cos(step * index));
+        energy += m_window[index] * m_window[index];
+        }
+
+      m_scale = 1.0f / (energy * parameters.averages);
+      }
+
+    /**
+     * @brief Show a block of samples to the monitor
+     *
+     * Must only be called from a single thread.
+     */
+    void tap(std::vector<sample_t> const & samples)
+      {
+      auto const needed = m_collected.size() * m_parameters.decimation;
+      auto offset = std::size_t{};
+
+      while(offset < samples.size())
+        {
+        if(m_position >= needed)
+          {
+          auto const skipped = std::min(m_period - m_position, samples.size() - offset);
+          offset += skipped;
+          m_position += skipped;
+
+          if(m_position == m_period)
+            {
+            m_position = 0;
+            }
+
+          continue;
+          }
+
+        auto const taken = std::min(needed - m_position, samples.size() - offset);
+        for(std::size_t index{}; index < taken; ++index)
+          {
+          m_sum += samples[offset + index];
+          if(++m_summed == m_parameters.decimation)
+            {
+            m_collected[m_filled++] = m_sum / static_cast<float>(m_parameters.decimation);
+            m_sum = sample_t{};
+            m_summed = 0;
+            }
+          }
+
+        offset += taken;
+        m_position += taken;
+
+        if(m_position == needed)
+          {
+          analyze();
+          }
+        }
+      }
+
+    /**
+     * @brief Copy the most recent spectrum
+     *
+     * May be called from any thread.
+     *
+     * @return @p false if no spectrum has been published yet
+     */
+    bool read(std::vector<float> & spectrum) const
+      {
+      return m_spectra.read(spectrum) != 0;
+      }
+
+    /**
+     * @brief Get the number of spectra published so far
+     */
+    std::uint64_t frames() const
+      {
+      return m_spectra.version();
+      }
+
+    private:
+      static spectrum_parameters const & checked(spectrum_parameters const & parameters)
+        {
+        if(!parameters.decimation || !parameters.averages || parameters.frame_rate <= 0.0f)
+          {
+          throw std::invalid_argument{"Invalid spectrum monitor parameters"};
+          }
+
+        return parameters;
+        }
+
+      void analyze()
+        {
+        auto const length = m_parameters.fft_length;
+        std::fill(m_power.begin(), m_power.end(), 0.0f);
+
+        for(std::size_t segment{}; segment < m_parameters.averages; ++segment)
+          {
+          auto const begin = segment * length / 2;
+          for(std::size_t index{}; index < length; ++index)
+            {
+            m_segment[index] = m_collected[begin + index] * m_window[index];
+            }
+
+          m_fft.forward(m_segment);
+
+          auto const values = reinterpret_cast<float const *>(m_segment.data());
+          for(std::size_t bin{}; bin < length; ++bin)
+            {
+            m_power[bin] += values[2 * bin] * values[2 * bin] + values[2 * bin + 1] * values[2 * bin + 1];
+            }
+          }
+
+        for(std::size_t bin{}; bin < length; ++bin)
+          {
+          m_published[(bin + length / 2) % length] = 10.0f * std::log10(m_power[bin] * m_scale + 1e-20f);
+          }
+
+        m_spectra.publish(m_published);
+        m_published.resize(length);
+        m_filled = 0;
+        }
+
+      spectrum_parameters const m_parameters;
+      fft const m_fft;
+      std::vector<float> m_window;
+      std::vector<sample_t> m_collected;
+      std::vector<sample_t> m_segment;
+      std::vector<float> m_power;
+      std::vector<float> m_published;
+      std::size_t const m_period;
+      float m_scale{};
+      std::size_t m_position{};
+      std::size_t m_filled{};
+      sample_t m_sum{};
+      std::size_t m_summed{};
+      double_buffer<float> m_spectra{};
+    };
+
+  }
+
+#endif
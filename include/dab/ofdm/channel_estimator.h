@@ -0,0 +1,295 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_OFDM_CHANNEL_ESTIMATOR
+#define DABCOMMON_OFDM_CHANNEL_ESTIMATOR
+
+#include "dab/types/common_types.h"
+#include "dab/types/transmission_mode.h"
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief The smoothing parameters of a dab::channel_estimator
+   *
+   * @author Felix Morgner
+   * @since  1.0.3
+   */
+  struct channel_estimation_parameters
+    {
+    float time_smoothing; ///< The weight of the newest estimate in the exponential average over frames, in (0, 1]
+    std::size_t frequency_smoothing; ///< The number of neighbouring carriers averaged on each side of a carrier
+    };
+
+  /**
+   * @brief The default smoothing parameters of a dab::channel_estimator
+   *
+   * @author Felix Morgner
+   * @since  1.0.3
+   */
+  channel_estimation_parameters constexpr kDefaultChannelEstimationParameters{0.5f, 2};
+
+  namespace internal
+    {
+
+    /**
+     * @internal
+     *
+     * @brief Divide two arrays of complex numbers element by element
+     *
+     * The arrays are processed as interleaved real and imaginary parts, which compilers turn into packed SIMD
+     * arithmetic. Divisions by zero yield zero.
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    inline void complex_divide(sample_t const * numerators, sample_t const * denominators, sample_t * quotients, std::size_t const size)
+      {
+      auto const numerator = reinterpret_cast<float const *>(numerators);
+      auto const denominator = reinterpret_cast<float const *>(denominators);
+      auto const quotient = reinterpret_cast<float *>(quotients);
+
+      for(std::size_t index{}; index < size; ++index)
+        {
+        auto const a = numerator[2 * index];
+        auto const b = numerator[2 * index + 1];
+        auto const c = denominator[2 * index];
+        auto const d = denominator[2 * index + 1];
+        auto const norm = c * c + d * d;
+        auto const scale = norm > 0.0f ? 1.0f / norm : 0.0f;
+
+        quotient[2 * index] = (a * c + b * d) * scale;
+        quotient[2 * index + 1] = (b * c - a * d) * scale;
+        }
+      }
+
+    }
+
+  /**
+   * @brief A per-carrier channel estimator driven by the phase reference symbol
+   *
+   * Each frame, the received carriers of the phase reference symbol are divided by the known reference to obtain a raw
+   * estimate of the channel transfer function. The raw estimate is smoothed across neighbouring carriers and then
+   * averaged exponentially over frames. The estimate can be used to equalize carriers and yields channel state
+   * information that scales the soft bits fed into the Viterbi decoder. Carriers in deep fades then contribute less to
+   * the path metrics, which lowers the number of failing codewords in multipath and SFN reception.
+   *
+   * Carriers are expected in ascending frequency order, with the unused center carrier removed.
+   *
+   * @author Felix Morgner
+   * @since  1.0.3
+   */
+  struct channel_estimator
+    {
+    /**
+     * @brief Construct an estimator for a transmission mode
+     *
+     * @param mode The transmission mode defining the number of carriers
+     * @param reference The transmitted phase reference symbol of @p mode, one value per carrier
+     * @param parameters The smoothing parameters
+     *
+     * @throws std::invalid_argument if @p reference does not have one value per carrier
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    channel_estimator(internal::types::transmission_mode const & mode,
+                      std::vector<sample_t> reference,
+                      channel_estimation_parameters const parameters = kDefaultChannelEstimationParameters)
+      : m_reference{std::move(reference)},
+        m_parameters{parameters},
+        m_raw(mode.carriers),
+        m_response(mode.carriers),
+        m_csi(mode.carriers, 1.0f)
+      {
+      if(m_reference.size() != mode.carriers)
+        {
+        throw std::invalid_argument{"Phase reference does not match the number of carriers"};
+        }
+      }
+
+    /**
+     * @brief Update the estimate from a received phase reference symbol
+     *
+     * @throws std::invalid_argument if @p received does not have one value per carrier
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    void update(std::vector<sample_t> const & received)
+      {
+      check(received.size());
+      internal::complex_divide(received.data(), m_reference.data(), m_raw.data(), m_raw.size());
+
+      auto const reach = m_parameters.frequency_smoothing;
+      auto const weight = m_updates ? m_parameters.time_smoothing : 1.0f;
+      auto sum = sample_t{};
+      auto power = 0.0f;
+
+      for(std::size_t index{}; index < std::min(reach, m_raw.size()); ++index)
+        {
+        sum += m_raw[index];
+        }
+
+      for(std::size_t index{}; index < m_raw.size(); ++index)
+        {
+        if(index + reach < m_raw.size())
+          {
+          sum += m_raw[index + reach];
+          }
+
+        if(index > reach)
+          {
+          sum -= m_raw[index - reach - 1];
+          }
+
+        auto const first = index > reach ? index - reach : 0;
+        auto const last = std::min(index + reach, m_raw.size() - 1);
+        auto const smoothed = sum / static_cast<float>(last - first + 1);
+
+        m_response[index] += weight * (smoothed - m_response[index]);
+        m_csi[index] = std::norm(m_response[index]);
+        power += m_csi[index];
+        }
+
+      auto const scale = power > 0.0f ? m_csi.size() / power : 0.0f;
+      for(auto & csi : m_csi)
+        {
+        csi *= scale;
+        }
+
+      ++m_updates;
+      }
+
+    /**
+     * @brief Divide received carriers by the estimated channel transfer function
+     *
+     * @throws std::invalid_argument if @p carriers does not have one value per carrier
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    void equalize(std::vector<sample_t> & carriers) const
+      {
+      check(carriers.size());
+      internal::complex_divide(carriers.data(), m_response.data(), carriers.data(), carriers.size());
+      }
+
+    /**
+     * @brief Scale the soft bits of a demodulated symbol by the channel state information of their carriers
+     *
+     * The soft bits are expected before frequency deinterleaving, with the carriers in ascending frequency order like in
+     * dab::channel_estimator::update. The bits of the real parts of all carriers come first, followed by the bits of
+     * the imaginary parts.
+     *
+     * @throws std::invalid_argument if @p softBits does not have two values per carrier
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    void weight(std::vector<float> & softBits) const
+      {
+      auto const carriers = m_csi.size();
+      if(softBits.size() != 2 * carriers)
+        {
+        throw std::invalid_argument{"Soft bits do not match the number of carriers"};
+        }
+
+      for(std::size_t index{}; index < carriers; ++index)
+        {
+        softBits[index] *= m_csi[index];
+        softBits[carriers + index] *= m_csi[index];
+        }
+      }
+
+    /**
+     * @brief Get the estimated channel transfer function
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    std::vector<sample_t> const & response() const
+      {
+      return m_response;
+      }
+
+    /**
+     * @brief Get the channel state information, the squared magnitudes of the transfer function normalized to a mean of one
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    std::vector<float> const & csi() const
+      {
+      return m_csi;
+      }
+
+    /**
+     * @brief Forget the current estimate, e.g. after retuning
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    void reset()
+      {
+      std::fill(m_response.begin(), m_response.end(), sample_t{});
+      std::fill(m_csi.begin(), m_csi.end(), 1.0f);
+      m_updates = 0;
+      }
+
+    private:
+      void check(std::size_t const size) const
+        {
+        if(size != m_raw.size())
+          {
+          throw std::invalid_argument{"Carriers do not match the transmission mode"};
+          }
+        }
+
+      std::vector<sample_t> const m_reference;
+      channel_estimation_parameters const m_parameters;
+      std::vector<sample_t> m_raw;
+      std::vector<sample_t> m_response;
+      std::vector<float> m_csi;
+      std::size_t m_updates{};
+    };
+
+  }
+
+#endif
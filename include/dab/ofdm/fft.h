@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_OFDM_FFT
+#define DABCOMMON_OFDM_FFT
+
+#include "dab/types/common_types.h"
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief An in-place radix-2 fast Fourier transform of a fixed power-of-two length
+   *
+   * The twiddle factors and the bit-reversal permutation are computed once on construction, so a single instance can
+   * be reused for every symbol. The transform is not normalized.
+   *
+   * @since 1.0.3
+   */
+  struct fft
+    {
+    /**
+     * @brief Construct a transform of the given length
+     *
+     * @throws std::invalid_argument if @p length is not a power of two
+     */
+    explicit fft(std::size_t const length)
+      : m_twiddles(length / 2),
+        m_swaps{},
+        m_length{length}
+      {
+      if(!length || (length & (length - 1)))
+        {
+        throw std::invalid_argument{"FFT length must be a power of two"};
+        }
+
+      auto const step = -2 * std::acos(-1.0) / length;
+      for(std::size_t index{}; index < m_twiddles.size(); ++index)
+        {
+        m_twiddles[index] = sample_t{static_cast<float>(std::cos(step * index)), static_cast<float>(std::sin(step * index))};
+        }
+
+      for(std::size_t index{}, reversed{}; index < length; ++index)
+        {
+        if(index < reversed)
+          {
+          m_swaps.emplace_back(index, reversed);
+          }
+
+        auto bit = length >> 1;
+        for(; reversed & bit; bit >>= 1)
+          {
+          reversed ^= bit;
+          }
+        reversed |= bit;
+        }
+      }
+
+    /**
+     * @brief Get the length of the transform
+     */
+    std::size_t length() const
+      {
+      return m_length;
+      }
+
+    /**
+     * @brief Transform time domain samples into the frequency domain
+     *
+     * @throws std::invalid_argument if @p data does not have the length of the transform
+     */
+    void forward(std::vector<sample_t> & data) const
+      {
+      transform(data, false);
+      }
+
+    /**
+     * @brief Transform frequency domain samples into the time domain, without dividing by the length
+     *
+     * @throws std::invalid_argument if @p data does not have the length of the transform
+     */
+    void inverse(std::vector<sample_t> & data) const
+      {
+      transform(data, true);
+      }
+
+    private:
+      void transform(std::vector<sample_t> & data, bool const inverse) const
+        {
+        if(data.size() != m_length)
+          {
+          throw std::invalid_argument{"Data does not match the FFT length"};
+          }
+
+        for(auto const & swap : m_swaps)
+          {
+          std::swap(data[swap.first], data[swap.second]);
+          }
+
+        for(std::size_t half{1}, stride{m_length / 2}; half < m_length; half *= 2, stride /= 2)
+          {
+          for(std::size_t block{}; block < m_length; block += 2 * half)
+            {
+            for(std::size_t index{}; index < half; ++index)
+              {
+              auto const twiddle = inverse ? std::conj(m_twiddles[index * stride]) : m_twiddles[index * stride];
+              auto const odd = data[block + index + half] * twiddle;
+              data[block + index + half] = data[block + index] - odd;
+              data[block + index] += odd;
+              }
+            }
+          }
+        }
+
+      std::vector<sample_t> m_twiddles;
+      std::vector<std::pair<std::size_t, std::size_t>> m_swaps;
+      std::size_t const m_length;
+    };
+
+  }
+
+#endif
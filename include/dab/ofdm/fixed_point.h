@@ -0,0 +1,419 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_OFDM_FIXED_POINT
+#define DABCOMMON_OFDM_FIXED_POINT
+
+#include "dab/system/tracing.h"
+#include "dab/types/common_types.h"
+#include "dab/types/transmission_mode.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * @file
+ *
+ * @brief This file contains an int16 fixed-point implementation of the per-symbol OFDM chain
+ *
+ * On small hosts without fast floating point units, the complex arithmetic of the float chain limits the number of
+ * sub-channels that can be decoded. This chain converts samples to Q15, removes the frequency offset using a table
+ * based NCO, transforms symbols using a fixed-point FFT and demodulates the DQPSK carriers into int8 soft bits. All
+ * arithmetic is integer arithmetic with explicit rounding, so the results are bit-exact on every platform.
+ *
+ * @since 1.0.3
+ */
+
+namespace dab
+  {
+
+  /**
+   * @brief A complex sample in Q15 format
+   *
+   * @since 1.0.3
+   */
+  struct fixed_sample
+    {
+    std::int16_t re;
+    std::int16_t im;
+    };
+
+  /**
+   * @brief Compare two fixed-point samples for equality
+   *
+   * @since 1.0.3
+   */
+  inline bool operator==(fixed_sample const & lhs, fixed_sample const & rhs)
+    {
+    return lhs.re == rhs.re && lhs.im == rhs.im;
+    }
+
+  namespace internal
+    {
+
+    /**
+     * @internal
+     * @brief The number of phase bits indexing the NCO table
+     */
+    std::size_t constexpr kFixedNcoTableBits{10};
+
+    inline std::int16_t saturate16(std::int32_t const value)
+      {
+      return static_cast<std::int16_t>(std::min<std::int32_t>(std::max<std::int32_t>(value, -32768), 32767));
+      }
+
+    inline std::int8_t saturate8(std::int32_t const value)
+      {
+      return static_cast<std::int8_t>(std::min<std::int32_t>(std::max<std::int32_t>(value, -127), 127));
+      }
+
+    /**
+     * @internal
+     * @brief Divide by a power of two, rounding half away from negative infinity
+     */
+    inline std::int32_t round_shift(std::int32_t const value, unsigned const shift)
+      {
+      return shift ? (value + (std::int32_t{1} << (shift - 1))) >> shift : value;
+      }
+
+    inline std::int16_t to_q15(double const value)
+      {
+      return saturate16(static_cast<std::int32_t>(std::lround(value * 32768.0)));
+      }
+
+    /**
+     * @internal
+     * @brief Multiply two Q15 complex values, rounding the result to Q15
+     */
+    inline fixed_sample multiply(fixed_sample const lhs, fixed_sample const rhs)
+      {
+      auto const re = std::int32_t{lhs.re} * rhs.re - std::int32_t{lhs.im} * rhs.im;
+      auto const im = std::int32_t{lhs.re} * rhs.im + std::int32_t{lhs.im} * rhs.re;
+      return {saturate16(round_shift(re, 15)), saturate16(round_shift(im, 15))};
+      }
+
+    }
+
+  /**
+   * @brief Convert float samples to Q15
+   *
+   * @param samples The samples to convert
+   * @param converted Receives the converted samples, saturated to the Q15 range
+   * @param gain The factor applied before conversion
+   *
+   * @since 1.0.3
+   */
+  inline void to_fixed(std::vector<sample_t> const & samples, std::vector<fixed_sample> & converted, float const gain = 1.0f)
+    {
+    converted.resize(samples.size());
+    std::transform(samples.begin(), samples.end(), converted.begin(), [gain](sample_t const & sample){
+      return fixed_sample{internal::to_q15(sample.real() * gain), internal::to_q15(sample.imag() * gain)};
+    });
+    }
+
+  /**
+   * @brief Convert interleaved unsigned 8 bit I/Q samples, as delivered by RTL2832 based tuners, to Q15
+   *
+   * @since 1.0.3
+   */
+  inline void to_fixed(std::uint8_t const * const iq, std::size_t const count, std::vector<fixed_sample> & converted)
+    {
+    converted.resize(count);
+    for(std::size_t index{}; index < count; ++index)
+      {
+      converted[index] = {static_cast<std::int16_t>((iq[2 * index] - 128) * 256), static_cast<std::int16_t>((iq[2 * index + 1] - 128) * 256)};
+      }
+    }
+
+  /**
+   * @brief A numerically controlled oscillator shifting Q15 samples in frequency
+   *
+   * The phase is kept in a 32 bit accumulator, and the oscillator is read from a Q15 table indexed by the rounded upper
+   * bits of the phase.
+   *
+   * @since 1.0.3
+   */
+  struct fixed_nco
+    {
+    explicit fixed_nco(double const frequency = 0.0, double const sampleRate = 2048000.0)
+      {
+      auto const size = std::size_t{1} << internal::kFixedNcoTableBits;
+      for(std::size_t index{}; index < size; ++index)
+        {
+        auto const angle = 2 * std::acos(-1.0) * index / size;
+        m_table[index] = {internal::to_q15(std::cos(angle)), internal::to_q15(std::sin(angle))};
+        }
+
+      tune(frequency, sampleRate);
+      }
+
+    /**
+     * @brief Set the frequency the samples are shifted by
+     *
+     * @param frequency The shift in Hz. To remove a frequency offset, pass its negative.
+     * @param sampleRate The sample rate in Hz
+     */
+    void tune(double const frequency, double const sampleRate)
+      {
+      auto const cycles = frequency / sampleRate;
+      m_increment = static_cast<std::uint32_t>(static_cast<std::int64_t>(std::llround((cycles - std::floor(cycles)) * 4294967296.0)));
+      }
+
+    /**
+     * @brief Shift samples in place, continuing the phase of the previous call
+     */
+    void mix(std::vector<fixed_sample> & samples)
+      {
+      for(auto & sample : samples)
+        {
+        auto const index = (m_phase + kRounding) >> (32 - internal::kFixedNcoTableBits) & (m_table.size() - 1);
+        sample = internal::multiply(sample, m_table[index]);
+        m_phase += m_increment;
+        }
+      }
+
+    std::uint32_t phase() const
+      {
+      return m_phase;
+      }
+
+    std::uint32_t increment() const
+      {
+      return m_increment;
+      }
+
+    private:
+      static std::uint32_t constexpr kRounding{std::uint32_t{1} << (31 - internal::kFixedNcoTableBits)};
+
+      std::array<fixed_sample, std::size_t{1} << internal::kFixedNcoTableBits> m_table{};
+      std::uint32_t m_phase{};
+      std::uint32_t m_increment{};
+    };
+
+  /**
+   * @brief An in-place radix-2 fixed-point FFT of a power-of-two length
+   *
+   * Every stage halves its outputs, so the result is the discrete Fourier transform divided by the length, and no
+   * butterfly can overflow.
+   *
+   * @since 1.0.3
+   */
+  struct fixed_fft
+    {
+    /**
+     * @throws std::invalid_argument if @p length is not a power of two
+     */
+    explicit fixed_fft(std::size_t const length)
+      : m_twiddles(length / 2),
+        m_swaps{},
+        m_length{length}
+      {
+      if(!length || (length & (length - 1)))
+        {
+        throw std::invalid_argument{"FFT length must be a power of two"};
+        }
+
+      auto const step = -2 * std::acos(-1.0) / length;
+      for(std::size_t index{}; index < m_twiddles.size(); ++index)
+        {
+        m_twiddles[index] = {internal::to_q15(std::cos(step * index)), internal::to_q15(std::sin(step * index))};
+        }
+
+      for(std::size_t index{}, reversed{}; index < length; ++index)
+        {
+        if(index < reversed)
+          {
+          m_swaps.emplace_back(index, reversed);
+          }
+
+        auto bit = length >> 1;
+        for(; reversed & bit; bit >>= 1)
+          {
+          reversed ^= bit;
+          }
+        reversed |= bit;
+        }
+      }
+
+    std::size_t length() const
+      {
+      return m_length;
+      }
+
+    /**
+     * @brief Transform time domain samples into the frequency domain, dividing by the length
+     *
+     * @param data The first of length() samples
+     */
+    void forward(fixed_sample * const data) const
+      {
+      for(auto const & swap : m_swaps)
+        {
+        std::swap(data[swap.first], data[swap.second]);
+        }
+
+      for(std::size_t half{1}, stride{m_length / 2}; half < m_length; half *= 2, stride /= 2)
+        {
+        for(std::size_t block{}; block < m_length; block += 2 * half)
+          {
+          for(std::size_t index{}; index < half; ++index)
+            {
+            auto & even = data[block + index];
+            auto & odd = data[block + index + half];
+            auto const product = internal::multiply(odd, m_twiddles[index * stride]);
+            auto const re = std::int32_t{even.re};
+            auto const im = std::int32_t{even.im};
+            even = {static_cast<std::int16_t>(internal::round_shift(re + product.re, 1)), static_cast<std::int16_t>(internal::round_shift(im + product.im, 1))};
+            odd = {static_cast<std::int16_t>(internal::round_shift(re - product.re, 1)), static_cast<std::int16_t>(internal::round_shift(im - product.im, 1))};
+            }
+          }
+        }
+      }
+
+    private:
+      std::vector<fixed_sample> m_twiddles;
+      std::vector<std::pair<std::size_t, std::size_t>> m_swaps;
+      std::size_t const m_length;
+    };
+
+  /**
+   * @brief Demodulates OFDM symbols in Q15 into int8 soft bits
+   *
+   * Each symbol is transformed after removing its guard interval, and each carrier is differentially demodulated
+   * against the same carrier of the previous symbol. Carriers are taken in ascending frequency order with the unused
+   * center carrier removed, and the soft bits of the real parts of all carriers precede those of the imaginary parts,
+   * as expected by dab::channel_estimator::weight. Following the library convention, a positive soft bit represents a
+   * 1, i.e. a negative component of the QPSK symbol. Each partial product of the differential demodulation is halved
+   * with rounding, so that their sum cannot overflow 32 bits. The soft bits of a symbol are scaled down by a common
+   * power of two, so that their mean magnitude is below 64 and strong carriers rarely saturate.
+   *
+   * @since 1.0.3
+   */
+  struct fixed_ofdm_demodulator
+    {
+    explicit fixed_ofdm_demodulator(internal::types::transmission_mode const & mode)
+      : m_transform{mode.fft_length},
+        m_symbol(mode.fft_length),
+        m_previous(mode.carriers),
+        m_current(mode.carriers),
+        m_products(2 * std::size_t{mode.carriers}),
+        m_guard{mode.guard_duration},
+        m_carriers{mode.carriers}
+      {
+      }
+
+    /**
+     * @brief Start a new transmission frame, making the next symbol the phase reference
+     */
+    void reset()
+      {
+      m_hasReference = false;
+      }
+
+    /**
+     * @brief Demodulate a symbol
+     *
+     * @param symbol The first sample of the symbol, including its guard interval
+     * @param softBits Receives two soft bits per carrier, unless the symbol is the phase reference symbol
+     * @return @p false if the symbol was the phase reference symbol and produced no soft bits, @p true otherwise
+     */
+    bool demodulate(fixed_sample const * const symbol, std::vector<std::int8_t> & softBits)
+      {
+      std::copy_n(symbol + m_guard, m_symbol.size(), m_symbol.begin());
+      m_transform.forward(m_symbol.data());
+
+      auto const size = m_symbol.size();
+      auto const half = m_carriers / 2;
+      for(std::size_t carrier{}; carrier < half; ++carrier)
+        {
+        m_current[carrier] = m_symbol[size - half + carrier];
+        m_current[half + carrier] = m_symbol[carrier + 1];
+        }
+
+      if(!m_hasReference)
+        {
+        DABCOMMON_PROBE1(frame_start, this);
+        std::swap(m_previous, m_current);
+        m_hasReference = true;
+        return false;
+        }
+
+      auto magnitude = std::uint64_t{};
+      for(std::size_t carrier{}; carrier < m_carriers; ++carrier)
+        {
+        auto const current = m_current[carrier];
+        auto const previous = m_previous[carrier];
+        auto const re = internal::round_shift(std::int32_t{current.re} * previous.re, 1) + internal::round_shift(std::int32_t{current.im} * previous.im, 1);
+        auto const im = internal::round_shift(std::int32_t{current.im} * previous.re, 1) - internal::round_shift(std::int32_t{current.re} * previous.im, 1);
+        m_products[carrier] = re;
+        m_products[m_carriers + carrier] = im;
+        magnitude += static_cast<std::uint64_t>(std::abs(re)) + static_cast<std::uint64_t>(std::abs(im));
+        }
+
+      std::swap(m_previous, m_current);
+
+      auto const mean = magnitude / (2 * m_carriers);
+      auto shift = 0u;
+      while((mean >> shift) >= 64)
+        {
+        ++shift;
+        }
+
+      softBits.resize(m_products.size());
+      for(std::size_t bit{}; bit < m_products.size(); ++bit)
+        {
+        softBits[bit] = internal::saturate8(-internal::round_shift(m_products[bit], shift));
+        }
+
+      return true;
+      }
+
+    private:
+      fixed_fft const m_transform;
+      std::vector<fixed_sample> m_symbol;
+      std::vector<fixed_sample> m_previous;
+      std::vector<fixed_sample> m_current;
+      std::vector<std::int32_t> m_products;
+      std::size_t const m_guard;
+      std::size_t const m_carriers;
+      bool m_hasReference{};
+    };
+
+  }
+
+#endif
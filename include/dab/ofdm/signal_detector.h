@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_OFDM_SIGNAL_DETECTOR
+#define DABCOMMON_OFDM_SIGNAL_DETECTOR
+
+#include "dab/constants/transmission_modes.h"
+#include "dab/ofdm/sync_state.h"
+#include "dab/types/common_types.h"
+#include "dab/types/transmission_mode.h"
+
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief The outcome of a dab::signal_detector
+   *
+   * @since 1.0.3
+   */
+  enum struct detection_status : std::uint8_t
+    {
+    empty, ///< The samples contain no null symbols, so there is no DAB signal
+    undecided, ///< The samples contain candidate null symbols that could not be confirmed
+    signal, ///< A null symbol followed by the phase reference symbol of a transmission mode was found
+    };
+
+  /**
+   * @brief The result of a dab::signal_detector
+   *
+   * @since 1.0.3
+   */
+  struct detection
+    {
+    detection_status status; ///< Whether a DAB signal was found
+    std::uint8_t mode; ///< The identifier of the detected transmission mode, or 0 if no signal was found
+    std::size_t null_symbol; ///< The sample index of the start of the first confirmed null symbol
+    float correlation; ///< The normalized guard interval correlation of the phase reference symbol
+    };
+
+  /**
+   * @brief A fast detector for DAB signals and their transmission mode
+   *
+   * The detector looks for the power dips of null symbols. The length of a dip identifies the transmission mode, since
+   * the null symbol durations of the modes are distinct. A dip is confirmed by correlating the guard interval of the
+   * following phase reference symbol with the end of its useful part: an OFDM symbol of the detected mode correlates
+   * strongly, noise and fades do not. Only a short window of samples is needed, so empty blocks are rejected after a
+   * single transmission frame instead of waiting for FIC acquisition to time out.
+   *
+   * @since 1.0.3
+   */
+  struct signal_detector
+    {
+    /**
+     * @brief Construct a detector
+     *
+     * @param nullDepth The ratio to the mean power below which samples are considered part of a null symbol
+     * @param minimumCorrelation The guard interval correlation required to confirm a null symbol
+     */
+    explicit signal_detector(float const nullDepth = 0.2f, float const minimumCorrelation = 0.5f)
+      : m_nullDepth{nullDepth},
+        m_minimumCorrelation{minimumCorrelation}
+      {
+      }
+
+    /**
+     * @brief Get the number of samples that always contain a complete null symbol and phase reference symbol
+     */
+    static std::size_t window()
+      {
+      return kTransmissionMode1.frame_duration + kTransmissionMode1.null_duration + kTransmissionMode1.symbol_duration;
+      }
+
+    /**
+     * @brief Search a block of samples for a DAB signal
+     */
+    detection analyze(std::vector<sample_t> const & samples)
+      {
+      auto result = detection{detection_status::empty, 0, 0, 0.0f};
+      auto const windows = samples.size() / kPowerWindow;
+      auto const values = reinterpret_cast<float const *>(samples.data());
+
+      m_power.assign(windows, 0.0f);
+      auto total = 0.0f;
+      for(std::size_t window{}; window < windows; ++window)
+        {
+        auto power = 0.0f;
+        for(std::size_t index{}; index < 2 * kPowerWindow; ++index)
+          {
+          power += values[2 * kPowerWindow * window + index] * values[2 * kPowerWindow * window + index];
+          }
+
+        m_power[window] = power;
+        total += power;
+        }
+
+      if(total <= 0.0f)
+        {
+        return result;
+        }
+
+      auto const threshold = m_nullDepth * total / windows;
+      for(std::size_t window{}; window < windows;)
+        {
+        if(m_power[window] >= threshold)
+          {
+          ++window;
+          continue;
+          }
+
+        auto end = window;
+        while(end < windows && m_power[end] < threshold)
+          {
+          ++end;
+          }
+
+        if(window > 0 && end < windows)
+          {
+          auto const mode = mode_of_null(window * kPowerWindow, end * kPowerWindow);
+          if(mode)
+            {
+            result.status = detection_status::undecided;
+
+            auto const correlation = guard_correlation(samples, end * kPowerWindow, *mode);
+            if(correlation >= m_minimumCorrelation)
+              {
+              return detection{detection_status::signal, mode->id, window * kPowerWindow, correlation};
+              }
+            }
+          }
+
+        window = end;
+        }
+
+      return result;
+      }
+
+    /**
+     * @brief Confirm the lock to a known ensemble at the position predicted by its synchronization state
+     *
+     * Instead of searching the samples for power dips, only the null symbol predicted by the state is located. Within
+     * the tolerance, the null symbol starts where the power over its duration is lowest. The lock is confirmed if that
+     * power dips below the null depth and the following phase reference symbol correlates with its guard interval.
+     * The samples therefore only need to cover a single frame plus the tolerance, and the caller can apply the fine
+     * frequency offset of the state right away.
+     *
+     * @param samples The samples received after tuning
+     * @param position The sample index of the first sample, counted on the same clock as the state
+     * @param state The synchronization state stored when the ensemble was last received
+     * @param tolerance The maximum deviation from the predicted null symbol start in samples
+     * @return A detection of status dab::detection_status::signal with the null symbol relative to @p samples if the
+     *         lock was confirmed, a detection of status dab::detection_status::undecided otherwise
+     */
+    detection resume(std::vector<sample_t> const & samples,
+                     std::uint64_t const position,
+                     sync_state const & state,
+                     std::size_t const tolerance = 64) const
+      {
+      auto result = detection{detection_status::undecided, 0, 0, 0.0f};
+      if(state.mode < 1 || state.mode > modes().size())
+        {
+        return result;
+        }
+
+      auto const & mode = *modes()[state.mode - 1];
+      auto const predicted = static_cast<std::size_t>(state.next_frame(position + tolerance, mode.frame_duration) - position);
+      if(predicted + tolerance + mode.null_duration + mode.symbol_duration > samples.size())
+        {
+        return result;
+        }
+
+      auto power = 0.0f;
+      for(auto index = predicted - tolerance; index < predicted - tolerance + mode.null_duration; ++index)
+        {
+        power += std::norm(samples[index]);
+        }
+
+      auto null = predicted - tolerance;
+      auto nullPower = power;
+      for(auto candidate = null + 1; candidate <= predicted + tolerance; ++candidate)
+        {
+        power += std::norm(samples[candidate + mode.null_duration - 1]) - std::norm(samples[candidate - 1]);
+        if(power < nullPower)
+          {
+          null = candidate;
+          nullPower = power;
+          }
+        }
+
+      auto symbolPower = 0.0f;
+      for(auto index = null + mode.null_duration; index < null + mode.null_duration + mode.symbol_duration; ++index)
+        {
+        symbolPower += std::norm(samples[index]);
+        }
+
+      if(nullPower / mode.null_duration >= m_nullDepth * symbolPower / mode.symbol_duration)
+        {
+        return result;
+        }
+
+      result.null_symbol = null;
+      result.correlation = guard_correlation(samples, null + mode.null_duration, mode);
+      if(result.correlation >= m_minimumCorrelation)
+        {
+        result.status = detection_status::signal;
+        result.mode = mode.id;
+        }
+
+      return result;
+      }
+
+    private:
+      static std::size_t constexpr kPowerWindow{16};
+
+      static std::array<internal::types::transmission_mode const *, 4> const & modes()
+        {
+        static std::array<internal::types::transmission_mode const *, 4> const all{{
+          &kTransmissionMode1, &kTransmissionMode2, &kTransmissionMode3, &kTransmissionMode4
+        }};
+
+        return all;
+        }
+
+      static internal::types::transmission_mode const * mode_of_null(std::size_t const begin, std::size_t const end)
+        {
+        auto const length = static_cast<long>(end - begin);
+        internal::types::transmission_mode const * best{};
+        auto bestDeviation = 0L;
+
+        for(auto const mode : modes())
+          {
+          auto const deviation = std::labs(length - static_cast<long>(mode->null_duration));
+          if(deviation <= static_cast<long>(mode->null_duration / 4 + 2 * kPowerWindow) && (!best || deviation < bestDeviation))
+            {
+            best = mode;
+            bestDeviation = deviation;
+            }
+          }
+
+        return best;
+        }
+
+      static float guard_correlation(std::vector<sample_t> const & samples,
+                                     std::size_t const symbol,
+                                     internal::types::transmission_mode const & mode)
+        {
+        auto const begin = symbol + kPowerWindow;
+        auto const end = symbol + mode.guard_duration - kPowerWindow;
+        if(end <= begin || end + mode.useful_duration > samples.size())
+          {
+          return 0.0f;
+          }
+
+        auto product = sample_t{};
+        auto guardPower = 0.0f;
+        auto tailPower = 0.0f;
+        for(auto index = begin; index < end; ++index)
+          {
+          product += samples[index] * std::conj(samples[index + mode.useful_duration]);
+          guardPower += std::norm(samples[index]);
+          tailPower += std::norm(samples[index + mode.useful_duration]);
+          }
+
+        auto const norm = std::sqrt(guardPower * tailPower);
+        return norm > 0.0f ? std::abs(product) / norm : 0.0f;
+        }
+
+      float const m_nullDepth;
+      float const m_minimumCorrelation;
+      std::vector<float> m_power{};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_OFDM_SYNC_STATE
+#define DABCOMMON_OFDM_SYNC_STATE
+
+#include "dab/fec/crc.h"
+#include "dab/types/common_types.h"
+#include "dab/types/little_endian.h"
+#include "dab/types/parse_status.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+
+namespace dab
+  {
+
+  /**
+   * @brief The synchronization state of a receiver locked to an ensemble
+   *
+   * The frame phase is expressed as the absolute sample index of a null symbol, counted on the sample clock of the
+   * tuner. As long as the tuner keeps counting samples across retunes, the position of the next null symbol of an
+   * ensemble that was received before can be predicted from this state.
+   *
+   * @author Felix Morgner
+   * @since  1.0.3
+   */
+  struct sync_state
+    {
+    std::uint8_t mode; ///< The identifier of the transmission mode
+    float frequency_offset; ///< The fine frequency offset in Hz
+    float clock_drift; ///< The deviation of the sample clock from the transmitter clock in ppm
+    std::uint64_t frame_start; ///< The sample index of the start of the last null symbol
+
+    /**
+     * @brief Predict the start of the first null symbol at or after a sample index
+     *
+     * @param position The sample index to predict the next null symbol for
+     * @param frameDuration The duration of a transmission frame of the mode in samples
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    std::uint64_t next_frame(std::uint64_t const position, std::size_t const frameDuration) const
+      {
+      if(position <= frame_start)
+        {
+        return frame_start;
+        }
+
+      auto const frame = frameDuration * (1.0 + clock_drift * 1e-6);
+      auto const frames = std::ceil((position - frame_start) / frame);
+      return frame_start + static_cast<std::uint64_t>(std::llround(frames * frame));
+      }
+    };
+
+  namespace internal
+    {
+
+    std::uint16_t constexpr kSyncStateVersion{1};
+    std::size_t constexpr kSyncStateHeaderBytes{8};
+    std::size_t constexpr kSyncStateRecordBytes{24};
+
+    inline std::uint32_t float_bits(float const value)
+      {
+      auto bits = std::uint32_t{};
+      std::memcpy(&bits, &value, sizeof(bits));
+      return bits;
+      }
+
+    inline float bits_float(std::uint32_t const bits)
+      {
+      auto value = 0.0f;
+      std::memcpy(&value, &bits, sizeof(value));
+      return value;
+      }
+
+    }
+
+  /**
+   * @brief The synchronization states of the ensembles a receiver has been locked to, keyed by frequency
+   *
+   * A receiver stores the state of the current ensemble before retuning and looks it up after tuning to an ensemble
+   * again, so that dab::signal_detector::resume can confirm the lock within a single frame instead of starting a
+   * coarse search. The states can be exported to a compact binary form to survive restarts. The cache is not
+   * synchronized.
+   *
+   * @author Felix Morgner
+   * @since  1.0.3
+   */
+  struct sync_state_cache
+    {
+    /**
+     * @brief Store or replace the state of the ensemble on a frequency
+     *
+     * @param frequency The center frequency in kHz
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    void store(std::uint32_t const frequency, sync_state const & state)
+      {
+      m_states[frequency] = state;
+      }
+
+    /**
+     * @brief Look up the state of the ensemble on a frequency
+     *
+     * @return @p true iff a state was stored for the frequency
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    bool find(std::uint32_t const frequency, sync_state & state) const
+      {
+      auto const entry = m_states.find(frequency);
+      if(entry == m_states.end())
+        {
+        return false;
+        }
+
+      state = entry->second;
+      return true;
+      }
+
+    /**
+     * @brief Drop the state of the ensemble on a frequency, e.g. after it failed to resume
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    void forget(std::uint32_t const frequency)
+      {
+      m_states.erase(frequency);
+      }
+
+    std::size_t size() const
+      {
+      return m_states.size();
+      }
+
+    /**
+     * @brief Export all states
+     *
+     * The export consists of an 8 byte header, a 24 byte little-endian record per frequency and a complemented CRC16
+     * over all preceding bytes, most significant byte first.
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    byte_vector_t export_states() const
+      {
+      auto const end = internal::kSyncStateHeaderBytes + m_states.size() * internal::kSyncStateRecordBytes;
+      auto bytes = byte_vector_t(end + 2);
+
+      std::memcpy(bytes.data(), "DABW", 4);
+      internal::store_little_endian(bytes.data() + 4, internal::kSyncStateVersion, 2);
+      internal::store_little_endian(bytes.data() + 6, m_states.size(), 2);
+
+      auto record = bytes.data() + internal::kSyncStateHeaderBytes;
+      for(auto const & entry : m_states)
+        {
+        internal::store_little_endian(record, entry.first, 4);
+        record[4] = entry.second.mode;
+        internal::store_little_endian(record + 8, internal::float_bits(entry.second.frequency_offset), 4);
+        internal::store_little_endian(record + 12, internal::float_bits(entry.second.clock_drift), 4);
+        internal::store_little_endian(record + 16, entry.second.frame_start, 8);
+        record += internal::kSyncStateRecordBytes;
+        }
+
+      auto const crc = static_cast<std::uint16_t>(~crc16(bytes.data(), end));
+      bytes[end] = static_cast<std::uint8_t>(crc >> 8);
+      bytes[end + 1] = static_cast<std::uint8_t>(crc & 0xFF);
+      return bytes;
+      }
+
+    /**
+     * @brief Import states previously exported using dab::sync_state_cache::export_states
+     *
+     * Imported states replace stored states for the same frequencies. Nothing is imported unless the data is valid.
+     *
+     * @return dab::parse_status::ok if the states were imported, dab::parse_status::incomplete if the data is
+     *         truncated, dab::parse_status::invalid_address if the data is not an export of a supported version and
+     *         dab::parse_status::invalid_crc if the data is corrupted
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    parse_status import_states(std::uint8_t const * const data, std::size_t const size)
+      {
+      if(size < internal::kSyncStateHeaderBytes + 2)
+        {
+        return parse_status::incomplete;
+        }
+
+      if(std::memcmp(data, "DABW", 4) || internal::load_little_endian(data + 4, 2) != internal::kSyncStateVersion)
+        {
+        return parse_status::invalid_address;
+        }
+
+      auto const count = static_cast<std::size_t>(internal::load_little_endian(data + 6, 2));
+      if(size != internal::kSyncStateHeaderBytes + count * internal::kSyncStateRecordBytes + 2)
+        {
+        return parse_status::incomplete;
+        }
+
+      if(!crc16_valid(data, size))
+        {
+        return parse_status::invalid_crc;
+        }
+
+      auto record = data + internal::kSyncStateHeaderBytes;
+      for(std::size_t index{}; index < count; ++index, record += internal::kSyncStateRecordBytes)
+        {
+        m_states[static_cast<std::uint32_t>(internal::load_little_endian(record, 4))] = sync_state{
+          record[4],
+          internal::bits_float(static_cast<std::uint32_t>(internal::load_little_endian(record + 8, 4))),
+          internal::bits_float(static_cast<std::uint32_t>(internal::load_little_endian(record + 12, 4))),
+          internal::load_little_endian(record + 16, 8)
+        };
+        }
+
+      return parse_status::ok;
+      }
+
+    private:
+      std::map<std::uint32_t, sync_state> m_states{};
+    };
+
+  }
+
+#endif
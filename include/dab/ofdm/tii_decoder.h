@@ -0,0 +1,333 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_OFDM_TII_DECODER
+#define DABCOMMON_OFDM_TII_DECODER
+
+#include "dab/ofdm/fft.h"
+#include "dab/system/scheduling.h"
+#include "dab/types/common_types.h"
+#include "dab/types/transmission_mode.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief The number of TII combs, which carry the sub-identifiers of transmitters
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kTiiCombs{24};
+
+  /**
+   * @brief The number of TII patterns, which carry the main identifiers of transmitters
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kTiiPatterns{70};
+
+  /**
+   * @brief By default, a dab::tii_decoder averages the null symbols of 8 transmission frames
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kDefaultTiiFrames{8};
+
+  /**
+   * @brief By default, a TII carrier position is considered active if it carries 4 times the noise power
+   *
+   * @since 1.0.3
+   */
+  float constexpr kDefaultTiiThreshold{4.0f};
+
+  /**
+   * @brief A transmitter identified by its TII signal
+   *
+   * @since 1.0.3
+   */
+  struct transmitter_identifier
+    {
+    std::uint8_t main; ///< The main identifier, i.e. the TII pattern
+    std::uint8_t sub; ///< The sub-identifier, i.e. the TII comb
+    float level; ///< The power of the transmitter relative to the strongest one, in dB
+    };
+
+  namespace internal
+    {
+
+    /**
+     * @internal
+     *
+     * @brief The TII patterns, each selecting 4 out of 8 carrier pair positions
+     *
+     * The patterns are the 8-bit values with four bits set, in ascending order. The most significant bit selects the
+     * first position of a group.
+     */
+    inline std::array<std::uint8_t, kTiiPatterns> const & tii_patterns()
+      {
+      static auto const patterns = []{
+        auto values = std::array<std::uint8_t, kTiiPatterns>{};
+        auto count = std::size_t{};
+
+        for(unsigned value{}; value < 256; ++value)
+          {
+          auto bits = 0;
+          for(auto remaining = value; remaining; remaining &= remaining - 1)
+            {
+            ++bits;
+            }
+
+          if(bits == 4)
+            {
+            values[count++] = static_cast<std::uint8_t>(value);
+            }
+          }
+
+        return values;
+      }();
+
+      return patterns;
+      }
+
+    }
+
+  /**
+   * @brief A decoder for the Transmitter Identification Information carried by the null symbol
+   *
+   * In a single frequency network, each transmitter switches on a distinct set of carrier pairs during the null symbol.
+   * The comb defines the position of the pairs within a group of 8 positions spaced 48 carriers apart, the pattern
+   * defines which 4 of the 8 positions are active. The groups are repeated across the band, with the pairs in the upper
+   * half of the band shifted by one carrier to skip the center carrier.
+   *
+   * Single null symbols are too noisy to decode reliably, so this decoder averages the power spectra of a number of
+   * null symbols before detecting transmitters. The power averaging runs over interleaved floats so that it vectorizes,
+   * and one FFT per frame is the only other cost. The decoder is meant to run on a low-priority thread, fed by a tap
+   * that copies the null symbols off the demodulation chain (see dab::tii_decoder::consume and
+   * dab::lower_current_thread_priority).
+   *
+   * Transmission modes I, II and IV are supported. Transmission mode III does not define TII.
+   *
+   * @since 1.0.3
+   */
+  struct tii_decoder
+    {
+    /**
+     * @brief Construct a decoder for a transmission mode
+     *
+     * @param mode The transmission mode of the ensemble
+     * @param frames The number of null symbols to average before detecting transmitters
+     * @param threshold The ratio of the power of an active carrier pair position to the noise power
+     *
+     * @throws std::invalid_argument if @p mode does not define TII
+     */
+    explicit tii_decoder(internal::types::transmission_mode const & mode,
+                         std::size_t const frames = kDefaultTiiFrames,
+                         float const threshold = kDefaultTiiThreshold)
+      : m_carriers{mode.carriers},
+        m_nullDuration{mode.null_duration},
+        m_frames{frames ? frames : 1},
+        m_threshold{threshold},
+        m_fft{mode.fft_length},
+        m_spectrum(mode.fft_length),
+        m_power(mode.fft_length)
+      {
+      if(mode.carriers % kGroupCarriers)
+        {
+        throw std::invalid_argument{"Transmission mode does not define TII"};
+        }
+      }
+
+    /**
+     * @brief Add the samples of a null symbol to the average
+     *
+     * @param nullSymbol The samples of the null symbol, at least as many as the FFT length of the transmission mode
+     * @return @p true iff a new detection result is available
+     *
+     * @throws std::invalid_argument if @p nullSymbol is too short
+     */
+    bool push(std::vector<sample_t> const & nullSymbol)
+      {
+      if(nullSymbol.size() < m_spectrum.size())
+        {
+        throw std::invalid_argument{"Null symbol shorter than the FFT length"};
+        }
+
+      std::copy(nullSymbol.end() - m_spectrum.size(), nullSymbol.end(), m_spectrum.begin());
+      m_fft.forward(m_spectrum);
+
+      auto const values = reinterpret_cast<float const *>(m_spectrum.data());
+      for(std::size_t bin{}; bin < m_power.size(); ++bin)
+        {
+        m_power[bin] += values[2 * bin] * values[2 * bin] + values[2 * bin + 1] * values[2 * bin + 1];
+        }
+
+      if(++m_accumulated < m_frames)
+        {
+        return false;
+        }
+
+      detect();
+      std::fill(m_power.begin(), m_power.end(), 0.0f);
+      m_accumulated = 0;
+      return true;
+      }
+
+    /**
+     * @brief Consume null symbols from a queue until the queue is closed
+     *
+     * Each dequeued block of the null symbol length is passed to dab::tii_decoder::push.
+     *
+     * @param nullSymbols The queue carrying the samples of null symbols
+     * @param report A callable invoked with the detected transmitters whenever a new result is available
+     */
+    template<typename ReportFunction>
+    void consume(sample_queue_t & nullSymbols, ReportFunction && report)
+      {
+      auto block = std::vector<sample_t>(m_nullDuration);
+
+      while(nullSymbols.dequeue(block))
+        {
+        if(push(block))
+          {
+          report(static_cast<std::vector<transmitter_identifier> const &>(m_transmitters));
+          }
+        }
+      }
+
+    /**
+     * @brief Get the transmitters detected in the most recent result, strongest first
+     */
+    std::vector<transmitter_identifier> const & transmitters() const
+      {
+      return m_transmitters;
+      }
+
+    private:
+      static std::size_t constexpr kGroupCarriers{384};
+      static std::size_t constexpr kPositionSpacing{48};
+      static std::size_t constexpr kPositions{8};
+
+      float pair_power(int const carrier) const
+        {
+        auto const size = static_cast<int>(m_power.size());
+        return m_power[(carrier + size) % size] + m_power[(carrier + 1 + size) % size];
+        }
+
+      void detect()
+        {
+        m_transmitters.clear();
+
+        auto active = std::vector<float>{};
+        auto const first = -static_cast<int>(m_carriers / 2);
+        for(auto carrier = first; carrier <= -first; ++carrier)
+          {
+          if(carrier)
+            {
+            active.push_back(m_power[(carrier + m_power.size()) % m_power.size()]);
+            }
+          }
+
+        auto const median = active.begin() + active.size() / 2;
+        std::nth_element(active.begin(), median, active.end());
+
+        auto const groups = m_carriers / kGroupCarriers;
+        auto const noise = *median * 2 * groups;
+        auto const & patterns = internal::tii_patterns();
+
+        for(std::size_t comb{}; comb < kTiiCombs; ++comb)
+          {
+          auto positions = std::array<float, kPositions>{};
+          for(std::size_t position{}; position < kPositions * groups; ++position)
+            {
+            auto carrier = first + static_cast<int>(2 * comb + kPositionSpacing * position);
+            positions[position % kPositions] += pair_power(carrier < 0 ? carrier : carrier + 1);
+            }
+
+          auto sorted = positions;
+          std::sort(sorted.begin(), sorted.end(), [](float lhs, float rhs){ return lhs > rhs; });
+          if(sorted[3] < m_threshold * noise)
+            {
+            continue;
+            }
+
+          auto pattern = std::uint8_t{};
+          for(std::size_t position{}; position < kPositions; ++position)
+            {
+            if(positions[position] >= sorted[3])
+              {
+              pattern |= static_cast<std::uint8_t>(0x80 >> position);
+              }
+            }
+
+          auto const match = std::find(patterns.begin(), patterns.end(), pattern);
+          if(match != patterns.end())
+            {
+            auto const level = std::fmax((sorted[0] + sorted[1] + sorted[2] + sorted[3]) / 4 - noise, 1e-12f);
+            m_transmitters.push_back({static_cast<std::uint8_t>(match - patterns.begin()), static_cast<std::uint8_t>(comb), level});
+            }
+          }
+
+        std::sort(m_transmitters.begin(), m_transmitters.end(), [](transmitter_identifier const & lhs, transmitter_identifier const & rhs){
+          return lhs.level > rhs.level;
+        });
+
+        if(!m_transmitters.empty())
+          {
+          auto const strongest = m_transmitters.front().level;
+          for(auto & transmitter : m_transmitters)
+            {
+            transmitter.level = 10.0f * std::log10(transmitter.level / strongest);
+            }
+          }
+        }
+
+      std::size_t const m_carriers;
+      std::size_t const m_nullDuration;
+      std::size_t const m_frames;
+      float const m_threshold;
+      fft const m_fft;
+      std::vector<sample_t> m_spectrum;
+      std::vector<float> m_power;
+      std::size_t m_accumulated{};
+      std::vector<transmitter_identifier> m_transmitters{};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_PAD_DYNAMIC_LABEL
+#define DABCOMMON_PAD_DYNAMIC_LABEL
+
+#include "dab/types/byte_view.h"
+#include "dab/types/parse_status.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace dab
+  {
+
+  /**
+   * @brief The maximum number of segments of a dynamic label
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kMaximumLabelSegments{8};
+
+  /**
+   * @brief The maximum number of characters in a dynamic label segment
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kLabelSegmentLength{16};
+
+  /**
+   * @brief A dynamic label, stored inline
+   *
+   * @since 1.0.3
+   */
+  struct dynamic_label
+    {
+    std::array<char, kMaximumLabelSegments * kLabelSegmentLength> text; ///< The characters of the label, not terminated
+    std::size_t length; ///< The number of characters in the label
+    std::uint8_t charset; ///< The character set of the label
+    };
+
+  /**
+   * @brief Reassembles dynamic labels from the Dynamic Label Segment data groups of a service
+   *
+   * Segments are collected until all segments up to the one flagged as last were received. A change of the toggle bit
+   * announces a new label and discards the collected segments.
+   *
+   * @since 1.0.3
+   */
+  struct dynamic_label_decoder
+    {
+    /**
+     * @brief Process a Dynamic Label data group
+     *
+     * @param group A data group with a valid CRC, as passed to the handler of dab::data_group_assembler::push
+     * @return dab::parse_status::ok if the label was completed or cleared, dab::parse_status::segment_lost if the last
+     *         segment was received but earlier segments are still missing and dab::parse_status::incomplete otherwise
+     */
+    parse_status decode(byte_view const group)
+      {
+      if(group.size() < 4)
+        {
+        return parse_status::incomplete;
+        }
+
+      auto const toggle = (group[0] & 0x80) != 0;
+      auto const first = (group[0] & 0x40) != 0;
+      auto const last = (group[0] & 0x20) != 0;
+      auto const command = (group[0] & 0x10) != 0;
+      auto const field = static_cast<std::size_t>(group[0] & 0x0F);
+
+      if(command)
+        {
+        if(field != 0x01)
+          {
+          return parse_status::incomplete;
+          }
+
+        m_label.length = 0;
+        m_received = 0;
+        return parse_status::ok;
+        }
+
+      if(toggle != m_toggle)
+        {
+        m_toggle = toggle;
+        m_received = 0;
+        m_segments = 0;
+        }
+
+      auto const segment = first ? 0 : static_cast<std::size_t>((group[1] >> 4) & 0x07);
+      auto const length = std::min(field + 1, group.size() - 4);
+      std::copy_n(group.begin() + 2, length, m_text.begin() + segment * kLabelSegmentLength);
+      m_lengths[segment] = static_cast<std::uint8_t>(length);
+      m_received |= 1u << segment;
+
+      if(first)
+        {
+        m_charset = static_cast<std::uint8_t>(group[1] >> 4);
+        }
+
+      if(last)
+        {
+        m_segments = segment + 1;
+        }
+
+      if(!m_segments)
+        {
+        return parse_status::incomplete;
+        }
+
+      auto const complete = (1u << m_segments) - 1;
+      if((m_received & complete) != complete)
+        {
+        return last ? parse_status::segment_lost : parse_status::incomplete;
+        }
+
+      m_label.length = 0;
+      for(std::size_t index{}; index < m_segments; ++index)
+        {
+        std::copy_n(m_text.begin() + index * kLabelSegmentLength, m_lengths[index], m_label.text.begin() + m_label.length);
+        m_label.length += m_lengths[index];
+        }
+
+      m_label.charset = m_charset;
+      m_received = 0;
+      m_segments = 0;
+      return parse_status::ok;
+      }
+
+    /**
+     * @brief Get the last completed label
+     */
+    dynamic_label const & label() const
+      {
+      return m_label;
+      }
+
+    private:
+      dynamic_label m_label{};
+      std::array<char, kMaximumLabelSegments * kLabelSegmentLength> m_text{};
+      std::array<std::uint8_t, kMaximumLabelSegments> m_lengths{};
+      unsigned m_received{};
+      std::size_t m_segments{};
+      std::uint8_t m_charset{};
+      bool m_toggle{};
+    };
+
+  }
+
+#endif
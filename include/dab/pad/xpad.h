@@ -0,0 +1,439 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_PAD_XPAD
+#define DABCOMMON_PAD_XPAD
+
+#include "dab/fec/crc.h"
+#include "dab/types/byte_view.h"
+#include "dab/types/parse_status.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @file
+ *
+ * @brief This file contains the demultiplexer and data group reassembly for X-PAD
+ *
+ * The Programme Associated Data is located at the end of an audio frame: two bytes of F-PAD, preceded by the X-PAD
+ * field. In DAB (MPEG Audio Layer II) frames, the Scale Factor CRC sits between the X-PAD field and the F-PAD. The
+ * X-PAD field is transmitted in reverse byte order. It carries an optional list of Contents Indicators (CI), each
+ * announcing the application type and length of one data subfield. Data subfields carry the segments of X-PAD data
+ * groups, like Dynamic Label Segments or MOT objects.
+ *
+ * @since 1.0.3
+ */
+
+namespace dab
+  {
+
+  /**
+   * @brief The lengths of the data subfields of variable size X-PAD, indexed by the length indicator of a CI
+   *
+   * @since 1.0.3
+   */
+  std::array<std::uint8_t, 8> constexpr kContentIndicatorLengths{{4, 6, 8, 12, 16, 24, 32, 48}};
+
+  /**
+   * @brief The maximum number of bytes in an X-PAD field
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kMaximumXpadBytes{196};
+
+  /**
+   * @brief The maximum number of bytes in an MOT data group
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kMaximumDataGroupBytes{16383};
+
+  /**
+   * @brief The X-PAD application types handled by dabcommon
+   *
+   * @since 1.0.3
+   */
+  enum struct xpad_application : std::uint8_t
+    {
+    end_marker = 0, ///< Terminates the CI list
+    data_group_length = 1, ///< The length of the next MOT data group
+    dynamic_label_start = 2, ///< The start of a Dynamic Label data group
+    dynamic_label = 3, ///< The continuation of a Dynamic Label data group
+    mot_start = 12, ///< The start of an MOT data group
+    mot = 13, ///< The continuation of an MOT data group
+    };
+
+  /**
+   * @brief A data subfield of an X-PAD field
+   *
+   * @since 1.0.3
+   */
+  struct xpad_subfield
+    {
+    std::uint8_t application; ///< The application type, see dab::xpad_application
+    byte_view data; ///< The bytes of the subfield in transmission order
+    };
+
+  /**
+   * @brief Splits the X-PAD field of audio frames into data subfields
+   *
+   * The X-PAD field is restored to transmission order once per frame, in a buffer owned by the demultiplexer. The
+   * returned subfields are views into this buffer and remain valid until the next frame is demultiplexed. X-PAD fields
+   * without a CI list continue the last data subfield of the previous frame, so a demultiplexer must be used for the
+   * frames of a single service only.
+   *
+   * In DAB+, the X-PAD field directly precedes the F-PAD. In DAB (MPEG Audio Layer II), the Scale Factor CRC (ScF-CRC)
+   * lies in between. Its length depends on the bit rate of the service and must be passed on construction.
+   *
+   * @since 1.0.3
+   */
+  struct xpad_demultiplexer
+    {
+    /**
+     * @brief Construct a demultiplexer
+     *
+     * @param scaleFactorCrcBytes The number of ScF-CRC bytes between the X-PAD field and the F-PAD. This is 0 for DAB+
+     *        and 2 or 4 for DAB, depending on the bit rate (see ETSI EN 300 401).
+     *
+     * @since 1.0.3
+     */
+    explicit xpad_demultiplexer(std::size_t const scaleFactorCrcBytes = 0)
+      : m_scaleFactorCrcBytes{scaleFactorCrcBytes}
+      {
+
+      }
+
+    /**
+     * @brief Demultiplex the PAD of an audio frame
+     *
+     * @param pad The end of an audio frame, with the two F-PAD bytes at its end, preceded by the ScF-CRC if any. Bytes
+     *        beyond the X-PAD field are ignored, so the complete frame may be passed.
+     * @param subfields Receives the data subfields
+     * @return dab::parse_status::incomplete if the X-PAD field is truncated, dab::parse_status::ok otherwise
+     */
+    parse_status demultiplex(byte_view const pad, std::vector<xpad_subfield> & subfields)
+      {
+      subfields.clear();
+
+      if(pad.size() < 2 + m_scaleFactorCrcBytes)
+        {
+        return parse_status::incomplete;
+        }
+
+      auto const indicator = (pad[pad.size() - 2] >> 4) & 0x03;
+      auto const contentsIndicated = (pad[pad.size() - 1] & 0x02) != 0;
+      if(!indicator || indicator == 3)
+        {
+        m_lastApplication = 0;
+        return parse_status::ok;
+        }
+
+      auto const end = pad.end() - 2 - m_scaleFactorCrcBytes;
+      auto const size = std::min(pad.size() - 2 - m_scaleFactorCrcBytes, kMaximumXpadBytes);
+      std::reverse_copy(end - size, end, m_field.begin());
+
+      auto cursor = std::size_t{};
+      auto contents = std::array<std::pair<std::uint8_t, std::size_t>, 4>{};
+      auto count = std::size_t{};
+
+      if(!contentsIndicated)
+        {
+        if(!m_lastApplication)
+          {
+          return parse_status::ok;
+          }
+
+        contents[count++] = {continuation(m_lastApplication), indicator == 1 ? 4 : m_lastLength};
+        }
+      else if(indicator == 1)
+        {
+        if(size)
+          {
+          contents[count++] = {static_cast<std::uint8_t>(m_field[cursor++] & 0x1F), 3};
+          }
+        }
+      else
+        {
+        while(count < contents.size() && cursor < size)
+          {
+          auto const indicatorByte = m_field[cursor++];
+          if(!(indicatorByte & 0x1F))
+            {
+            break;
+            }
+
+          contents[count++] = {static_cast<std::uint8_t>(indicatorByte & 0x1F), kContentIndicatorLengths[indicatorByte >> 5]};
+          }
+        }
+
+      m_lastApplication = 0;
+      for(std::size_t index{}; index < count; ++index)
+        {
+        auto const length = contents[index].second;
+        if(cursor + length > size)
+          {
+          return parse_status::incomplete;
+          }
+
+        subfields.push_back({contents[index].first, {m_field.data() + cursor, length}});
+        cursor += length;
+        }
+
+      if(count)
+        {
+        m_lastApplication = contents[count - 1].first;
+        m_lastLength = contents[count - 1].second;
+        }
+
+      return parse_status::ok;
+      }
+
+    private:
+      static std::uint8_t continuation(std::uint8_t const application)
+        {
+        switch(static_cast<xpad_application>(application))
+          {
+          case xpad_application::dynamic_label_start:
+            return static_cast<std::uint8_t>(xpad_application::dynamic_label);
+          case xpad_application::mot_start:
+            return static_cast<std::uint8_t>(xpad_application::mot);
+          default:
+            return application;
+          }
+        }
+
+      std::size_t m_scaleFactorCrcBytes;
+      std::array<std::uint8_t, kMaximumXpadBytes> m_field{};
+      std::uint8_t m_lastApplication{};
+      std::size_t m_lastLength{};
+    };
+
+  namespace internal
+    {
+
+    /**
+     * @internal
+     *
+     * @brief A data group being reassembled from data subfields, stored inline
+     */
+    template<std::size_t Capacity>
+    struct data_group_buffer
+      {
+      bool active() const
+        {
+        return m_expected;
+        }
+
+      void begin(std::size_t const expected)
+        {
+        m_expected = expected;
+        m_size = 0;
+        }
+
+      void clear()
+        {
+        m_expected = 0;
+        }
+
+      /**
+       * @return The number of bytes that were appended
+       */
+      std::size_t append(byte_view const data)
+        {
+        auto const count = std::min(data.size(), Capacity - m_size);
+        std::copy_n(data.begin(), count, m_bytes.begin() + m_size);
+        m_size += count;
+        return count;
+        }
+
+      std::size_t size() const
+        {
+        return m_size;
+        }
+
+      std::size_t expected() const
+        {
+        return m_expected;
+        }
+
+      void expect(std::size_t const expected)
+        {
+        m_expected = expected;
+        }
+
+      byte_view group() const
+        {
+        return {m_bytes.data(), m_expected};
+        }
+
+      std::uint8_t operator[](std::size_t const index) const
+        {
+        return m_bytes[index];
+        }
+
+      private:
+        std::array<std::uint8_t, Capacity> m_bytes{};
+        std::size_t m_expected{};
+        std::size_t m_size{};
+      };
+
+    /**
+     * @internal
+     *
+     * @brief Get the length of a Dynamic Label data group, including its prefix and CRC, from its prefix
+     */
+    inline std::size_t dynamic_label_group_length(std::uint8_t const first, std::uint8_t const second)
+      {
+      auto const command = (first & 0x10) != 0;
+      auto const field = first & 0x0F;
+
+      if(!command)
+        {
+        return 2 + field + 1 + 2;
+        }
+
+      return field == 0x02 ? 2 + (second & 0x0F) + 1 + 2 : 2 + 2;
+      }
+
+    }
+
+  /**
+   * @brief Reassembles X-PAD data groups from data subfields
+   *
+   * Dynamic Label and MOT data groups are reassembled separately, since their data subfields are interleaved. The
+   * length of MOT data groups is taken from the preceding data group length indicator. Completed data groups are passed
+   * to a handler, together with the result of checking their CRC, as views into a buffer that is reused for the next
+   * data group of the same application.
+   *
+   * @since 1.0.3
+   */
+  struct data_group_assembler
+    {
+    /**
+     * @brief Process the data subfields of a frame
+     *
+     * @param subfields The data subfields as returned by dab::xpad_demultiplexer::demultiplex
+     * @param handler A callable accepting the start application type of a data group, a dab::parse_status and a
+     *        dab::byte_view of the data group including its CRC. The status is dab::parse_status::segment_lost if the
+     *        data group was interrupted by the start of the next one, in which case the view is empty.
+     */
+    template<typename HandlerType>
+    void push(std::vector<xpad_subfield> const & subfields, HandlerType && handler)
+      {
+      for(auto const & subfield : subfields)
+        {
+        switch(static_cast<xpad_application>(subfield.application))
+          {
+          case xpad_application::data_group_length:
+            m_length.begin(4);
+            append(m_length, xpad_application::data_group_length, subfield.data, [this](xpad_application, parse_status const status, byte_view const group){
+              if(status == parse_status::ok)
+                {
+                m_nextLength = ((group[0] & 0x3F) << 8) | group[1];
+                }
+            });
+            break;
+          case xpad_application::dynamic_label_start:
+            interrupt(m_label, xpad_application::dynamic_label_start, handler);
+            m_label.begin(kMaximumLabelGroupBytes);
+            append(m_label, xpad_application::dynamic_label_start, subfield.data, handler);
+            break;
+          case xpad_application::dynamic_label:
+            append(m_label, xpad_application::dynamic_label_start, subfield.data, handler);
+            break;
+          case xpad_application::mot_start:
+            interrupt(m_mot, xpad_application::mot_start, handler);
+            if(m_nextLength)
+              {
+              m_mot.begin(m_nextLength);
+              m_nextLength = 0;
+              append(m_mot, xpad_application::mot_start, subfield.data, handler);
+              }
+            break;
+          case xpad_application::mot:
+            append(m_mot, xpad_application::mot_start, subfield.data, handler);
+            break;
+          default:
+            break;
+          }
+        }
+      }
+
+    private:
+      static std::size_t constexpr kMaximumLabelGroupBytes{2 + 16 + 2};
+
+      template<typename BufferType, typename HandlerType>
+      static void interrupt(BufferType & buffer, xpad_application const application, HandlerType && handler)
+        {
+        if(buffer.active())
+          {
+          buffer.clear();
+          handler(application, parse_status::segment_lost, byte_view{});
+          }
+        }
+
+      template<typename BufferType, typename HandlerType>
+      static void append(BufferType & buffer, xpad_application const application, byte_view const data, HandlerType && handler)
+        {
+        if(!buffer.active())
+          {
+          return;
+          }
+
+        auto const hadPrefix = buffer.size() >= 2;
+        buffer.append(data);
+        if(application == xpad_application::dynamic_label_start && !hadPrefix && buffer.size() >= 2)
+          {
+          buffer.expect(internal::dynamic_label_group_length(buffer[0], buffer[1]));
+          }
+
+        if(buffer.size() >= buffer.expected())
+          {
+          auto const group = buffer.group();
+          buffer.clear();
+          handler(application, crc16_valid(group.data(), group.size()) ? parse_status::ok : parse_status::invalid_crc, group);
+          }
+        }
+
+      internal::data_group_buffer<4> m_length{};
+      internal::data_group_buffer<kMaximumLabelGroupBytes> m_label{};
+      internal::data_group_buffer<kMaximumDataGroupBytes> m_mot{};
+      std::size_t m_nextLength{};
+    };
+
+  }
+
+#endif
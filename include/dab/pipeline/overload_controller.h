@@ -0,0 +1,358 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_PIPELINE_OVERLOAD_CONTROLLER
+#define DABCOMMON_PIPELINE_OVERLOAD_CONTROLLER
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief The measures an overloaded receiver can take to reduce its load
+   *
+   * @author Felix Morgner
+   * @since  1.0.3
+   */
+  enum struct shed_action : std::uint8_t
+    {
+    monitoring_taps, ///< Stop feeding the signal quality, spectrum and TII monitors
+    unsubscribed_subchannels, ///< Stop decoding sub-channels that no client subscribed to
+    hard_decision_viterbi, ///< Decode using dab::viterbi_decode_hard instead of soft decisions
+    };
+
+  /**
+   * @brief The tuning of a dab::overload_controller
+   *
+   * @author Felix Morgner
+   * @since  1.0.3
+   */
+  struct overload_parameters
+    {
+    double rising_trend; ///< The smoothed growth in elements per second above which a growing queue is rising
+    std::size_t high_watermark; ///< The depth above which a queue is considered overloaded regardless of its trend
+    std::size_t low_watermark; ///< The depth above which a rising queue is overloaded, and below which any other is relaxed
+    std::chrono::milliseconds degrade_after; ///< The time the pipeline must be overloaded before the next measure is taken
+    std::chrono::milliseconds restore_after; ///< The time the pipeline must be relaxed before the last measure is lifted
+    double smoothing; ///< The weight of the latest sample in the exponentially smoothed trend
+    };
+
+  /**
+   * @brief The default tuning of a dab::overload_controller
+   *
+   * @author Felix Morgner
+   * @since  1.0.3
+   */
+  overload_parameters constexpr kDefaultOverloadParameters{
+    0.0,
+    1024,
+    64,
+    std::chrono::milliseconds{500},
+    std::chrono::milliseconds{5000},
+    0.25,
+  };
+
+  /**
+   * @brief A change of the degradation level of a dab::overload_controller
+   *
+   * @author Felix Morgner
+   * @since  1.0.3
+   */
+  struct overload_event
+    {
+    shed_action action; ///< The measure that was taken or lifted
+    bool degraded; ///< Whether the measure was taken, as opposed to lifted
+    std::size_t level; ///< The number of measures in effect after the change
+    };
+
+  /**
+   * @brief Sheds work in a configurable order when the queues of a pipeline keep growing
+   *
+   * The controller periodically samples the depths of the watched queues and smoothes their growth rates. While any
+   * queue above the low watermark grew since the last sample with a trend above the configured one, or any queue
+   * exceeds the high watermark, the next measure in the configured order is taken after every
+   * dab::overload_parameters::degrade_after. Once all queues are stable or shrinking and below the
+   * low watermark for dab::overload_parameters::restore_after, the measures are lifted again in reverse order. The hold
+   * times keep the controller from oscillating.
+   *
+   * dab::overload_controller::update and the configuration functions must be called from a single supervising thread,
+   * which also runs the event handler. dab::overload_controller::shedding is lock-free and can be queried from the
+   * processing threads.
+   *
+   * @code
+   * dab::overload_controller controller{};
+   * controller.watch(samples);
+   * controller.watch(symbols);
+   * controller.on_change([](dab::overload_event const & event){ log(event); });
+   *
+   * // supervisor thread
+   * controller.update();
+   *
+   * // processing threads
+   * if(!controller.shedding(dab::shed_action::monitoring_taps)) monitor.tap(symbol);
+   * @endcode
+   *
+   * @author Felix Morgner
+   * @since  1.0.3
+   */
+  struct overload_controller
+    {
+    using clock = std::chrono::steady_clock;
+    using depth_function = std::function<std::size_t()>;
+    using event_handler = std::function<void(overload_event const &)>;
+
+    /**
+     * @brief Construct a controller
+     *
+     * @param order The measures to take, in the order they are taken
+     * @param parameters The tuning of the controller
+     * @throws std::invalid_argument if a measure occurs more than once in @p order
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    explicit overload_controller(std::vector<shed_action> order = {shed_action::monitoring_taps,
+                                                                   shed_action::unsubscribed_subchannels,
+                                                                   shed_action::hard_decision_viterbi},
+                                 overload_parameters const & parameters = kDefaultOverloadParameters)
+      : m_order{std::move(order)}
+      , m_parameters(parameters)
+      {
+      auto mask = 0u;
+      for(auto const action : m_order)
+        {
+        if(mask & bit(action))
+          {
+          throw std::invalid_argument{"Each measure may only be taken once"};
+          }
+
+        mask |= bit(action);
+        }
+      }
+
+    overload_controller(overload_controller const &) = delete;
+    overload_controller & operator=(overload_controller const &) = delete;
+
+    /**
+     * @brief Watch a queue providing approximate_size(), like dab::internal::queue
+     *
+     * The queue must outlive the controller.
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    template<typename QueueType>
+    void watch(QueueType const & queue)
+      {
+      watch_depth([&queue]{ return queue.approximate_size(); });
+      }
+
+    /**
+     * @brief Watch an arbitrary depth, for example the number of pending tasks of a dab::task_pool
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    void watch_depth(depth_function depth)
+      {
+      m_watched.push_back({std::move(depth), 0, 0.0});
+      }
+
+    /**
+     * @brief Set the handler invoked whenever a measure is taken or lifted
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    void on_change(event_handler handler)
+      {
+      m_handler = std::move(handler);
+      }
+
+    /**
+     * @brief Sample the watched queues and adjust the degradation level
+     *
+     * This function should be called at a regular interval that is considerably shorter than the hold times, e.g.
+     * every 100 ms.
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    void update(clock::time_point const now = clock::now())
+      {
+      auto overloaded = false;
+      auto relaxed = true;
+      auto const seconds = m_sampled ? std::chrono::duration<double>(now - m_last).count() : 0.0;
+      if(!m_sampled)
+        {
+        m_overloadedSince = now;
+        m_relaxedSince = now;
+        }
+
+      for(auto & watched : m_watched)
+        {
+        auto const depth = watched.depth();
+        auto const growing = depth > watched.last;
+        if(seconds > 0.0)
+          {
+          auto const rate = (static_cast<double>(depth) - static_cast<double>(watched.last)) / seconds;
+          watched.trend += m_parameters.smoothing * (rate - watched.trend);
+          }
+
+        watched.last = depth;
+        auto const rising = growing && seconds > 0.0 && watched.trend > m_parameters.rising_trend;
+        overloaded |= depth > m_parameters.high_watermark || (rising && depth > m_parameters.low_watermark);
+        relaxed &= depth <= m_parameters.low_watermark && !rising;
+        }
+
+      m_last = now;
+      m_sampled = true;
+
+      if(overloaded)
+        {
+        m_relaxedSince = now;
+        if(now - m_overloadedSince >= m_parameters.degrade_after && m_level < m_order.size())
+          {
+          change(true);
+          m_overloadedSince = now;
+          }
+        }
+      else if(relaxed)
+        {
+        m_overloadedSince = now;
+        if(now - m_relaxedSince >= m_parameters.restore_after && m_level)
+          {
+          change(false);
+          m_relaxedSince = now;
+          }
+        }
+      else
+        {
+        m_overloadedSince = now;
+        m_relaxedSince = now;
+        }
+      }
+
+    /**
+     * @brief Check whether a measure is currently in effect
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    bool shedding(shed_action const action) const
+      {
+      return m_shedding.load(std::memory_order_relaxed) & bit(action);
+      }
+
+    /**
+     * @brief Get the number of measures currently in effect
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    std::size_t level() const
+      {
+      return m_level;
+      }
+
+    /**
+     * @brief Get the smoothed growth rates of the watched queues in elements per second, in the order they were added
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    std::vector<double> trends() const
+      {
+      auto result = std::vector<double>{};
+      for(auto const & watched : m_watched)
+        {
+        result.push_back(watched.trend);
+        }
+
+      return result;
+      }
+
+    private:
+      struct watched_depth
+        {
+        depth_function depth;
+        std::size_t last;
+        double trend;
+        };
+
+      static unsigned bit(shed_action const action)
+        {
+        return 1u << static_cast<unsigned>(action);
+        }
+
+      void change(bool const degrade)
+        {
+        if(degrade)
+          {
+          m_shedding.fetch_or(bit(m_order[m_level++]), std::memory_order_relaxed);
+          }
+        else
+          {
+          m_shedding.fetch_and(~bit(m_order[--m_level]), std::memory_order_relaxed);
+          }
+
+        auto const action = m_order[degrade ? m_level - 1 : m_level];
+
+        if(m_handler)
+          {
+          m_handler({action, degrade, m_level});
+          }
+        }
+
+      std::vector<shed_action> const m_order;
+      overload_parameters const m_parameters;
+      std::vector<watched_depth> m_watched{};
+      event_handler m_handler{};
+      std::atomic<unsigned> m_shedding{};
+      std::size_t m_level{};
+      clock::time_point m_last{};
+      clock::time_point m_overloadedSince{};
+      clock::time_point m_relaxedSince{};
+      bool m_sampled{};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,325 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_PIPELINE_PIPELINE
+#define DABCOMMON_PIPELINE_PIPELINE
+
+#include "dab/pipeline/stage.h"
+#include "dab/system/numa.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief A graph of stages connected by queues
+   *
+   * A pipeline owns its stages and the threads executing them. Stages are connected implicitly by sharing queues: the
+   * output queue of one stage is the input queue of the next. Dedicated stages get their own, optionally pinned, thread.
+   * Pooled stages share a number of pool threads that round-robin over them. If a stage fails, the whole pipeline is
+   * stopped and the failure is reported by pipeline::join.
+   *
+   * @code
+   * dab::sample_queue_t samples{};
+   * dab::symbol_queue_t symbols{};
+   * dab::pipeline receiver{};
+   *
+   * receiver.add<dab::source_stage<dab::sample_t>>("capture", samples, read_device).schedule(dab::stage_scheduling::dedicated, {0});
+   * receiver.add<dab::stage<dab::sample_t, std::vector<float>>>("demod", samples, symbols, demodulate, 2656);
+   * receiver.add<dab::sink_stage<std::vector<float>>>("decode", symbols, decode, 76);
+   * receiver.negotiate();
+   * receiver.start();
+   * @endcode
+   *
+   * @since 1.0.3
+   */
+  struct pipeline
+    {
+    pipeline() = default;
+
+    pipeline(pipeline const &) = delete;
+    pipeline & operator=(pipeline const &) = delete;
+
+    ~pipeline()
+      {
+      stop();
+      join_threads();
+      }
+
+    /**
+     * @brief Add a new stage to the pipeline
+     *
+     * @return A reference to the newly created stage
+     *
+     * @since 1.0.3
+     */
+    template<typename StageType, typename ...ArgumentTypes>
+    StageType & add(ArgumentTypes && ...arguments)
+      {
+      auto added = new StageType(std::forward<ArgumentTypes>(arguments)...);
+      m_stages.emplace_back(added);
+      return *added;
+      }
+
+    /**
+     * @brief Match the output batch size of each stage to the input batch size of its successor
+     *
+     * @throws std::length_error if the input batch of a stage exceeds the capacity of its pinned input queue
+     *
+     * @since 1.0.3
+     */
+    void negotiate()
+      {
+      for(auto & stage : m_stages)
+        {
+        auto const capacity = stage->input_capacity();
+
+        if(capacity && stage->input_batch() > capacity)
+          {
+          throw std::length_error{"batch of stage '" + stage->name() + "' exceeds the capacity of its pinned input queue"};
+          }
+        }
+
+      for(auto & producer : m_stages)
+        {
+        for(auto & consumer : m_stages)
+          {
+          if(producer->output_queue() && producer->output_queue() == consumer->input_queue())
+            {
+            producer->set_output_batch(consumer->input_batch());
+            }
+          }
+        }
+      }
+
+    /**
+     * @brief Start executing the stages of the pipeline
+     *
+     * @param poolThreads The number of threads shared by the pooled stages. If 0, one thread is used when there are
+     * pooled stages.
+     *
+     * @since 1.0.3
+     */
+    void start(std::size_t poolThreads = 0)
+      {
+      auto pooled = std::vector<stage_base *>{};
+
+      for(auto & stage : m_stages)
+        {
+        if(stage->scheduling() == stage_scheduling::dedicated)
+          {
+          auto const current = stage.get();
+          m_threads.emplace_back([this, current]{
+            if(!current->cpus().empty())
+              {
+              pin_current_thread(current->cpus());
+              }
+
+            while(current->step(true) != stage_state::finished);
+
+            if(current->error())
+              {
+              stop();
+              }
+          });
+          }
+        else
+          {
+          pooled.push_back(stage.get());
+          }
+        }
+
+      if(pooled.empty())
+        {
+        return;
+        }
+
+      poolThreads = poolThreads ? poolThreads : 1;
+      m_pooled = std::make_shared<pool_state>(std::move(pooled));
+
+      for(std::size_t thread{}; thread < poolThreads; ++thread)
+        {
+        auto const state = m_pooled;
+        m_threads.emplace_back([this, state]{ state->run(*this); });
+        }
+      }
+
+    /**
+     * @brief Ask all stages to stop
+     *
+     * Sources stop producing and close their outputs, which causes the remaining stages to drain their inputs and
+     * terminate in turn.
+     *
+     * @since 1.0.3
+     */
+    void stop()
+      {
+      for(auto & stage : m_stages)
+        {
+        stage->request_stop();
+        }
+      }
+
+    /**
+     * @brief Wait for all stages to finish
+     *
+     * @throws The exception of the first failed stage, if any
+     *
+     * @since 1.0.3
+     */
+    void join()
+      {
+      join_threads();
+
+      for(auto & stage : m_stages)
+        {
+        if(stage->error())
+          {
+          std::rethrow_exception(stage->error());
+          }
+        }
+      }
+
+    /**
+     * @brief Get the runtime statistics of all stages
+     *
+     * @since 1.0.3
+     */
+    std::vector<std::pair<std::string, stage_statistics>> statistics() const
+      {
+      auto result = std::vector<std::pair<std::string, stage_statistics>>{};
+
+      for(auto & stage : m_stages)
+        {
+        result.emplace_back(stage->name(), stage->statistics());
+        }
+
+      return result;
+      }
+
+    private:
+      /**
+       * @internal
+       * @brief Wait for all threads of the pipeline to terminate
+       */
+      void join_threads()
+        {
+        for(auto & thread : m_threads)
+          {
+          if(thread.joinable())
+            {
+            thread.join();
+            }
+          }
+
+        m_threads.clear();
+        }
+
+      /**
+       * @internal
+       * @brief The pooled stages and the per-stage ownership flags preventing concurrent execution
+       */
+      struct pool_state
+        {
+        explicit pool_state(std::vector<stage_base *> stages)
+          : stages{std::move(stages)}
+          , running(this->stages.size())
+          {
+
+          }
+
+        void run(pipeline & owner)
+          {
+          auto const kIdleBackoff = std::chrono::microseconds{100};
+
+          while(true)
+            {
+            auto active = false;
+            auto worked = false;
+
+            for(std::size_t index{}; index < stages.size(); ++index)
+              {
+              if(stages[index]->finished())
+                {
+                continue;
+                }
+
+              active = true;
+
+              if(running[index].exchange(true))
+                {
+                continue;
+                }
+
+              auto const state = stages[index]->step(false);
+              worked |= state == stage_state::worked;
+              running[index] = false;
+
+              if(state == stage_state::finished && stages[index]->error())
+                {
+                owner.stop();
+                }
+              }
+
+            if(!active)
+              {
+              return;
+              }
+
+            if(!worked)
+              {
+              std::this_thread::sleep_for(kIdleBackoff);
+              }
+            }
+          }
+
+        std::vector<stage_base *> const stages;
+        std::vector<std::atomic_bool> running;
+        };
+
+      std::vector<std::unique_ptr<stage_base>> m_stages{};
+      std::vector<std::thread> m_threads{};
+      std::shared_ptr<pool_state> m_pooled{};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,746 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_PIPELINE_STAGE
+#define DABCOMMON_PIPELINE_STAGE
+
+#include "dab/system/perf_counters.h"
+#include "dab/system/timeline.h"
+#include "dab/system/tracing.h"
+#include "dab/types/queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief The result of executing a single step of a pipeline stage
+   *
+   * @since 1.0.3
+   */
+  enum struct stage_state : std::uint8_t
+    {
+    worked, ///< The stage processed a batch
+    idle, ///< The stage had nothing to do
+    finished, ///< The stage has drained its input and closed its output
+    };
+
+  /**
+   * @brief The scheduling strategy of a pipeline stage
+   *
+   * @since 1.0.3
+   */
+  enum struct stage_scheduling : std::uint8_t
+    {
+    dedicated, ///< The stage runs on its own thread, blocking on its input queue
+    pooled, ///< The stage shares the threads of the pipeline's pool with other pooled stages
+    };
+
+  /**
+   * @brief A snapshot of the runtime statistics of a pipeline stage
+   *
+   * @since 1.0.3
+   */
+  struct stage_statistics
+    {
+    std::chrono::nanoseconds busy; ///< The time spent in the stage's processing function
+    std::chrono::nanoseconds idle; ///< The time the stage was running, but not processing
+    std::uint64_t batches; ///< The number of batches processed
+    std::uint64_t items; ///< The number of input items processed
+    };
+
+  /**
+   * @brief The type-erased base of all pipeline stages
+   *
+   * A stage consumes batches of elements from its input queue, processes them and forwards the results to its output
+   * queue. Once the input queue is closed and drained, the stage flushes its pending results and closes its output
+   * queue, thus propagating the end of the stream downstream.
+   *
+   * Pooled stages never block. Results that a full pinned output queue cannot take yet are kept by the stage, which
+   * forwards them before processing further input.
+   *
+   * If processing throws, the stage finishes, keeps the exception (see stage_base::error) and closes its queues, so
+   * that neither its predecessor nor its successor remain blocked on it.
+   *
+   * @since 1.0.3
+   */
+  struct stage_base
+    {
+    stage_base(std::string name, std::size_t const batch)
+      : m_name{std::move(name)}
+      , m_inputBatch{batch ? batch : 1}
+      {
+
+      }
+
+    stage_base(stage_base const &) = delete;
+    stage_base & operator=(stage_base const &) = delete;
+
+    virtual ~stage_base() = default;
+
+    /**
+     * @brief Get the name of the stage
+     *
+     * @since 1.0.3
+     */
+    std::string const & name() const
+      {
+      return m_name;
+      }
+
+    /**
+     * @brief Get the number of elements the stage consumes per batch
+     *
+     * @since 1.0.3
+     */
+    std::size_t input_batch() const
+      {
+      return m_inputBatch;
+      }
+
+    /**
+     * @brief Get the number of results the stage accumulates before forwarding them
+     *
+     * @since 1.0.3
+     */
+    std::size_t output_batch() const
+      {
+      return m_outputBatch;
+      }
+
+    /**
+     * @brief Set the number of results the stage accumulates before forwarding them
+     *
+     * Matching the output batch of a stage to the input batch of its successor avoids waking the successor for partial
+     * batches. See dab::pipeline::negotiate.
+     *
+     * @since 1.0.3
+     */
+    void set_output_batch(std::size_t const batch)
+      {
+      m_outputBatch = batch ? batch : 1;
+      }
+
+    /**
+     * @brief Get the scheduling strategy of the stage
+     *
+     * @since 1.0.3
+     */
+    stage_scheduling scheduling() const
+      {
+      return m_scheduling;
+      }
+
+    /**
+     * @brief Select the scheduling strategy of the stage
+     *
+     * @param scheduling The scheduling strategy
+     * @param cpus The CPUs a dedicated stage thread shall be restricted to. If empty, the thread is not pinned.
+     *
+     * @since 1.0.3
+     */
+    stage_base & schedule(stage_scheduling const scheduling, std::vector<unsigned> cpus = {})
+      {
+      m_scheduling = scheduling;
+      m_cpus = std::move(cpus);
+      return *this;
+      }
+
+    /**
+     * @brief Get the CPUs a dedicated stage thread is pinned to
+     *
+     * @since 1.0.3
+     */
+    std::vector<unsigned> const & cpus() const
+      {
+      return m_cpus;
+      }
+
+    /**
+     * @brief Get an identifier of the input queue of the stage, or @p nullptr for source stages
+     *
+     * @since 1.0.3
+     */
+    virtual void const * input_queue() const
+      {
+      return nullptr;
+      }
+
+    /**
+     * @brief Get an identifier of the output queue of the stage, or @p nullptr for sink stages
+     *
+     * @since 1.0.3
+     */
+    virtual void const * output_queue() const
+      {
+      return nullptr;
+      }
+
+    /**
+     * @brief Get the number of elements the input queue of the stage can hold at once, or 0 if it grows on demand
+     *
+     * @since 1.0.3
+     */
+    virtual std::size_t input_capacity() const
+      {
+      return 0;
+      }
+
+    /**
+     * @brief Ask the stage to stop
+     *
+     * Source stages stop producing and close their output. All other stages keep running until their input is closed,
+     * so that in-flight data is flushed through the pipeline.
+     *
+     * @since 1.0.3
+     */
+    void request_stop()
+      {
+      m_stopRequested = true;
+      }
+
+    /**
+     * @brief Check whether the stage has finished
+     *
+     * @since 1.0.3
+     */
+    bool finished() const
+      {
+      return m_finished;
+      }
+
+    /**
+     * @brief Get the exception that terminated the stage, or @p nullptr if the stage did not fail
+     *
+     * @note The result is only meaningful once the stage has finished.
+     *
+     * @since 1.0.3
+     */
+    std::exception_ptr error() const
+      {
+      return m_error;
+      }
+
+    /**
+     * @brief Record every step in which the stage did not idle as a span on a timeline
+     *
+     * @note The timeline must outlive the stage and should be set before the pipeline is started.
+     *
+     * @since 1.0.3
+     */
+    void trace(timeline & target)
+      {
+      m_timeline = &target;
+      }
+
+    /**
+     * @brief Enable or disable sampling the hardware performance counters for every step in which the stage did not idle
+     *
+     * @note Reading the counters costs a few system calls per step.
+     *
+     * @since 1.0.3
+     */
+    void measure(bool const enabled)
+      {
+      m_measuring.store(enabled, std::memory_order_relaxed);
+      }
+
+    /**
+     * @brief Get the hardware performance counters accumulated over the measured steps of the stage
+     *
+     * @since 1.0.3
+     */
+    perf_statistics performance() const
+      {
+      return m_performance.statistics();
+      }
+
+    /**
+     * @brief Execute a single step of the stage
+     *
+     * @param blocking Whether the stage may block waiting for input
+     *
+     * @return stage_state::finished if the stage has finished or failed. Exceptions thrown while processing are not
+     * propagated, but stored in the stage.
+     *
+     * @since 1.0.3
+     */
+    stage_state step(bool const blocking)
+      {
+      if(m_finished)
+        {
+        return stage_state::finished;
+        }
+
+      auto expected = clock::rep{};
+      m_started.compare_exchange_strong(expected, clock::now().time_since_epoch().count());
+
+      DABCOMMON_PROBE1(stage_step_start, this);
+      auto const measuring = m_measuring.load(std::memory_order_relaxed);
+      auto const counters = measuring ? thread_perf_counters().read() : perf_sample{};
+      auto const begin = m_timeline ? timeline::now() : 0;
+      auto state = stage_state::finished;
+
+      try
+        {
+        state = do_step(blocking);
+        }
+      catch(...)
+        {
+        m_error = std::current_exception();
+        close_queues();
+        }
+
+      DABCOMMON_PROBE2(stage_step_end, this, static_cast<int>(state));
+
+      if(m_timeline && state != stage_state::idle)
+        {
+        m_timeline->record(m_name.c_str(), begin, timeline::now());
+        }
+
+      if(measuring && state != stage_state::idle)
+        {
+        m_performance.add(thread_perf_counters().read() - counters);
+        }
+
+      if(state == stage_state::finished)
+        {
+        m_stopped = clock::now().time_since_epoch().count();
+        m_finished = true;
+        }
+
+      return state;
+      }
+
+    /**
+     * @brief Get a snapshot of the runtime statistics of the stage
+     *
+     * The idle time is the time since the stage first ran, minus the time spent processing. For dedicated stages, this
+     * is the time spent waiting on the input and output queues.
+     *
+     * @since 1.0.3
+     */
+    stage_statistics statistics() const
+      {
+      auto const started = m_started.load();
+      auto const stopped = m_finished ? m_stopped.load() : clock::now().time_since_epoch().count();
+      auto const busy = std::chrono::nanoseconds{m_busy.load()};
+      auto const running = started ? std::chrono::duration_cast<std::chrono::nanoseconds>(clock::duration{stopped - started})
+                                   : std::chrono::nanoseconds{};
+
+      return {busy, running > busy ? running - busy : std::chrono::nanoseconds{}, m_batches.load(), m_items.load()};
+      }
+
+    protected:
+      using clock = std::chrono::steady_clock;
+
+      /**
+       * @internal
+       * @brief Execute a single step of the concrete stage
+       */
+      virtual stage_state do_step(bool blocking) = 0;
+
+      /**
+       * @internal
+       * @brief Close the queues of a failed stage, releasing its blocked neighbours
+       */
+      virtual void close_queues() = 0;
+
+      /**
+       * @internal
+       * @brief Invoke the processing function of the stage and account for the time spent
+       */
+      template<typename FunctionType>
+      auto timed(std::size_t const items, FunctionType && function) -> decltype(function())
+        {
+        auto const start = clock::now();
+        auto guard = accounting{*this, start, items};
+        return function();
+        }
+
+      bool stop_requested() const
+        {
+        return m_stopRequested;
+        }
+
+    private:
+      /**
+       * @internal
+       * @brief Records the busy time of a processing invocation, even if it returns a value
+       */
+      struct accounting
+        {
+        ~accounting()
+          {
+          m_stage.m_busy += std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - m_start).count();
+          ++m_stage.m_batches;
+          m_stage.m_items += m_items;
+          }
+
+        stage_base & m_stage;
+        clock::time_point m_start;
+        std::size_t m_items;
+        };
+
+      std::string const m_name;
+      std::size_t const m_inputBatch;
+      std::size_t m_outputBatch{1};
+      stage_scheduling m_scheduling{stage_scheduling::dedicated};
+      std::vector<unsigned> m_cpus{};
+      std::atomic_bool m_stopRequested{};
+      std::atomic_bool m_finished{};
+      std::atomic<clock::rep> m_started{};
+      std::atomic<clock::rep> m_stopped{};
+      std::atomic<std::int64_t> m_busy{};
+      std::atomic<std::uint64_t> m_batches{};
+      std::atomic<std::uint64_t> m_items{};
+      timeline * m_timeline{};
+      std::atomic_bool m_measuring{};
+      perf_accumulator m_performance{};
+      std::exception_ptr m_error{};
+    };
+
+  namespace internal
+    {
+
+    /**
+     * @internal
+     * @brief Forwards the pending results of a stage to its output queue
+     *
+     * Results exceeding the capacity of a pinned output queue are forwarded in chunks the queue can hold. Unless
+     * @p blocking is set, only as many results as a pinned queue has room for are forwarded, and the rest is kept in
+     * @p pending.
+     *
+     * @return @p true if no results are left that should have been forwarded, @p false otherwise
+     *
+     * @since 1.0.3
+     */
+    template<typename OutputType>
+    bool forward(queue<OutputType> & output, std::vector<OutputType> & pending, std::size_t const batch, bool const flush,
+                 bool const blocking)
+      {
+      if(pending.empty() || (!flush && pending.size() < batch))
+        {
+        return true;
+        }
+
+      auto const bounded = output.pinned() && !output.closed();
+      auto const chunk = bounded ? output.capacity() : pending.size();
+      auto const room = bounded && !blocking ? output.free_space() : pending.size();
+
+      if(pending.size() <= std::min(chunk, room))
+        {
+        output.enqueue(std::move(pending));
+        pending.clear();
+        return true;
+        }
+
+      auto first = pending.begin();
+      auto left = room;
+
+      while(first != pending.end() && left)
+        {
+        auto const count = std::min(std::min(chunk, left), static_cast<std::size_t>(pending.end() - first));
+        auto const last = first + static_cast<std::ptrdiff_t>(count);
+        output.enqueue(std::vector<OutputType>{std::make_move_iterator(first), std::make_move_iterator(last)});
+        left -= count;
+        first = last;
+        }
+
+      pending.erase(pending.begin(), first);
+      return pending.empty();
+      }
+
+    /**
+     * @internal
+     * @brief Receives the next batch of input elements of a stage
+     *
+     * @return @p true if a batch is available in @p batch, @p false otherwise. If the input is closed and drained,
+     * @p drained is set and the remaining elements, if any, are stored in @p batch.
+     *
+     * @since 1.0.3
+     */
+    template<typename InputType>
+    bool receive(queue<InputType> & input, std::vector<InputType> & batch, std::size_t const size, bool const blocking,
+                 bool & drained)
+      {
+      batch.resize(size);
+
+      if(blocking ? input.dequeue(batch) : input.try_dequeue(batch))
+        {
+        return true;
+        }
+
+      if(!input.closed())
+        {
+        batch.clear();
+        return false;
+        }
+
+      batch.clear();
+      auto element = InputType{};
+      while(input.try_dequeue(element))
+        {
+        batch.push_back(std::move(element));
+        }
+
+      drained = true;
+      return !batch.empty();
+      }
+
+    }
+
+  /**
+   * @brief A pipeline stage producing elements into a queue
+   *
+   * The production function is called repeatedly with the vector of pending results. It shall return @p false once
+   * the end of the stream has been reached.
+   *
+   * @note Sources that block on I/O should be scheduled on a dedicated thread.
+   *
+   * @since 1.0.3
+   */
+  template<typename OutputType>
+  struct source_stage : stage_base
+    {
+    using output_queue_type = internal::queue<OutputType>;
+    using function_type = std::function<bool(std::vector<OutputType> &)>;
+
+    source_stage(std::string name, output_queue_type & output, function_type function)
+      : stage_base{std::move(name), 1}
+      , m_output{output}
+      , m_function{std::move(function)}
+      {
+
+      }
+
+    void const * output_queue() const override
+      {
+      return &m_output;
+      }
+
+    private:
+      stage_state do_step(bool const blocking) override
+        {
+        if(m_backlogged)
+          {
+          m_backlogged = !internal::forward(m_output, m_pending, output_batch(), m_exhausted, blocking);
+          }
+        else if(!m_exhausted)
+          {
+          m_exhausted = stop_requested() || !timed(1, [&]{ return m_function(m_pending); });
+          m_backlogged = !internal::forward(m_output, m_pending, output_batch(), m_exhausted, blocking);
+          }
+        else
+          {
+          return stage_state::idle;
+          }
+
+        if(m_backlogged)
+          {
+          return stage_state::idle;
+          }
+
+        if(m_exhausted)
+          {
+          m_output.close();
+          return stage_state::finished;
+          }
+
+        return stage_state::worked;
+        }
+
+      void close_queues() override
+        {
+        m_output.close();
+        }
+
+      output_queue_type & m_output;
+      function_type m_function;
+      std::vector<OutputType> m_pending{};
+      bool m_backlogged{};
+      bool m_exhausted{};
+    };
+
+  /**
+   * @brief A pipeline stage transforming batches of input elements into output elements
+   *
+   * The transformation function receives the current input batch and appends its results to the vector of pending
+   * results. The last batch of a stream may be shorter than the configured batch size.
+   *
+   * @since 1.0.3
+   */
+  template<typename InputType, typename OutputType>
+  struct stage : stage_base
+    {
+    using input_queue_type = internal::queue<InputType>;
+    using output_queue_type = internal::queue<OutputType>;
+    using function_type = std::function<void(std::vector<InputType> &, std::vector<OutputType> &)>;
+
+    stage(std::string name, input_queue_type & input, output_queue_type & output, function_type function,
+          std::size_t const batch = 1)
+      : stage_base{std::move(name), batch}
+      , m_input{input}
+      , m_output{output}
+      , m_function{std::move(function)}
+      {
+
+      }
+
+    void const * input_queue() const override
+      {
+      return &m_input;
+      }
+
+    void const * output_queue() const override
+      {
+      return &m_output;
+      }
+
+    std::size_t input_capacity() const override
+      {
+      return m_input.pinned() ? m_input.capacity() : 0;
+      }
+
+    private:
+      stage_state do_step(bool const blocking) override
+        {
+        m_batch.clear();
+
+        if(m_backlogged)
+          {
+          m_backlogged = !internal::forward(m_output, m_pending, output_batch(), m_drained, blocking);
+          }
+        else if(!m_drained)
+          {
+          if(internal::receive(m_input, m_batch, input_batch(), blocking, m_drained))
+            {
+            timed(m_batch.size(), [&]{ m_function(m_batch, m_pending); });
+            }
+
+          m_backlogged = !internal::forward(m_output, m_pending, output_batch(), m_drained, blocking);
+          }
+
+        if(m_drained && !m_backlogged)
+          {
+          m_output.close();
+          return stage_state::finished;
+          }
+
+        return m_batch.empty() ? stage_state::idle : stage_state::worked;
+        }
+
+      void close_queues() override
+        {
+        m_input.close();
+        m_output.close();
+        }
+
+      input_queue_type & m_input;
+      output_queue_type & m_output;
+      function_type m_function;
+      std::vector<InputType> m_batch{};
+      std::vector<OutputType> m_pending{};
+      bool m_backlogged{};
+      bool m_drained{};
+    };
+
+  /**
+   * @brief A pipeline stage consuming batches of elements from a queue
+   *
+   * @since 1.0.3
+   */
+  template<typename InputType>
+  struct sink_stage : stage_base
+    {
+    using input_queue_type = internal::queue<InputType>;
+    using function_type = std::function<void(std::vector<InputType> &)>;
+
+    sink_stage(std::string name, input_queue_type & input, function_type function, std::size_t const batch = 1)
+      : stage_base{std::move(name), batch}
+      , m_input{input}
+      , m_function{std::move(function)}
+      {
+
+      }
+
+    void const * input_queue() const override
+      {
+      return &m_input;
+      }
+
+    std::size_t input_capacity() const override
+      {
+      return m_input.pinned() ? m_input.capacity() : 0;
+      }
+
+    private:
+      stage_state do_step(bool const blocking) override
+        {
+        auto drained = false;
+
+        if(internal::receive(m_input, m_batch, input_batch(), blocking, drained))
+          {
+          timed(m_batch.size(), [&]{ m_function(m_batch); });
+          }
+
+        if(drained)
+          {
+          return stage_state::finished;
+          }
+
+        return m_batch.empty() ? stage_state::idle : stage_state::worked;
+        }
+
+      void close_queues() override
+        {
+        m_input.close();
+        }
+
+      input_queue_type & m_input;
+      function_type m_function;
+      std::vector<InputType> m_batch{};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,553 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_PIPELINE_TASK_POOL
+#define DABCOMMON_PIPELINE_TASK_POOL
+
+#include "dab/system/numa.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief A work-stealing thread pool
+   *
+   * Each worker owns a task deque. Tasks submitted from within a worker are pushed to the worker's own deque and
+   * executed in LIFO order, which keeps the data of continuations hot in the worker's cache. Idle workers steal the
+   * oldest tasks from the other workers. This balances uneven jobs, like the decoding of sub-channels with very
+   * different bitrates, without partitioning them statically.
+   *
+   * @since 1.0.3
+   */
+  struct task_pool
+    {
+    using task = std::function<void()>;
+
+    /**
+     * @brief Construct a pool and start its workers
+     *
+     * @param threads The number of workers. If 0, one worker per hardware thread is started.
+     * @param cpus The CPUs the workers are restricted to. If empty, the workers are not pinned.
+     *
+     * @since 1.0.3
+     */
+    explicit task_pool(std::size_t threads = 0, std::vector<unsigned> cpus = {})
+      {
+      threads = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+
+      for(std::size_t index{}; index < threads; ++index)
+        {
+        m_queues.emplace_back(new worker_queue{});
+        }
+
+      for(std::size_t index{}; index < threads; ++index)
+        {
+        m_threads.emplace_back([this, index, cpus]{
+          if(!cpus.empty())
+            {
+            pin_current_thread(cpus);
+            }
+
+          work(index);
+        });
+        }
+      }
+
+    task_pool(task_pool const &) = delete;
+    task_pool & operator=(task_pool const &) = delete;
+
+    /**
+     * @brief Execute all remaining tasks and stop the workers
+     *
+     * @since 1.0.3
+     */
+    ~task_pool()
+      {
+        {
+        auto lock = std::unique_lock<std::mutex>{m_sleepMutex};
+        m_stopping = true;
+        }
+
+      m_wakeUp.notify_all();
+
+      for(auto & thread : m_threads)
+        {
+        thread.join();
+        }
+      }
+
+    /**
+     * @brief Get the number of workers of the pool
+     *
+     * @since 1.0.3
+     */
+    std::size_t size() const
+      {
+      return m_threads.size();
+      }
+
+    /**
+     * @brief Submit a task for execution
+     *
+     * @note Tasks must not throw, since they run on the workers of the pool. Jobs of a dab::task_group may throw, the
+     * group reports their exceptions from dab::task_group::wait.
+     *
+     * @since 1.0.3
+     */
+    void submit(task job)
+      {
+        {
+        auto lock = std::unique_lock<std::mutex>{m_sleepMutex};
+        ++m_pending;
+        }
+
+      auto const local = current_worker();
+      auto const index = local.first == this ? local.second : m_next++ % m_queues.size();
+
+        {
+        auto & target = *m_queues[index];
+        auto lock = std::unique_lock<std::mutex>{target.mutex};
+        target.tasks.push_back(std::move(job));
+        }
+
+      m_wakeUp.notify_one();
+      }
+
+    /**
+     * @brief Execute a single pending task on the calling thread
+     *
+     * This is used by threads waiting for a set of tasks to complete, so that they contribute to the work instead of
+     * blocking a worker.
+     *
+     * @return @p true if a task was executed, @p false if there was no pending task.
+     *
+     * @since 1.0.3
+     */
+    bool run_pending_task()
+      {
+      auto const local = current_worker();
+      auto job = task{};
+
+      if(!find_task(local.first == this ? local.second : 0, job))
+        {
+        return false;
+        }
+
+      job();
+      return true;
+      }
+
+    private:
+      /**
+       * @internal
+       * @brief The task deque of a single worker
+       */
+      struct worker_queue
+        {
+        std::mutex mutex;
+        std::deque<task> tasks;
+        };
+
+      /**
+       * @internal
+       * @brief The pool and index of the worker running on the calling thread
+       */
+      static std::pair<task_pool const *, std::size_t> & current_worker()
+        {
+        static thread_local std::pair<task_pool const *, std::size_t> identity{nullptr, 0};
+        return identity;
+        }
+
+      /**
+       * @internal
+       * @brief Take a task from the own deque, or steal one from another worker
+       */
+      bool find_task(std::size_t const self, task & job)
+        {
+          {
+          auto & own = *m_queues[self];
+          auto lock = std::unique_lock<std::mutex>{own.mutex};
+          if(!own.tasks.empty())
+            {
+            job = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            --m_pending;
+            return true;
+            }
+          }
+
+        for(std::size_t offset{1}; offset < m_queues.size(); ++offset)
+          {
+          auto & victim = *m_queues[(self + offset) % m_queues.size()];
+          auto lock = std::unique_lock<std::mutex>{victim.mutex};
+          if(!victim.tasks.empty())
+            {
+            job = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --m_pending;
+            return true;
+            }
+          }
+
+        return false;
+        }
+
+      /**
+       * @internal
+       * @brief The main loop of a worker
+       */
+      void work(std::size_t const self)
+        {
+        current_worker() = {this, self};
+        auto job = task{};
+
+        while(true)
+          {
+          if(find_task(self, job))
+            {
+            job();
+            job = nullptr;
+            continue;
+            }
+
+          auto lock = std::unique_lock<std::mutex>{m_sleepMutex};
+          m_wakeUp.wait(lock, [&]{ return m_pending > 0 || m_stopping; });
+
+          if(m_stopping && !m_pending)
+            {
+            return;
+            }
+          }
+        }
+
+      std::vector<std::unique_ptr<worker_queue>> m_queues{};
+      std::vector<std::thread> m_threads{};
+      std::atomic_size_t m_pending{};
+      std::atomic_size_t m_next{};
+      std::mutex m_sleepMutex{};
+      std::condition_variable m_wakeUp{};
+      bool m_stopping{};
+    };
+
+  /**
+   * @brief A set of related jobs with an optional continuation and deadline
+   *
+   * A task group is typically used to decode a single CIF: each selected sub-channel becomes a job, and a continuation
+   * forwards the results once all jobs have finished. Jobs submitted using run_before_deadline() are skipped if they
+   * would start after the deadline of the group, so that a CIF that is already late does not delay the next one.
+   *
+   * If a job throws, the continuation is skipped and the first exception is rethrown by wait().
+   *
+   * @code
+   * dab::task_group cif{pool, std::chrono::steady_clock::now() + dab::cif_duration(dab::kTransmissionMode1)};
+   *
+   * for(auto & subchannel : selected)
+   *   {
+   *   cif.run([&]{ decode(subchannel); });
+   *   }
+   *
+   * cif.then([&]{ publish(selected); });
+   * cif.wait();
+   * @endcode
+   *
+   * @since 1.0.3
+   */
+  struct task_group
+    {
+    using clock = std::chrono::steady_clock;
+    using task = task_pool::task;
+
+    /**
+     * @brief Construct a task group executing its jobs on the given pool
+     *
+     * @since 1.0.3
+     */
+    explicit task_group(task_pool & pool, clock::time_point const deadline = clock::time_point::max())
+      : m_pool{pool}
+      , m_state{std::make_shared<state>(pool, deadline)}
+      {
+
+      }
+
+    task_group(task_group const &) = delete;
+    task_group & operator=(task_group const &) = delete;
+
+    /**
+     * @brief Wait for all jobs and the continuation to finish
+     *
+     * @since 1.0.3
+     */
+    ~task_group()
+      {
+      drain();
+      }
+
+    /**
+     * @brief Submit a job to the group
+     *
+     * @since 1.0.3
+     */
+    void run(task job)
+      {
+      state::submit(m_state, std::move(job), false);
+      }
+
+    /**
+     * @brief Submit a job that is skipped if it would start after the deadline of the group
+     *
+     * @since 1.0.3
+     */
+    void run_before_deadline(task job)
+      {
+      state::submit(m_state, std::move(job), true);
+      }
+
+    /**
+     * @brief Set the continuation of the group
+     *
+     * The continuation is executed on the pool once all jobs submitted so far have finished. If all jobs have already
+     * finished, the continuation is submitted immediately.
+     *
+     * @since 1.0.3
+     */
+    void then(task continuation)
+      {
+      state::set_continuation(m_state, std::move(continuation));
+      }
+
+    /**
+     * @brief Wait for all jobs and the continuation to finish
+     *
+     * The calling thread executes pending tasks of the pool while waiting.
+     *
+     * @throws The first exception thrown by a job or the continuation since the last call to wait()
+     *
+     * @since 1.0.3
+     */
+    void wait()
+      {
+      drain();
+
+      auto error = std::exception_ptr{};
+
+        {
+        auto lock = std::unique_lock<std::mutex>{m_state->mutex};
+        std::swap(error, m_state->error);
+        }
+
+      if(error)
+        {
+        std::rethrow_exception(error);
+        }
+      }
+
+    /**
+     * @brief Get the deadline of the group
+     *
+     * @since 1.0.3
+     */
+    clock::time_point deadline() const
+      {
+      return m_state->deadline;
+      }
+
+    /**
+     * @brief Get the time remaining until the deadline of the group
+     *
+     * @return The remaining time, which is negative if the deadline has passed.
+     *
+     * @since 1.0.3
+     */
+    clock::duration slack() const
+      {
+      return m_state->deadline - clock::now();
+      }
+
+    /**
+     * @brief Check whether the group finished its work after its deadline
+     *
+     * @note This function only returns a meaningful result after wait() returned.
+     *
+     * @since 1.0.3
+     */
+    bool deadline_missed() const
+      {
+      return m_state->missed || m_state->dropped;
+      }
+
+    /**
+     * @brief Get the number of jobs that were skipped because the deadline had passed
+     *
+     * @since 1.0.3
+     */
+    std::size_t dropped() const
+      {
+      return m_state->dropped;
+      }
+
+    private:
+      /**
+       * @internal
+       * @brief Wait for all jobs and the continuation to finish, without reporting their exceptions
+       */
+      void drain()
+        {
+        while(m_state->outstanding)
+          {
+          if(!m_pool.run_pending_task())
+            {
+            auto lock = std::unique_lock<std::mutex>{m_state->mutex};
+            m_state->done.wait_for(lock, std::chrono::microseconds{100}, [&]{ return !m_state->outstanding; });
+            }
+          }
+        }
+
+      /**
+       * @internal
+       * @brief The state shared between the group and its in-flight jobs
+       */
+      struct state
+        {
+        state(task_pool & pool, clock::time_point const deadline)
+          : pool{pool}
+          , deadline{deadline}
+          {
+
+          }
+
+        static void submit(std::shared_ptr<state> const & self, task job, bool const droppable)
+          {
+          ++self->outstanding;
+          enqueue(self, std::move(job), droppable);
+          }
+
+        /**
+         * @internal
+         * @brief Submit a job that has already been counted as outstanding to the pool
+         */
+        static void enqueue(std::shared_ptr<state> const & self, task job, bool const droppable)
+          {
+          self->pool.submit([self, job, droppable]{
+            if(droppable && clock::now() > self->deadline)
+              {
+              ++self->dropped;
+              }
+            else
+              {
+              try
+                {
+                job();
+                }
+              catch(...)
+                {
+                auto lock = std::unique_lock<std::mutex>{self->mutex};
+                if(!self->error)
+                  {
+                  self->error = std::current_exception();
+                  }
+                }
+              }
+
+            complete(self);
+          });
+          }
+
+        static void set_continuation(std::shared_ptr<state> const & self, task continuation)
+          {
+          auto lock = std::unique_lock<std::mutex>{self->mutex};
+
+          if(self->outstanding)
+            {
+            self->continuation = std::move(continuation);
+            return;
+            }
+
+          lock.unlock();
+          submit(self, std::move(continuation), false);
+          }
+
+        static void complete(std::shared_ptr<state> const & self)
+          {
+          auto lock = std::unique_lock<std::mutex>{self->mutex};
+
+          if(self->outstanding > 1)
+            {
+            --self->outstanding;
+            return;
+            }
+
+          auto continuation = std::move(self->continuation);
+          self->continuation = nullptr;
+
+          if(continuation && !self->error)
+            {
+            lock.unlock();
+            enqueue(self, std::move(continuation), false);
+            return;
+            }
+
+          self->missed = clock::now() > self->deadline;
+          --self->outstanding;
+          self->done.notify_all();
+          }
+
+        task_pool & pool;
+        clock::time_point const deadline;
+        std::atomic_size_t outstanding{};
+        std::atomic_size_t dropped{};
+        std::atomic_bool missed{};
+        task continuation{};
+        std::exception_ptr error{};
+        std::mutex mutex{};
+        std::condition_variable done{};
+        };
+
+      task_pool & m_pool;
+      std::shared_ptr<state> m_state;
+    };
+
+  }
+
+#endif
@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_SCAN_BAND_SCANNER
+#define DABCOMMON_SCAN_BAND_SCANNER
+
+#include "dab/constants/band_iii.h"
+#include "dab/constants/transmission_modes.h"
+#include "dab/ofdm/signal_detector.h"
+#include "dab/types/common_types.h"
+#include "dab/types/transmission_mode.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief The result of scanning a single frequency block
+   *
+   * @since 1.0.3
+   */
+  struct scan_result
+    {
+    band_iii_block block; ///< The scanned block
+    std::uint8_t mode; ///< The identifier of the detected transmission mode, or 0 if no signal was found
+    bool acquired; ///< Whether the FIC acquisition succeeded
+    std::size_t samples; ///< The number of samples read for signal detection
+    };
+
+  /**
+   * @brief A replayable recording of a number of frequency blocks
+   *
+   * The recording can be used in place of a tuner by dab::band_scanner. Reading wraps around at the end of the
+   * recording of the current block, so a short recording can be replayed indefinitely.
+   *
+   * @since 1.0.3
+   */
+  struct band_recording
+    {
+    /**
+     * @brief Add the samples recorded on a block
+     */
+    void add(std::string const & label, std::vector<sample_t> samples)
+      {
+      m_blocks[label] = std::move(samples);
+      }
+
+    /**
+     * @brief Select the block to replay
+     *
+     * @return @p false if the block is not part of the recording
+     */
+    bool tune(band_iii_block const & block)
+      {
+      auto const found = m_blocks.find(block.label);
+      m_current = found == m_blocks.end() || found->second.empty() ? nullptr : &found->second;
+      m_position = 0;
+      return m_current;
+      }
+
+    /**
+     * @brief Fill a block of samples from the current recording
+     *
+     * @return @p false if no block is selected
+     */
+    bool read(std::vector<sample_t> & samples)
+      {
+      if(!m_current)
+        {
+        return false;
+        }
+
+      for(std::size_t offset{}; offset < samples.size();)
+        {
+        auto const count = std::min(samples.size() - offset, m_current->size() - m_position);
+        std::copy(m_current->begin() + m_position, m_current->begin() + m_position + count, samples.begin() + offset);
+        offset += count;
+        m_position = (m_position + count) % m_current->size();
+        }
+
+      return true;
+      }
+
+    private:
+      std::map<std::string, std::vector<sample_t>> m_blocks{};
+      std::vector<sample_t> const * m_current{};
+      std::size_t m_position{};
+    };
+
+  /**
+   * @brief A scan engine rejecting empty frequency blocks before attempting FIC acquisition
+   *
+   * For every block, the scanner reads one detection window of samples and runs a dab::signal_detector on it. Blocks
+   * without any null symbol are rejected immediately. Blocks with unconfirmed candidates get a second window. FIC
+   * acquisition, which takes seconds, is only attempted on blocks where a signal was detected, using the detected
+   * transmission mode.
+   *
+   * The source of samples must provide @p bool tune(band_iii_block const &) and @p bool read(std::vector<sample_t> &),
+   * like a tuner wrapper or a dab::band_recording. The acquisition function is invoked as
+   * @p bool(band_iii_block const &, internal::types::transmission_mode const &).
+   *
+   * @since 1.0.3
+   */
+  struct band_scanner
+    {
+    /**
+     * @brief Construct a scanner
+     *
+     * @param windows The maximum number of detection windows read per block
+     * @param detector The detector used to find DAB signals
+     */
+    explicit band_scanner(std::size_t const windows = 2, signal_detector detector = signal_detector{})
+      : m_windows{windows ? windows : 1},
+        m_detector(std::move(detector)),
+        m_samples(signal_detector::window())
+      {
+      }
+
+    /**
+     * @brief Scan a single block
+     */
+    template<typename SourceType, typename AcquireFunction>
+    scan_result scan(SourceType & source, band_iii_block const & block, AcquireFunction && acquire)
+      {
+      auto result = scan_result{block, 0, false, 0};
+
+      if(!source.tune(block))
+        {
+        return result;
+        }
+
+      for(std::size_t window{}; window < m_windows; ++window)
+        {
+        if(!source.read(m_samples))
+          {
+          break;
+          }
+
+        result.samples += m_samples.size();
+
+        auto const detected = m_detector.analyze(m_samples);
+        if(detected.status == detection_status::signal)
+          {
+          result.mode = detected.mode;
+          result.acquired = acquire(block, mode(detected.mode));
+          break;
+          }
+
+        if(detected.status == detection_status::empty)
+          {
+          break;
+          }
+        }
+
+      return result;
+      }
+
+    /**
+     * @brief Scan a list of blocks, by default all of Band III
+     */
+    template<typename SourceType, typename AcquireFunction>
+    std::vector<scan_result> scan(SourceType & source,
+                                  AcquireFunction && acquire,
+                                  std::vector<band_iii_block> const & blocks = {kBandIIIBlocks.begin(), kBandIIIBlocks.end()})
+      {
+      auto results = std::vector<scan_result>{};
+
+      for(auto const & block : blocks)
+        {
+        results.push_back(scan(source, block, acquire));
+        }
+
+      return results;
+      }
+
+    private:
+      static internal::types::transmission_mode const & mode(std::uint8_t const id)
+        {
+        switch(id)
+          {
+          case 2:
+            return kTransmissionMode2;
+          case 3:
+            return kTransmissionMode3;
+          case 4:
+            return kTransmissionMode4;
+          default:
+            return kTransmissionMode1;
+          }
+        }
+
+      std::size_t const m_windows;
+      signal_detector m_detector;
+      std::vector<sample_t> m_samples;
+    };
+
+  }
+
+#endif
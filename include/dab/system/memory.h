@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_SYSTEM_MEMORY
+#define DABCOMMON_SYSTEM_MEMORY
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define DABCOMMON_HAS_MLOCK 1
+#endif
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#if defined(SYS_mbind)
+#define DABCOMMON_HAS_MBIND 1
+#endif
+#endif
+
+/**
+ * @file
+ *
+ * @brief This file contains helpers to keep memory used by real-time threads resident
+ *
+ * Page faults taken on freshly allocated memory can stall a receiving thread for milliseconds. The functions in this
+ * file make it possible to touch and lock memory ahead of time, so that no faults occur once streaming has started.
+ *
+ * @since 1.0.3
+ */
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    /**
+     * @internal
+     * @brief Get the size of a memory page
+     *
+     * @since 1.0.3
+     */
+    inline std::size_t page_size()
+      {
+#ifdef DABCOMMON_HAS_MLOCK
+      static auto const size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+      return size;
+#else
+      return 4096;
+#endif
+      }
+
+    }
+
+  /**
+   * @brief Touch every page of a memory region, forcing the operating system to back it with physical memory
+   *
+   * @note The contents of the touched region are preserved.
+   *
+   * @since 1.0.3
+   */
+  inline void prefault(void * const memory, std::size_t const bytes)
+    {
+    auto const bytePointer = static_cast<char volatile *>(memory);
+    auto const step = internal::page_size();
+
+    for(std::size_t offset{}; offset < bytes; offset += step)
+      {
+      bytePointer[offset] = bytePointer[offset];
+      }
+
+    if(bytes)
+      {
+      bytePointer[bytes - 1] = bytePointer[bytes - 1];
+      }
+    }
+
+  /**
+   * @brief Lock a memory region into RAM
+   *
+   * @return @p true if the region was locked, @p false if locking is not supported or was not permitted (e.g. due to
+   * RLIMIT_MEMLOCK).
+   *
+   * @since 1.0.3
+   */
+  inline bool lock_memory(void const * const memory, std::size_t const bytes)
+    {
+#ifdef DABCOMMON_HAS_MLOCK
+    return bytes && !mlock(memory, bytes);
+#else
+    (void)memory;
+    (void)bytes;
+    return false;
+#endif
+    }
+
+  /**
+   * @brief Unlock a memory region previously locked using dab::lock_memory
+   *
+   * @since 1.0.3
+   */
+  inline void unlock_memory(void const * const memory, std::size_t const bytes)
+    {
+#ifdef DABCOMMON_HAS_MLOCK
+    if(bytes)
+      {
+      munlock(memory, bytes);
+      }
+#else
+    (void)memory;
+    (void)bytes;
+#endif
+    }
+
+  /**
+   * @brief Lock all current and future mappings of the process into RAM
+   *
+   * This is the coarse alternative to pinning individual queues and arenas. It also covers thread stacks and the memory
+   * of third-party libraries.
+   *
+   * @return @p true if the memory of the process was locked, @p false otherwise
+   *
+   * @since 1.0.3
+   */
+  inline bool lock_process_memory()
+    {
+#if defined(DABCOMMON_HAS_MLOCK) && defined(MCL_CURRENT) && defined(MCL_FUTURE)
+    return !mlockall(MCL_CURRENT | MCL_FUTURE);
+#else
+    return false;
+#endif
+    }
+
+  /**
+   * @brief Bind a memory region to a NUMA node
+   *
+   * Only the pages completely contained in the region are bound, since binding operates on whole pages. Pages that
+   * were already touched are migrated to the node. The bound pages are prefaulted afterwards, so that the placement
+   * takes effect immediately.
+   *
+   * @return @p true if the region was bound to the node, @p false otherwise
+   *
+   * @since 1.0.3
+   */
+  inline bool bind_to_node(void * const memory, std::size_t const bytes, unsigned const node)
+    {
+#ifdef DABCOMMON_HAS_MBIND
+    auto constexpr kBindPolicy = 2; // MPOL_BIND
+    auto constexpr kMoveFlag = 1u << 1; // MPOL_MF_MOVE
+    auto constexpr kMaskBits = sizeof(unsigned long) * 8;
+
+    if(node >= kMaskBits)
+      {
+      return false;
+      }
+
+    auto const pageSize = internal::page_size();
+    auto const begin = (reinterpret_cast<std::uintptr_t>(memory) + pageSize - 1) / pageSize * pageSize;
+    auto const end = (reinterpret_cast<std::uintptr_t>(memory) + bytes) / pageSize * pageSize;
+
+    if(end <= begin)
+      {
+      return false;
+      }
+
+    auto const mask = 1ul << node;
+    auto const result = syscall(SYS_mbind, begin, end - begin, kBindPolicy, &mask, kMaskBits + 1, kMoveFlag);
+
+    prefault(reinterpret_cast<void *>(begin), end - begin);
+    return !result;
+#else
+    (void)memory;
+    (void)bytes;
+    (void)node;
+    return false;
+#endif
+    }
+
+  /**
+   * @brief Pin a number of queues and arenas before streaming begins
+   *
+   * This function calls @p pin() on each of its arguments, preallocating, prefaulting and locking their memory.
+   *
+   * @return @p true if the memory of all arguments could be locked, @p false otherwise. Even if locking failed, all
+   * arguments are prefaulted and will not grow anymore.
+   *
+   * @since 1.0.3
+   */
+  inline bool warm_up()
+    {
+    return true;
+    }
+
+  template<typename PinnableType, typename ...PinnableTypes>
+  bool warm_up(PinnableType & first, PinnableTypes & ...rest)
+    {
+    auto const locked = first.pin();
+    return warm_up(rest...) && locked;
+    }
+
+  }
+
+#endif
@@ -0,0 +1,284 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_SYSTEM_NUMA
+#define DABCOMMON_SYSTEM_NUMA
+
+#include "dab/system/memory.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#define DABCOMMON_HAS_AFFINITY 1
+#endif
+
+/**
+ * @file
+ *
+ * @brief This file contains helpers for NUMA-aware placement of threads and memory
+ *
+ * On multi-socket hosts, a producer and a consumer of a queue should run on the same NUMA node as the backing store of
+ * the queue. Otherwise, every element crosses the interconnect. The helpers in this file query the node topology via
+ * sysfs and pin threads to the CPUs of a node, without requiring libnuma. See dab::bind_to_node for placing memory.
+ *
+ * @note On systems other than Linux, all functions in this file degrade to no-ops reporting failure.
+ *
+ * @since 1.0.3
+ */
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    /**
+     * @internal
+     * @brief The maximum number of digits of a CPU or node ID accepted in a CPU/node list
+     *
+     * @since 1.0.3
+     */
+    std::size_t constexpr kMaximumCpuDigits{5};
+
+    /**
+     * @internal
+     * @brief Parse a Linux CPU/node list (e.g. "0-3,8,10-11")
+     *
+     * Malformed entries are skipped.
+     *
+     * @since 1.0.3
+     */
+    inline std::vector<unsigned> parse_cpu_list(std::string const & list)
+      {
+      auto result = std::vector<unsigned>{};
+      auto stream = std::istringstream{list};
+      auto range = std::string{};
+
+      auto const number = [](std::string text) {
+        if(!text.empty() && text.back() == '\n')
+          {
+          text.pop_back();
+          }
+
+        return !text.empty() && text.size() <= kMaximumCpuDigits && text.find_first_not_of("0123456789") == std::string::npos;
+      };
+
+      while(std::getline(stream, range, ','))
+        {
+        auto const dash = range.find('-');
+        if(range.empty() || !number(range.substr(0, dash)) || (dash != std::string::npos && !number(range.substr(dash + 1))))
+          {
+          continue;
+          }
+
+        auto const first = std::stoul(range.substr(0, dash));
+        auto const last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+
+        for(auto entry = first; entry <= last; ++entry)
+          {
+          result.push_back(static_cast<unsigned>(entry));
+          }
+        }
+
+      return result;
+      }
+
+    /**
+     * @internal
+     * @brief Read a CPU/node list from sysfs
+     *
+     * @since 1.0.3
+     */
+    inline std::vector<unsigned> read_cpu_list(std::string const & path)
+      {
+      auto file = std::ifstream{path};
+      auto list = std::string{};
+      std::getline(file, list);
+      return parse_cpu_list(list);
+      }
+
+    }
+
+  /**
+   * @brief Get the NUMA nodes that are currently online
+   *
+   * @return The IDs of the online nodes. On hosts without NUMA support, a single node with ID 0 is reported.
+   *
+   * @since 1.0.3
+   */
+  inline std::vector<unsigned> numa_nodes()
+    {
+    auto nodes = internal::read_cpu_list("/sys/devices/system/node/online");
+    return nodes.empty() ? std::vector<unsigned>{0} : nodes;
+    }
+
+  /**
+   * @brief Get the CPUs that belong to the given NUMA node
+   *
+   * @return The IDs of the CPUs of the node or an empty vector if the node is unknown.
+   *
+   * @since 1.0.3
+   */
+  inline std::vector<unsigned> numa_node_cpus(unsigned const node)
+    {
+    return internal::read_cpu_list("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    }
+
+  /**
+   * @brief Get the NUMA node of a CPU
+   *
+   * @return The ID of the node the CPU belongs to, or -1 if the node could not be determined.
+   *
+   * @since 1.0.3
+   */
+  inline int numa_node_of_cpu(unsigned const cpu)
+    {
+    for(auto const node : numa_nodes())
+      {
+      for(auto const candidate : numa_node_cpus(node))
+        {
+        if(candidate == cpu)
+          {
+          return static_cast<int>(node);
+          }
+        }
+      }
+
+    return -1;
+    }
+
+  /**
+   * @brief Get the CPU the calling thread is currently running on
+   *
+   * @return The ID of the CPU, or -1 if it could not be determined.
+   *
+   * @since 1.0.3
+   */
+  inline int current_cpu()
+    {
+#ifdef DABCOMMON_HAS_AFFINITY
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+    }
+
+  /**
+   * @brief Restrict a thread to the given set of CPUs
+   *
+   * @return @p true if the affinity of the thread was changed, @p false otherwise
+   *
+   * @since 1.0.3
+   */
+  inline bool pin_thread(std::thread::native_handle_type const thread, std::vector<unsigned> const & cpus)
+    {
+#ifdef DABCOMMON_HAS_AFFINITY
+    if(cpus.empty())
+      {
+      return false;
+      }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+
+    for(auto const cpu : cpus)
+      {
+      if(cpu < CPU_SETSIZE)
+        {
+        CPU_SET(cpu, &set);
+        }
+      }
+
+    return !pthread_setaffinity_np(thread, sizeof(set), &set);
+#else
+    (void)thread;
+    (void)cpus;
+    return false;
+#endif
+    }
+
+  /**
+   * @brief Restrict a thread to the given set of CPUs
+   *
+   * @since 1.0.3
+   */
+  inline bool pin_thread(std::thread & thread, std::vector<unsigned> const & cpus)
+    {
+    return pin_thread(thread.native_handle(), cpus);
+    }
+
+  /**
+   * @brief Restrict the calling thread to the given set of CPUs
+   *
+   * @since 1.0.3
+   */
+  inline bool pin_current_thread(std::vector<unsigned> const & cpus)
+    {
+#ifdef DABCOMMON_HAS_AFFINITY
+    return pin_thread(pthread_self(), cpus);
+#else
+    (void)cpus;
+    return false;
+#endif
+    }
+
+  /**
+   * @brief Place the producer and consumer of a queue, as well as its backing store, on the same NUMA node
+   *
+   * The producer and the consumer threads are restricted to the CPUs of the given node and the backing store of the
+   * queue is bound to the node. This works with any queue or pool providing @p place_on_node, like dab::sample_queue_t
+   * or dab::frame_arena.
+   *
+   * @return @p true if all placements succeeded, @p false otherwise
+   *
+   * @since 1.0.3
+   */
+  template<typename PlaceableType>
+  bool colocate(std::thread & producer, std::thread & consumer, PlaceableType & queue, unsigned const node)
+    {
+    auto const cpus = numa_node_cpus(node);
+
+    auto success = pin_thread(producer, cpus);
+    success &= pin_thread(consumer, cpus);
+    success &= queue.place_on_node(node);
+
+    return success;
+    }
+
+  }
+
+#endif
@@ -0,0 +1,477 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_SYSTEM_PERF_COUNTERS
+#define DABCOMMON_SYSTEM_PERF_COUNTERS
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(SYS_perf_event_open)
+#define DABCOMMON_HAS_PERF_EVENTS 1
+#endif
+#endif
+
+/**
+ * @file
+ *
+ * @brief This file contains a small wrapper around the hardware performance counters of the CPU
+ *
+ * Wall-clock time does not tell whether a kernel is limited by instruction throughput, by the caches or by branch
+ * prediction. The types in this file count cycles, instructions, cache misses and branch misses of the calling thread
+ * via perf_event_open(2) and attribute them to scoped regions, like a single OFDM symbol or a CIF.
+ *
+ * Only user-space events of the calling thread are counted, which perf_event_paranoid levels up to 2 permit. Counters
+ * the kernel or the CPU do not provide, e.g. in virtual machines, are reported as unavailable instead of failing. On
+ * systems other than Linux, no counters are available.
+ *
+ * @author Felix Morgner
+ * @since  1.0.3
+ */
+
+namespace dab
+  {
+
+  /**
+   * @brief The hardware events counted by a dab::perf_counters
+   *
+   * @author Felix Morgner
+   * @since  1.0.3
+   */
+  enum struct perf_counter : std::uint8_t
+    {
+    cycles, ///< CPU cycles
+    instructions, ///< Retired instructions
+    cache_misses, ///< Last level cache misses
+    branch_misses, ///< Mispredicted branches
+    };
+
+  /**
+   * @brief The number of hardware events counted by a dab::perf_counters
+   *
+   * @author Felix Morgner
+   * @since  1.0.3
+   */
+  std::size_t constexpr kPerfCounters{4};
+
+  /**
+   * @brief The values of the hardware counters, either absolute or for a region
+   *
+   * @author Felix Morgner
+   * @since  1.0.3
+   */
+  struct perf_sample
+    {
+    std::array<std::uint64_t, kPerfCounters> values{{}}; ///< The counter values, indexed by dab::perf_counter
+    std::uint8_t available{}; ///< A mask of the counters whose values are valid
+
+    /**
+     * @brief Check whether the value of a counter is valid
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    bool has(perf_counter const counter) const
+      {
+      return available & bit(counter);
+      }
+
+    /**
+     * @brief Get the value of a counter, or 0 if the counter is unavailable
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    std::uint64_t operator[](perf_counter const counter) const
+      {
+      return has(counter) ? values[static_cast<std::size_t>(counter)] : 0;
+      }
+
+    /**
+     * @brief Get the number of instructions per cycle, or 0 if either counter is unavailable
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    double ipc() const
+      {
+      auto const cycles = (*this)[perf_counter::cycles];
+      return cycles ? static_cast<double>((*this)[perf_counter::instructions]) / static_cast<double>(cycles) : 0.0;
+      }
+
+    /**
+     * @brief Add the values of another sample
+     *
+     * Only counters available in both samples stay available.
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    perf_sample & operator+=(perf_sample const & other)
+      {
+      for(std::size_t index{}; index < kPerfCounters; ++index)
+        {
+        values[index] += other.values[index];
+        }
+
+      available &= other.available;
+      return *this;
+      }
+
+    /**
+     * @brief Get the difference between a later and an earlier sample
+     *
+     * Only counters available in both samples stay available.
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    friend perf_sample operator-(perf_sample const & later, perf_sample const & earlier)
+      {
+      auto difference = perf_sample{};
+
+      for(std::size_t index{}; index < kPerfCounters; ++index)
+        {
+        auto const after = later.values[index];
+        auto const before = earlier.values[index];
+        difference.values[index] = after > before ? after - before : 0;
+        }
+
+      difference.available = later.available & earlier.available;
+      return difference;
+      }
+
+    /**
+     * @brief Get the bit of a counter in dab::perf_sample::available
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    static std::uint8_t bit(perf_counter const counter)
+      {
+      return static_cast<std::uint8_t>(1u << static_cast<unsigned>(counter));
+      }
+    };
+
+  /**
+   * @brief The hardware counters accumulated over a number of samples
+   *
+   * @author Felix Morgner
+   * @since  1.0.3
+   */
+  struct perf_statistics
+    {
+    std::uint64_t samples; ///< The number of samples
+    perf_sample total; ///< The sum of all samples
+
+    /**
+     * @brief Get the number of instructions per cycle over all samples
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    double ipc() const
+      {
+      return total.ipc();
+      }
+
+    /**
+     * @brief Get the average value of a counter per sample, or 0 if there were no samples
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    double per_sample(perf_counter const counter) const
+      {
+      return samples ? static_cast<double>(total[counter]) / static_cast<double>(samples) : 0.0;
+      }
+    };
+
+  /**
+   * @brief The hardware performance counters of the calling thread
+   *
+   * The counters are opened for, and only count, the thread constructing the object. They must only be read from this
+   * thread. See dab::thread_perf_counters for a lazily opened set of counters per thread.
+   *
+   * @author Felix Morgner
+   * @since  1.0.3
+   */
+  struct perf_counters
+    {
+    perf_counters()
+      {
+      for(std::size_t index{}; index < kPerfCounters; ++index)
+        {
+        m_descriptors[index] = open(static_cast<perf_counter>(index));
+        }
+      }
+
+    perf_counters(perf_counters const &) = delete;
+    perf_counters & operator=(perf_counters const &) = delete;
+
+    ~perf_counters()
+      {
+#ifdef DABCOMMON_HAS_PERF_EVENTS
+      for(auto const descriptor : m_descriptors)
+        {
+        if(descriptor >= 0)
+          {
+          close(descriptor);
+          }
+        }
+#endif
+      }
+
+    /**
+     * @brief Check whether any counter is available
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    bool available() const
+      {
+      return read().available;
+      }
+
+    /**
+     * @brief Check whether the given counter is available
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    bool available(perf_counter const counter) const
+      {
+      return m_descriptors[static_cast<std::size_t>(counter)] >= 0;
+      }
+
+    /**
+     * @brief Read the current values of the counters
+     *
+     * If the kernel multiplexed a counter with other events, its value is extrapolated to the time it was enabled.
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    perf_sample read() const
+      {
+      auto sample = perf_sample{};
+
+#ifdef DABCOMMON_HAS_PERF_EVENTS
+      for(std::size_t index{}; index < kPerfCounters; ++index)
+        {
+        if(m_descriptors[index] < 0)
+          {
+          continue;
+          }
+
+        std::uint64_t data[3]{};
+        if(::read(m_descriptors[index], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || !data[2])
+          {
+          continue;
+          }
+
+        auto value = data[0];
+        if(data[2] < data[1])
+          {
+          value = static_cast<std::uint64_t>(static_cast<double>(value) * data[1] / data[2]);
+          }
+
+        sample.values[index] = value;
+        sample.available |= perf_sample::bit(static_cast<perf_counter>(index));
+        }
+#endif
+
+      return sample;
+      }
+
+    private:
+      static int open(perf_counter const counter)
+        {
+#ifdef DABCOMMON_HAS_PERF_EVENTS
+        static std::uint64_t const kConfigs[kPerfCounters]{
+          PERF_COUNT_HW_CPU_CYCLES,
+          PERF_COUNT_HW_INSTRUCTIONS,
+          PERF_COUNT_HW_CACHE_MISSES,
+          PERF_COUNT_HW_BRANCH_MISSES,
+        };
+
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.config = kConfigs[static_cast<std::size_t>(counter)];
+        attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+
+        return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#else
+        static_cast<void>(counter);
+        return -1;
+#endif
+        }
+
+      std::array<int, kPerfCounters> m_descriptors{{-1, -1, -1, -1}};
+    };
+
+  /**
+   * @brief Get the hardware performance counters of the calling thread
+   *
+   * The counters are opened on first use by a thread and closed when the thread exits.
+   *
+   * @author Felix Morgner
+   * @since  1.0.3
+   */
+  inline perf_counters & thread_perf_counters()
+    {
+    static thread_local perf_counters counters{};
+    return counters;
+    }
+
+  /**
+   * @brief Accumulates the hardware counters of regions, possibly measured on several threads
+   *
+   * @author Felix Morgner
+   * @since  1.0.3
+   */
+  struct perf_accumulator
+    {
+    /**
+     * @brief Add the counters of a region
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    void add(perf_sample const & sample)
+      {
+      for(std::size_t index{}; index < kPerfCounters; ++index)
+        {
+        m_totals[index].fetch_add(sample.values[index], std::memory_order_relaxed);
+        }
+
+      m_available.fetch_and(sample.available, std::memory_order_relaxed);
+      m_samples.fetch_add(1, std::memory_order_relaxed);
+      }
+
+    /**
+     * @brief Get the counters accumulated so far
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    perf_statistics statistics() const
+      {
+      auto statistics = perf_statistics{m_samples.load(std::memory_order_relaxed), {}};
+
+      for(std::size_t index{}; index < kPerfCounters; ++index)
+        {
+        statistics.total.values[index] = m_totals[index].load(std::memory_order_relaxed);
+        }
+
+      statistics.total.available = statistics.samples ? m_available.load(std::memory_order_relaxed) : 0;
+      return statistics;
+      }
+
+    /**
+     * @brief Forget the counters accumulated so far
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    void reset()
+      {
+      for(auto & total : m_totals)
+        {
+        total.store(0, std::memory_order_relaxed);
+        }
+
+      m_available.store(0xff, std::memory_order_relaxed);
+      m_samples.store(0, std::memory_order_relaxed);
+      }
+
+    private:
+      std::array<std::atomic<std::uint64_t>, kPerfCounters> m_totals{{}};
+      std::atomic<std::uint8_t> m_available{0xff};
+      std::atomic<std::uint64_t> m_samples{};
+    };
+
+  /**
+   * @brief Attributes the hardware counters of the calling thread to a region, from construction to destruction
+   *
+   * @code
+   * dab::perf_accumulator symbols{};
+   * for(auto symbol : frame)
+   *   {
+   *   dab::perf_scope region{symbols};
+   *   demodulator.demodulate(symbol, softBits);
+   *   }
+   * auto const statistics = symbols.statistics();
+   * std::cout << statistics.ipc() << " IPC, " << statistics.per_sample(dab::perf_counter::cache_misses) << " misses\n";
+   * @endcode
+   *
+   * @author Felix Morgner
+   * @since  1.0.3
+   */
+  struct perf_scope
+    {
+    explicit perf_scope(perf_accumulator & target, perf_counters & counters = thread_perf_counters())
+      : m_target{target}
+      , m_counters{counters}
+      , m_start{counters.read()}
+      {
+
+      }
+
+    perf_scope(perf_scope const &) = delete;
+    perf_scope & operator=(perf_scope const &) = delete;
+
+    ~perf_scope()
+      {
+      m_target.add(m_counters.read() - m_start);
+      }
+
+    private:
+      perf_accumulator & m_target;
+      perf_counters & m_counters;
+      perf_sample const m_start;
+    };
+
+  }
+
+#endif
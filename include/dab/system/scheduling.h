@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_SYSTEM_SCHEDULING
+#define DABCOMMON_SYSTEM_SCHEDULING
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#if defined(SCHED_IDLE)
+#define DABCOMMON_HAS_SCHED_IDLE 1
+#endif
+#endif
+
+/**
+ * @file
+ *
+ * @brief This file contains helpers adjusting the scheduling of threads
+ *
+ * @since 1.0.3
+ */
+
+namespace dab
+  {
+
+  /**
+   * @brief Move the calling thread into the idle scheduling class
+   *
+   * Monitoring consumers, like TII decoding or spectrum analysis, should only use CPU time the demodulation chain
+   * leaves unused. On Linux, the calling thread is switched to SCHED_IDLE.
+   *
+   * @return @p true iff the scheduling class was changed
+   *
+   * @since 1.0.3
+   */
+  inline bool lower_current_thread_priority()
+    {
+#ifdef DABCOMMON_HAS_SCHED_IDLE
+    auto parameters = sched_param{};
+    parameters.sched_priority = 0;
+    return !pthread_setschedparam(pthread_self(), SCHED_IDLE, &parameters);
+#else
+    return false;
+#endif
+    }
+
+  }
+
+#endif
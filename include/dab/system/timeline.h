@@ -0,0 +1,575 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_SYSTEM_TIMELINE
+#define DABCOMMON_SYSTEM_TIMELINE
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define DABCOMMON_HAS_RDTSC 1
+#endif
+
+/**
+ * @file
+ *
+ * @brief This file contains a lightweight in-process tracer for per-frame processing timelines
+ *
+ * Every thread records its spans into a ring buffer of its own, so recording never takes a lock once a thread has
+ * registered with the timeline, as long as the thread records into no more than a handful of timelines. On x86,
+ * timestamps are taken via RDTSC and converted to wall time when the timeline is exported. The exported Chrome trace
+ * JSON can be opened in chrome://tracing or the Perfetto UI, which makes pipeline bubbles and the cost of handing
+ * frames between cores visible.
+ *
+ * @since 1.0.3
+ */
+
+namespace dab
+  {
+
+  /**
+   * @brief The frame number of spans not associated with a transmission frame
+   *
+   * @since 1.0.3
+   */
+  std::uint64_t constexpr kNoFrame{std::numeric_limits<std::uint64_t>::max()};
+
+  /**
+   * @brief The maximum number of characters of a span name, longer names are truncated
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kTimelineNameLength{23};
+
+  /**
+   * @brief The default number of spans kept per thread by a dab::timeline
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kDefaultTimelineCapacity{4096};
+
+  namespace internal
+    {
+
+    /**
+     * @internal
+     * @brief The number of timelines each thread remembers its ring buffer for
+     *
+     * @since 1.0.3
+     */
+    std::size_t constexpr kTimelineCacheEntries{8};
+
+    /**
+     * @internal
+     * @brief Read the timestamp counter, or the steady clock in nanoseconds where no timestamp counter is available
+     *
+     * @since 1.0.3
+     */
+    inline std::uint64_t timeline_ticks()
+      {
+#ifdef DABCOMMON_HAS_RDTSC
+      return __rdtsc();
+#else
+      return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+      }
+
+    }
+
+  /**
+   * @brief A span recorded by a dab::timeline
+   *
+   * @since 1.0.3
+   */
+  struct timeline_event
+    {
+    char name[kTimelineNameLength + 1]; ///< The zero-terminated name of the span
+    std::uint64_t begin; ///< The tick at which the span began
+    std::uint64_t end; ///< The tick at which the span ended
+    std::uint64_t frame; ///< The transmission frame the span belongs to, or dab::kNoFrame
+    };
+
+  /**
+   * @brief The spans recorded by a single thread
+   *
+   * @since 1.0.3
+   */
+  struct timeline_thread
+    {
+    std::size_t id; ///< The number of the thread, in order of registration with the timeline
+    std::string name; ///< The name given via dab::timeline::name_thread, if any
+    std::vector<timeline_event> events; ///< The recorded spans, oldest first
+    std::uint64_t dropped; ///< The number of spans overwritten before they were collected
+    };
+
+  struct timeline;
+
+  /**
+   * @brief Records a span from its construction until its destruction
+   *
+   * @see dab::timeline::span
+   *
+   * @since 1.0.3
+   */
+  struct timeline_span
+    {
+    timeline_span(timeline * const target, char const * const name, std::uint64_t const frame)
+      : m_timeline{target}
+      , m_name{name}
+      , m_frame{frame}
+      , m_begin{target ? internal::timeline_ticks() : 0}
+      {
+
+      }
+
+    timeline_span(timeline_span && other)
+      : m_timeline{other.m_timeline}
+      , m_name{other.m_name}
+      , m_frame{other.m_frame}
+      , m_begin{other.m_begin}
+      {
+      other.m_timeline = nullptr;
+      }
+
+    timeline_span(timeline_span const &) = delete;
+    timeline_span & operator=(timeline_span const &) = delete;
+
+    inline ~timeline_span();
+
+    private:
+      timeline * m_timeline;
+      char const * m_name;
+      std::uint64_t m_frame;
+      std::uint64_t m_begin;
+    };
+
+  /**
+   * @brief A lightweight in-process tracer recording spans into per-thread ring buffers
+   *
+   * Spans are recorded either explicitly via record() or for a scope via span():
+   *
+   * @code
+   * dab::timeline timeline{};
+   * ...
+   * {
+   * auto span = timeline.span("fic decode", frame);
+   * combiner.decode(cif, soft);
+   * }
+   * ...
+   * std::ofstream trace{"trace.json"};
+   * timeline.write_chrome_trace(trace);
+   * @endcode
+   *
+   * Each thread owns a ring buffer of fixed capacity, which only it writes. Once full, the oldest spans of the thread
+   * are overwritten. Collecting the spans does not stop the writers. Spans overwritten while being collected are
+   * discarded and accounted for in dab::timeline_thread::dropped.
+   *
+   * @since 1.0.3
+   */
+  struct timeline
+    {
+    /**
+     * @brief Construct a timeline
+     *
+     * @param eventsPerThread The number of spans kept per thread, rounded up to a power of two
+     */
+    explicit timeline(std::size_t const eventsPerThread = kDefaultTimelineCapacity)
+      : m_id{next_id()}
+      , m_capacity{round_up(eventsPerThread)}
+      , m_originTicks{internal::timeline_ticks()}
+      , m_originTime{clock::now()}
+      {
+
+      }
+
+    timeline(timeline const &) = delete;
+    timeline & operator=(timeline const &) = delete;
+
+    /**
+     * @brief Enable or disable recording
+     *
+     * Spans are not recorded while the timeline is disabled. A timeline starts out enabled.
+     */
+    void enable(bool const enabled)
+      {
+      m_enabled.store(enabled, std::memory_order_relaxed);
+      }
+
+    /**
+     * @brief Check whether the timeline records spans
+     */
+    bool enabled() const
+      {
+      return m_enabled.load(std::memory_order_relaxed);
+      }
+
+    /**
+     * @brief Name the calling thread in exported traces
+     */
+    void name_thread(std::string name)
+      {
+      auto & buffer = local();
+      auto lock = std::unique_lock<std::mutex>{m_mutex};
+      buffer.name = std::move(name);
+      }
+
+    /**
+     * @brief Record a span of the calling thread
+     *
+     * @param name The name of the span, truncated to dab::kTimelineNameLength characters
+     * @param begin The tick at which the span began, as returned by dab::timeline::now
+     * @param end The tick at which the span ended, as returned by dab::timeline::now
+     * @param frame The transmission frame the span belongs to
+     */
+    void record(char const * const name, std::uint64_t const begin, std::uint64_t const end,
+                std::uint64_t const frame = kNoFrame)
+      {
+      if(!enabled())
+        {
+        return;
+        }
+
+      auto event = timeline_event{{}, begin, end, frame};
+      for(std::size_t index{}; index < kTimelineNameLength && name[index]; ++index)
+        {
+        event.name[index] = name[index];
+        }
+
+      local().push(event);
+      }
+
+    /**
+     * @brief Start a span of the calling thread that ends when the returned object is destroyed
+     *
+     * @note @p name must stay valid until the span ends
+     */
+    timeline_span span(char const * const name, std::uint64_t const frame = kNoFrame)
+      {
+      return {enabled() ? this : nullptr, name, frame};
+      }
+
+    /**
+     * @brief Get the current tick
+     */
+    static std::uint64_t now()
+      {
+      return internal::timeline_ticks();
+      }
+
+    /**
+     * @brief Collect the spans recorded so far by all threads
+     */
+    std::vector<timeline_thread> collect() const
+      {
+      auto lock = std::unique_lock<std::mutex>{m_mutex};
+      auto threads = std::vector<timeline_thread>{};
+
+      for(std::size_t index{}; index < m_buffers.size(); ++index)
+        {
+        auto const & buffer = *m_buffers[index];
+        threads.push_back(timeline_thread{index, buffer.name, {}, 0});
+        buffer.collect(threads.back());
+        }
+
+      return threads;
+      }
+
+    /**
+     * @brief Convert a number of ticks to microseconds
+     *
+     * The conversion is calibrated against the steady clock over the lifetime of the timeline.
+     */
+    double to_microseconds(std::uint64_t const ticks) const
+      {
+      return static_cast<double>(ticks) * microseconds_per_tick();
+      }
+
+    /**
+     * @brief Write the recorded spans in the Chrome trace event format
+     *
+     * Every span becomes a complete event on the thread that recorded it, with its frame, if any, as an argument. The
+     * timestamps are relative to the construction of the timeline.
+     */
+    void write_chrome_trace(std::ostream & out) const
+      {
+      auto const threads = collect();
+      auto const scale = microseconds_per_tick();
+      auto separator = "";
+
+      out << "{\"traceEvents\":[";
+      out << std::fixed << std::setprecision(3);
+
+      for(auto const & thread : threads)
+        {
+        if(!thread.name.empty())
+          {
+          out << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.id
+              << ",\"args\":{\"name\":";
+          write_string(out, thread.name);
+          out << "}}";
+          separator = ",";
+          }
+
+        for(auto const & event : thread.events)
+          {
+          auto const begin = event.begin > m_originTicks ? event.begin - m_originTicks : 0;
+          auto const duration = event.end > event.begin ? event.end - event.begin : 0;
+
+          out << separator << "{\"name\":";
+          write_string(out, event.name);
+          out << ",\"cat\":\"dab\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread.id
+              << ",\"ts\":" << static_cast<double>(begin) * scale
+              << ",\"dur\":" << static_cast<double>(duration) * scale;
+
+          if(event.frame != kNoFrame)
+            {
+            out << ",\"args\":{\"frame\":" << event.frame << '}';
+            }
+
+          out << '}';
+          separator = ",";
+          }
+        }
+
+      out << "],\"displayTimeUnit\":\"ns\"}";
+      }
+
+    private:
+      using clock = std::chrono::steady_clock;
+
+      static std::size_t constexpr kWords = sizeof(timeline_event) / sizeof(std::uint64_t);
+      static_assert(sizeof(timeline_event) % sizeof(std::uint64_t) == 0, "Timeline events must consist of whole words");
+
+      /**
+       * @internal
+       * @brief The single-writer ring buffer of a thread
+       *
+       * The slots are held in atomic words, which keeps collecting concurrently to recording free of data races. Like
+       * dab::seqlock, the writer publishes the start of a write before storing to a slot, so a collector can discard
+       * every slot that might have been overwritten while it was being read.
+       */
+      struct thread_buffer
+        {
+        explicit thread_buffer(std::size_t const capacity)
+          : slots(capacity)
+          {
+
+          }
+
+        void push(timeline_event const & event)
+          {
+          auto words = std::array<std::uint64_t, kWords>{};
+          std::memcpy(words.data(), &event, sizeof(timeline_event));
+
+          auto const index = head.load(std::memory_order_relaxed);
+          auto & slot = slots[index & (slots.size() - 1)];
+
+          started.store(index + 1, std::memory_order_relaxed);
+          std::atomic_thread_fence(std::memory_order_release);
+
+          for(std::size_t word{}; word < kWords; ++word)
+            {
+            slot[word].store(words[word], std::memory_order_relaxed);
+            }
+
+          head.store(index + 1, std::memory_order_release);
+          }
+
+        void collect(timeline_thread & target) const
+          {
+          auto const capacity = slots.size();
+          auto const last = head.load(std::memory_order_acquire);
+          auto const first = last > capacity ? last - capacity : 0;
+          auto words = std::array<std::uint64_t, kWords>{};
+
+          target.events.resize(last - first);
+          for(auto index = first; index < last; ++index)
+            {
+            auto const & slot = slots[index & (capacity - 1)];
+            for(std::size_t word{}; word < kWords; ++word)
+              {
+              words[word] = slot[word].load(std::memory_order_relaxed);
+              }
+
+            std::memcpy(&target.events[index - first], words.data(), sizeof(timeline_event));
+            }
+
+          std::atomic_thread_fence(std::memory_order_acquire);
+          auto const now = started.load(std::memory_order_relaxed);
+          auto const valid = now > capacity ? now - capacity : 0;
+          auto const overwritten = std::min<std::uint64_t>(valid > first ? valid - first : 0, last - first);
+
+          target.events.erase(target.events.begin(), target.events.begin() + overwritten);
+          target.dropped = first + overwritten;
+          }
+
+        std::thread::id owner{std::this_thread::get_id()};
+        std::string name{};
+        std::atomic<std::uint64_t> head{};
+        std::atomic<std::uint64_t> started{};
+        std::vector<std::array<std::atomic<std::uint64_t>, kWords>> slots;
+        };
+
+      /**
+       * @internal
+       * @brief Get the ring buffer of the calling thread, registering the thread if necessary
+       *
+       * Each thread caches its buffers of the internal::kTimelineCacheEntries timelines it most recently registered
+       * with, keyed by the unique identifier of the timeline. Only cache misses take the lock.
+       */
+      thread_buffer & local()
+        {
+        struct cache_entry
+          {
+          std::uint64_t timeline;
+          thread_buffer * buffer;
+          };
+
+        struct thread_cache
+          {
+          std::array<cache_entry, internal::kTimelineCacheEntries> entries;
+          std::size_t next;
+          };
+
+        static thread_local auto cache = thread_cache{};
+
+        for(auto const & entry : cache.entries)
+          {
+          if(entry.timeline == m_id)
+            {
+            return *entry.buffer;
+            }
+          }
+
+        auto lock = std::unique_lock<std::mutex>{m_mutex};
+        auto const self = std::this_thread::get_id();
+        auto found = std::find_if(m_buffers.begin(), m_buffers.end(), [&](std::unique_ptr<thread_buffer> const & buffer) {
+          return buffer->owner == self;
+        });
+
+        if(found == m_buffers.end())
+          {
+          m_buffers.emplace_back(new thread_buffer{m_capacity});
+          found = m_buffers.end() - 1;
+          }
+
+        cache.entries[cache.next] = cache_entry{m_id, found->get()};
+        cache.next = (cache.next + 1) % internal::kTimelineCacheEntries;
+        return **found;
+        }
+
+      double microseconds_per_tick() const
+        {
+        auto const elapsedTicks = internal::timeline_ticks() - m_originTicks;
+        auto const elapsedTime = std::chrono::duration<double, std::micro>{clock::now() - m_originTime}.count();
+
+        if(!elapsedTicks || elapsedTime <= 0.0)
+          {
+          return 0.0;
+          }
+
+        return elapsedTime / static_cast<double>(elapsedTicks);
+        }
+
+      template<typename StringType>
+      static void write_string(std::ostream & out, StringType const & text)
+        {
+        out << '"';
+        for(auto character : std::string{text})
+          {
+          if(character == '"' || character == '\\')
+            {
+            out << '\\' << character;
+            }
+          else if(static_cast<unsigned char>(character) < 0x20)
+            {
+            out << ' ';
+            }
+          else
+            {
+            out << character;
+            }
+          }
+        out << '"';
+        }
+
+      static std::uint64_t next_id()
+        {
+        static std::atomic<std::uint64_t> counter{};
+        return ++counter;
+        }
+
+      static std::size_t round_up(std::size_t const capacity)
+        {
+        auto rounded = std::size_t{1};
+        while(rounded < capacity)
+          {
+          rounded <<= 1;
+          }
+        return rounded;
+        }
+
+      std::uint64_t const m_id;
+      std::size_t const m_capacity;
+      std::uint64_t const m_originTicks;
+      clock::time_point const m_originTime;
+      std::atomic_bool m_enabled{true};
+      std::mutex mutable m_mutex{};
+      std::vector<std::unique_ptr<thread_buffer>> m_buffers{};
+    };
+
+  timeline_span::~timeline_span()
+    {
+    if(m_timeline)
+      {
+      m_timeline->record(m_name, m_begin, internal::timeline_ticks(), m_frame);
+      }
+    }
+
+  }
+
+#endif
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_SYSTEM_TRACING
+#define DABCOMMON_SYSTEM_TRACING
+
+/**
+ * @file
+ *
+ * @brief This file contains the static tracepoints of the library
+ *
+ * When DABCOMMON_ENABLE_USDT is defined (see the CMake option DABCOMMON_ENABLE_USDT), every DABCOMMON_PROBE* macro
+ * emits a USDT probe via <sys/sdt.h> in the provider @p dabcommon. A probe compiles to a single NOP and a note in the
+ * ELF file, so it costs nothing until a tracer like bpftrace or perf attaches to it:
+ *
+ * @code
+ * bpftrace -e 'usdt:./receiver:dabcommon:queue_wait_start { @s[arg0] = nsecs; }
+ *              usdt:./receiver:dabcommon:queue_wait_end /@s[arg0]/ { @wait = hist(nsecs - @s[arg0]); delete(@s[arg0]); }'
+ * @endcode
+ *
+ * Without DABCOMMON_ENABLE_USDT, the probes expand to unevaluated expressions. The arguments are still type-checked,
+ * but no code is generated.
+ *
+ * The library defines the following probes. The first argument of queue probes is the address of the queue.
+ *
+ * - queue_enqueue(queue, elements, size): elements were enqueued, @p size is the new size of the queue
+ * - queue_dequeue(queue, elements, size): elements were dequeued, @p size is the new size of the queue
+ * - queue_resize(queue, old, new): the backing store grew from @p old to @p new elements
+ * - queue_shift_down(queue, elements): the contained elements were moved to the start of the backing store
+ * - queue_wait_start(queue, elements, space): an operation started blocking. @p space is 0 if a consumer waits for
+ *   elements and 1 if a producer waits for space in a pinned queue.
+ * - queue_wait_end(queue, elements, space): a blocking operation stopped waiting
+ * - stage_step_start(stage): a pipeline stage started a step
+ * - stage_step_end(stage, state): a pipeline stage finished a step, @p state is the resulting dab::stage_state
+ * - frame_start(demodulator): a demodulator received the phase reference symbol of a transmission frame
+ * - cif_start(deinterleaver, cifs): a CIF entered a dab::selective_deinterleaver, @p cifs is the number of CIFs before it
+ * - fic_decode(combiner, cif, combining): a dab::fic_combiner decodes the FIC of a CIF position
+ *
+ * @since 1.0.3
+ */
+
+#ifdef DABCOMMON_ENABLE_USDT
+
+#include <sys/sdt.h>
+
+#define DABCOMMON_PROBE0(name) DTRACE_PROBE(dabcommon, name)
+#define DABCOMMON_PROBE1(name, a1) DTRACE_PROBE1(dabcommon, name, a1)
+#define DABCOMMON_PROBE2(name, a1, a2) DTRACE_PROBE2(dabcommon, name, a1, a2)
+#define DABCOMMON_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(dabcommon, name, a1, a2, a3)
+
+#else
+
+#define DABCOMMON_PROBE0(name) do { } while(false)
+#define DABCOMMON_PROBE1(name, a1) do { static_cast<void>(sizeof(a1)); } while(false)
+#define DABCOMMON_PROBE2(name, a1, a2) do { static_cast<void>(sizeof(a1)); static_cast<void>(sizeof(a2)); } while(false)
+#define DABCOMMON_PROBE3(name, a1, a2, a3) \
+  do { static_cast<void>(sizeof(a1)); static_cast<void>(sizeof(a2)); static_cast<void>(sizeof(a3)); } while(false)
+
+#endif
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TYPES_BYTE_VIEW
+#define DABCOMMON_TYPES_BYTE_VIEW
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief A non-owning view of a contiguous range of bytes
+   *
+   * The view mirrors the interface of a C++20 std::span over const bytes. It does not extend the lifetime of the
+   * viewed bytes.
+   *
+   * @since 1.0.3
+   */
+  struct byte_view
+    {
+    using value_type = std::uint8_t;
+    using const_iterator = std::uint8_t const *;
+
+    constexpr byte_view() noexcept = default;
+
+    constexpr byte_view(std::uint8_t const * const data, std::size_t const size) noexcept
+      : m_data{data},
+        m_size{size}
+      {
+      }
+
+    template<typename AllocatorType>
+    byte_view(std::vector<std::uint8_t, AllocatorType> const & bytes) noexcept
+      : m_data{bytes.data()},
+        m_size{bytes.size()}
+      {
+      }
+
+    constexpr std::uint8_t const * data() const noexcept
+      {
+      return m_data;
+      }
+
+    constexpr std::size_t size() const noexcept
+      {
+      return m_size;
+      }
+
+    constexpr bool empty() const noexcept
+      {
+      return !m_size;
+      }
+
+    constexpr const_iterator begin() const noexcept
+      {
+      return m_data;
+      }
+
+    constexpr const_iterator end() const noexcept
+      {
+      return m_data + m_size;
+      }
+
+    constexpr std::uint8_t operator[](std::size_t const index) const noexcept
+      {
+      return m_data[index];
+      }
+
+    /**
+     * @brief Get a view of a part of this view
+     *
+     * @throws std::out_of_range if the part does not lie within this view
+     */
+    byte_view subview(std::size_t const offset, std::size_t const size) const
+      {
+      if(offset > m_size || size > m_size - offset)
+        {
+        throw std::out_of_range{"The subview does not lie within the viewed bytes"};
+        }
+
+      return {m_data + offset, size};
+      }
+
+    private:
+      std::uint8_t const * m_data{};
+      std::size_t m_size{};
+    };
+
+  }
+
+#endif
@@ -32,6 +32,7 @@
 #ifndef DABCOMMON_TYPES_COMMON_TYPES
 #define DABCOMMON_TYPES_COMMON_TYPES
 
+#include "dab/types/frame_arena.h"
 #include "dab/types/parse_status.h"
 #include "dab/types/queue.h"
 
@@ -73,6 +74,41 @@ namespace dab
    **/
   using pair_status_vector_t = std::pair<dab::parse_status, byte_vector_t>;
 
+  /**
+   * @brief A vector of bytes allocated from a frame arena
+   *
+   * @since 1.0.3
+   */
+  using arena_byte_vector_t = std::vector<std::uint8_t, arena_allocator<std::uint8_t>>;
+
+  /**
+   * @brief A parser return value whose payload is allocated from a frame arena
+   *
+   * @since 1.0.3
+   */
+  using arena_pair_status_vector_t = std::pair<dab::parse_status, arena_byte_vector_t>;
+
+#ifdef DABCOMMON_HAS_MEMORY_RESOURCE
+  namespace pmr
+    {
+
+    /**
+     * @brief A vector of bytes using a polymorphic allocator
+     *
+     * @since 1.0.3
+     */
+    using byte_vector_t = std::pmr::vector<std::uint8_t>;
+
+    /**
+     * @brief A parser return value whose payload uses a polymorphic allocator
+     *
+     * @since 1.0.3
+     */
+    using pair_status_vector_t = std::pair<dab::parse_status, byte_vector_t>;
+
+    }
+#endif
+
   /**
    * @brief The type of a queue for transporting samples
    *
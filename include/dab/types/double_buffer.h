@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TYPES_DOUBLE_BUFFER
+#define DABCOMMON_TYPES_DOUBLE_BUFFER
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace dab
+  {
+
+  /**
+   * @brief A single-writer, multi-reader double buffer for publishing blocks of values
+   *
+   * The writer fills the inactive buffer and then makes it the active one. Readers copy the active buffer. Neither side
+   * ever blocks: a reader that observes a buffer being switched simply retries, and the writer drops a block instead of
+   * overwriting a buffer that a slow reader is still copying.
+   *
+   * @tparam ValueType The type of the published values
+   *
+   * @since 1.0.3
+   */
+  template<typename ValueType>
+  struct double_buffer
+    {
+    /**
+     * @brief Publish a block of values
+     *
+     * The block is swapped into the inactive buffer, so @p block receives the previous contents of that buffer, which
+     * allows the writer to reuse its storage. Only a single thread may publish blocks at any time.
+     *
+     * @return @p true iff the block was published, @p false if it was dropped because a reader still held the inactive
+     *         buffer
+     */
+    bool publish(std::vector<ValueType> & block)
+      {
+      auto const target = 1 - m_active.load();
+      if(m_readers[target].load())
+        {
+        return false;
+        }
+
+      std::swap(m_buffers[target], block);
+      m_active.store(target);
+      m_version.fetch_add(1);
+      return true;
+      }
+
+    /**
+     * @brief Copy the most recently published block
+     *
+     * @return The number of published blocks observed when the copy started, or 0 if nothing has been published yet
+     */
+    std::uint64_t read(std::vector<ValueType> & target) const
+      {
+      for(;;)
+        {
+        auto const version = m_version.load();
+        auto const active = m_active.load();
+
+        m_readers[active].fetch_add(1);
+        if(m_active.load() == active)
+          {
+          target = m_buffers[active];
+          m_readers[active].fetch_sub(1);
+          return version;
+          }
+
+        m_readers[active].fetch_sub(1);
+        }
+      }
+
+    /**
+     * @brief Get the number of blocks published so far
+     */
+    std::uint64_t version() const
+      {
+      return m_version.load();
+      }
+
+    private:
+      std::array<std::vector<ValueType>, 2> m_buffers{};
+      std::atomic<std::size_t> m_active{0};
+      std::atomic<std::uint64_t> m_version{0};
+      mutable std::array<std::atomic<unsigned>, 2> m_readers{};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,453 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TYPES_FRAME_ARENA
+#define DABCOMMON_TYPES_FRAME_ARENA
+
+#include "dab/system/memory.h"
+#include "dab/types/transmission_mode.h"
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define DABCOMMON_HAS_MEMORY_RESOURCE 1
+#endif
+#endif
+
+namespace dab
+  {
+
+  /**
+   * @brief The number of arena bytes reserved per sample of a transmission frame
+   *
+   * A frame arena sized for a transmission mode provides the storage of one complex sample for each sample of the
+   * frame. This comfortably covers the soft bits of all symbols of a frame plus the FIBs, FIGs and parse results that
+   * are derived from them.
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kFrameArenaBytesPerSample{sizeof(std::complex<float>)};
+
+  /**
+   * @brief A monotonic arena for transient per-frame decoding state
+   *
+   * A frame arena hands out memory by bumping a pointer into a preallocated buffer. Individual deallocations are no-ops,
+   * the whole arena is reclaimed at once by calling reset(), typically at each frame boundary. If the preallocated
+   * buffer is exhausted, the arena falls back to allocating overflow chunks from the free store. These chunks are
+   * released on the next reset.
+   *
+   * @note A frame arena is not thread-safe. Each decoding thread is expected to own its own arena.
+   *
+   * @since 1.0.3
+   */
+  struct frame_arena
+    {
+    /**
+     * @brief Construct an arena with the given capacity in bytes
+     *
+     * @since 1.0.3
+     */
+    explicit frame_arena(std::size_t const capacity)
+      : m_capacity{capacity}
+      , m_buffer{new char[capacity]}
+      {
+
+      }
+
+    /**
+     * @brief Construct an arena sized to hold the transient state of one frame in the given transmission mode
+     *
+     * @since 1.0.3
+     */
+    explicit frame_arena(internal::types::transmission_mode const & mode)
+      : frame_arena(mode.frame_duration * kFrameArenaBytesPerSample)
+      {
+      m_frameDuration = mode.frame_duration;
+      }
+
+    frame_arena(frame_arena const &) = delete;
+    frame_arena & operator=(frame_arena const &) = delete;
+
+    ~frame_arena()
+      {
+      if(m_locked)
+        {
+        unlock_memory(m_buffer.get(), m_capacity);
+        }
+      }
+
+    /**
+     * @brief Prefault and lock the preallocated buffer of the arena into RAM
+     *
+     * @return @p true if the buffer could be locked, @p false otherwise. The buffer is prefaulted in either case.
+     *
+     * @note Allocations exceeding the capacity of the arena are still served from overflow chunks, which are neither
+     * prefaulted nor locked. Use high_water() to size the arena such that this does not happen.
+     *
+     * @since 1.0.3
+     */
+    bool pin()
+      {
+      prefault(m_buffer.get(), m_capacity);
+
+      if(!m_locked)
+        {
+        m_locked = lock_memory(m_buffer.get(), m_capacity);
+        }
+
+      return m_locked;
+      }
+
+    /**
+     * @brief Bind the preallocated buffer of the arena to a NUMA node
+     *
+     * @return @p true if the buffer was bound to the node, @p false otherwise
+     *
+     * @since 1.0.3
+     */
+    bool place_on_node(unsigned const node)
+      {
+      return bind_to_node(m_buffer.get(), m_capacity, node);
+      }
+
+    /**
+     * @brief Allocate a block of memory with the given size and alignment
+     *
+     * @throws std::bad_alloc if an overflow chunk can not be obtained
+     *
+     * @since 1.0.3
+     */
+    void * allocate(std::size_t const bytes, std::size_t const alignment = alignof(std::max_align_t))
+      {
+      auto result = bump(m_buffer.get(), m_capacity, m_used, bytes, alignment);
+
+      if(!result)
+        {
+        result = allocate_overflow(bytes, alignment);
+        }
+
+      auto const inUse = m_used + m_overflowBytes;
+      if(inUse > m_highWater)
+        {
+        m_highWater = inUse;
+        }
+
+      return result;
+      }
+
+    /**
+     * @brief Deallocate a block of memory
+     *
+     * @note This is a no-op. Memory is only reclaimed when the arena is reset.
+     *
+     * @since 1.0.3
+     */
+    void deallocate(void *, std::size_t, std::size_t = alignof(std::max_align_t))
+      {
+
+      }
+
+    /**
+     * @brief Reclaim all memory handed out by the arena
+     *
+     * @note All objects allocated in the arena must have been destroyed before calling this function.
+     *
+     * @since 1.0.3
+     */
+    void reset()
+      {
+      m_used = 0;
+      m_overflow.clear();
+      m_overflowBytes = 0;
+      m_overflowUsed = 0;
+      m_elapsed = 0;
+      }
+
+    /**
+     * @brief Account for a number of processed samples and reset the arena at each frame boundary
+     *
+     * @return @p true if a frame boundary was crossed and the arena was reset, @p false otherwise.
+     *
+     * @note This function only has an effect on arenas that were constructed from a transmission mode.
+     *
+     * @since 1.0.3
+     */
+    bool advance(std::size_t const samples)
+      {
+      if(!m_frameDuration)
+        {
+        return false;
+        }
+
+      auto const elapsed = m_elapsed + samples;
+
+      if(elapsed < m_frameDuration)
+        {
+        m_elapsed = elapsed;
+        return false;
+        }
+
+      reset();
+      m_elapsed = elapsed % m_frameDuration;
+      return true;
+      }
+
+    /**
+     * @brief Get the size in bytes of the preallocated buffer
+     *
+     * @since 1.0.3
+     */
+    std::size_t capacity() const
+      {
+      return m_capacity;
+      }
+
+    /**
+     * @brief Get the number of bytes currently handed out by the arena, including overflow chunks
+     *
+     * @since 1.0.3
+     */
+    std::size_t used() const
+      {
+      return m_used + m_overflowBytes;
+      }
+
+    /**
+     * @brief Get the largest number of bytes ever in use between two resets
+     *
+     * The high water mark can be used to tune the capacity of the arena so that no overflow chunks are required.
+     *
+     * @since 1.0.3
+     */
+    std::size_t high_water() const
+      {
+      return m_highWater;
+      }
+
+    /**
+     * @brief Check whether the arena had to fall back to the free store since the last reset
+     *
+     * @since 1.0.3
+     */
+    bool overflowed() const
+      {
+      return !m_overflow.empty();
+      }
+
+#ifdef DABCOMMON_HAS_MEMORY_RESOURCE
+    /**
+     * @brief Get a std::pmr::memory_resource backed by this arena
+     *
+     * @since 1.0.3
+     */
+    std::pmr::memory_resource * resource()
+      {
+      return &m_resource;
+      }
+#endif
+
+    private:
+      /**
+       * @internal
+       * @brief Try to carve an aligned block out of the given buffer
+       */
+      static void * bump(char * const buffer,
+                         std::size_t const capacity,
+                         std::size_t & used,
+                         std::size_t const bytes,
+                         std::size_t const alignment)
+        {
+        if(!buffer)
+          {
+          return nullptr;
+          }
+
+        void * current = buffer + used;
+        auto space = capacity - used;
+
+        if(!std::align(alignment, bytes, current, space))
+          {
+          return nullptr;
+          }
+
+        used = static_cast<char *>(current) - buffer + bytes;
+        return current;
+        }
+
+      /**
+       * @internal
+       * @brief Serve an allocation that does not fit the preallocated buffer
+       *
+       * Overflow chunks grow geometrically, so that a badly sized arena degrades gracefully.
+       */
+      void * allocate_overflow(std::size_t const bytes, std::size_t const alignment)
+        {
+        if(!m_overflow.empty())
+          {
+          auto & chunk = m_overflow.back();
+          auto const before = m_overflowUsed;
+          if(auto result = bump(chunk.get(), m_overflowCapacity, m_overflowUsed, bytes, alignment))
+            {
+            m_overflowBytes += m_overflowUsed - before;
+            return result;
+            }
+          }
+
+        auto chunkSize = std::max(m_capacity, m_overflowCapacity * 2);
+        chunkSize = std::max(chunkSize, bytes + alignment);
+
+        m_overflow.emplace_back(new char[chunkSize]);
+        m_overflowCapacity = chunkSize;
+        m_overflowUsed = 0;
+
+        auto result = bump(m_overflow.back().get(), m_overflowCapacity, m_overflowUsed, bytes, alignment);
+        m_overflowBytes += m_overflowUsed;
+        return result;
+        }
+
+#ifdef DABCOMMON_HAS_MEMORY_RESOURCE
+      /**
+       * @internal
+       * @brief A std::pmr adaptor forwarding to the owning arena
+       */
+      struct memory_resource : std::pmr::memory_resource
+        {
+        explicit memory_resource(frame_arena & arena)
+          : m_arena{arena}
+          {
+
+          }
+
+        private:
+          void * do_allocate(std::size_t bytes, std::size_t alignment) override
+            {
+            return m_arena.allocate(bytes, alignment);
+            }
+
+          void do_deallocate(void *, std::size_t, std::size_t) override
+            {
+
+            }
+
+          bool do_is_equal(std::pmr::memory_resource const & other) const noexcept override
+            {
+            return this == &other;
+            }
+
+          frame_arena & m_arena;
+        };
+#endif
+
+      std::size_t m_capacity{};
+      std::unique_ptr<char[]> m_buffer{};
+      std::size_t m_used{};
+      std::vector<std::unique_ptr<char[]>> m_overflow{};
+      std::size_t m_overflowCapacity{};
+      std::size_t m_overflowUsed{};
+      std::size_t m_overflowBytes{};
+      std::size_t m_highWater{};
+      std::size_t m_frameDuration{};
+      std::size_t m_elapsed{};
+      bool m_locked{};
+#ifdef DABCOMMON_HAS_MEMORY_RESOURCE
+      memory_resource m_resource{*this};
+#endif
+    };
+
+  /**
+   * @brief A standard allocator drawing its memory from a frame arena
+   *
+   * This allocator makes it possible to use the standard library containers, as well as the containers of this library,
+   * with a frame arena in C++11 code. In C++17 code, frame_arena::resource() can be used with the std::pmr containers
+   * instead.
+   *
+   * @tparam ValueType The type of the objects to allocate
+   *
+   * @since 1.0.3
+   */
+  template<typename ValueType>
+  struct arena_allocator
+    {
+    using value_type = ValueType;
+
+    template<typename OtherType>
+    friend struct arena_allocator;
+
+    arena_allocator(frame_arena & arena) noexcept
+      : m_arena{&arena}
+      {
+
+      }
+
+    template<typename OtherType>
+    arena_allocator(arena_allocator<OtherType> const & other) noexcept
+      : m_arena{other.m_arena}
+      {
+
+      }
+
+    value_type * allocate(std::size_t const count)
+      {
+      return static_cast<value_type *>(m_arena->allocate(count * sizeof(value_type), alignof(value_type)));
+      }
+
+    void deallocate(value_type * const pointer, std::size_t const count) noexcept
+      {
+      m_arena->deallocate(pointer, count * sizeof(value_type), alignof(value_type));
+      }
+
+    template<typename OtherType>
+    bool operator==(arena_allocator<OtherType> const & other) const noexcept
+      {
+      return m_arena == other.m_arena;
+      }
+
+    template<typename OtherType>
+    bool operator!=(arena_allocator<OtherType> const & other) const noexcept
+      {
+      return !(*this == other);
+      }
+
+    private:
+      frame_arena * m_arena;
+    };
+
+  }
+
+#endif
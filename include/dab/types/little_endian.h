@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TYPES_LITTLE_ENDIAN
+#define DABCOMMON_TYPES_LITTLE_ENDIAN
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @internal
+ * @file
+ *
+ * @brief This file contains helpers to store integers in little-endian byte order
+ *
+ * @author Felix Morgner
+ * @since  1.0.3
+ */
+
+namespace dab
+  {
+
+  namespace internal
+    {
+
+    /**
+     * @internal
+     *
+     * @brief Store the @p size least significant bytes of @p value, least significant byte first
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    inline void store_little_endian(std::uint8_t * const bytes, std::uint64_t const value, std::size_t const size)
+      {
+      for(std::size_t index{}; index < size; ++index)
+        {
+        bytes[index] = static_cast<std::uint8_t>(value >> (8 * index));
+        }
+      }
+
+    /**
+     * @internal
+     *
+     * @brief Load an integer of @p size bytes stored by dab::internal::store_little_endian
+     *
+     * @author Felix Morgner
+     * @since  1.0.3
+     */
+    inline std::uint64_t load_little_endian(std::uint8_t const * const bytes, std::size_t const size)
+      {
+      auto value = std::uint64_t{};
+      for(std::size_t index{}; index < size; ++index)
+        {
+        value |= static_cast<std::uint64_t>(bytes[index]) << (8 * index);
+        }
+
+      return value;
+      }
+
+    }
+
+  }
+
+#endif
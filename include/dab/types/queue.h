@@ -32,14 +32,20 @@
 #ifndef DABCOMMON_TYPES_QUEUE
 #define DABCOMMON_TYPES_QUEUE
 
+#include "dab/system/memory.h"
+#include "dab/system/tracing.h"
+
 #include <algorithm>
 #include <array>
 #include <atomic>
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
+#include <limits>
 #include <memory>
 #include <mutex>
+#include <stdexcept>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -48,6 +54,8 @@
 namespace dab { namespace test { namespace type { namespace queue {
 struct enqueueing_tests;
 struct dequeueing_tests;
+struct pinning_tests;
+struct closing_tests;
 }}}}
 #endif
 
@@ -75,6 +83,17 @@ namespace dab
     //std::size_t constexpr kQueueDefaultGroupSize{512};
     std::size_t constexpr kQueueDefaultGroupSize{4};
 
+    /**
+     * The memory management strategies supported by the queue
+     *
+     * @since 1.0.3
+     */
+    enum struct queue_memory : std::uint8_t
+      {
+      growable, ///< The backing store grows whenever an element does not fit
+      pinned, ///< The backing store is prefaulted, locked into RAM and never grows
+      };
+
     /**
      * @internal
      * @brief A thread-safe block-allocated SPSC queue
@@ -106,15 +125,104 @@ namespace dab
        * @brief Construct an empty queue
        *
        * @param nofInitialGroups The number of block groups to preallocate during construction
+       * @param memory The memory management strategy of the queue. See queue::pin() for pinned queues.
        *
        * @author Felix Morgner
        * @since  1.0.1
        */
-      explicit queue(std::size_t const nofInitialGroups = 1)
+      explicit queue(std::size_t const nofInitialGroups = 1, queue_memory const memory = queue_memory::growable)
         : m_capacity{nofInitialGroups * alloc_size}
         , m_backingStore{allocate(m_capacity)}
         {
+        if(memory == queue_memory::pinned)
+          {
+          pin();
+          }
+        }
 
+      ~queue()
+        {
+        if(m_locked)
+          {
+          unlock_memory(m_backingStore.get(), m_capacity * element_size);
+          }
+        }
+
+      /**
+       * @brief Pin the backing store of the queue
+       *
+       * Pinning prefaults every page of the backing store and locks it into RAM. A pinned queue never grows. Instead,
+       * enqueueing blocks until enough space is available.
+       *
+       * @return @p true if the backing store could be locked into RAM, @p false otherwise. The queue is prefaulted and
+       * stops growing even if locking fails.
+       *
+       * @since 1.0.3
+       */
+      bool pin()
+        {
+        auto lock = std::unique_lock<std::mutex>{m_mutex};
+        auto const bytes = m_capacity * element_size;
+
+        m_pinned = true;
+        prefault(m_backingStore.get(), bytes);
+
+        if(!m_locked)
+          {
+          m_locked = lock_memory(m_backingStore.get(), bytes);
+          }
+
+        return m_locked;
+        }
+
+      /**
+       * @brief Bind the backing store of the queue to a NUMA node
+       *
+       * The binding is reapplied whenever the backing store grows. For best results, the producer and the consumer of
+       * the queue should run on the same node (see dab::colocate).
+       *
+       * @return @p true if the backing store was bound to the node, @p false otherwise
+       *
+       * @since 1.0.3
+       */
+      bool place_on_node(unsigned const node)
+        {
+        auto lock = std::unique_lock<std::mutex>{m_mutex};
+        m_node = static_cast<int>(node);
+        return bind_to_node(m_backingStore.get(), m_capacity * element_size, node);
+        }
+
+      /**
+       * @brief Check whether the queue is pinned
+       *
+       * @since 1.0.3
+       */
+      bool pinned() const
+        {
+        return m_pinned;
+        }
+
+      /**
+       * @brief Get the number of elements the queue can hold without growing
+       *
+       * @since 1.0.3
+       */
+      std::size_t capacity() const
+        {
+        return m_capacity;
+        }
+
+      /**
+       * @brief Get the number of elements that can be enqueued without blocking
+       *
+       * For queues that are not pinned, this is the maximum value of std::size_t, since they grow on demand.
+       *
+       * @since 1.0.3
+       */
+      std::size_t free_space() const
+        {
+        auto lock = std::unique_lock<std::mutex>{m_mutex};
+        return m_pinned ? m_capacity - m_size : std::numeric_limits<std::size_t>::max();
         }
 
       /**
@@ -151,7 +259,7 @@ namespace dab
       void enqueue(ValueType const & elem)
         {
         auto lock = std::unique_lock<std::mutex>{m_mutex};
-        do_enqueue(elem);
+        do_enqueue(lock, elem);
         }
 
       /**
@@ -165,7 +273,7 @@ namespace dab
       void enqueue(ValueType && elem)
         {
         auto lock = std::unique_lock<std::mutex>{m_mutex};
-        do_enqueue(std::move(elem));
+        do_enqueue(lock, std::move(elem));
         }
 
       /**
@@ -173,13 +281,15 @@ namespace dab
        *
        * @note This call blocks until the block can be enqueued.
        *
+       * @throws std::length_error if the queue is pinned and the block is larger than the capacity of the queue
+       *
        * @author Felix Morgner
        * @since  1.0.1
        */
       void enqueue(std::vector<ValueType> const & block)
         {
         auto lock = std::unique_lock<std::mutex>{m_mutex};
-        do_enqueue_block(block);
+        do_enqueue_block(lock, block);
         }
 
       /**
@@ -187,45 +297,68 @@ namespace dab
        *
        * @note This call blocks until the block can be enqueued.
        *
+       * @throws std::length_error if the queue is pinned and the block is larger than the capacity of the queue
+       *
        * @author Felix Morgner
        * @since  1.0.1
        */
       void enqueue(std::vector<ValueType> && block)
         {
         auto lock = std::unique_lock<std::mutex>{m_mutex};
-        do_enqueue_block(std::move(block));
+        do_enqueue_block(lock, std::move(block));
         }
 
       /**
        * @brief Dequeue a single element from the queue
        *
-       * @note This call blocks until the element can be dequeued
+       * @note This call blocks until the element can be dequeued or the queue is closed
+       *
+       * @return @p false if the queue was closed and is empty, @p true otherwise
        *
        * @author Felix Morgner
        * @since  1.0.1
        */
-      void dequeue(ValueType & target)
+      bool dequeue(ValueType & target)
         {
         auto lock = std::unique_lock<std::mutex>{m_mutex};
-        m_hasElements.wait(lock, [&]{ return m_size > 0; });
+        await(m_hasElements, lock, 1, false, [&]{ return m_size > 0 || m_closed; });
+
+        if(!m_size)
+          {
+          return false;
+          }
 
         do_dequeue(target);
+        return true;
         }
 
       /**
        * @brief Dequeue a block of elements from the queue
        *
-       * @note This call blocks until the block can be dequeued
+       * @note This call blocks until the block can be dequeued or the queue is closed
+       *
+       * @return @p false if the queue was closed and contains fewer elements than requested, @p true otherwise. If
+       * @p false is returned, @p block is left untouched and the remaining elements can be dequeued using
+       * try_dequeue(ValueType &).
+       *
+       * @throws std::length_error if the queue is pinned and the block is larger than the capacity of the queue
        *
        * @author Felix Morgner
        * @since  1.0.1
        */
-      void dequeue(std::vector<ValueType> & block)
+      bool dequeue(std::vector<ValueType> & block)
         {
         auto lock = std::unique_lock<std::mutex>{m_mutex};
-        m_hasElements.wait(lock, [&]{ return m_size >= block.size(); });
+        check_block_size(block.size());
+        await(m_hasElements, lock, block.size(), false, [&]{ return m_size >= block.size() || m_closed; });
+
+        if(m_size < block.size())
+          {
+          return false;
+          }
 
         do_dequeue_block(block);
+        return true;
         }
 
 
@@ -255,12 +388,15 @@ namespace dab
        *
        * @note This call never blocks
        *
+       * @throws std::length_error if the queue is pinned and the block is larger than the capacity of the queue
+       *
        * @author Felix Morgner
        * @since  1.0.1
        */
       bool try_dequeue(std::vector<ValueType> & block)
         {
         auto lock = std::unique_lock<std::mutex>{m_mutex};
+        check_block_size(block.size());
 
         if(m_size < block.size())
           {
@@ -280,12 +416,42 @@ namespace dab
         {
         auto lock = std::unique_lock<std::mutex>{m_mutex};
         m_size = m_current = 0;
+        m_hasSpace.notify_all();
+        }
+
+      /**
+       * @brief Close the queue
+       *
+       * Closing a queue signals the consumer that no more elements will arrive. Blocked dequeue operations return once
+       * the remaining elements do not suffice to satisfy them. Enqueue operations blocked on a full pinned queue return
+       * without enqueueing.
+       *
+       * @since 1.0.3
+       */
+      void close()
+        {
+        auto lock = std::unique_lock<std::mutex>{m_mutex};
+        m_closed = true;
+        m_hasElements.notify_all();
+        m_hasSpace.notify_all();
+        }
+
+      /**
+       * @brief Check whether the queue has been closed
+       *
+       * @since 1.0.3
+       */
+      bool closed() const
+        {
+        return m_closed;
         }
 
       private:
 #ifdef CUTE_TESTING
         friend dab::test::type::queue::enqueueing_tests;
         friend dab::test::type::queue::dequeueing_tests;
+        friend dab::test::type::queue::pinning_tests;
+        friend dab::test::type::queue::closing_tests;
 #endif
 
         /**
@@ -328,9 +494,16 @@ namespace dab
          * @since  1.0.1
          */
         template<typename ElementType>
-        void do_enqueue(ElementType && element)
+        void do_enqueue(std::unique_lock<std::mutex> & lock, ElementType && element)
           {
-          if(!available())
+          if(m_pinned)
+            {
+            if(!wait_for_space(lock, 1))
+              {
+              return;
+              }
+            }
+          else if(!available())
             {
             resize(m_capacity + alloc_size);
             }
@@ -338,6 +511,7 @@ namespace dab
           new (enqueue_pointer()) value_type{std::forward<ElementType>(element)};
 
           m_size++;
+          DABCOMMON_PROBE3(queue_enqueue, this, 1, m_size.load());
           m_hasElements.notify_one();
           }
 
@@ -352,13 +526,22 @@ namespace dab
          * @since  1.0.1
          */
         template<typename BlockType>
-        void do_enqueue_block(BlockType && block)
+        void do_enqueue_block(std::unique_lock<std::mutex> & lock, BlockType && block)
           {
           auto const blockSize = block.size();
-          auto const availableSlots = available();
 
-          if(blockSize >= availableSlots)
+          if(m_pinned)
             {
+            check_block_size(blockSize);
+
+            if(!wait_for_space(lock, blockSize))
+              {
+              return;
+              }
+            }
+          else if(blockSize >= available())
+            {
+            auto const availableSlots = available();
             auto factor = (blockSize - availableSlots) / alloc_size + 1;
             resize(m_capacity + factor * alloc_size);
             }
@@ -366,6 +549,7 @@ namespace dab
           do_enqueue_block_impl<ValueType>(std::forward<BlockType>(block));
 
           m_size += blockSize;
+          DABCOMMON_PROBE3(queue_enqueue, this, blockSize, m_size.load());
           m_hasElements.notify_one();
           }
 
@@ -416,11 +600,17 @@ namespace dab
 
           --m_size;
           ++m_current;
+          DABCOMMON_PROBE3(queue_dequeue, this, 1, m_size.load());
 
           if(m_current > m_capacity / 2)
             {
             shift_down();
             }
+
+          if(m_pinned)
+            {
+            m_hasSpace.notify_one();
+            }
           }
 
         /**
@@ -441,11 +631,17 @@ namespace dab
 
           m_size -= block.size();
           m_current += block.size();
+          DABCOMMON_PROBE3(queue_dequeue, this, block.size(), m_size.load());
 
           if(m_current > m_capacity / 2)
             {
             shift_down();
             }
+
+          if(m_pinned)
+            {
+            m_hasSpace.notify_one();
+            }
           }
 
         /**
@@ -477,6 +673,70 @@ namespace dab
             }
           }
 
+        /**
+         * @internal
+         * @brief Reject blocks that a pinned queue can never hold at once
+         *
+         * @throws std::length_error if the queue is pinned and @p elements exceeds its capacity
+         *
+         * @since 1.0.3
+         */
+        void check_block_size(std::size_t const elements) const
+          {
+          if(m_pinned && elements > m_capacity)
+            {
+            throw std::length_error{"block exceeds the capacity of the pinned queue"};
+            }
+          }
+
+        /**
+         * @internal
+         * @brief Wait until a pinned queue can hold the given number of additional elements
+         *
+         * @return @p false if the queue was closed before enough space became available, @p true otherwise
+         * @note This function expects the queue to be locked via @p lock
+         *
+         * @since 1.0.3
+         */
+        bool wait_for_space(std::unique_lock<std::mutex> & lock, std::size_t const elements)
+          {
+          await(m_hasSpace, lock, elements, true, [&]{ return m_capacity - m_size >= elements || m_closed; });
+
+          if(m_capacity - m_size < elements)
+            {
+            return false;
+            }
+
+          if(available() < elements)
+            {
+            shift_down();
+            }
+
+          return true;
+          }
+
+        /**
+         * @internal
+         * @brief Wait on a condition until the predicate holds, reporting the time spent blocked via tracepoints
+         *
+         * @note This function expects the queue to be locked via @p lock
+         *
+         * @since 1.0.3
+         */
+        template<typename PredicateType>
+        void await(std::condition_variable & condition, std::unique_lock<std::mutex> & lock, std::size_t const elements,
+                   bool const space, PredicateType && predicate)
+          {
+          if(predicate())
+            {
+            return;
+            }
+
+          DABCOMMON_PROBE3(queue_wait_start, this, elements, space);
+          condition.wait(lock, predicate);
+          DABCOMMON_PROBE3(queue_wait_end, this, elements, space);
+          }
+
         /**
          * @internal
          * @brief Move the contained items down to the lower end of the backing store
@@ -485,6 +745,7 @@ namespace dab
          */
         void shift_down()
           {
+          DABCOMMON_PROBE2(queue_shift_down, this, m_size.load());
           shift_down_impl<value_type>();
           m_current = 0;
           }
@@ -526,8 +787,14 @@ namespace dab
          */
         void resize(std::size_t const elements)
           {
+          DABCOMMON_PROBE3(queue_resize, this, m_capacity.load(), elements);
           auto newBackingStore = allocate(elements);
 
+          if(m_node >= 0)
+            {
+            bind_to_node(newBackingStore.get(), elements * element_size, static_cast<unsigned>(m_node));
+            }
+
           transfer<value_type>(newBackingStore);
 
           m_backingStore = std::move(newBackingStore);
@@ -625,6 +892,11 @@ namespace dab
         std::unique_ptr<char[]> m_backingStore{};
         std::mutex mutable m_mutex{};
         std::condition_variable m_hasElements{};
+        std::condition_variable m_hasSpace{};
+        std::atomic_bool m_pinned{};
+        std::atomic_bool m_closed{};
+        bool m_locked{};
+        int m_node{-1};
       };
 
     }
@@ -0,0 +1,377 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TYPES_REORDER_BUFFER
+#define DABCOMMON_TYPES_REORDER_BUFFER
+
+#include "dab/types/parse_status.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace dab
+  {
+
+  /**
+   * @brief A bounded buffer restoring the order of results produced in parallel
+   *
+   * Results of frames or CIFs that are processed in parallel are pushed from any number of producer threads, tagged
+   * with their sequence number. A single consumer pops them in strict sequence order. Pushing and popping results that
+   * are ready is lock-free. Only waiting for a missing result or for room in the window takes a lock.
+   *
+   * If a result does not arrive within the configured timeout while later results are already available, the consumer
+   * skips it and receives parse_status::segment_lost instead.
+   *
+   * @tparam ValueType The type of the buffered results. It must be default-constructible and move-assignable.
+   *
+   * @since 1.0.3
+   */
+  template<typename ValueType>
+  struct reorder_buffer
+    {
+    using value_type = ValueType;
+    using clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Construct a reorder buffer
+     *
+     * @param window The number of sequence numbers that may be in flight at once
+     * @param timeout The time to wait for a missing result before reporting it as lost
+     * @param first The sequence number of the first result
+     *
+     * @since 1.0.3
+     */
+    reorder_buffer(std::size_t const window, clock::duration const timeout, std::uint64_t const first = 0)
+      : m_window{window ? window : 1}
+      , m_timeout{timeout}
+      , m_slots{new slot[m_window]}
+      , m_next{first}
+      {
+
+      }
+
+    reorder_buffer(reorder_buffer const &) = delete;
+    reorder_buffer & operator=(reorder_buffer const &) = delete;
+
+    /**
+     * @brief Insert a result, waiting until its sequence number falls into the window
+     *
+     * @return @p true if the result was inserted, @p false if it arrived too late, is a duplicate, or the buffer was
+     * closed while waiting for room.
+     *
+     * @since 1.0.3
+     */
+    bool push(std::uint64_t const sequence, value_type value)
+      {
+      if(!in_window(sequence))
+        {
+        ++m_waitingProducers;
+        auto admitted = false;
+          {
+          auto lock = std::unique_lock<std::mutex>{m_mutex};
+          m_hasRoom.wait(lock, [&]{ return in_window(sequence) || m_closed; });
+          admitted = !m_closed && in_window(sequence);
+          }
+        --m_waitingProducers;
+
+        if(!admitted)
+          {
+          return false;
+          }
+        }
+
+      return insert(sequence, std::move(value));
+      }
+
+    /**
+     * @brief Insert a result if its sequence number falls into the window
+     *
+     * @return @p true if the result was inserted, @p false otherwise
+     *
+     * @since 1.0.3
+     */
+    bool try_push(std::uint64_t const sequence, value_type value)
+      {
+      return in_window(sequence) && insert(sequence, std::move(value));
+      }
+
+    /**
+     * @brief Release the next result in sequence order
+     *
+     * This call blocks until the next result is available, it is declared lost, or the buffer is closed and drained.
+     *
+     * @return parse_status::ok if @p target received the next result, parse_status::segment_lost if the next result was
+     * skipped (@p target is left untouched), or parse_status::incomplete if the buffer was closed and no more results
+     * will be released.
+     *
+     * @since 1.0.3
+     */
+    parse_status pop(value_type & target)
+      {
+      auto const sequence = m_next.load();
+
+      if(take(sequence, target, false))
+        {
+        return parse_status::ok;
+        }
+
+      auto waitStart = clock::now();
+      auto lock = std::unique_lock<std::mutex>{m_mutex};
+      m_consumerWaiting = true;
+
+      while(true)
+        {
+        if(take(sequence, target, true))
+          {
+          m_consumerWaiting = false;
+          return parse_status::ok;
+          }
+
+        auto const later = m_highest.load() > sequence + 1;
+
+        if(m_closed)
+          {
+          m_consumerWaiting = false;
+          return later ? skip(sequence) : parse_status::incomplete;
+          }
+
+        if(!later)
+          {
+          m_hasResult.wait(lock);
+          waitStart = clock::now();
+          continue;
+          }
+
+        if(clock::now() - waitStart >= m_timeout)
+          {
+          m_consumerWaiting = false;
+          return skip(sequence);
+          }
+
+        m_hasResult.wait_until(lock, waitStart + m_timeout);
+        }
+      }
+
+    /**
+     * @brief Close the buffer
+     *
+     * After closing, the consumer releases the remaining results, reporting gaps as lost without waiting for them.
+     *
+     * @since 1.0.3
+     */
+    void close()
+      {
+      auto lock = std::unique_lock<std::mutex>{m_mutex};
+      m_closed = true;
+      m_hasResult.notify_all();
+      m_hasRoom.notify_all();
+      }
+
+    /**
+     * @brief Get the sequence number of the next result to be released
+     *
+     * @since 1.0.3
+     */
+    std::uint64_t next() const
+      {
+      return m_next;
+      }
+
+    /**
+     * @brief Get the number of results that were declared lost
+     *
+     * @since 1.0.3
+     */
+    std::size_t lost() const
+      {
+      return m_lost;
+      }
+
+    /**
+     * @brief Get the number of results that were rejected because they arrived after being declared lost
+     *
+     * @since 1.0.3
+     */
+    std::size_t late() const
+      {
+      return m_late;
+      }
+
+    private:
+      static auto constexpr kEmpty = std::numeric_limits<std::uint64_t>::max();
+      static auto constexpr kWriting = kEmpty - 1;
+
+      /**
+       * @internal
+       * @brief A slot of the ring buffer
+       *
+       * The state of a slot is either kEmpty, kWriting, or the sequence number of the result it contains.
+       */
+      struct slot
+        {
+        std::atomic<std::uint64_t> state{kEmpty};
+        value_type value{};
+        };
+
+      bool in_window(std::uint64_t const sequence) const
+        {
+        return sequence < m_next.load() + m_window;
+        }
+
+      /**
+       * @internal
+       * @brief Store a result in its slot and wake the consumer if it is waiting
+       */
+      bool insert(std::uint64_t const sequence, value_type && value)
+        {
+        if(sequence < m_next.load())
+          {
+          ++m_late;
+          return false;
+          }
+
+        auto & target = m_slots[sequence % m_window];
+        auto state = target.state.load();
+
+        while(true)
+          {
+          if(state == sequence || state == kWriting)
+            {
+            return false;
+            }
+
+          if(state != kEmpty && state >= m_next.load())
+            {
+            return false;
+            }
+
+          if(target.state.compare_exchange_weak(state, kWriting))
+            {
+            break;
+            }
+          }
+
+        target.value = std::move(value);
+        target.state.store(sequence);
+
+        auto highest = m_highest.load();
+        while(highest < sequence + 1 && !m_highest.compare_exchange_weak(highest, sequence + 1));
+
+        if(m_consumerWaiting.load())
+          {
+          auto lock = std::unique_lock<std::mutex>{m_mutex};
+          m_hasResult.notify_one();
+          }
+
+        return true;
+        }
+
+      /**
+       * @internal
+       * @brief Take the result with the given sequence number, if it is available
+       */
+      bool take(std::uint64_t const sequence, value_type & target, bool const locked)
+        {
+        auto & source = m_slots[sequence % m_window];
+
+        if(source.state.load() != sequence)
+          {
+          return false;
+          }
+
+        target = std::move(source.value);
+        source.state.store(kEmpty);
+        advance(sequence, locked);
+        return true;
+        }
+
+      /**
+       * @internal
+       * @brief Declare the result with the given sequence number as lost
+       *
+       * @note This function expects the buffer to be locked
+       */
+      parse_status skip(std::uint64_t const sequence)
+        {
+        ++m_lost;
+        advance(sequence, true);
+        return parse_status::segment_lost;
+        }
+
+      /**
+       * @internal
+       * @brief Move the window past the given sequence number and wake producers waiting for room
+       */
+      void advance(std::uint64_t const sequence, bool const locked)
+        {
+        m_next.store(sequence + 1);
+
+        if(!m_waitingProducers.load())
+          {
+          return;
+          }
+
+        if(locked)
+          {
+          m_hasRoom.notify_all();
+          }
+        else
+          {
+          auto lock = std::unique_lock<std::mutex>{m_mutex};
+          m_hasRoom.notify_all();
+          }
+        }
+
+      std::size_t const m_window;
+      clock::duration const m_timeout;
+      std::unique_ptr<slot[]> m_slots;
+      std::atomic<std::uint64_t> m_next;
+      std::atomic<std::uint64_t> m_highest{};
+      std::atomic_size_t m_lost{};
+      std::atomic_size_t m_late{};
+      std::atomic_size_t m_waitingProducers{};
+      std::atomic_bool m_consumerWaiting{};
+      bool m_closed{};
+      std::mutex m_mutex{};
+      std::condition_variable m_hasResult{};
+      std::condition_variable m_hasRoom{};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TYPES_SEQLOCK
+#define DABCOMMON_TYPES_SEQLOCK
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace dab
+  {
+
+  /**
+   * @brief A single-writer, multi-reader container publishing snapshots of a trivially copyable value
+   *
+   * The writer never waits for readers. Readers retry whenever they observe a write in progress, so a snapshot is always
+   * a consistent copy of one stored value. The value is held in atomic words, which keeps concurrent reads and writes
+   * free of data races.
+   *
+   * @tparam ValueType The type of the published value
+   *
+   * @since 1.0.3
+   */
+  template<typename ValueType>
+  struct seqlock
+    {
+    static_assert(std::is_trivially_copyable<ValueType>::value, "Values published through a seqlock must be trivially copyable");
+
+    explicit seqlock(ValueType const & initial = ValueType{})
+      {
+      store(initial);
+      }
+
+    /**
+     * @brief Publish a new value
+     *
+     * Only a single thread may store values at any time.
+     */
+    void store(ValueType const & value)
+      {
+      auto words = std::array<std::uint64_t, kWords>{};
+      std::memcpy(words.data(), &value, sizeof(ValueType));
+
+      auto const sequence = m_sequence.load(std::memory_order_relaxed);
+      m_sequence.store(sequence + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+
+      for(std::size_t index{}; index < kWords; ++index)
+        {
+        m_words[index].store(words[index], std::memory_order_relaxed);
+        }
+
+      m_sequence.store(sequence + 2, std::memory_order_release);
+      }
+
+    /**
+     * @brief Get a consistent copy of the most recently published value
+     */
+    ValueType load() const
+      {
+      auto words = std::array<std::uint64_t, kWords>{};
+
+      for(;;)
+        {
+        auto const before = m_sequence.load(std::memory_order_acquire);
+        if(before & 1)
+          {
+          continue;
+          }
+
+        for(std::size_t index{}; index < kWords; ++index)
+          {
+          words[index] = m_words[index].load(std::memory_order_relaxed);
+          }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(m_sequence.load(std::memory_order_relaxed) == before)
+          {
+          break;
+          }
+        }
+
+      auto value = ValueType{};
+      std::memcpy(&value, words.data(), sizeof(ValueType));
+      return value;
+      }
+
+    /**
+     * @brief Get the number of values published so far, including the initial one
+     */
+    std::uint64_t version() const
+      {
+      return m_sequence.load(std::memory_order_acquire) / 2;
+      }
+
+    private:
+      static std::size_t constexpr kWords = (sizeof(ValueType) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+      std::atomic<std::uint64_t> m_sequence{};
+      std::array<std::atomic<std::uint64_t>, kWords> m_words{};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TYPES_SUBSCRIPTION_SET
+#define DABCOMMON_TYPES_SUBSCRIPTION_SET
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace dab
+  {
+
+  /**
+   * @brief The number of sub-channel identifiers available in an ensemble
+   *
+   * @since 1.0.3
+   */
+  std::size_t constexpr kSubchannelIds{64};
+
+  /**
+   * @brief A lock-free set of subscribed sub-channel identifiers
+   *
+   * Consumers may subscribe and unsubscribe from any thread while the decoding thread takes a snapshot once per CIF.
+   * Every sub-channel identifier is mapped onto one bit of an atomic 64-bit mask.
+   *
+   * @since 1.0.3
+   */
+  struct subscription_set
+    {
+    /**
+     * @brief Add a sub-channel to the set
+     *
+     * @return @p true iff the sub-channel was not subscribed before
+     * @throws std::out_of_range if @p id is not a valid sub-channel identifier
+     */
+    bool subscribe(std::size_t const id)
+      {
+      auto const bit = mask(id);
+      return !(m_mask.fetch_or(bit, std::memory_order_acq_rel) & bit);
+      }
+
+    /**
+     * @brief Remove a sub-channel from the set
+     *
+     * @return @p true iff the sub-channel was subscribed before
+     * @throws std::out_of_range if @p id is not a valid sub-channel identifier
+     */
+    bool unsubscribe(std::size_t const id)
+      {
+      auto const bit = mask(id);
+      return m_mask.fetch_and(~bit, std::memory_order_acq_rel) & bit;
+      }
+
+    /**
+     * @brief Check whether a sub-channel is subscribed
+     */
+    bool contains(std::size_t const id) const
+      {
+      return id < kSubchannelIds && (snapshot() & (std::uint64_t{1} << id));
+      }
+
+    /**
+     * @brief Get the current subscriptions as a bit mask, with bit n representing sub-channel n
+     */
+    std::uint64_t snapshot() const
+      {
+      return m_mask.load(std::memory_order_acquire);
+      }
+
+    private:
+      static std::uint64_t mask(std::size_t const id)
+        {
+        if(id >= kSubchannelIds)
+          {
+          throw std::out_of_range{"Invalid sub-channel identifier"};
+          }
+
+        return std::uint64_t{1} << id;
+        }
+
+      std::atomic<std::uint64_t> m_mask{};
+    };
+
+  }
+
+#endif
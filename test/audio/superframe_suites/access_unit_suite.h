@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_AUDIO_SUPERFRAME__ACCESS_UNIT_SUITE
+#define DABCOMMON_TEST_AUDIO_SUPERFRAME__ACCESS_UNIT_SUITE
+
+#include "header_suite.h"
+
+#include <dab/audio/superframe.h>
+#include <dab/types/parse_status.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace audio
+      {
+
+      namespace superframe
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(access_unit_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(access_unit_tests, Test)
+            suite += LOCAL_TEST(access_units_start_after_the_header);
+            suite += LOCAL_TEST(access_units_view_the_superframe);
+            suite += LOCAL_TEST(six_access_units_are_located);
+            suite += LOCAL_TEST(corrupted_access_unit_is_flagged_individually);
+            suite += LOCAL_TEST(units_are_replaced_on_every_superframe);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void access_units_start_after_the_header()
+            {
+            auto header = superframe_header{};
+            auto units = std::vector<access_unit>{};
+
+            auto const two = internal::build(0x20, {50, 60});
+            extract_access_units(two, header, units);
+            ASSERT_EQUAL(5, units[0].data.data() - two.data());
+
+            auto const three = internal::build(0x60, {50, 60, 70});
+            extract_access_units(three, header, units);
+            ASSERT_EQUAL(6, units[0].data.data() - three.data());
+
+            auto const four = internal::build(0x00, {50, 60, 70, 80});
+            extract_access_units(four, header, units);
+            ASSERT_EQUAL(8, units[0].data.data() - four.data());
+            }
+
+          void access_units_view_the_superframe()
+            {
+            auto const bytes = internal::build(0x00, {50, 60, 70, 80});
+            auto header = superframe_header{};
+            auto units = std::vector<access_unit>{};
+
+            ASSERT_EQUAL(parse_status::ok, extract_access_units(bytes, header, units));
+            ASSERT_EQUAL(4u, units.size());
+            ASSERT_EQUAL(68u, units[2].data.size());
+            ASSERT_EQUAL(32, static_cast<int>(units[2].data[0]));
+            ASSERT_EQUAL(bytes.data() + 8 + 50 + 60, units[2].data.data());
+            }
+
+          void six_access_units_are_located()
+            {
+            auto const bytes = internal::build(0x40, {30, 31, 32, 33, 34, 35});
+            auto header = superframe_header{};
+            auto units = std::vector<access_unit>{};
+
+            ASSERT_EQUAL(parse_status::ok, extract_access_units(bytes, header, units));
+            ASSERT_EQUAL(6u, units.size());
+            ASSERT_EQUAL(11, units[0].data.data() - bytes.data());
+            for(std::size_t index{}; index < units.size(); ++index)
+              {
+              ASSERT_EQUAL(parse_status::ok, units[index].status);
+              ASSERT_EQUAL(28 + index, units[index].data.size());
+              ASSERT_EQUAL(static_cast<int>(index * 16), static_cast<int>(units[index].data[0]));
+              }
+            }
+
+          void corrupted_access_unit_is_flagged_individually()
+            {
+            auto bytes = internal::build(0x00, {50, 60, 70, 80});
+            bytes[8 + 50 + 3] ^= 0x01;
+            auto header = superframe_header{};
+            auto units = std::vector<access_unit>{};
+
+            ASSERT_EQUAL(parse_status::ok, extract_access_units(bytes, header, units));
+            ASSERT_EQUAL(parse_status::ok, units[0].status);
+            ASSERT_EQUAL(parse_status::invalid_crc, units[1].status);
+            ASSERT_EQUAL(parse_status::ok, units[2].status);
+            ASSERT_EQUAL(parse_status::ok, units[3].status);
+            }
+
+          void units_are_replaced_on_every_superframe()
+            {
+            auto header = superframe_header{};
+            auto units = std::vector<access_unit>{};
+
+            extract_access_units(internal::build(0x00, {50, 60, 70, 80}), header, units);
+            extract_access_units(internal::build(0x20, {50, 60}), header, units);
+            ASSERT_EQUAL(2u, units.size());
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
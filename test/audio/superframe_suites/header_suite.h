@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_AUDIO_SUPERFRAME__HEADER_SUITE
+#define DABCOMMON_TEST_AUDIO_SUPERFRAME__HEADER_SUITE
+
+#include <dab/audio/superframe.h>
+#include <dab/fec/crc.h>
+#include <dab/types/parse_status.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace audio
+      {
+
+      namespace superframe
+        {
+
+        namespace internal
+          {
+
+          /**
+           * Build a superframe with the given header flags, consisting of access units of the given sizes (including
+           * their CRC) filled with a counting pattern.
+           */
+          inline std::vector<std::uint8_t> build(std::uint8_t const flags, std::vector<std::size_t> const & sizes)
+            {
+            auto const headerBytes = 3 + ((sizes.size() - 1) * 12 + 7) / 8;
+            auto bytes = std::vector<std::uint8_t>(headerBytes);
+            bytes[2] = flags;
+
+            auto start = headerBytes;
+            for(std::size_t index{}; index < sizes.size(); ++index)
+              {
+              if(index)
+                {
+                auto const bit = (index - 1) * 12;
+                if(bit % 8)
+                  {
+                  bytes[3 + bit / 8] |= static_cast<std::uint8_t>(start >> 8);
+                  bytes[4 + bit / 8] = static_cast<std::uint8_t>(start);
+                  }
+                else
+                  {
+                  bytes[3 + bit / 8] = static_cast<std::uint8_t>(start >> 4);
+                  bytes[4 + bit / 8] = static_cast<std::uint8_t>(start << 4);
+                  }
+                }
+
+              for(std::size_t offset{}; offset < sizes[index] - 2; ++offset)
+                {
+                bytes.push_back(static_cast<std::uint8_t>(index * 16 + offset));
+                }
+
+              auto const crc = static_cast<std::uint16_t>(~dab::crc16(bytes.data() + start, sizes[index] - 2));
+              bytes.push_back(static_cast<std::uint8_t>(crc >> 8));
+              bytes.push_back(static_cast<std::uint8_t>(crc & 0xFF));
+              start += sizes[index];
+              }
+
+            bytes.resize(std::max<std::size_t>(bytes.size(), 11));
+            auto const code = dab::internal::firecode(bytes.data() + 2);
+            bytes[0] = static_cast<std::uint8_t>(code >> 8);
+            bytes[1] = static_cast<std::uint8_t>(code & 0xFF);
+            return bytes;
+            }
+
+          }
+
+        CUTE_DESCRIPTIVE_STRUCT(header_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(header_tests, Test)
+            suite += LOCAL_TEST(access_unit_count_depends_on_rate_and_sbr);
+            suite += LOCAL_TEST(audio_parameters_are_parsed);
+            suite += LOCAL_TEST(corrupted_header_fails_the_firecode);
+            suite += LOCAL_TEST(short_superframe_is_incomplete);
+            suite += LOCAL_TEST(inconsistent_start_addresses_are_rejected);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void access_unit_count_depends_on_rate_and_sbr()
+            {
+            ASSERT_EQUAL(4u, (superframe_header{false, false, false, false, 0}.access_units()));
+            ASSERT_EQUAL(2u, (superframe_header{false, true, false, false, 0}.access_units()));
+            ASSERT_EQUAL(6u, (superframe_header{true, false, false, false, 0}.access_units()));
+            ASSERT_EQUAL(3u, (superframe_header{true, true, false, false, 0}.access_units()));
+            }
+
+          void audio_parameters_are_parsed()
+            {
+            auto const bytes = internal::build(0x79, {100, 120, 140});
+            auto header = superframe_header{};
+            auto units = std::vector<access_unit>{};
+
+            ASSERT_EQUAL(parse_status::ok, extract_access_units(bytes, header, units));
+            ASSERT(header.dac_rate);
+            ASSERT(header.sbr);
+            ASSERT(header.stereo);
+            ASSERT(header.parametric_stereo);
+            ASSERT_EQUAL(1, static_cast<int>(header.mpeg_surround));
+            ASSERT_EQUAL(48000u, header.sample_rate());
+            }
+
+          void corrupted_header_fails_the_firecode()
+            {
+            auto bytes = internal::build(0x00, {100, 100, 100, 100});
+            bytes[4] ^= 0x10;
+            auto header = superframe_header{};
+            auto units = std::vector<access_unit>{};
+
+            ASSERT_EQUAL(parse_status::invalid_crc, extract_access_units(bytes, header, units));
+            ASSERT(units.empty());
+            }
+
+          void short_superframe_is_incomplete()
+            {
+            auto const bytes = std::vector<std::uint8_t>(10);
+            auto header = superframe_header{};
+            auto units = std::vector<access_unit>{};
+
+            ASSERT_EQUAL(parse_status::incomplete, extract_access_units(bytes, header, units));
+            }
+
+          void inconsistent_start_addresses_are_rejected()
+            {
+            auto bytes = internal::build(0x20, {100, 100});
+            bytes[3] = 0xFF;
+            bytes[4] = 0xF0;
+            auto const code = dab::internal::firecode(bytes.data() + 2);
+            bytes[0] = static_cast<std::uint8_t>(code >> 8);
+            bytes[1] = static_cast<std::uint8_t>(code & 0xFF);
+            auto header = superframe_header{};
+            auto units = std::vector<access_unit>{};
+
+            ASSERT_EQUAL(parse_status::invalid_address, extract_access_units(bytes, header, units));
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_ENSEMBLE_ENSEMBLE_SNAPSHOT__SERIALIZATION_SUITE
+#define DABCOMMON_TEST_ENSEMBLE_ENSEMBLE_SNAPSHOT__SERIALIZATION_SUITE
+
+#include <dab/ensemble/ensemble_snapshot.h>
+#include <dab/types/parse_status.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace ensemble
+      {
+
+      namespace ensemble_snapshot
+        {
+
+        inline dab::label make_label(char const * const text, std::uint16_t const mask)
+          {
+          auto result = dab::label{{}, mask};
+          result.text.fill(' ');
+          for(std::size_t index{}; text[index] && index < result.text.size(); ++index)
+            {
+            result.text[index] = text[index];
+            }
+
+          return result;
+          }
+
+        inline dab::ensemble_snapshot make_snapshot()
+          {
+          return {
+            227360,
+            0x10E1,
+            make_label("DR Deutschland", 0xF000),
+            {
+              {0xD210, make_label("Deutschlandfunk", 0xFF00)},
+              {0xD220, make_label("DLF Kultur", 0xF000)},
+            },
+            {
+              {1, 0x02, 0, 72},
+              {2, 0x83, 72, 54},
+            },
+            {
+              {0xD210, 1, 63, true},
+              {0xD220, 2, 63, true},
+            },
+          };
+          }
+
+        CUTE_DESCRIPTIVE_STRUCT(serialization_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(serialization_tests, Test)
+            suite += LOCAL_TEST(serialized_snapshot_has_fixed_record_layout);
+            suite += LOCAL_TEST(serialized_snapshot_round_trips);
+            suite += LOCAL_TEST(view_reads_records_in_place);
+            suite += LOCAL_TEST(corrupted_snapshot_is_rejected);
+            suite += LOCAL_TEST(truncated_snapshot_is_incomplete);
+            suite += LOCAL_TEST(foreign_bytes_are_rejected);
+            suite += LOCAL_TEST(path_is_keyed_by_frequency_and_eid);
+            suite += LOCAL_TEST(stored_snapshot_is_mapped_back);
+            suite += LOCAL_TEST(missing_snapshot_is_incomplete);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void serialized_snapshot_has_fixed_record_layout()
+            {
+            auto const bytes = dab::serialize(make_snapshot());
+
+            ASSERT_EQUAL(40 + 2 * 24 + 2 * 8 + 2 * 8 + 2, static_cast<int>(bytes.size()));
+            ASSERT_EQUAL('D', static_cast<char>(bytes[0]));
+            ASSERT_EQUAL(0xE1, static_cast<int>(bytes[6]));
+            ASSERT_EQUAL(0x10, static_cast<int>(bytes[7]));
+            }
+
+          void serialized_snapshot_round_trips()
+            {
+            auto const original = make_snapshot();
+            auto const bytes = dab::serialize(original);
+            auto view = dab::snapshot_view{};
+
+            ASSERT_EQUAL(dab::parse_status::ok, view.open(bytes.data(), bytes.size()));
+
+            auto const restored = view.snapshot();
+            ASSERT_EQUAL(original.frequency, restored.frequency);
+            ASSERT_EQUAL(original.eid, restored.eid);
+            ASSERT(original.label.text == restored.label.text);
+            ASSERT_EQUAL(original.label.short_mask, restored.label.short_mask);
+            ASSERT_EQUAL(original.services.size(), restored.services.size());
+            ASSERT_EQUAL(original.services[1].id, restored.services[1].id);
+            ASSERT(original.services[1].label.text == restored.services[1].label.text);
+            ASSERT_EQUAL(original.subchannels[1].protection, restored.subchannels[1].protection);
+            ASSERT_EQUAL(original.subchannels[1].start, restored.subchannels[1].start);
+            ASSERT_EQUAL(original.subchannels[1].size, restored.subchannels[1].size);
+            ASSERT_EQUAL(original.components[1].service, restored.components[1].service);
+            ASSERT_EQUAL(original.components[1].type, restored.components[1].type);
+            ASSERT(restored.components[1].primary);
+            }
+
+          void view_reads_records_in_place()
+            {
+            auto const bytes = dab::serialize(make_snapshot());
+            auto view = dab::snapshot_view{};
+            view.open(bytes.data(), bytes.size());
+
+            ASSERT_EQUAL(2u, view.subchannels());
+            ASSERT_EQUAL(72, static_cast<int>(view.subchannel(1).start));
+            ASSERT_EQUAL(2, static_cast<int>(view.component(1).subchannel));
+
+            auto const descriptors = view.snapshot().subchannel_descriptors();
+            ASSERT_EQUAL(2u, descriptors.size());
+            ASSERT_EQUAL(54u, descriptors[1].size);
+            }
+
+          void corrupted_snapshot_is_rejected()
+            {
+            auto bytes = dab::serialize(make_snapshot());
+            bytes[50] ^= 0x01;
+            auto view = dab::snapshot_view{};
+
+            ASSERT_EQUAL(dab::parse_status::invalid_crc, view.open(bytes.data(), bytes.size()));
+            }
+
+          void truncated_snapshot_is_incomplete()
+            {
+            auto const bytes = dab::serialize(make_snapshot());
+            auto view = dab::snapshot_view{};
+
+            ASSERT_EQUAL(dab::parse_status::incomplete, view.open(bytes.data(), bytes.size() - 1));
+            ASSERT_EQUAL(dab::parse_status::incomplete, view.open(bytes.data(), 10));
+            }
+
+          void foreign_bytes_are_rejected()
+            {
+            auto bytes = dab::serialize(make_snapshot());
+            bytes[4] = 0x7F;
+            auto view = dab::snapshot_view{};
+
+            ASSERT_EQUAL(dab::parse_status::invalid_address, view.open(bytes.data(), bytes.size()));
+            }
+
+          void path_is_keyed_by_frequency_and_eid()
+            {
+            ASSERT_EQUAL(std::string{"/cache/227360-10E1.ensemble"}, dab::snapshot_path("/cache", 227360, 0x10E1));
+            ASSERT_EQUAL(std::string{"/cache/178352-00A1.ensemble"}, dab::snapshot_path("/cache", 178352, 0xA1));
+            }
+
+          void stored_snapshot_is_mapped_back()
+            {
+            auto const directory = std::string{"."};
+            auto const original = make_snapshot();
+            ASSERT(dab::store_snapshot(directory, original));
+
+              {
+              dab::mapped_snapshot const mapped{directory, original.frequency, original.eid};
+              ASSERT_EQUAL(dab::parse_status::ok, mapped.status());
+              ASSERT_EQUAL(original.services[0].id, mapped.view().service(0).id);
+              }
+
+            std::remove(dab::snapshot_path(directory, original.frequency, original.eid).c_str());
+            }
+
+          void missing_snapshot_is_incomplete()
+            {
+            dab::mapped_snapshot const mapped{".", 1, 0xFFFF};
+            ASSERT_EQUAL(dab::parse_status::incomplete, mapped.status());
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
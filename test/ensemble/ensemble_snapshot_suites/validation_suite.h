@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_ENSEMBLE_ENSEMBLE_SNAPSHOT__VALIDATION_SUITE
+#define DABCOMMON_TEST_ENSEMBLE_ENSEMBLE_SNAPSHOT__VALIDATION_SUITE
+
+#include "serialization_suite.h"
+
+#include <dab/ensemble/ensemble_snapshot.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace ensemble
+      {
+
+      namespace ensemble_snapshot
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(validation_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(validation_tests, Test)
+            suite += LOCAL_TEST(snapshot_is_confirmed_once_all_subchannels_match);
+            suite += LOCAL_TEST(reorganized_subchannel_makes_snapshot_stale);
+            suite += LOCAL_TEST(unknown_subchannel_makes_snapshot_stale);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void snapshot_is_confirmed_once_all_subchannels_match()
+            {
+            auto validator = dab::snapshot_validator{make_snapshot()};
+
+            ASSERT(validator.check({2, 0x83, 72, 54}));
+            ASSERT(!validator.confirmed());
+            ASSERT(validator.check({1, 0x02, 0, 72}));
+            ASSERT(validator.confirmed());
+            ASSERT(!validator.stale());
+            }
+
+          void reorganized_subchannel_makes_snapshot_stale()
+            {
+            auto validator = dab::snapshot_validator{make_snapshot()};
+
+            validator.check({1, 0x02, 0, 72});
+            ASSERT(!validator.check({2, 0x83, 72, 84}));
+            ASSERT(validator.stale());
+            ASSERT(!validator.confirmed());
+            }
+
+          void unknown_subchannel_makes_snapshot_stale()
+            {
+            auto validator = dab::snapshot_validator{make_snapshot()};
+
+            ASSERT(!validator.check({7, 0x02, 200, 24}));
+            ASSERT(validator.stale());
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_FEC_CRC__CHECKSUM_SUITE
+#define DABCOMMON_TEST_FEC_CRC__CHECKSUM_SUITE
+
+#include <dab/fec/crc.h>
+#include <dab/fec/energy_dispersal.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace fec
+      {
+
+      namespace crc
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(checksum_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(checksum_tests, Test)
+            suite += LOCAL_TEST(checksum_of_the_check_string_matches_the_reference);
+            suite += LOCAL_TEST(checksum_can_be_continued_over_several_blocks);
+            suite += LOCAL_TEST(block_with_complemented_checksum_is_valid);
+            suite += LOCAL_TEST(block_with_flipped_bit_is_invalid);
+            suite += LOCAL_TEST(block_shorter_than_the_checksum_is_invalid);
+            suite += LOCAL_TEST(energy_dispersal_sequence_starts_with_the_reference_bits);
+            suite += LOCAL_TEST(applying_energy_dispersal_twice_restores_the_bits);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void checksum_of_the_check_string_matches_the_reference()
+            {
+            ASSERT_EQUAL(0x29B1, dab::crc16(m_check.data(), m_check.size()));
+            }
+
+          void checksum_can_be_continued_over_several_blocks()
+            {
+            auto const head = dab::crc16(m_check.data(), 4);
+
+            ASSERT_EQUAL(dab::crc16(m_check.data(), m_check.size()), dab::crc16(m_check.data() + 4, m_check.size() - 4, head));
+            }
+
+          void block_with_complemented_checksum_is_valid()
+            {
+            ASSERT(dab::crc16_valid(m_protected.data(), m_protected.size()));
+            }
+
+          void block_with_flipped_bit_is_invalid()
+            {
+            auto corrupted = m_protected;
+            corrupted[3] ^= 0x10;
+
+            ASSERT(!dab::crc16_valid(corrupted.data(), corrupted.size()));
+            }
+
+          void block_shorter_than_the_checksum_is_invalid()
+            {
+            ASSERT(!dab::crc16_valid(m_protected.data(), 1));
+            }
+
+          void energy_dispersal_sequence_starts_with_the_reference_bits()
+            {
+            auto const expected = std::vector<std::uint8_t>{0, 0, 0, 0, 0, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 0};
+
+            ASSERT_EQUAL(expected, dab::energy_dispersal_sequence(16));
+            }
+
+          void applying_energy_dispersal_twice_restores_the_bits()
+            {
+            auto const bits = std::vector<std::uint8_t>{1, 0, 1, 1, 0, 0, 1, 0, 1, 1};
+            auto scrambled = bits;
+
+            dab::apply_energy_dispersal(scrambled);
+            ASSERT(bits != scrambled);
+
+            dab::apply_energy_dispersal(scrambled);
+            ASSERT_EQUAL(bits, scrambled);
+            }
+
+          private:
+            std::vector<std::uint8_t> const m_check{'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+            std::vector<std::uint8_t> const m_protected{'1', '2', '3', '4', '5', '6', '7', '8', '9', 0xD6, 0x4E};
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
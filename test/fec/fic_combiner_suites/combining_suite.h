@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_FEC_FIC_COMBINER__COMBINING_SUITE
+#define DABCOMMON_TEST_FEC_FIC_COMBINER__COMBINING_SUITE
+
+#include <dab/constants/transmission_modes.h>
+#include <dab/fec/crc.h>
+#include <dab/fec/energy_dispersal.h>
+#include <dab/fec/fic_combiner.h>
+#include <dab/fec/viterbi.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace fec
+      {
+
+      namespace fic_combiner
+        {
+
+        namespace internal
+          {
+
+          inline std::vector<std::uint8_t> fic_codeword(std::vector<std::uint8_t> & fibs, unsigned const seed)
+            {
+            auto generator = std::mt19937{seed};
+            auto bits = std::vector<std::uint8_t>{};
+
+            fibs.resize(3 * kFibBytes);
+            for(std::size_t fib{}; fib < 3; ++fib)
+              {
+              auto const begin = &fibs[fib * kFibBytes];
+              for(std::size_t index{}; index < kFibBytes - 2; ++index)
+                {
+                begin[index] = static_cast<std::uint8_t>(generator());
+                }
+
+              auto const crc = static_cast<std::uint16_t>(~dab::crc16(begin, kFibBytes - 2));
+              begin[kFibBytes - 2] = crc >> 8;
+              begin[kFibBytes - 1] = crc & 0xFF;
+              }
+
+            for(auto const byte : fibs)
+              {
+              for(auto bit = 8; bit-- > 0;)
+                {
+                bits.push_back((byte >> bit) & 1);
+                }
+              }
+
+            dab::apply_energy_dispersal(bits);
+            return dab::convolutional_encode(bits);
+            }
+
+          inline std::vector<float> transmit(std::vector<std::uint8_t> const & codeword, std::mt19937 & generator, float const deviation)
+            {
+            auto noise = std::normal_distribution<float>{0.0f, deviation};
+            auto soft = std::vector<float>{};
+
+            for(auto const bit : codeword)
+              {
+              soft.push_back((bit ? 1.0f : -1.0f) + (deviation > 0.0f ? noise(generator) : 0.0f));
+              }
+
+            return soft;
+            }
+
+          inline bool all_valid(std::vector<pair_status_vector_t> const & fibs)
+            {
+            for(auto const & fib : fibs)
+              {
+              if(fib.first != parse_status::ok)
+                {
+                return false;
+                }
+              }
+
+            return true;
+            }
+
+          }
+
+        CUTE_DESCRIPTIVE_STRUCT(combining_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(combining_tests, Test)
+            suite += LOCAL_TEST(clean_codeword_yields_all_fibs);
+            suite += LOCAL_TEST(erased_codeword_yields_invalid_crcs);
+            suite += LOCAL_TEST(weak_codewords_are_recovered_by_combining);
+            suite += LOCAL_TEST(depth_of_one_disables_combining);
+            suite += LOCAL_TEST(partially_decoded_codeword_is_accumulated);
+            suite += LOCAL_TEST(cif_outside_of_the_frame_throws);
+            suite += LOCAL_TEST(codeword_of_wrong_size_throws);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void clean_codeword_yields_all_fibs()
+            {
+            auto combiner = dab::fic_combiner{kTransmissionMode1};
+            auto const fibs = combiner.decode(0, internal::transmit(m_codeword, m_generator, 0.0f));
+
+            ASSERT_EQUAL(3u, fibs.size());
+            for(std::size_t fib{}; fib < fibs.size(); ++fib)
+              {
+              ASSERT(fibs[fib].first == parse_status::ok);
+              ASSERT_EQUAL(byte_vector_t(m_fibs.begin() + fib * kFibBytes, m_fibs.begin() + (fib + 1) * kFibBytes), fibs[fib].second);
+              }
+            }
+
+          void erased_codeword_yields_invalid_crcs()
+            {
+            auto combiner = dab::fic_combiner{kTransmissionMode1};
+            auto const fibs = combiner.decode(1, std::vector<float>(m_codeword.size()));
+
+            for(auto const & fib : fibs)
+              {
+              ASSERT(fib.first == parse_status::invalid_crc);
+              }
+            }
+
+          void weak_codewords_are_recovered_by_combining()
+            {
+            auto combiner = dab::fic_combiner{kTransmissionMode1};
+            auto frames = 0;
+
+            while(!internal::all_valid(combiner.decode(2, internal::transmit(m_codeword, m_generator, 1.6f))) && frames < 8)
+              {
+              ++frames;
+              }
+
+            ASSERT(frames > 0);
+            ASSERT(frames < 8);
+            ASSERT(combiner.recovered() > 0);
+            }
+
+          void depth_of_one_disables_combining()
+            {
+            auto combiner = dab::fic_combiner{kTransmissionMode1, 1};
+
+            for(auto frame = 0; frame < 8; ++frame)
+              {
+              combiner.decode(3, internal::transmit(m_codeword, m_generator, 1.6f));
+              }
+
+            ASSERT_EQUAL(0u, combiner.recovered());
+            }
+
+          void partially_decoded_codeword_is_accumulated()
+            {
+            auto combiner = dab::fic_combiner{kTransmissionMode1};
+            auto partial = internal::transmit(m_codeword, m_generator, 0.0f);
+            std::fill(partial.begin() + (kFibBytes + 4) * 8 * 4, partial.end(), 0.0f);
+
+            auto const first = combiner.decode(0, partial);
+
+            ASSERT(first[0].first == parse_status::ok);
+            ASSERT(first[1].first == parse_status::invalid_crc);
+            ASSERT(first[2].first == parse_status::invalid_crc);
+
+            auto const second = combiner.decode(0, std::vector<float>(m_codeword.size()));
+
+            ASSERT(second[0].first == parse_status::ok);
+            ASSERT(second[1].first == parse_status::invalid_crc);
+            ASSERT_EQUAL(1u, combiner.recovered());
+            }
+
+          void cif_outside_of_the_frame_throws()
+            {
+            auto combiner = dab::fic_combiner{kTransmissionMode1};
+
+            ASSERT_THROWS(combiner.decode(4, internal::transmit(m_codeword, m_generator, 0.0f)), std::out_of_range);
+            }
+
+          void codeword_of_wrong_size_throws()
+            {
+            auto combiner = dab::fic_combiner{kTransmissionMode1};
+
+            ASSERT_THROWS(combiner.decode(0, std::vector<float>(100)), std::invalid_argument);
+            }
+
+          private:
+            std::vector<std::uint8_t> m_fibs{};
+            std::vector<std::uint8_t> const m_codeword = internal::fic_codeword(m_fibs, 7);
+            std::mt19937 m_generator{11};
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_FEC_SELECTIVE_DEINTERLEAVER__DEINTERLEAVING_SUITE
+#define DABCOMMON_TEST_FEC_SELECTIVE_DEINTERLEAVER__DEINTERLEAVING_SUITE
+
+#include <dab/fec/selective_deinterleaver.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace fec
+      {
+
+      namespace selective_deinterleaver
+        {
+
+        namespace internal
+          {
+
+          inline float logical_bit(long const frame, std::size_t const index)
+            {
+            return frame < 0 ? -1.0f : static_cast<float>(frame * 100000 + index);
+            }
+
+          inline std::vector<float> interleaved_cif(long const cif)
+            {
+            auto bits = std::vector<float>(kCifCapacityUnits * kCapacityUnitBits);
+
+            for(std::size_t index{}; index < bits.size(); ++index)
+              {
+              bits[index] = logical_bit(cif - dab::internal::kTimeInterleavingDelays[index % kTimeInterleavingDepth], index);
+              }
+
+            return bits;
+            }
+
+          }
+
+        CUTE_DESCRIPTIVE_STRUCT(deinterleaving_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(deinterleaving_tests, Test)
+            suite += LOCAL_TEST(nothing_is_delivered_before_warm_up);
+            suite += LOCAL_TEST(unsubscribed_subchannels_are_skipped);
+            suite += LOCAL_TEST(subscribed_subchannel_is_deinterleaved);
+            suite += LOCAL_TEST(late_subscription_is_warm_immediately);
+            suite += LOCAL_TEST(subchannel_outside_of_the_cif_throws);
+            suite += LOCAL_TEST(cif_of_wrong_size_throws);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void nothing_is_delivered_before_warm_up()
+            {
+            dab::selective_deinterleaver deinterleaver{};
+            deinterleaver.configure(m_subchannels);
+            deinterleaver.subscriptions().subscribe(3);
+
+            for(long cif{}; cif < 15; ++cif)
+              {
+              ASSERT_EQUAL(0u, deinterleaver.push(internal::interleaved_cif(cif), [](subchannel_descriptor const &, std::vector<float> const &){}));
+              }
+
+            ASSERT(!deinterleaver.warm());
+            }
+
+          void unsubscribed_subchannels_are_skipped()
+            {
+            dab::selective_deinterleaver deinterleaver{};
+            deinterleaver.configure(m_subchannels);
+
+            auto delivered = std::size_t{};
+            for(long cif{}; cif < 20; ++cif)
+              {
+              delivered += deinterleaver.push(internal::interleaved_cif(cif), [](subchannel_descriptor const &, std::vector<float> const &){});
+              }
+
+            ASSERT(deinterleaver.warm());
+            ASSERT_EQUAL(0u, delivered);
+            }
+
+          void subscribed_subchannel_is_deinterleaved()
+            {
+            dab::selective_deinterleaver deinterleaver{};
+            deinterleaver.configure(m_subchannels);
+            deinterleaver.subscriptions().subscribe(3);
+
+            for(long cif{}; cif < 18; ++cif)
+              {
+              deinterleaver.push(internal::interleaved_cif(cif), [&](subchannel_descriptor const & subchannel, std::vector<float> const & bits){
+                ASSERT_EQUAL(3u, subchannel.id);
+                ASSERT_EQUAL(12 * kCapacityUnitBits, bits.size());
+                for(std::size_t index{}; index < bits.size(); ++index)
+                  {
+                  ASSERT_EQUAL(internal::logical_bit(cif - 15, 100 * kCapacityUnitBits + index), bits[index]);
+                  }
+              });
+              }
+            }
+
+          void late_subscription_is_warm_immediately()
+            {
+            dab::selective_deinterleaver deinterleaver{};
+            deinterleaver.configure(m_subchannels);
+
+            for(long cif{}; cif < 30; ++cif)
+              {
+              deinterleaver.push(internal::interleaved_cif(cif), [](subchannel_descriptor const &, std::vector<float> const &){});
+              }
+
+            deinterleaver.subscriptions().subscribe(9);
+
+            auto first = 0.0f;
+            ASSERT_EQUAL(1u, deinterleaver.push(internal::interleaved_cif(30), [&](subchannel_descriptor const &, std::vector<float> const & bits){
+              first = bits[1];
+            }));
+            ASSERT_EQUAL(internal::logical_bit(15, 1), first);
+            }
+
+          void subchannel_outside_of_the_cif_throws()
+            {
+            dab::selective_deinterleaver deinterleaver{};
+
+            ASSERT_THROWS(deinterleaver.configure({{1, 860, 8}}), std::out_of_range);
+            }
+
+          void cif_of_wrong_size_throws()
+            {
+            dab::selective_deinterleaver deinterleaver{};
+
+            ASSERT_THROWS(deinterleaver.push(std::vector<float>(10), [](subchannel_descriptor const &, std::vector<float> const &){}), std::invalid_argument);
+            }
+
+          private:
+            std::vector<subchannel_descriptor> const m_subchannels{{3, 100, 12}, {9, 0, 4}};
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
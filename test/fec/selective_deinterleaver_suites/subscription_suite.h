@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_FEC_SELECTIVE_DEINTERLEAVER__SUBSCRIPTION_SUITE
+#define DABCOMMON_TEST_FEC_SELECTIVE_DEINTERLEAVER__SUBSCRIPTION_SUITE
+
+#include <dab/types/subscription_set.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace fec
+      {
+
+      namespace selective_deinterleaver
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(subscription_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(subscription_tests, Test)
+            suite += LOCAL_TEST(new_set_is_empty);
+            suite += LOCAL_TEST(subscribing_reports_new_subscriptions);
+            suite += LOCAL_TEST(unsubscribing_reports_removed_subscriptions);
+            suite += LOCAL_TEST(snapshot_maps_identifiers_to_bits);
+            suite += LOCAL_TEST(invalid_identifier_throws);
+            suite += LOCAL_TEST(concurrent_subscriptions_are_not_lost);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void new_set_is_empty()
+            {
+            subscription_set subscriptions{};
+
+            ASSERT_EQUAL(0u, subscriptions.snapshot());
+            ASSERT(!subscriptions.contains(0));
+            }
+
+          void subscribing_reports_new_subscriptions()
+            {
+            subscription_set subscriptions{};
+
+            ASSERT(subscriptions.subscribe(5));
+            ASSERT(!subscriptions.subscribe(5));
+            ASSERT(subscriptions.contains(5));
+            }
+
+          void unsubscribing_reports_removed_subscriptions()
+            {
+            subscription_set subscriptions{};
+            subscriptions.subscribe(63);
+
+            ASSERT(subscriptions.unsubscribe(63));
+            ASSERT(!subscriptions.unsubscribe(63));
+            ASSERT(!subscriptions.contains(63));
+            }
+
+          void snapshot_maps_identifiers_to_bits()
+            {
+            subscription_set subscriptions{};
+            subscriptions.subscribe(0);
+            subscriptions.subscribe(63);
+
+            ASSERT_EQUAL(0x8000000000000001ull, subscriptions.snapshot());
+            }
+
+          void invalid_identifier_throws()
+            {
+            subscription_set subscriptions{};
+
+            ASSERT_THROWS(subscriptions.subscribe(64), std::out_of_range);
+            ASSERT(!subscriptions.contains(64));
+            }
+
+          void concurrent_subscriptions_are_not_lost()
+            {
+            subscription_set subscriptions{};
+            auto threads = std::vector<std::thread>{};
+
+            for(std::size_t thread{}; thread < 4; ++thread)
+              {
+              threads.emplace_back([&, thread]{
+                for(auto id = thread; id < kSubchannelIds; id += 4)
+                  {
+                  subscriptions.subscribe(id);
+                  }
+              });
+              }
+
+            for(auto & thread : threads)
+              {
+              thread.join();
+              }
+
+            ASSERT_EQUAL(~std::uint64_t{}, subscriptions.snapshot());
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
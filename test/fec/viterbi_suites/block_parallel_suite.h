@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_FEC_VITERBI__BLOCK_PARALLEL_SUITE
+#define DABCOMMON_TEST_FEC_VITERBI__BLOCK_PARALLEL_SUITE
+
+#include "decoding_suite.h"
+
+#include <dab/fec/block_viterbi.h>
+#include <dab/pipeline/task_pool.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace fec
+      {
+
+      namespace viterbi
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(block_parallel_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(block_parallel_tests, Test)
+            suite += LOCAL_TEST(short_codewords_are_decoded_serially);
+            suite += LOCAL_TEST(noiseless_blocks_restore_the_bits);
+            suite += LOCAL_TEST(noisy_blocks_match_serial_decoding);
+            suite += LOCAL_TEST(blocks_without_overlap_restore_noiseless_bits);
+            suite += LOCAL_TEST(overlap_lowers_the_error_rate_at_block_edges);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void short_codewords_are_decoded_serially()
+            {
+            auto const bits = internal::random_bits(100, 3);
+            auto const soft = internal::modulate(dab::convolutional_encode(bits), 3, 0.0f);
+
+            ASSERT_EQUAL(bits, dab::block_parallel_viterbi_decode(soft, m_pool, {128, 32, 32}));
+            }
+
+          void noiseless_blocks_restore_the_bits()
+            {
+            auto const soft = internal::modulate(dab::convolutional_encode(m_bits), 4, 0.0f);
+
+            ASSERT_EQUAL(m_bits, dab::block_parallel_viterbi_decode(soft, m_pool, {500, 48, 48}));
+            }
+
+          void noisy_blocks_match_serial_decoding()
+            {
+            auto const soft = internal::modulate(dab::convolutional_encode(m_bits), 5, 0.7f);
+
+            ASSERT_EQUAL(dab::viterbi_decode(soft), dab::block_parallel_viterbi_decode(soft, m_pool, {512, 64, 64}));
+            }
+
+          void blocks_without_overlap_restore_noiseless_bits()
+            {
+            auto const soft = internal::modulate(dab::convolutional_encode(m_bits), 6, 0.0f);
+
+            ASSERT_EQUAL(m_bits, dab::block_parallel_viterbi_decode(soft, m_pool, {256, 0, 0}));
+            }
+
+          void overlap_lowers_the_error_rate_at_block_edges()
+            {
+            auto const bits = internal::random_bits(20000, 23);
+            auto const soft = internal::modulate(dab::convolutional_encode(bits), 7, 1.2f);
+
+            auto const serial = edge_errors(bits, dab::viterbi_decode(soft));
+            auto const none = edge_errors(bits, dab::block_parallel_viterbi_decode(soft, m_pool, {kEdgeBlockLength, 0, 0}));
+            auto const narrow = edge_errors(bits, dab::block_parallel_viterbi_decode(soft, m_pool, {kEdgeBlockLength, 8, 8}));
+            auto const wide = edge_errors(bits, dab::block_parallel_viterbi_decode(soft, m_pool, {kEdgeBlockLength, 64, 64}));
+
+            ASSERT(none > narrow);
+            ASSERT(narrow > wide);
+            ASSERT(none > 4 * serial);
+            ASSERT(wide * 4 < serial * 5);
+            }
+
+          private:
+            static std::size_t constexpr kEdgeBlockLength{64};
+            static std::size_t constexpr kEdgeWidth{8};
+
+            /**
+             * Count the bit errors within kEdgeWidth bits of the block boundaries
+             */
+            static std::size_t edge_errors(std::vector<std::uint8_t> const & expected, std::vector<std::uint8_t> const & decoded)
+              {
+              auto errors = std::size_t{};
+
+              for(std::size_t index{}; index < expected.size(); ++index)
+                {
+                auto const offset = index % kEdgeBlockLength;
+
+                if((offset < kEdgeWidth || offset >= kEdgeBlockLength - kEdgeWidth) && expected[index] != decoded[index])
+                  {
+                  ++errors;
+                  }
+                }
+
+              return errors;
+              }
+
+            dab::task_pool m_pool{2};
+            std::vector<std::uint8_t> const m_bits = internal::random_bits(3000, 17);
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
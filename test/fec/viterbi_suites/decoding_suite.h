@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_FEC_VITERBI__DECODING_SUITE
+#define DABCOMMON_TEST_FEC_VITERBI__DECODING_SUITE
+
+#include <dab/fec/viterbi.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace fec
+      {
+
+      namespace viterbi
+        {
+
+        namespace internal
+          {
+
+          inline std::vector<std::uint8_t> random_bits(std::size_t const count, unsigned const seed)
+            {
+            auto generator = std::mt19937{seed};
+            auto bits = std::vector<std::uint8_t>(count);
+
+            for(auto & bit : bits)
+              {
+              bit = generator() & 1;
+              }
+
+            return bits;
+            }
+
+          inline std::vector<float> modulate(std::vector<std::uint8_t> const & codeword, unsigned const seed, float const deviation)
+            {
+            auto generator = std::mt19937{seed};
+            auto noise = std::normal_distribution<float>{0.0f, deviation};
+            auto soft = std::vector<float>{};
+
+            for(auto const bit : codeword)
+              {
+              soft.push_back((bit ? 1.0f : -1.0f) + (deviation > 0.0f ? noise(generator) : 0.0f));
+              }
+
+            return soft;
+            }
+
+          }
+
+        CUTE_DESCRIPTIVE_STRUCT(decoding_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(decoding_tests, Test)
+            suite += LOCAL_TEST(encoding_a_single_one_produces_all_ones);
+            suite += LOCAL_TEST(codeword_size_includes_tail);
+            suite += LOCAL_TEST(decoding_a_noiseless_codeword_restores_the_bits);
+            suite += LOCAL_TEST(decoding_a_noisy_codeword_restores_the_bits);
+            suite += LOCAL_TEST(decoding_a_codeword_with_erasures_restores_the_bits);
+            suite += LOCAL_TEST(hard_decision_decoding_restores_the_bits);
+            suite += LOCAL_TEST(hard_decision_decoding_corrects_isolated_bit_errors);
+            suite += LOCAL_TEST(hard_decision_decoding_ignores_erasures);
+            suite += LOCAL_TEST(multi_stream_decoding_matches_single_stream_decoding);
+            suite += LOCAL_TEST(multi_stream_decoding_preserves_the_order_of_mixed_lengths);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void encoding_a_single_one_produces_all_ones()
+            {
+            auto const codeword = dab::convolutional_encode({1});
+
+            ASSERT_EQUAL((std::vector<std::uint8_t>{1, 1, 1, 1}), std::vector<std::uint8_t>(codeword.begin(), codeword.begin() + 4));
+            }
+
+          void codeword_size_includes_tail()
+            {
+            ASSERT_EQUAL((768 + kMotherCodeTailBits) * kMotherCodeRate, dab::convolutional_encode(m_bits).size());
+            }
+
+          void decoding_a_noiseless_codeword_restores_the_bits()
+            {
+            auto const soft = internal::modulate(dab::convolutional_encode(m_bits), 0, 0.0f);
+
+            ASSERT_EQUAL(m_bits, dab::viterbi_decode(soft));
+            }
+
+          void decoding_a_noisy_codeword_restores_the_bits()
+            {
+            auto const soft = internal::modulate(dab::convolutional_encode(m_bits), 1, 0.5f);
+
+            ASSERT_EQUAL(m_bits, dab::viterbi_decode(soft));
+            }
+
+          void decoding_a_codeword_with_erasures_restores_the_bits()
+            {
+            auto soft = internal::modulate(dab::convolutional_encode(m_bits), 2, 0.0f);
+
+            for(std::size_t index{3}; index < soft.size(); index += 4)
+              {
+              soft[index] = 0.0f;
+              }
+
+            ASSERT_EQUAL(m_bits, dab::viterbi_decode(soft));
+            }
+
+          void hard_decision_decoding_restores_the_bits()
+            {
+            auto const soft = internal::modulate(dab::convolutional_encode(m_bits), 3, 0.0f);
+
+            ASSERT_EQUAL(m_bits, dab::viterbi_decode_hard(soft));
+            }
+
+          void hard_decision_decoding_corrects_isolated_bit_errors()
+            {
+            auto soft = internal::modulate(dab::convolutional_encode(m_bits), 4, 0.0f);
+
+            for(std::size_t index{5}; index < soft.size(); index += 97)
+              {
+              soft[index] = -soft[index];
+              }
+
+            ASSERT_EQUAL(m_bits, dab::viterbi_decode_hard(soft));
+            }
+
+          void hard_decision_decoding_ignores_erasures()
+            {
+            auto soft = internal::modulate(dab::convolutional_encode(m_bits), 5, 0.0f);
+
+            for(std::size_t index{3}; index < soft.size(); index += 4)
+              {
+              soft[index] = 0.0f;
+              }
+
+            ASSERT_EQUAL(m_bits, dab::viterbi_decode_hard(soft));
+            }
+
+          void multi_stream_decoding_matches_single_stream_decoding()
+            {
+            auto codewords = std::vector<std::vector<float>>{};
+            for(unsigned seed{}; seed < 11; ++seed)
+              {
+              codewords.push_back(internal::modulate(dab::convolutional_encode(internal::random_bits(256, seed)), seed, 0.8f));
+              }
+
+            auto decoder = dab::multi_stream_viterbi{};
+            auto const decoded = decoder.decode(codewords);
+
+            for(std::size_t index{}; index < codewords.size(); ++index)
+              {
+              ASSERT_EQUAL(dab::viterbi_decode(codewords[index]), decoded[index]);
+              }
+            }
+
+          void multi_stream_decoding_preserves_the_order_of_mixed_lengths()
+            {
+            auto bits = std::vector<std::vector<std::uint8_t>>{};
+            auto codewords = std::vector<std::vector<float>>{};
+            for(unsigned seed{}; seed < 6; ++seed)
+              {
+              bits.push_back(internal::random_bits(seed % 2 ? 128 : 200, seed));
+              codewords.push_back(internal::modulate(dab::convolutional_encode(bits.back()), seed, 0.0f));
+              }
+
+            auto decoder = dab::multi_stream_viterbi{};
+
+            ASSERT_EQUAL(bits, decoder.decode(codewords));
+            }
+
+          private:
+            std::vector<std::uint8_t> const m_bits = internal::random_bits(768, 42);
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
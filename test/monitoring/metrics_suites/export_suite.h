@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_MONITORING_METRICS__EXPORT_SUITE
+#define DABCOMMON_TEST_MONITORING_METRICS__EXPORT_SUITE
+
+#include <dab/monitoring/metrics.h>
+#include <dab/monitoring/metrics_server.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace monitoring
+      {
+
+      namespace metrics
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(export_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(export_tests, Test)
+            suite += LOCAL_TEST(metrics_file_contains_rendered_metrics);
+            suite += LOCAL_TEST(metrics_file_fails_for_missing_directory);
+            suite += LOCAL_TEST(tcp_server_serves_metrics);
+            suite += LOCAL_TEST(unix_server_serves_metrics);
+            suite += LOCAL_TEST(unix_server_removes_socket_file);
+            suite += LOCAL_TEST(server_stops_while_client_does_not_read);
+            suite += LOCAL_TEST(client_that_does_not_read_is_dropped);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void metrics_file_contains_rendered_metrics()
+            {
+            metrics_registry registry{};
+            registry.counter("dab_frames_total", "Frames").increment(7);
+            auto const path = std::string{"/tmp/dabcommon_metrics_test.prom"};
+
+            ASSERT(write_metrics_file(registry, path));
+
+            std::ifstream file{path};
+            auto const text = std::string{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+            std::remove(path.c_str());
+
+            ASSERT_EQUAL(registry.prometheus(), text);
+            }
+
+          void metrics_file_fails_for_missing_directory()
+            {
+            metrics_registry registry{};
+
+            ASSERT(!write_metrics_file(registry, "/nonexistent/dabcommon/metrics.prom"));
+            }
+
+          void tcp_server_serves_metrics()
+            {
+            metrics_registry registry{};
+            registry.counter("dab_frames_total", "Frames").increment(7);
+            metrics_server server{registry, std::uint16_t{0}};
+
+            ASSERT(server.listening());
+            ASSERT(server.port() != 0);
+
+            auto address = sockaddr_in{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(server.port());
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+            auto const response = scrape(AF_INET, reinterpret_cast<sockaddr const *>(&address), sizeof(address));
+
+            ASSERT(response.find("HTTP/1.0 200 OK\r\n") == 0);
+            ASSERT(response.find("\r\n\r\n" + registry.prometheus()) != std::string::npos);
+            ASSERT_EQUAL(1u, server.served());
+            }
+
+          void unix_server_serves_metrics()
+            {
+            metrics_registry registry{};
+            registry.gauge("dab_snr_db", "SNR").set(9.5);
+            metrics_server server{registry, kSocketPath};
+
+            ASSERT(server.listening());
+            ASSERT_EQUAL(0u, server.port());
+
+            auto address = unix_address();
+            auto const response = scrape(AF_UNIX, reinterpret_cast<sockaddr const *>(&address), sizeof(address));
+
+            ASSERT(response.find("dab_snr_db 9.5\n") != std::string::npos);
+            }
+
+          void unix_server_removes_socket_file()
+            {
+              {
+              metrics_registry registry{};
+              metrics_server server{registry, kSocketPath};
+              ASSERT(::access(kSocketPath, F_OK) == 0);
+              }
+
+            ASSERT(::access(kSocketPath, F_OK) != 0);
+            }
+
+          void server_stops_while_client_does_not_read()
+            {
+            metrics_registry registry{};
+            registry.counter("dab_frames_total", "Frames", {{"padding", std::string(kLargeResponse, 'x')}});
+            auto server = std::unique_ptr<metrics_server>{new metrics_server{registry, kSocketPath}};
+
+            auto address = unix_address();
+            auto const connection = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            ASSERT_EQUAL(0, ::connect(connection, reinterpret_cast<sockaddr const *>(&address), sizeof(address)));
+
+            auto const request = std::string{"GET /metrics HTTP/1.0\r\n\r\n"};
+            static_cast<void>(::send(connection, request.data(), request.size(), 0));
+            std::this_thread::sleep_for(std::chrono::milliseconds{200});
+
+            auto stopping = std::async(std::launch::async, [&]{ server.reset(); });
+            auto const status = stopping.wait_for(std::chrono::seconds{2});
+            ::close(connection);
+
+            ASSERT_EQUAL(std::future_status::ready, status);
+            }
+
+          void client_that_does_not_read_is_dropped()
+            {
+            metrics_registry registry{};
+            registry.counter("dab_frames_total", "Frames", {{"padding", std::string(kLargeResponse, 'x')}});
+            metrics_server server{registry, kSocketPath};
+
+            auto address = unix_address();
+            auto const connection = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            ASSERT_EQUAL(0, ::connect(connection, reinterpret_cast<sockaddr const *>(&address), sizeof(address)));
+
+            auto const request = std::string{"GET /metrics HTTP/1.0\r\n\r\n"};
+            static_cast<void>(::send(connection, request.data(), request.size(), 0));
+
+            auto scraping = std::async(std::launch::async, [&]{
+              return scrape(AF_UNIX, reinterpret_cast<sockaddr const *>(&address), sizeof(address));
+            });
+            auto const status = scraping.wait_for(std::chrono::seconds{10});
+            ::close(connection);
+
+            ASSERT_EQUAL(std::future_status::ready, status);
+            ASSERT(scraping.get().find("HTTP/1.0 200 OK\r\n") == 0);
+            ASSERT_EQUAL(1u, server.served());
+            }
+
+          private:
+            static constexpr char const * kSocketPath{"/tmp/dabcommon_metrics_test.sock"};
+            static constexpr std::size_t kLargeResponse{16 * 1024 * 1024};
+
+            static sockaddr_un unix_address()
+              {
+              auto address = sockaddr_un{};
+              address.sun_family = AF_UNIX;
+              std::strncpy(address.sun_path, kSocketPath, sizeof(address.sun_path) - 1);
+              return address;
+              }
+
+            static std::string scrape(int const family, sockaddr const * const address, socklen_t const length)
+              {
+              auto const connection = ::socket(family, SOCK_STREAM, 0);
+              if(connection < 0 || ::connect(connection, address, length))
+                {
+                return {};
+                }
+
+              auto const request = std::string{"GET /metrics HTTP/1.0\r\n\r\n"};
+              static_cast<void>(::send(connection, request.data(), request.size(), 0));
+
+              auto response = std::string{};
+              char buffer[1024];
+              for(auto received = ::recv(connection, buffer, sizeof(buffer), 0); received > 0;
+                  received = ::recv(connection, buffer, sizeof(buffer), 0))
+                {
+                response.append(buffer, static_cast<std::size_t>(received));
+                }
+
+              ::close(connection);
+              return response;
+              }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
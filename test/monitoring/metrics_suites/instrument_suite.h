@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_MONITORING_METRICS__INSTRUMENT_SUITE
+#define DABCOMMON_TEST_MONITORING_METRICS__INSTRUMENT_SUITE
+
+#include <dab/monitoring/metrics.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace monitoring
+      {
+
+      namespace metrics
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(instrument_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(instrument_tests, Test)
+            suite += LOCAL_TEST(aligned_words_start_on_a_cache_line);
+            suite += LOCAL_TEST(counter_starts_at_zero);
+            suite += LOCAL_TEST(counter_sums_increments);
+            suite += LOCAL_TEST(counter_sums_increments_of_all_threads);
+            suite += LOCAL_TEST(gauge_can_be_set_and_adjusted);
+            suite += LOCAL_TEST(histogram_counts_values_into_buckets);
+            suite += LOCAL_TEST(histogram_bounds_are_inclusive);
+            suite += LOCAL_TEST(histogram_aggregates_all_threads);
+            suite += LOCAL_TEST(histogram_rejects_unordered_bounds);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void aligned_words_start_on_a_cache_line()
+            {
+            for(std::size_t words{1}; words <= 2 * dab::internal::kCacheLineWords; ++words)
+              {
+              dab::internal::cache_aligned_words cells{words};
+
+              ASSERT_EQUAL(0u, reinterpret_cast<std::uintptr_t>(&cells[0]) % dab::internal::kCacheLineBytes);
+              ASSERT_EQUAL(0u, cells[words - 1].load());
+              }
+            }
+
+          void counter_starts_at_zero()
+            {
+            metrics_counter counter{};
+
+            ASSERT_EQUAL(0u, counter.value());
+            }
+
+          void counter_sums_increments()
+            {
+            metrics_counter counter{};
+            counter.increment();
+            counter.increment(41);
+
+            ASSERT_EQUAL(42u, counter.value());
+            }
+
+          void counter_sums_increments_of_all_threads()
+            {
+            metrics_counter counter{};
+            auto threads = std::vector<std::thread>{};
+
+            for(std::size_t index{}; index < kThreads; ++index)
+              {
+              threads.emplace_back([&]{
+                for(std::size_t count{}; count < kIncrements; ++count)
+                  {
+                  counter.increment();
+                  }
+              });
+              }
+
+            for(auto & thread : threads)
+              {
+              thread.join();
+              }
+
+            ASSERT_EQUAL(kThreads * kIncrements, counter.value());
+            }
+
+          void gauge_can_be_set_and_adjusted()
+            {
+            metrics_gauge gauge{};
+            gauge.set(2.5);
+            gauge.add(-1.0);
+
+            ASSERT_EQUAL_DELTA(1.5, gauge.value(), 1e-12);
+            }
+
+          void histogram_counts_values_into_buckets()
+            {
+            metrics_histogram histogram{{1.0, 10.0}};
+            histogram.observe(0.5);
+            histogram.observe(5.0);
+            histogram.observe(50.0);
+            histogram.observe(500.0);
+
+            auto const snapshot = histogram.snapshot();
+
+            ASSERT_EQUAL((std::vector<std::uint64_t>{1, 2, 4}), snapshot.buckets);
+            ASSERT_EQUAL(4u, snapshot.count);
+            ASSERT_EQUAL_DELTA(555.5, snapshot.sum, 1e-9);
+            }
+
+          void histogram_bounds_are_inclusive()
+            {
+            metrics_histogram histogram{{1.0}};
+            histogram.observe(1.0);
+
+            ASSERT_EQUAL(1u, histogram.snapshot().buckets[0]);
+            }
+
+          void histogram_aggregates_all_threads()
+            {
+            metrics_histogram histogram{{0.5}};
+            auto threads = std::vector<std::thread>{};
+
+            for(std::size_t index{}; index < kThreads; ++index)
+              {
+              threads.emplace_back([&]{
+                for(std::size_t count{}; count < kIncrements; ++count)
+                  {
+                  histogram.observe(1.0);
+                  }
+              });
+              }
+
+            for(auto & thread : threads)
+              {
+              thread.join();
+              }
+
+            auto const snapshot = histogram.snapshot();
+
+            ASSERT_EQUAL(0u, snapshot.buckets[0]);
+            ASSERT_EQUAL(kThreads * kIncrements, snapshot.count);
+            ASSERT_EQUAL_DELTA(static_cast<double>(kThreads * kIncrements), snapshot.sum, 1e-9);
+            }
+
+          void histogram_rejects_unordered_bounds()
+            {
+            ASSERT_THROWS(metrics_histogram({1.0, 1.0}), std::invalid_argument);
+            }
+
+          private:
+            static std::size_t constexpr kThreads{4};
+            static std::size_t constexpr kIncrements{10000};
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_MONITORING_METRICS__REGISTRY_SUITE
+#define DABCOMMON_TEST_MONITORING_METRICS__REGISTRY_SUITE
+
+#include <dab/monitoring/metrics.h>
+#include <dab/types/parse_status.h>
+#include <dab/types/queue.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace monitoring
+      {
+
+      namespace metrics
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(registry_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(registry_tests, Test)
+            suite += LOCAL_TEST(empty_registry_renders_nothing);
+            suite += LOCAL_TEST(same_name_and_labels_yield_same_metric);
+            suite += LOCAL_TEST(different_labels_yield_different_series);
+            suite += LOCAL_TEST(counter_is_rendered_with_help_and_type);
+            suite += LOCAL_TEST(labels_are_escaped);
+            suite += LOCAL_TEST(gauge_callback_is_read_on_render);
+            suite += LOCAL_TEST(special_values_are_rendered);
+            suite += LOCAL_TEST(histogram_is_rendered_cumulatively);
+            suite += LOCAL_TEST(type_mismatch_is_rejected);
+            suite += LOCAL_TEST(invalid_names_are_rejected);
+            suite += LOCAL_TEST(parse_status_metrics_count_per_status);
+            suite += LOCAL_TEST(queue_depth_is_exported);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void empty_registry_renders_nothing()
+            {
+            metrics_registry registry{};
+
+            ASSERT_EQUAL(std::string{}, registry.prometheus());
+            }
+
+          void same_name_and_labels_yield_same_metric()
+            {
+            metrics_registry registry{};
+
+            ASSERT_EQUAL(&registry.counter("dab_frames_total", "Frames", {{"mode", "1"}}),
+                         &registry.counter("dab_frames_total", "Frames", {{"mode", "1"}}));
+            }
+
+          void different_labels_yield_different_series()
+            {
+            metrics_registry registry{};
+            registry.counter("dab_frames_total", "Frames", {{"mode", "1"}}).increment(1);
+            registry.counter("dab_frames_total", "Frames", {{"mode", "2"}}).increment(2);
+
+            ASSERT_EQUAL(std::string{"# HELP dab_frames_total Frames\n"
+                                     "# TYPE dab_frames_total counter\n"
+                                     "dab_frames_total{mode=\"1\"} 1\n"
+                                     "dab_frames_total{mode=\"2\"} 2\n"}, registry.prometheus());
+            }
+
+          void counter_is_rendered_with_help_and_type()
+            {
+            metrics_registry registry{};
+            registry.counter("dab_sync_losses_total", "Losses of\nsync").increment(3);
+
+            ASSERT_EQUAL(std::string{"# HELP dab_sync_losses_total Losses of\\nsync\n"
+                                     "# TYPE dab_sync_losses_total counter\n"
+                                     "dab_sync_losses_total 3\n"}, registry.prometheus());
+            }
+
+          void labels_are_escaped()
+            {
+            metrics_registry registry{};
+            registry.gauge("dab_label", "Label", {{"text", "a\"b\\c\nd"}}).set(1);
+
+            ASSERT(contains(registry.prometheus(), "dab_label{text=\"a\\\"b\\\\c\\nd\"} 1\n"));
+            }
+
+          void gauge_callback_is_read_on_render()
+            {
+            metrics_registry registry{};
+            auto value = 1.0;
+            registry.gauge_callback("dab_snr_db", "SNR", [&]{ return value; });
+            value = 12.25;
+
+            ASSERT(contains(registry.prometheus(), "dab_snr_db 12.25\n"));
+            }
+
+          void special_values_are_rendered()
+            {
+            metrics_registry registry{};
+            registry.gauge("dab_a", "A").set(std::numeric_limits<double>::infinity());
+            registry.gauge("dab_b", "B").set(std::numeric_limits<double>::quiet_NaN());
+
+            auto const text = registry.prometheus();
+
+            ASSERT(contains(text, "dab_a +Inf\n"));
+            ASSERT(contains(text, "dab_b NaN\n"));
+            }
+
+          void histogram_is_rendered_cumulatively()
+            {
+            metrics_registry registry{};
+            auto & histogram = registry.histogram("dab_decode_seconds", "Decode time", {0.001, 0.01}, {{"stage", "fic"}});
+            histogram.observe(0.0005);
+            histogram.observe(0.005);
+            histogram.observe(1.0);
+
+            ASSERT(contains(registry.prometheus(), "# TYPE dab_decode_seconds histogram\n"
+                                                   "dab_decode_seconds_bucket{stage=\"fic\",le=\"0.001\"} 1\n"
+                                                   "dab_decode_seconds_bucket{stage=\"fic\",le=\"0.01\"} 2\n"
+                                                   "dab_decode_seconds_bucket{stage=\"fic\",le=\"+Inf\"} 3\n"
+                                                   "dab_decode_seconds_sum{stage=\"fic\"} 1.0055\n"
+                                                   "dab_decode_seconds_count{stage=\"fic\"} 3\n"));
+            }
+
+          void type_mismatch_is_rejected()
+            {
+            metrics_registry registry{};
+            registry.counter("dab_frames_total", "Frames");
+            registry.gauge_callback("dab_depth", "Depth", []{ return 0.0; });
+
+            ASSERT_THROWS(registry.gauge("dab_frames_total", "Frames"), std::invalid_argument);
+            ASSERT_THROWS(registry.gauge("dab_depth", "Depth"), std::invalid_argument);
+            }
+
+          void invalid_names_are_rejected()
+            {
+            metrics_registry registry{};
+
+            ASSERT_THROWS(registry.counter("1frames", "Frames"), std::invalid_argument);
+            ASSERT_THROWS(registry.counter("dab-frames", "Frames"), std::invalid_argument);
+            ASSERT_THROWS(registry.counter("dab_frames", "Frames", {{"__name", "x"}}), std::invalid_argument);
+            ASSERT_THROWS(registry.histogram("dab_seconds", "Seconds", {1.0}, {{"le", "x"}}), std::invalid_argument);
+            }
+
+          void parse_status_metrics_count_per_status()
+            {
+            metrics_registry registry{};
+            auto fibs = parse_status_metrics{registry, "dab_fibs_total", "FIBs", {{"ensemble", "10E1"}}};
+            fibs.count(parse_status::ok);
+            fibs.count(parse_status::ok);
+            fibs.count(parse_status::invalid_crc);
+
+            auto const text = registry.prometheus();
+
+            ASSERT(contains(text, "dab_fibs_total{ensemble=\"10E1\",status=\"ok\"} 2\n"));
+            ASSERT(contains(text, "dab_fibs_total{ensemble=\"10E1\",status=\"invalid_crc\"} 1\n"));
+            ASSERT(contains(text, "dab_fibs_total{ensemble=\"10E1\",status=\"segment_lost\"} 0\n"));
+            }
+
+          void queue_depth_is_exported()
+            {
+            metrics_registry registry{};
+            internal::queue<int> samples{};
+            watch_queue(registry, samples, {{"queue", "samples"}});
+            samples.enqueue(1);
+            samples.enqueue(2);
+
+            ASSERT(contains(registry.prometheus(), "dab_queue_depth{queue=\"samples\"} 2\n"));
+            }
+
+          private:
+            static bool contains(std::string const & text, std::string const & part)
+              {
+              return text.find(part) != std::string::npos;
+              }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_MONITORING_SIGNAL_QUALITY__MEASUREMENT_SUITE
+#define DABCOMMON_TEST_MONITORING_SIGNAL_QUALITY__MEASUREMENT_SUITE
+
+#include <dab/constants/transmission_modes.h>
+#include <dab/monitoring/signal_quality.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cmath>
+#include <complex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace monitoring
+      {
+
+      namespace signal_quality
+        {
+
+        namespace internal
+          {
+
+          inline std::vector<sample_t> symbol(std::mt19937 & generator, float const deviation, float const rotation)
+            {
+            auto const quarter = std::acos(-1.0f) / 2;
+            auto noise = std::normal_distribution<float>{0.0f, deviation};
+            auto carriers = std::vector<sample_t>{};
+
+            for(std::size_t carrier{}; carrier < kTransmissionMode1.carriers; ++carrier)
+              {
+              auto const phase = quarter / 2 + quarter * (generator() % 4) + rotation;
+              carriers.push_back(std::polar(1.0f, phase) + (deviation > 0.0f ? sample_t{noise(generator), noise(generator)} : sample_t{}));
+              }
+
+            return carriers;
+            }
+
+          }
+
+        CUTE_DESCRIPTIVE_STRUCT(measurement_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(measurement_tests, Test)
+            suite += LOCAL_TEST(new_monitor_reports_nothing);
+            suite += LOCAL_TEST(only_every_nth_symbol_is_measured);
+            suite += LOCAL_TEST(mer_and_snr_follow_the_noise_level);
+            suite += LOCAL_TEST(constellation_rotation_yields_the_frequency_offset);
+            suite += LOCAL_TEST(check_results_are_counted_per_status);
+            suite += LOCAL_TEST(failure_rates_exclude_successful_checks);
+            suite += LOCAL_TEST(snapshots_can_be_taken_while_measuring);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void new_monitor_reports_nothing()
+            {
+            signal_quality_monitor monitor{kTransmissionMode1};
+
+            ASSERT_EQUAL(0u, monitor.snapshot().symbols);
+            ASSERT_EQUAL(0.0f, monitor.snapshot().fic_failure_rate());
+            }
+
+          void only_every_nth_symbol_is_measured()
+            {
+            signal_quality_monitor monitor{kTransmissionMode1, 4};
+
+            for(auto symbol = 0; symbol < 10; ++symbol)
+              {
+              monitor.tap(internal::symbol(m_generator, 0.1f, 0.0f));
+              }
+
+            ASSERT_EQUAL(3u, monitor.snapshot().symbols);
+            }
+
+          void mer_and_snr_follow_the_noise_level()
+            {
+            signal_quality_monitor monitor{kTransmissionMode1, 1};
+
+            for(auto symbol = 0; symbol < 20; ++symbol)
+              {
+              monitor.tap(internal::symbol(m_generator, 0.1f, 0.0f));
+              }
+
+            auto const expected = -10.0f * std::log10(2 * 0.1f * 0.1f);
+            ASSERT_EQUAL_DELTA(expected, monitor.snapshot().mer, 0.5f);
+            ASSERT_EQUAL_DELTA(expected, monitor.snapshot().snr, 0.5f);
+            }
+
+          void constellation_rotation_yields_the_frequency_offset()
+            {
+            signal_quality_monitor monitor{kTransmissionMode1, 1};
+            auto const rotation = 2 * std::acos(-1.0f) * 100.0f * kTransmissionMode1.symbol_duration / kDefaultSampleRate;
+
+            for(auto symbol = 0; symbol < 20; ++symbol)
+              {
+              monitor.tap(internal::symbol(m_generator, 0.05f, rotation));
+              }
+
+            ASSERT_EQUAL_DELTA(100.0f, monitor.snapshot().frequency_offset, 2.0f);
+            ASSERT(monitor.snapshot().mer > 20.0f);
+            }
+
+          void check_results_are_counted_per_status()
+            {
+            signal_quality_monitor monitor{kTransmissionMode1};
+            monitor.record(quality_source::fic, parse_status::ok);
+            monitor.record(quality_source::fic, parse_status::invalid_crc);
+            monitor.record(quality_source::subchannel, parse_status::segment_lost);
+
+            auto const quality = monitor.snapshot();
+            ASSERT_EQUAL(1u, quality.fic[static_cast<std::size_t>(parse_status::ok)]);
+            ASSERT_EQUAL(1u, quality.fic[static_cast<std::size_t>(parse_status::invalid_crc)]);
+            ASSERT_EQUAL(1u, quality.subchannels[static_cast<std::size_t>(parse_status::segment_lost)]);
+            ASSERT_EQUAL(0u, quality.subchannels[static_cast<std::size_t>(parse_status::ok)]);
+            }
+
+          void failure_rates_exclude_successful_checks()
+            {
+            signal_quality_monitor monitor{kTransmissionMode1};
+            for(auto check = 0; check < 3; ++check)
+              {
+              monitor.record(quality_source::fic, parse_status::ok);
+              }
+            monitor.record(quality_source::fic, parse_status::invalid_crc);
+
+            ASSERT_EQUAL_DELTA(0.25f, monitor.snapshot().fic_failure_rate(), 1e-6f);
+            ASSERT_EQUAL(0.0f, monitor.snapshot().subchannel_failure_rate());
+            }
+
+          void snapshots_can_be_taken_while_measuring()
+            {
+            signal_quality_monitor monitor{kTransmissionMode1, 1};
+            auto const symbol = internal::symbol(m_generator, 0.1f, 0.0f);
+
+            auto reader = std::thread{[&]{
+              for(auto snapshot = 0; snapshot < 1000; ++snapshot)
+                {
+                monitor.snapshot();
+                monitor.record(quality_source::subchannel, parse_status::ok);
+                }
+            }};
+
+            for(auto tap = 0; tap < 200; ++tap)
+              {
+              monitor.tap(symbol);
+              }
+
+            reader.join();
+
+            ASSERT_EQUAL(200u, monitor.snapshot().symbols);
+            ASSERT_EQUAL(1000u, monitor.snapshot().subchannels[static_cast<std::size_t>(parse_status::ok)]);
+            }
+
+          private:
+            std::mt19937 m_generator{31};
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
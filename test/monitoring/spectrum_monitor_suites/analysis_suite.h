@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_MONITORING_SPECTRUM_MONITOR__ANALYSIS_SUITE
+#define DABCOMMON_TEST_MONITORING_SPECTRUM_MONITOR__ANALYSIS_SUITE
+
+#include <dab/monitoring/spectrum_monitor.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace monitoring
+      {
+
+      namespace spectrum_monitor
+        {
+
+        namespace internal
+          {
+
+          inline std::vector<sample_t> tone(std::size_t const samples, float const frequency, std::size_t const sampleRate)
+            {
+            auto const step = 2 * std::acos(-1.0) * frequency / sampleRate;
+            auto block = std::vector<sample_t>(samples);
+
+            for(std::size_t index{}; index < samples; ++index)
+              {
+              block[index] = std::polar(1.0f, static_cast<float>(std::fmod(step * index, 2 * std::acos(-1.0))));
+              }
+
+            return block;
+            }
+
+          inline std::size_t peak(std::vector<float> const & spectrum)
+            {
+            return std::max_element(spectrum.begin(), spectrum.end()) - spectrum.begin();
+            }
+
+          }
+
+        CUTE_DESCRIPTIVE_STRUCT(analysis_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(analysis_tests, Test)
+            suite += LOCAL_TEST(nothing_is_published_before_the_first_spectrum);
+            suite += LOCAL_TEST(spectra_are_produced_at_the_frame_rate);
+            suite += LOCAL_TEST(tone_appears_in_its_bin);
+            suite += LOCAL_TEST(decimation_narrows_the_bandwidth);
+            suite += LOCAL_TEST(block_boundaries_do_not_matter);
+            suite += LOCAL_TEST(invalid_parameters_throw);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void nothing_is_published_before_the_first_spectrum()
+            {
+            dab::spectrum_monitor monitor{{256, 1, 4, 10.0f}, 64000};
+            auto spectrum = std::vector<float>{};
+
+            monitor.tap(std::vector<sample_t>(100));
+
+            ASSERT(!monitor.read(spectrum));
+            }
+
+          void spectra_are_produced_at_the_frame_rate()
+            {
+            dab::spectrum_monitor monitor{{256, 1, 4, 10.0f}, 64000};
+
+            monitor.tap(internal::tone(64000, 1000.0f, 64000));
+
+            ASSERT_EQUAL(10u, monitor.frames());
+            }
+
+          void tone_appears_in_its_bin()
+            {
+            dab::spectrum_monitor monitor{{256, 1, 4, 10.0f}, 64000};
+            auto spectrum = std::vector<float>{};
+
+            monitor.tap(internal::tone(6400, 8000.0f, 64000));
+
+            ASSERT(monitor.read(spectrum));
+            ASSERT_EQUAL(256u, spectrum.size());
+            ASSERT_EQUAL(128u + 32u, internal::peak(spectrum));
+            }
+
+          void decimation_narrows_the_bandwidth()
+            {
+            dab::spectrum_monitor monitor{{256, 2, 4, 10.0f}, 64000};
+            auto spectrum = std::vector<float>{};
+
+            monitor.tap(internal::tone(6400, -4000.0f, 64000));
+
+            ASSERT(monitor.read(spectrum));
+            ASSERT_EQUAL(128u - 32u, internal::peak(spectrum));
+            }
+
+          void block_boundaries_do_not_matter()
+            {
+            dab::spectrum_monitor whole{{256, 1, 2, 10.0f}, 64000};
+            dab::spectrum_monitor split{{256, 1, 2, 10.0f}, 64000};
+            auto const samples = internal::tone(12800, 3000.0f, 64000);
+
+            whole.tap(samples);
+            for(std::size_t offset{}; offset < samples.size(); offset += 100)
+              {
+              split.tap(std::vector<sample_t>(samples.begin() + offset, samples.begin() + offset + 100));
+              }
+
+            auto wholeSpectrum = std::vector<float>{};
+            auto splitSpectrum = std::vector<float>{};
+            whole.read(wholeSpectrum);
+            split.read(splitSpectrum);
+
+            ASSERT_EQUAL(whole.frames(), split.frames());
+            ASSERT_EQUAL(wholeSpectrum, splitSpectrum);
+            }
+
+          void invalid_parameters_throw()
+            {
+            ASSERT_THROWS(dab::spectrum_monitor({100, 1, 4, 10.0f}), std::invalid_argument);
+            ASSERT_THROWS(dab::spectrum_monitor({256, 0, 4, 10.0f}), std::invalid_argument);
+            ASSERT_THROWS(dab::spectrum_monitor({256, 1, 0, 10.0f}), std::invalid_argument);
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_OFDM_CHANNEL_ESTIMATOR__ESTIMATION_SUITE
+#define DABCOMMON_TEST_OFDM_CHANNEL_ESTIMATOR__ESTIMATION_SUITE
+
+#include <dab/constants/transmission_modes.h>
+#include <dab/ofdm/channel_estimator.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cmath>
+#include <complex>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace ofdm
+      {
+
+      namespace channel_estimator
+        {
+
+        namespace internal
+          {
+
+          inline std::vector<sample_t> reference(std::size_t const carriers)
+            {
+            auto generator = std::mt19937{23};
+            auto symbols = std::vector<sample_t>{};
+            auto const phases = std::vector<sample_t>{{1.0f, 0.0f}, {0.0f, 1.0f}, {-1.0f, 0.0f}, {0.0f, -1.0f}};
+
+            for(std::size_t carrier{}; carrier < carriers; ++carrier)
+              {
+              symbols.push_back(phases[generator() % 4]);
+              }
+
+            return symbols;
+            }
+
+          inline std::vector<sample_t> through(std::vector<sample_t> const & symbols, std::vector<sample_t> const & channel)
+            {
+            auto received = symbols;
+
+            for(std::size_t carrier{}; carrier < received.size(); ++carrier)
+              {
+              received[carrier] *= channel[carrier];
+              }
+
+            return received;
+            }
+
+          }
+
+        CUTE_DESCRIPTIVE_STRUCT(estimation_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(estimation_tests, Test)
+            suite += LOCAL_TEST(flat_channel_is_estimated_exactly);
+            suite += LOCAL_TEST(equalization_restores_the_transmitted_carriers);
+            suite += LOCAL_TEST(faded_carriers_get_low_weights);
+            suite += LOCAL_TEST(soft_bits_are_weighted_by_their_carrier);
+            suite += LOCAL_TEST(time_smoothing_averages_over_frames);
+            suite += LOCAL_TEST(frequency_smoothing_suppresses_noise);
+            suite += LOCAL_TEST(mismatched_sizes_throw);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void flat_channel_is_estimated_exactly()
+            {
+            auto estimator = dab::channel_estimator{kTransmissionMode2, m_reference};
+            estimator.update(internal::through(m_reference, std::vector<sample_t>(m_carriers, {0.5f, -0.5f})));
+
+            for(std::size_t carrier{}; carrier < m_carriers; ++carrier)
+              {
+              ASSERT_EQUAL_DELTA(0.5f, estimator.response()[carrier].real(), 1e-5f);
+              ASSERT_EQUAL_DELTA(-0.5f, estimator.response()[carrier].imag(), 1e-5f);
+              ASSERT_EQUAL_DELTA(1.0f, estimator.csi()[carrier], 1e-4f);
+              }
+            }
+
+          void equalization_restores_the_transmitted_carriers()
+            {
+            auto channel = std::vector<sample_t>(m_carriers);
+            for(std::size_t carrier{}; carrier < m_carriers; ++carrier)
+              {
+              channel[carrier] = std::polar(1.0f + 0.001f * carrier, 0.002f * carrier);
+              }
+
+            auto estimator = dab::channel_estimator{kTransmissionMode2, m_reference, {1.0f, 0}};
+            estimator.update(internal::through(m_reference, channel));
+
+            auto data = internal::through(m_reference, channel);
+            estimator.equalize(data);
+
+            for(std::size_t carrier{}; carrier < m_carriers; ++carrier)
+              {
+              ASSERT_EQUAL_DELTA(0.0f, std::abs(data[carrier] - m_reference[carrier]), 1e-4f);
+              }
+            }
+
+          void faded_carriers_get_low_weights()
+            {
+            auto channel = std::vector<sample_t>(m_carriers, {1.0f, 0.0f});
+            for(std::size_t carrier{100}; carrier < 120; ++carrier)
+              {
+              channel[carrier] = {0.05f, 0.0f};
+              }
+
+            auto estimator = dab::channel_estimator{kTransmissionMode2, m_reference};
+            estimator.update(internal::through(m_reference, channel));
+
+            auto soft = std::vector<float>(2 * m_carriers, 1.0f);
+            estimator.weight(soft);
+
+            ASSERT(soft[110] < 0.1f);
+            ASSERT(soft[m_carriers + 110] < 0.1f);
+            ASSERT(soft[10] > 1.0f);
+            }
+
+          void soft_bits_are_weighted_by_their_carrier()
+            {
+            auto channel = std::vector<sample_t>(m_carriers);
+            auto power = 0.0f;
+            for(std::size_t carrier{}; carrier < m_carriers; ++carrier)
+              {
+              channel[carrier] = {0.1f + 0.002f * carrier, 0.0f};
+              power += std::norm(channel[carrier]);
+              }
+
+            auto estimator = dab::channel_estimator{kTransmissionMode2, m_reference, {1.0f, 0}};
+            estimator.update(internal::through(m_reference, channel));
+
+            auto soft = std::vector<float>(2 * m_carriers);
+            for(std::size_t bit{}; bit < soft.size(); ++bit)
+              {
+              soft[bit] = bit + 1.0f;
+              }
+            estimator.weight(soft);
+
+            for(std::size_t carrier{}; carrier < m_carriers; ++carrier)
+              {
+              auto const csi = std::norm(channel[carrier]) * m_carriers / power;
+              auto const real = (carrier + 1.0f) * csi;
+              auto const imaginary = (m_carriers + carrier + 1.0f) * csi;
+
+              ASSERT_EQUAL_DELTA(real, soft[carrier], 1e-4f * real);
+              ASSERT_EQUAL_DELTA(imaginary, soft[m_carriers + carrier], 1e-4f * imaginary);
+              }
+            }
+
+          void time_smoothing_averages_over_frames()
+            {
+            auto estimator = dab::channel_estimator{kTransmissionMode2, m_reference, {0.25f, 0}};
+            estimator.update(internal::through(m_reference, std::vector<sample_t>(m_carriers, {1.0f, 0.0f})));
+            estimator.update(internal::through(m_reference, std::vector<sample_t>(m_carriers, {0.0f, 0.0f})));
+
+            ASSERT_EQUAL_DELTA(0.75f, estimator.response()[7].real(), 1e-5f);
+            }
+
+          void frequency_smoothing_suppresses_noise()
+            {
+            auto generator = std::mt19937{5};
+            auto noise = std::normal_distribution<float>{0.0f, 0.2f};
+            auto channel = std::vector<sample_t>(m_carriers);
+            for(auto & value : channel)
+              {
+              value = {1.0f + noise(generator), noise(generator)};
+              }
+
+            auto smoothed = dab::channel_estimator{kTransmissionMode2, m_reference, {1.0f, 4}};
+            auto raw = dab::channel_estimator{kTransmissionMode2, m_reference, {1.0f, 0}};
+            smoothed.update(internal::through(m_reference, channel));
+            raw.update(internal::through(m_reference, channel));
+
+            auto smoothedError = 0.0f;
+            auto rawError = 0.0f;
+            for(std::size_t carrier{}; carrier < m_carriers; ++carrier)
+              {
+              smoothedError += std::norm(smoothed.response()[carrier] - sample_t{1.0f, 0.0f});
+              rawError += std::norm(raw.response()[carrier] - sample_t{1.0f, 0.0f});
+              }
+
+            ASSERT(smoothedError < rawError / 4);
+            }
+
+          void mismatched_sizes_throw()
+            {
+            ASSERT_THROWS(dab::channel_estimator(kTransmissionMode2, std::vector<sample_t>(10)), std::invalid_argument);
+
+            auto estimator = dab::channel_estimator{kTransmissionMode2, m_reference};
+            auto soft = std::vector<float>(m_carriers);
+
+            ASSERT_THROWS(estimator.update(std::vector<sample_t>(10)), std::invalid_argument);
+            ASSERT_THROWS(estimator.weight(soft), std::invalid_argument);
+            }
+
+          private:
+            std::size_t const m_carriers{kTransmissionMode2.carriers};
+            std::vector<sample_t> const m_reference = internal::reference(m_carriers);
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_OFDM_FFT__TRANSFORM_SUITE
+#define DABCOMMON_TEST_OFDM_FFT__TRANSFORM_SUITE
+
+#include <dab/ofdm/fft.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace ofdm
+      {
+
+      namespace fft
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(transform_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(transform_tests, Test)
+            suite += LOCAL_TEST(impulse_yields_a_flat_spectrum);
+            suite += LOCAL_TEST(tone_yields_a_single_bin);
+            suite += LOCAL_TEST(inverse_transform_restores_the_samples);
+            suite += LOCAL_TEST(length_must_be_a_power_of_two);
+            suite += LOCAL_TEST(data_must_match_the_length);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void impulse_yields_a_flat_spectrum()
+            {
+            auto data = std::vector<sample_t>(64);
+            data[0] = 1.0f;
+
+            m_transform.forward(data);
+
+            for(auto const & bin : data)
+              {
+              ASSERT_EQUAL_DELTA(0.0f, std::abs(bin - sample_t{1.0f, 0.0f}), 1e-5f);
+              }
+            }
+
+          void tone_yields_a_single_bin()
+            {
+            auto data = std::vector<sample_t>(64);
+            for(std::size_t index{}; index < data.size(); ++index)
+              {
+              data[index] = std::polar(1.0f, 2 * std::acos(-1.0f) * 5 * index / 64);
+              }
+
+            m_transform.forward(data);
+
+            for(std::size_t bin{}; bin < data.size(); ++bin)
+              {
+              ASSERT_EQUAL_DELTA(bin == 5 ? 64.0f : 0.0f, std::abs(data[bin]), 1e-3f);
+              }
+            }
+
+          void inverse_transform_restores_the_samples()
+            {
+            auto data = std::vector<sample_t>(64);
+            for(std::size_t index{}; index < data.size(); ++index)
+              {
+              data[index] = {static_cast<float>(index % 7), -static_cast<float>(index % 3)};
+              }
+            auto const original = data;
+
+            m_transform.forward(data);
+            m_transform.inverse(data);
+
+            for(std::size_t index{}; index < data.size(); ++index)
+              {
+              ASSERT_EQUAL_DELTA(0.0f, std::abs(data[index] / 64.0f - original[index]), 1e-4f);
+              }
+            }
+
+          void length_must_be_a_power_of_two()
+            {
+            ASSERT_THROWS(dab::fft{48}, std::invalid_argument);
+            ASSERT_THROWS(dab::fft{0}, std::invalid_argument);
+            }
+
+          void data_must_match_the_length()
+            {
+            auto data = std::vector<sample_t>(32);
+
+            ASSERT_THROWS(m_transform.forward(data), std::invalid_argument);
+            }
+
+          private:
+            dab::fft const m_transform{64};
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
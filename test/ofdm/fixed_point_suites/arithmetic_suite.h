@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_OFDM_FIXED_POINT__ARITHMETIC_SUITE
+#define DABCOMMON_TEST_OFDM_FIXED_POINT__ARITHMETIC_SUITE
+
+#include <dab/ofdm/fixed_point.h>
+#include <dab/types/common_types.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace ofdm
+      {
+
+      namespace fixed_point
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(arithmetic_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(arithmetic_tests, Test)
+            suite += LOCAL_TEST(float_samples_are_converted_to_q15);
+            suite += LOCAL_TEST(float_conversion_saturates);
+            suite += LOCAL_TEST(unsigned_iq_samples_are_centered);
+            suite += LOCAL_TEST(multiplication_rounds_to_q15);
+            suite += LOCAL_TEST(nco_without_offset_preserves_samples_within_one_lsb);
+            suite += LOCAL_TEST(nco_rotates_like_a_complex_exponential);
+            suite += LOCAL_TEST(nco_matches_scalar_reference_bit_exactly);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void float_samples_are_converted_to_q15()
+            {
+            auto converted = std::vector<fixed_sample>{};
+            to_fixed({{0.5f, -0.25f}, {0.0f, 0.125f}}, converted);
+
+            ASSERT_EQUAL(2u, converted.size());
+            ASSERT(converted[0] == (fixed_sample{16384, -8192}));
+            ASSERT(converted[1] == (fixed_sample{0, 4096}));
+            }
+
+          void float_conversion_saturates()
+            {
+            auto converted = std::vector<fixed_sample>{};
+            to_fixed({{2.0f, -2.0f}}, converted);
+
+            ASSERT(converted[0] == (fixed_sample{32767, -32768}));
+            }
+
+          void unsigned_iq_samples_are_centered()
+            {
+            auto const iq = std::vector<std::uint8_t>{128, 0, 255, 129};
+            auto converted = std::vector<fixed_sample>{};
+            to_fixed(iq.data(), 2, converted);
+
+            ASSERT(converted[0] == (fixed_sample{0, -32768}));
+            ASSERT(converted[1] == (fixed_sample{32512, 256}));
+            }
+
+          void multiplication_rounds_to_q15()
+            {
+            ASSERT(dab::internal::multiply({16384, 0}, {16384, 0}) == (fixed_sample{8192, 0}));
+            ASSERT(dab::internal::multiply({0, 16384}, {0, 16384}) == (fixed_sample{-8192, 0}));
+            ASSERT(dab::internal::multiply({3, 0}, {16384, 0}) == (fixed_sample{2, 0}));
+            }
+
+          void nco_without_offset_preserves_samples_within_one_lsb()
+            {
+            auto samples = std::vector<fixed_sample>{{1000, -2000}, {-16384, 16384}};
+            auto const original = samples;
+            auto nco = fixed_nco{};
+            nco.mix(samples);
+
+            for(std::size_t index{}; index < samples.size(); ++index)
+              {
+              ASSERT_EQUAL_DELTA(original[index].re, samples[index].re, 1);
+              ASSERT_EQUAL_DELTA(original[index].im, samples[index].im, 1);
+              }
+            }
+
+          void nco_rotates_like_a_complex_exponential()
+            {
+            auto const frequency = 12345.0;
+            auto const sampleRate = 2048000.0;
+            auto samples = std::vector<fixed_sample>(4096, fixed_sample{16384, 0});
+            auto nco = fixed_nco{frequency, sampleRate};
+            nco.mix(samples);
+
+            for(std::size_t index{}; index < samples.size(); index += 97)
+              {
+              auto const angle = 2 * std::acos(-1.0) * frequency * index / sampleRate;
+              ASSERT_EQUAL_DELTA(16384 * std::cos(angle), samples[index].re, 60.0);
+              ASSERT_EQUAL_DELTA(16384 * std::sin(angle), samples[index].im, 60.0);
+              }
+            }
+
+          void nco_matches_scalar_reference_bit_exactly()
+            {
+            auto samples = std::vector<fixed_sample>(1000);
+            for(std::size_t index{}; index < samples.size(); ++index)
+              {
+              samples[index] = {static_cast<std::int16_t>(index * 37 % 20000 - 10000), static_cast<std::int16_t>(index * 53 % 20000 - 10000)};
+              }
+
+            auto expected = samples;
+            auto const increment = static_cast<std::uint32_t>(std::llround(-1000.0 / 2048000.0 * 4294967296.0) + 4294967296LL);
+            for(std::size_t index{}; index < expected.size(); ++index)
+              {
+              auto const phase = static_cast<std::uint32_t>(increment * index);
+              auto const angle = 2 * std::acos(-1.0) * ((phase + (1u << 21)) >> 22 & 1023) / 1024;
+              auto const oscillator = fixed_sample{dab::internal::to_q15(std::cos(angle)), dab::internal::to_q15(std::sin(angle))};
+              auto const re = std::int32_t{expected[index].re} * oscillator.re - std::int32_t{expected[index].im} * oscillator.im;
+              auto const im = std::int32_t{expected[index].re} * oscillator.im + std::int32_t{expected[index].im} * oscillator.re;
+              expected[index] = {static_cast<std::int16_t>((re + 16384) >> 15), static_cast<std::int16_t>((im + 16384) >> 15)};
+              }
+
+            auto nco = fixed_nco{-1000.0, 2048000.0};
+            nco.mix(samples);
+
+            ASSERT(samples == expected);
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
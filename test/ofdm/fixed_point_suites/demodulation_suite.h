@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_OFDM_FIXED_POINT__DEMODULATION_SUITE
+#define DABCOMMON_TEST_OFDM_FIXED_POINT__DEMODULATION_SUITE
+
+#include "transform_suite.h"
+
+#include <dab/constants/transmission_modes.h>
+#include <dab/ofdm/fft.h>
+#include <dab/ofdm/fixed_point.h>
+#include <dab/types/common_types.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace ofdm
+      {
+
+      namespace fixed_point
+        {
+
+        namespace internal
+          {
+
+          /**
+           * Generate the samples of a phase reference symbol followed by DQPSK symbols carrying the given bits, rotated
+           * by a frequency offset.
+           */
+          inline std::vector<sample_t> transmit(dab::internal::types::transmission_mode const & mode,
+                                                std::vector<std::vector<std::uint8_t>> const & bits,
+                                                double const offset)
+            {
+            auto const transform = dab::fft{mode.fft_length};
+            auto const half = std::size_t{mode.carriers} / 2;
+            auto carriers = std::vector<sample_t>(mode.carriers);
+            auto samples = std::vector<sample_t>{};
+            auto generator = std::mt19937{3};
+
+            for(auto & carrier : carriers)
+              {
+              carrier = {generator() % 2 ? 0.005f : -0.005f, generator() % 2 ? 0.005f : -0.005f};
+              }
+
+            for(std::size_t symbol{}; symbol <= bits.size(); ++symbol)
+              {
+              if(symbol)
+                {
+                for(std::size_t carrier{}; carrier < mode.carriers; ++carrier)
+                  {
+                  auto const & symbolBits = bits[symbol - 1];
+                  carriers[carrier] *= sample_t{symbolBits[carrier] ? -1.0f : 1.0f, symbolBits[mode.carriers + carrier] ? -1.0f : 1.0f} / std::sqrt(2.0f);
+                  }
+                }
+
+              auto spectrum = std::vector<sample_t>(mode.fft_length);
+              for(std::size_t carrier{}; carrier < half; ++carrier)
+                {
+                spectrum[mode.fft_length - half + carrier] = carriers[carrier];
+                spectrum[carrier + 1] = carriers[half + carrier];
+                }
+
+              transform.inverse(spectrum);
+              samples.insert(samples.end(), spectrum.end() - mode.guard_duration, spectrum.end());
+              samples.insert(samples.end(), spectrum.begin(), spectrum.end());
+              }
+
+            for(std::size_t index{}; index < samples.size(); ++index)
+              {
+              samples[index] *= std::polar(1.0f, static_cast<float>(2 * std::acos(-1.0) * offset * index / 2048000.0));
+              }
+
+            return samples;
+            }
+
+          inline std::vector<std::vector<std::uint8_t>> random_symbols(std::size_t const count, std::size_t const carriers)
+            {
+            auto generator = std::mt19937{5};
+            auto symbols = std::vector<std::vector<std::uint8_t>>(count, std::vector<std::uint8_t>(2 * carriers));
+            for(auto & symbol : symbols)
+              {
+              for(auto & bit : symbol)
+                {
+                bit = generator() & 1;
+                }
+              }
+
+            return symbols;
+            }
+
+          }
+
+        CUTE_DESCRIPTIVE_STRUCT(demodulation_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(demodulation_tests, Test)
+            suite += LOCAL_TEST(phase_reference_symbol_yields_no_soft_bits);
+            suite += LOCAL_TEST(chain_recovers_the_transmitted_bits);
+            suite += LOCAL_TEST(soft_bits_match_scalar_reference_bit_exactly);
+            suite += LOCAL_TEST(weak_soft_bits_are_rounded_like_the_scalar_reference);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void phase_reference_symbol_yields_no_soft_bits()
+            {
+            auto const & mode = kTransmissionMode2;
+            auto fixed = std::vector<fixed_sample>{};
+            to_fixed(internal::transmit(mode, internal::random_symbols(1, mode.carriers), 0.0), fixed);
+
+            auto demodulator = fixed_ofdm_demodulator{mode};
+            auto soft = std::vector<std::int8_t>{};
+
+            ASSERT(!demodulator.demodulate(fixed.data(), soft));
+            ASSERT(demodulator.demodulate(fixed.data() + mode.symbol_duration, soft));
+            ASSERT_EQUAL(2u * mode.carriers, soft.size());
+
+            demodulator.reset();
+            ASSERT(!demodulator.demodulate(fixed.data(), soft));
+            }
+
+          void chain_recovers_the_transmitted_bits()
+            {
+            auto const & mode = kTransmissionMode2;
+            auto const bits = internal::random_symbols(4, mode.carriers);
+            auto fixed = std::vector<fixed_sample>{};
+            to_fixed(internal::transmit(mode, bits, 1500.0), fixed);
+
+            auto nco = fixed_nco{-1500.0, 2048000.0};
+            nco.mix(fixed);
+
+            auto demodulator = fixed_ofdm_demodulator{mode};
+            auto soft = std::vector<std::int8_t>{};
+            demodulator.demodulate(fixed.data(), soft);
+
+            for(std::size_t symbol{}; symbol < bits.size(); ++symbol)
+              {
+              ASSERT(demodulator.demodulate(fixed.data() + (symbol + 1) * mode.symbol_duration, soft));
+              for(std::size_t bit{}; bit < soft.size(); ++bit)
+                {
+                ASSERT_EQUAL(bits[symbol][bit] == 1, soft[bit] > 0);
+                ASSERT(std::abs(soft[bit]) > 16);
+                }
+              }
+            }
+
+          void soft_bits_match_scalar_reference_bit_exactly()
+            {
+            match_reference(1);
+            }
+
+          void weak_soft_bits_are_rounded_like_the_scalar_reference()
+            {
+            ASSERT_EQUAL(0, match_reference(kWeakAttenuation));
+            }
+
+          private:
+            static auto constexpr kWeakAttenuation = 32;
+
+            /**
+             * Compare the soft bits of an attenuated symbol to a scalar reference that halves each partial product with
+             * rounding. Returns the common shift applied to the soft bits.
+             */
+            int match_reference(int const attenuation)
+              {
+              auto const & mode = kTransmissionMode2;
+              auto fixed = std::vector<fixed_sample>{};
+              to_fixed(internal::transmit(mode, internal::random_symbols(1, mode.carriers), 0.0), fixed);
+
+              for(auto & sample : fixed)
+                {
+                sample = {static_cast<std::int16_t>(sample.re / attenuation), static_cast<std::int16_t>(sample.im / attenuation)};
+                }
+
+              auto spectra = std::vector<std::vector<fixed_sample>>{};
+              for(std::size_t symbol{}; symbol < 2; ++symbol)
+                {
+                auto const begin = fixed.begin() + symbol * mode.symbol_duration + mode.guard_duration;
+                spectra.push_back(internal::reference_fft({begin, begin + mode.fft_length}, mode.fft_length));
+                }
+
+              auto const carrier = [&](std::size_t const symbol, std::size_t const index){
+                return index < mode.carriers / 2 ? spectra[symbol][mode.fft_length - mode.carriers / 2 + index] : spectra[symbol][index - mode.carriers / 2 + 1];
+              };
+
+              auto const half = [](long const product){ return (product + 1) >> 1; };
+              auto products = std::vector<long>{};
+              auto magnitude = 0L;
+              for(std::size_t index{}; index < 2u * mode.carriers; ++index)
+                {
+                auto const previous = carrier(0, index % mode.carriers);
+                auto const current = carrier(1, index % mode.carriers);
+                auto const product = index < mode.carriers ? half(current.re * previous.re) + half(current.im * previous.im)
+                                                           : half(current.im * previous.re) - half(current.re * previous.im);
+                products.push_back(product);
+                magnitude += std::abs(product);
+                }
+
+              auto shift = 0;
+              while((magnitude / (2 * mode.carriers)) >> shift >= 64)
+                {
+                ++shift;
+                }
+
+              auto demodulator = fixed_ofdm_demodulator{mode};
+              auto soft = std::vector<std::int8_t>{};
+              demodulator.demodulate(fixed.data(), soft);
+              demodulator.demodulate(fixed.data() + mode.symbol_duration, soft);
+
+              for(std::size_t index{}; index < soft.size(); ++index)
+                {
+                auto const expected = -((products[index] + (shift ? 1L << (shift - 1) : 0)) >> shift);
+                ASSERT_EQUAL(std::max(-127L, std::min(127L, expected)), static_cast<long>(soft[index]));
+                }
+
+              return shift;
+              }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_OFDM_FIXED_POINT__TRANSFORM_SUITE
+#define DABCOMMON_TEST_OFDM_FIXED_POINT__TRANSFORM_SUITE
+
+#include <dab/ofdm/fft.h>
+#include <dab/ofdm/fixed_point.h>
+#include <dab/types/common_types.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace ofdm
+      {
+
+      namespace fixed_point
+        {
+
+        namespace internal
+          {
+
+          /**
+           * A recursive decimation-in-time reference of the fixed-point FFT, using the same twiddle factors, rounding
+           * and scaling per butterfly.
+           */
+          inline std::vector<fixed_sample> reference_fft(std::vector<fixed_sample> const & data, std::size_t const length)
+            {
+            auto const size = data.size();
+            if(size == 1)
+              {
+              return data;
+              }
+
+            auto even = std::vector<fixed_sample>{};
+            auto odd = std::vector<fixed_sample>{};
+            for(std::size_t index{}; index < size; index += 2)
+              {
+              even.push_back(data[index]);
+              odd.push_back(data[index + 1]);
+              }
+
+            even = reference_fft(even, length);
+            odd = reference_fft(odd, length);
+
+            auto const step = -2 * std::acos(-1.0) / length;
+            auto result = std::vector<fixed_sample>(size);
+            for(std::size_t index{}; index < size / 2; ++index)
+              {
+              auto const exponent = index * (length / size);
+              auto const twiddle = fixed_sample{dab::internal::to_q15(std::cos(step * exponent)), dab::internal::to_q15(std::sin(step * exponent))};
+              auto const product = dab::internal::multiply(odd[index], twiddle);
+              result[index] = {static_cast<std::int16_t>((even[index].re + product.re + 1) >> 1), static_cast<std::int16_t>((even[index].im + product.im + 1) >> 1)};
+              result[index + size / 2] = {static_cast<std::int16_t>((even[index].re - product.re + 1) >> 1), static_cast<std::int16_t>((even[index].im - product.im + 1) >> 1)};
+              }
+
+            return result;
+            }
+
+          inline std::vector<fixed_sample> random_samples(std::size_t const count, unsigned const seed, int const amplitude)
+            {
+            auto generator = std::mt19937{seed};
+            auto distribution = std::uniform_int_distribution<int>{-amplitude, amplitude};
+            auto samples = std::vector<fixed_sample>(count);
+            for(auto & sample : samples)
+              {
+              sample = {static_cast<std::int16_t>(distribution(generator)), static_cast<std::int16_t>(distribution(generator))};
+              }
+
+            return samples;
+            }
+
+          }
+
+        CUTE_DESCRIPTIVE_STRUCT(transform_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(transform_tests, Test)
+            suite += LOCAL_TEST(length_must_be_a_power_of_two);
+            suite += LOCAL_TEST(transform_matches_scalar_reference_bit_exactly);
+            suite += LOCAL_TEST(transform_approximates_float_transform);
+            suite += LOCAL_TEST(full_scale_input_does_not_overflow);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void length_must_be_a_power_of_two()
+            {
+            ASSERT_THROWS(fixed_fft{1536}, std::invalid_argument);
+            }
+
+          void transform_matches_scalar_reference_bit_exactly()
+            {
+            for(auto const length : {std::size_t{256}, std::size_t{2048}})
+              {
+              auto samples = internal::random_samples(length, static_cast<unsigned>(length), 20000);
+              auto const expected = internal::reference_fft(samples, length);
+
+              fixed_fft{length}.forward(samples.data());
+              ASSERT(samples == expected);
+              }
+            }
+
+          void transform_approximates_float_transform()
+            {
+            auto const length = std::size_t{512};
+            auto samples = internal::random_samples(length, 7, 16000);
+            auto reference = std::vector<sample_t>(length);
+            for(std::size_t index{}; index < length; ++index)
+              {
+              reference[index] = {samples[index].re / 32768.0f, samples[index].im / 32768.0f};
+              }
+
+            fixed_fft{length}.forward(samples.data());
+            dab::fft{length}.forward(reference);
+
+            for(std::size_t index{}; index < length; ++index)
+              {
+              ASSERT_EQUAL_DELTA(reference[index].real() / length * 32768.0f, samples[index].re, 6.0f);
+              ASSERT_EQUAL_DELTA(reference[index].imag() / length * 32768.0f, samples[index].im, 6.0f);
+              }
+            }
+
+          void full_scale_input_does_not_overflow()
+            {
+            auto samples = std::vector<fixed_sample>(1024, fixed_sample{32767, -32768});
+            fixed_fft{1024}.forward(samples.data());
+
+            ASSERT_EQUAL_DELTA(32767, samples[0].re, 16);
+            ASSERT_EQUAL_DELTA(-32768, samples[0].im, 16);
+            for(std::size_t index{1}; index < samples.size(); ++index)
+              {
+              ASSERT_EQUAL_DELTA(0, samples[index].re, 16);
+              ASSERT_EQUAL_DELTA(0, samples[index].im, 16);
+              }
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
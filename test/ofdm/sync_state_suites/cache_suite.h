@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_OFDM_SYNC_STATE__CACHE_SUITE
+#define DABCOMMON_TEST_OFDM_SYNC_STATE__CACHE_SUITE
+
+#include <dab/ofdm/sync_state.h>
+#include <dab/types/parse_status.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace ofdm
+      {
+
+      namespace sync_state
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(cache_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(cache_tests, Test)
+            suite += LOCAL_TEST(next_frame_is_predicted_from_the_frame_phase);
+            suite += LOCAL_TEST(next_frame_accounts_for_clock_drift);
+            suite += LOCAL_TEST(states_are_keyed_by_frequency);
+            suite += LOCAL_TEST(exported_states_round_trip);
+            suite += LOCAL_TEST(corrupted_export_is_not_imported);
+            suite += LOCAL_TEST(truncated_export_is_incomplete);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void next_frame_is_predicted_from_the_frame_phase()
+            {
+            auto const state = dab::sync_state{1, 0.0f, 0.0f, 1000};
+
+            ASSERT_EQUAL(1000l, static_cast<long>(state.next_frame(0, 196608)));
+            ASSERT_EQUAL(1000l + 196608, static_cast<long>(state.next_frame(1001, 196608)));
+            ASSERT_EQUAL(1000l + 10 * 196608, static_cast<long>(state.next_frame(1000 + 10 * 196608, 196608)));
+            }
+
+          void next_frame_accounts_for_clock_drift()
+            {
+            auto const state = dab::sync_state{1, 0.0f, 10.0f, 0};
+
+            ASSERT_EQUAL(100l * 196608 + 197, static_cast<long>(state.next_frame(100l * 196608, 196608)));
+            }
+
+          void states_are_keyed_by_frequency()
+            {
+            auto cache = dab::sync_state_cache{};
+            auto state = dab::sync_state{};
+
+            cache.store(227360, {1, 120.5f, 1.5f, 42});
+            ASSERT(!cache.find(225648, state));
+            ASSERT(cache.find(227360, state));
+            ASSERT_EQUAL(42l, static_cast<long>(state.frame_start));
+
+            cache.forget(227360);
+            ASSERT_EQUAL(0u, cache.size());
+            }
+
+          void exported_states_round_trip()
+            {
+            auto cache = dab::sync_state_cache{};
+            cache.store(227360, {1, 120.5f, 1.5f, 42});
+            cache.store(178352, {2, -35.25f, -0.75f, 1ull << 40});
+
+            auto const bytes = cache.export_states();
+            ASSERT_EQUAL(8u + 2 * 24 + 2, bytes.size());
+
+            auto restored = dab::sync_state_cache{};
+            auto state = dab::sync_state{};
+            ASSERT_EQUAL(dab::parse_status::ok, restored.import_states(bytes.data(), bytes.size()));
+            ASSERT_EQUAL(2u, restored.size());
+            ASSERT(restored.find(178352, state));
+            ASSERT_EQUAL(2, static_cast<int>(state.mode));
+            ASSERT_EQUAL(-35.25f, state.frequency_offset);
+            ASSERT_EQUAL(-0.75f, state.clock_drift);
+            ASSERT(state.frame_start == 1ull << 40);
+            }
+
+          void corrupted_export_is_not_imported()
+            {
+            auto cache = dab::sync_state_cache{};
+            cache.store(227360, {1, 120.5f, 1.5f, 42});
+            auto bytes = cache.export_states();
+            bytes[20] ^= 0x80;
+
+            auto restored = dab::sync_state_cache{};
+            ASSERT_EQUAL(dab::parse_status::invalid_crc, restored.import_states(bytes.data(), bytes.size()));
+            ASSERT_EQUAL(0u, restored.size());
+            }
+
+          void truncated_export_is_incomplete()
+            {
+            auto cache = dab::sync_state_cache{};
+            cache.store(227360, {1, 120.5f, 1.5f, 42});
+            auto const bytes = cache.export_states();
+
+            auto restored = dab::sync_state_cache{};
+            ASSERT_EQUAL(dab::parse_status::incomplete, restored.import_states(bytes.data(), bytes.size() - 3));
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_OFDM_TII_DECODER__DETECTION_SUITE
+#define DABCOMMON_TEST_OFDM_TII_DECODER__DETECTION_SUITE
+
+#include <dab/constants/transmission_modes.h>
+#include <dab/ofdm/fft.h>
+#include <dab/ofdm/tii_decoder.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cmath>
+#include <complex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace ofdm
+      {
+
+      namespace tii_decoder
+        {
+
+        namespace internal
+          {
+
+          struct transmitter
+            {
+            std::size_t pattern;
+            std::size_t comb;
+            float amplitude;
+            };
+
+          inline std::vector<sample_t> null_symbol(dab::internal::types::transmission_mode const & mode,
+                                                   std::vector<transmitter> const & transmitters,
+                                                   std::mt19937 & generator,
+                                                   float const deviation)
+            {
+            auto const size = static_cast<int>(mode.fft_length);
+            auto const first = -static_cast<int>(mode.carriers / 2);
+            auto phase = std::uniform_real_distribution<float>{0.0f, 2 * std::acos(-1.0f)};
+            auto noise = std::normal_distribution<float>{0.0f, deviation};
+            auto spectrum = std::vector<sample_t>(mode.fft_length);
+
+            for(auto const & transmitter : transmitters)
+              {
+              auto const pattern = dab::internal::tii_patterns()[transmitter.pattern];
+              for(std::size_t position{}; position < mode.carriers / 48; ++position)
+                {
+                if(pattern & (0x80 >> (position % 8)))
+                  {
+                  auto carrier = first + static_cast<int>(2 * transmitter.comb + 48 * position);
+                  carrier += carrier >= 0;
+                  spectrum[(carrier + size) % size] += std::polar(transmitter.amplitude, phase(generator));
+                  spectrum[(carrier + 1 + size) % size] += std::polar(transmitter.amplitude, phase(generator));
+                  }
+                }
+              }
+
+            for(auto carrier = first; carrier <= -first; ++carrier)
+              {
+              spectrum[(carrier + size) % size] += sample_t{noise(generator), noise(generator)};
+              }
+
+            dab::fft{mode.fft_length}.inverse(spectrum);
+
+            auto samples = std::vector<sample_t>(spectrum.end() - (mode.null_duration - mode.fft_length), spectrum.end());
+            samples.insert(samples.end(), spectrum.begin(), spectrum.end());
+            return samples;
+            }
+
+          }
+
+        CUTE_DESCRIPTIVE_STRUCT(detection_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(detection_tests, Test)
+            suite += LOCAL_TEST(patterns_select_four_of_eight_positions);
+            suite += LOCAL_TEST(results_are_reported_after_the_configured_frames);
+            suite += LOCAL_TEST(single_transmitter_is_identified);
+            suite += LOCAL_TEST(transmitters_are_ordered_by_level);
+            suite += LOCAL_TEST(noise_alone_yields_no_transmitters);
+            suite += LOCAL_TEST(transmission_mode_2_is_supported);
+            suite += LOCAL_TEST(transmission_mode_3_is_rejected);
+            suite += LOCAL_TEST(null_symbols_are_consumed_from_a_queue);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void patterns_select_four_of_eight_positions()
+            {
+            auto const & patterns = dab::internal::tii_patterns();
+
+            ASSERT_EQUAL(0x0F, patterns.front());
+            ASSERT_EQUAL(0xF0, patterns.back());
+            }
+
+          void results_are_reported_after_the_configured_frames()
+            {
+            auto decoder = dab::tii_decoder{kTransmissionMode1, 3};
+            auto const symbol = internal::null_symbol(kTransmissionMode1, {{1, 1, 1.0f}}, m_generator, 0.1f);
+
+            ASSERT(!decoder.push(symbol));
+            ASSERT(!decoder.push(symbol));
+            ASSERT(decoder.push(symbol));
+            }
+
+          void single_transmitter_is_identified()
+            {
+            auto decoder = dab::tii_decoder{kTransmissionMode1, 4};
+            for(auto frame = 0; frame < 4; ++frame)
+              {
+              decoder.push(internal::null_symbol(kTransmissionMode1, {{42, 17, 1.0f}}, m_generator, 0.3f));
+              }
+
+            ASSERT_EQUAL(1u, decoder.transmitters().size());
+            ASSERT_EQUAL(42, decoder.transmitters()[0].main);
+            ASSERT_EQUAL(17, decoder.transmitters()[0].sub);
+            ASSERT_EQUAL_DELTA(0.0f, decoder.transmitters()[0].level, 1e-6f);
+            }
+
+          void transmitters_are_ordered_by_level()
+            {
+            auto decoder = dab::tii_decoder{kTransmissionMode1, 8};
+            for(auto frame = 0; frame < 8; ++frame)
+              {
+              decoder.push(internal::null_symbol(kTransmissionMode1, {{5, 3, 0.5f}, {5, 10, 1.0f}}, m_generator, 0.1f));
+              }
+
+            ASSERT_EQUAL(2u, decoder.transmitters().size());
+            ASSERT_EQUAL(10, decoder.transmitters()[0].sub);
+            ASSERT_EQUAL(3, decoder.transmitters()[1].sub);
+            ASSERT_EQUAL(5, decoder.transmitters()[1].main);
+            ASSERT_EQUAL_DELTA(-6.0f, decoder.transmitters()[1].level, 1.0f);
+            }
+
+          void noise_alone_yields_no_transmitters()
+            {
+            auto decoder = dab::tii_decoder{kTransmissionMode1, 4};
+            for(auto frame = 0; frame < 4; ++frame)
+              {
+              decoder.push(internal::null_symbol(kTransmissionMode1, {}, m_generator, 0.3f));
+              }
+
+            ASSERT(decoder.transmitters().empty());
+            }
+
+          void transmission_mode_2_is_supported()
+            {
+            auto decoder = dab::tii_decoder{kTransmissionMode2, 4};
+            for(auto frame = 0; frame < 4; ++frame)
+              {
+              decoder.push(internal::null_symbol(kTransmissionMode2, {{69, 23, 1.0f}}, m_generator, 0.1f));
+              }
+
+            ASSERT_EQUAL(1u, decoder.transmitters().size());
+            ASSERT_EQUAL(69, decoder.transmitters()[0].main);
+            ASSERT_EQUAL(23, decoder.transmitters()[0].sub);
+            }
+
+          void transmission_mode_3_is_rejected()
+            {
+            ASSERT_THROWS(dab::tii_decoder{kTransmissionMode3}, std::invalid_argument);
+            }
+
+          void null_symbols_are_consumed_from_a_queue()
+            {
+            auto decoder = dab::tii_decoder{kTransmissionMode2, 2};
+            sample_queue_t nullSymbols{};
+            auto reports = 0;
+
+            auto consumer = std::thread{[&]{
+              decoder.consume(nullSymbols, [&](std::vector<transmitter_identifier> const & transmitters){
+                reports += transmitters.size() == 1;
+              });
+            }};
+
+            for(auto frame = 0; frame < 4; ++frame)
+              {
+              nullSymbols.enqueue(internal::null_symbol(kTransmissionMode2, {{7, 7, 1.0f}}, m_generator, 0.1f));
+              }
+            nullSymbols.close();
+            consumer.join();
+
+            ASSERT_EQUAL(2, reports);
+            }
+
+          private:
+            std::mt19937 m_generator{13};
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
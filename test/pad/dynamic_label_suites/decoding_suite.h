@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_PAD_DYNAMIC_LABEL__DECODING_SUITE
+#define DABCOMMON_TEST_PAD_DYNAMIC_LABEL__DECODING_SUITE
+
+#include <dab/fec/crc.h>
+#include <dab/pad/dynamic_label.h>
+#include <dab/types/parse_status.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace pad
+      {
+
+      namespace dynamic_label
+        {
+
+        namespace internal
+          {
+
+          inline std::vector<std::uint8_t> segment(std::string const & text, std::uint8_t const flags, std::uint8_t const second)
+            {
+            auto bytes = std::vector<std::uint8_t>{};
+            bytes.reserve(text.size() + 4);
+            bytes.push_back(static_cast<std::uint8_t>(flags | (text.size() - 1)));
+            bytes.push_back(second);
+            bytes.insert(bytes.end(), text.begin(), text.end());
+
+            auto const crc = static_cast<std::uint16_t>(~dab::crc16(bytes.data(), bytes.size()));
+            bytes.push_back(static_cast<std::uint8_t>(crc >> 8));
+            bytes.push_back(static_cast<std::uint8_t>(crc & 0xFF));
+            return bytes;
+            }
+
+          inline std::string text(dab::dynamic_label const & label)
+            {
+            return {label.text.begin(), label.text.begin() + label.length};
+            }
+
+          }
+
+        CUTE_DESCRIPTIVE_STRUCT(decoding_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(decoding_tests, Test)
+            suite += LOCAL_TEST(single_segment_label_is_complete);
+            suite += LOCAL_TEST(segments_are_joined_in_order);
+            suite += LOCAL_TEST(missing_segment_is_reported);
+            suite += LOCAL_TEST(missing_segment_is_filled_by_repetition);
+            suite += LOCAL_TEST(toggle_discards_collected_segments);
+            suite += LOCAL_TEST(clear_command_clears_the_label);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void single_segment_label_is_complete()
+            {
+            auto decoder = dynamic_label_decoder{};
+
+            ASSERT_EQUAL(parse_status::ok, decoder.decode(internal::segment("Hello", 0x60, 0xF0)));
+            ASSERT_EQUAL(std::string{"Hello"}, internal::text(decoder.label()));
+            ASSERT_EQUAL(15, static_cast<int>(decoder.label().charset));
+            }
+
+          void segments_are_joined_in_order()
+            {
+            auto decoder = dynamic_label_decoder{};
+
+            ASSERT_EQUAL(parse_status::incomplete, decoder.decode(internal::segment("Now playing: The", 0x40, 0x00)));
+            ASSERT_EQUAL(parse_status::incomplete, decoder.decode(internal::segment(" Artist - A Long", 0x00, 0x10)));
+            ASSERT_EQUAL(parse_status::ok, decoder.decode(internal::segment(" Title", 0x20, 0x20)));
+            ASSERT_EQUAL(std::string{"Now playing: The Artist - A Long Title"}, internal::text(decoder.label()));
+            }
+
+          void missing_segment_is_reported()
+            {
+            auto decoder = dynamic_label_decoder{};
+
+            decoder.decode(internal::segment("Now playing: The", 0x40, 0x00));
+            ASSERT_EQUAL(parse_status::segment_lost, decoder.decode(internal::segment(" Title", 0x20, 0x20)));
+            ASSERT_EQUAL(0u, decoder.label().length);
+            }
+
+          void missing_segment_is_filled_by_repetition()
+            {
+            auto decoder = dynamic_label_decoder{};
+
+            decoder.decode(internal::segment("Now playing: The", 0x40, 0x00));
+            decoder.decode(internal::segment(" Title", 0x20, 0x20));
+            ASSERT_EQUAL(parse_status::ok, decoder.decode(internal::segment(" Artist - A Long", 0x00, 0x10)));
+            ASSERT_EQUAL(std::string{"Now playing: The Artist - A Long Title"}, internal::text(decoder.label()));
+            }
+
+          void toggle_discards_collected_segments()
+            {
+            auto decoder = dynamic_label_decoder{};
+
+            decoder.decode(internal::segment("Now playing: The", 0x40, 0x00));
+            ASSERT_EQUAL(parse_status::segment_lost, decoder.decode(internal::segment(" Title", 0xA0, 0x20)));
+            ASSERT_EQUAL(parse_status::ok, decoder.decode(internal::segment("Next", 0xE0, 0x00)));
+            ASSERT_EQUAL(std::string{"Next"}, internal::text(decoder.label()));
+            }
+
+          void clear_command_clears_the_label()
+            {
+            auto decoder = dynamic_label_decoder{};
+
+            decoder.decode(internal::segment("Hello", 0x60, 0x00));
+            ASSERT_EQUAL(parse_status::ok, decoder.decode(std::vector<std::uint8_t>{0x11, 0x00, 0x00, 0x00}));
+            ASSERT_EQUAL(0u, decoder.label().length);
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
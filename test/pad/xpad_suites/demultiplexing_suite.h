@@ -0,0 +1,271 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_PAD_XPAD__DEMULTIPLEXING_SUITE
+#define DABCOMMON_TEST_PAD_XPAD__DEMULTIPLEXING_SUITE
+
+#include <dab/fec/crc.h>
+#include <dab/pad/xpad.h>
+#include <dab/types/parse_status.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace pad
+      {
+
+      namespace xpad
+        {
+
+        namespace internal
+          {
+
+          using contents_t = std::vector<std::pair<std::uint8_t, std::vector<std::uint8_t>>>;
+
+          /**
+           * Build the end of an audio frame carrying variable size X-PAD with the given CIs and data subfields. Subfields
+           * are padded with zeros to the length announced by their CI.
+           */
+          inline std::vector<std::uint8_t> variable_pad(contents_t const & contents, bool const indicated = true)
+            {
+            auto field = std::vector<std::uint8_t>{};
+
+            if(indicated)
+              {
+              for(auto const & content : contents)
+                {
+                auto const length = std::find_if(kContentIndicatorLengths.begin(), kContentIndicatorLengths.end(), [&](std::uint8_t length){
+                  return length >= content.second.size();
+                });
+                field.push_back(static_cast<std::uint8_t>((length - kContentIndicatorLengths.begin()) << 5 | content.first));
+                }
+
+              if(contents.size() < 4)
+                {
+                field.push_back(0);
+                }
+              }
+
+            for(auto const & content : contents)
+              {
+              auto const length = *std::find_if(kContentIndicatorLengths.begin(), kContentIndicatorLengths.end(), [&](std::uint8_t length){
+                return length >= content.second.size();
+              });
+              auto data = content.second;
+              data.resize(length);
+              field.insert(field.end(), data.begin(), data.end());
+              }
+
+            auto frame = std::vector<std::uint8_t>{};
+            frame.reserve(field.size() + 4);
+            frame.push_back(0xAA);
+            frame.push_back(0xBB);
+            frame.insert(frame.end(), field.rbegin(), field.rend());
+            frame.push_back(0x20);
+            frame.push_back(indicated ? 0x02 : 0x00);
+            return frame;
+            }
+
+          inline std::vector<std::uint8_t> with_crc(std::vector<std::uint8_t> bytes)
+            {
+            auto const crc = static_cast<std::uint16_t>(~dab::crc16(bytes.data(), bytes.size()));
+            bytes.push_back(static_cast<std::uint8_t>(crc >> 8));
+            bytes.push_back(static_cast<std::uint8_t>(crc & 0xFF));
+            return bytes;
+            }
+
+          inline std::vector<std::uint8_t> label_segment(std::string const & text, std::uint8_t const flags, std::uint8_t const second = 0)
+            {
+            auto bytes = std::vector<std::uint8_t>{};
+            bytes.reserve(text.size() + 4);
+            bytes.push_back(static_cast<std::uint8_t>(flags | (text.size() - 1)));
+            bytes.push_back(second);
+            bytes.insert(bytes.end(), text.begin(), text.end());
+            return with_crc(bytes);
+            }
+
+          }
+
+        CUTE_DESCRIPTIVE_STRUCT(demultiplexing_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(demultiplexing_tests, Test)
+            suite += LOCAL_TEST(frame_without_xpad_has_no_subfields);
+            suite += LOCAL_TEST(short_xpad_carries_three_bytes_after_its_ci);
+            suite += LOCAL_TEST(short_xpad_without_ci_continues_with_four_bytes);
+            suite += LOCAL_TEST(ci_list_announces_subfield_lengths);
+            suite += LOCAL_TEST(subfields_are_restored_to_transmission_order);
+            suite += LOCAL_TEST(xpad_without_ci_continues_the_last_subfield);
+            suite += LOCAL_TEST(truncated_xpad_is_incomplete);
+            suite += LOCAL_TEST(scale_factor_crc_is_skipped);
+            suite += LOCAL_TEST(frame_shorter_than_scale_factor_crc_is_incomplete);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void frame_without_xpad_has_no_subfields()
+            {
+            auto demultiplexer = xpad_demultiplexer{};
+            auto subfields = std::vector<xpad_subfield>{};
+
+            ASSERT_EQUAL(parse_status::ok, demultiplexer.demultiplex(std::vector<std::uint8_t>{1, 2, 3, 0x00, 0x00}, subfields));
+            ASSERT(subfields.empty());
+            }
+
+          void short_xpad_carries_three_bytes_after_its_ci()
+            {
+            auto demultiplexer = xpad_demultiplexer{};
+            auto subfields = std::vector<xpad_subfield>{};
+
+            ASSERT_EQUAL(parse_status::ok, demultiplexer.demultiplex(std::vector<std::uint8_t>{0xFF, 0x13, 0x12, 0x11, 0x02, 0x10, 0x02}, subfields));
+            ASSERT_EQUAL(1u, subfields.size());
+            ASSERT_EQUAL(2, static_cast<int>(subfields[0].application));
+            ASSERT_EQUAL(3u, subfields[0].data.size());
+            ASSERT_EQUAL(0x11, static_cast<int>(subfields[0].data[0]));
+            }
+
+          void short_xpad_without_ci_continues_with_four_bytes()
+            {
+            auto demultiplexer = xpad_demultiplexer{};
+            auto subfields = std::vector<xpad_subfield>{};
+
+            demultiplexer.demultiplex(std::vector<std::uint8_t>{0x13, 0x12, 0x11, 0x02, 0x10, 0x02}, subfields);
+            ASSERT_EQUAL(parse_status::ok, demultiplexer.demultiplex(std::vector<std::uint8_t>{0x24, 0x23, 0x22, 0x21, 0x10, 0x00}, subfields));
+            ASSERT_EQUAL(1u, subfields.size());
+            ASSERT_EQUAL(3, static_cast<int>(subfields[0].application));
+            ASSERT_EQUAL(4u, subfields[0].data.size());
+            ASSERT_EQUAL(0x21, static_cast<int>(subfields[0].data[0]));
+            }
+
+          void ci_list_announces_subfield_lengths()
+            {
+            auto demultiplexer = xpad_demultiplexer{};
+            auto subfields = std::vector<xpad_subfield>{};
+            auto const frame = internal::variable_pad({{1, {1, 2, 3, 4}}, {12, std::vector<std::uint8_t>(20, 7)}});
+
+            ASSERT_EQUAL(parse_status::ok, demultiplexer.demultiplex(frame, subfields));
+            ASSERT_EQUAL(2u, subfields.size());
+            ASSERT_EQUAL(1, static_cast<int>(subfields[0].application));
+            ASSERT_EQUAL(4u, subfields[0].data.size());
+            ASSERT_EQUAL(12, static_cast<int>(subfields[1].application));
+            ASSERT_EQUAL(24u, subfields[1].data.size());
+            }
+
+          void subfields_are_restored_to_transmission_order()
+            {
+            auto demultiplexer = xpad_demultiplexer{};
+            auto subfields = std::vector<xpad_subfield>{};
+            auto const frame = internal::variable_pad({{2, {1, 2, 3, 4, 5, 6}}});
+
+            demultiplexer.demultiplex(frame, subfields);
+            ASSERT(std::equal(subfields[0].data.begin(), subfields[0].data.end(), std::vector<std::uint8_t>{1, 2, 3, 4, 5, 6}.begin()));
+            }
+
+          void xpad_without_ci_continues_the_last_subfield()
+            {
+            auto demultiplexer = xpad_demultiplexer{};
+            auto subfields = std::vector<xpad_subfield>{};
+
+            demultiplexer.demultiplex(internal::variable_pad({{12, std::vector<std::uint8_t>(8, 1)}}), subfields);
+            demultiplexer.demultiplex(internal::variable_pad({{0, std::vector<std::uint8_t>(8, 2)}}, false), subfields);
+
+            ASSERT_EQUAL(1u, subfields.size());
+            ASSERT_EQUAL(13, static_cast<int>(subfields[0].application));
+            ASSERT_EQUAL(8u, subfields[0].data.size());
+            ASSERT_EQUAL(2, static_cast<int>(subfields[0].data[0]));
+            }
+
+          void truncated_xpad_is_incomplete()
+            {
+            auto demultiplexer = xpad_demultiplexer{};
+            auto subfields = std::vector<xpad_subfield>{};
+            auto const frame = internal::variable_pad({{2, {1, 2, 3, 4}}, {3, std::vector<std::uint8_t>(16, 1)}});
+
+            ASSERT_EQUAL(parse_status::incomplete, demultiplexer.demultiplex(byte_view{frame}.subview(10, frame.size() - 10), subfields));
+            ASSERT_EQUAL(1u, subfields.size());
+            }
+
+          void scale_factor_crc_is_skipped()
+            {
+            auto demultiplexer = xpad_demultiplexer{4};
+            auto subfields = std::vector<xpad_subfield>{};
+            auto frame = internal::variable_pad({{2, {1, 2, 3, 4}}, {12, {5, 6}}});
+            auto const scaleFactorCrc = std::vector<std::uint8_t>{0xC1, 0xC2, 0xC3, 0xC4};
+            frame.insert(frame.end() - 2, scaleFactorCrc.begin(), scaleFactorCrc.end());
+
+            ASSERT_EQUAL(parse_status::ok, demultiplexer.demultiplex(frame, subfields));
+            ASSERT_EQUAL(2u, subfields.size());
+            ASSERT_EQUAL(2, static_cast<int>(subfields[0].application));
+            ASSERT_EQUAL(4u, subfields[0].data.size());
+            ASSERT_EQUAL(1, static_cast<int>(subfields[0].data[0]));
+            ASSERT_EQUAL(4, static_cast<int>(subfields[0].data[3]));
+            ASSERT_EQUAL(12, static_cast<int>(subfields[1].application));
+            ASSERT_EQUAL(5, static_cast<int>(subfields[1].data[0]));
+            ASSERT_EQUAL(6, static_cast<int>(subfields[1].data[1]));
+            }
+
+          void frame_shorter_than_scale_factor_crc_is_incomplete()
+            {
+            auto demultiplexer = xpad_demultiplexer{4};
+            auto subfields = std::vector<xpad_subfield>{};
+
+            ASSERT_EQUAL(parse_status::incomplete, demultiplexer.demultiplex(std::vector<std::uint8_t>{0xC1, 0xC2, 0x20, 0x02}, subfields));
+            ASSERT(subfields.empty());
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
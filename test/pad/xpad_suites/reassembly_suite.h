@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_PAD_XPAD__REASSEMBLY_SUITE
+#define DABCOMMON_TEST_PAD_XPAD__REASSEMBLY_SUITE
+
+#include "demultiplexing_suite.h"
+
+#include <dab/pad/xpad.h>
+#include <dab/types/parse_status.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace pad
+      {
+
+      namespace xpad
+        {
+
+        struct received_group
+          {
+          xpad_application application;
+          parse_status status;
+          std::vector<std::uint8_t> bytes;
+          };
+
+        CUTE_DESCRIPTIVE_STRUCT(reassembly_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(reassembly_tests, Test)
+            suite += LOCAL_TEST(label_group_in_a_single_subfield_is_complete);
+            suite += LOCAL_TEST(label_group_is_reassembled_across_frames);
+            suite += LOCAL_TEST(corrupted_label_group_is_reported);
+            suite += LOCAL_TEST(interrupted_label_group_is_lost);
+            suite += LOCAL_TEST(mot_group_length_is_taken_from_the_indicator);
+            suite += LOCAL_TEST(mot_group_without_length_is_dropped);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          std::vector<received_group> run(std::vector<internal::contents_t> const & frames)
+            {
+            auto demultiplexer = xpad_demultiplexer{};
+            auto assembler = data_group_assembler{};
+            auto subfields = std::vector<xpad_subfield>{};
+            auto groups = std::vector<received_group>{};
+
+            for(auto const & frame : frames)
+              {
+              demultiplexer.demultiplex(internal::variable_pad(frame), subfields);
+              assembler.push(subfields, [&](xpad_application const application, parse_status const status, byte_view const group){
+                groups.push_back({application, status, {group.begin(), group.end()}});
+              });
+              }
+
+            return groups;
+            }
+
+          void label_group_in_a_single_subfield_is_complete()
+            {
+            auto const segment = internal::label_segment("Hello", 0x60);
+            auto const groups = run({{{2, segment}}});
+
+            ASSERT_EQUAL(1u, groups.size());
+            ASSERT(groups[0].application == xpad_application::dynamic_label_start);
+            ASSERT_EQUAL(parse_status::ok, groups[0].status);
+            ASSERT(groups[0].bytes == segment);
+            }
+
+          void label_group_is_reassembled_across_frames()
+            {
+            auto const segment = internal::label_segment("Now playing: abc", 0x40);
+            auto const groups = run({
+              {{2, {segment.begin(), segment.begin() + 8}}},
+              {{3, {segment.begin() + 8, segment.begin() + 16}}},
+              {{3, {segment.begin() + 16, segment.end()}}},
+            });
+
+            ASSERT_EQUAL(1u, groups.size());
+            ASSERT_EQUAL(parse_status::ok, groups[0].status);
+            ASSERT(groups[0].bytes == segment);
+            }
+
+          void corrupted_label_group_is_reported()
+            {
+            auto segment = internal::label_segment("Hello", 0x60);
+            segment[3] ^= 0x01;
+            auto const groups = run({{{2, segment}}});
+
+            ASSERT_EQUAL(1u, groups.size());
+            ASSERT_EQUAL(parse_status::invalid_crc, groups[0].status);
+            }
+
+          void interrupted_label_group_is_lost()
+            {
+            auto const first = internal::label_segment("Now playing: abc", 0x40);
+            auto const second = internal::label_segment("Hello", 0x60);
+            auto const groups = run({
+              {{2, {first.begin(), first.begin() + 8}}},
+              {{2, second}},
+            });
+
+            ASSERT_EQUAL(2u, groups.size());
+            ASSERT_EQUAL(parse_status::segment_lost, groups[0].status);
+            ASSERT_EQUAL(parse_status::ok, groups[1].status);
+            }
+
+          void mot_group_length_is_taken_from_the_indicator()
+            {
+            auto const object = internal::with_crc(std::vector<std::uint8_t>(38, 0x55));
+            auto const groups = run({
+              {{1, internal::with_crc({0x00, 40})}, {12, {object.begin(), object.begin() + 24}}},
+              {{13, {object.begin() + 24, object.end()}}},
+            });
+
+            ASSERT_EQUAL(1u, groups.size());
+            ASSERT(groups[0].application == xpad_application::mot_start);
+            ASSERT_EQUAL(parse_status::ok, groups[0].status);
+            ASSERT_EQUAL(40u, groups[0].bytes.size());
+            }
+
+          void mot_group_without_length_is_dropped()
+            {
+            auto const object = internal::with_crc(std::vector<std::uint8_t>(10, 0x55));
+            auto const groups = run({{{12, object}}});
+
+            ASSERT(groups.empty());
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
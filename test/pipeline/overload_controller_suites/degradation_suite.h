@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_PIPELINE_OVERLOAD_CONTROLLER__DEGRADATION_SUITE
+#define DABCOMMON_TEST_PIPELINE_OVERLOAD_CONTROLLER__DEGRADATION_SUITE
+
+#include <dab/pipeline/overload_controller.h>
+#include <dab/types/common_types.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace pipeline
+      {
+
+      namespace overload_controller
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(degradation_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(degradation_tests, Test)
+            suite += LOCAL_TEST(stable_queues_cause_no_degradation);
+            suite += LOCAL_TEST(growing_queue_sheds_in_configured_order);
+            suite += LOCAL_TEST(degradation_waits_for_the_hold_time);
+            suite += LOCAL_TEST(relaxed_queues_restore_in_reverse_order);
+            suite += LOCAL_TEST(plateaued_queue_restores_measures);
+            suite += LOCAL_TEST(queue_plateaued_between_the_watermarks_causes_no_degradation);
+            suite += LOCAL_TEST(deep_queue_is_overloaded_without_growth);
+            suite += LOCAL_TEST(custom_order_is_respected);
+            suite += LOCAL_TEST(duplicate_measures_are_rejected);
+            suite += LOCAL_TEST(queues_are_watched_by_their_size);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          using clock = dab::overload_controller::clock;
+
+          void stable_queues_cause_no_degradation()
+            {
+            dab::overload_controller controller{};
+            attach(controller);
+            step(controller, 100, [](std::size_t){ return 10; });
+
+            ASSERT_EQUAL(0u, controller.level());
+            ASSERT(m_events.empty());
+            }
+
+          void growing_queue_sheds_in_configured_order()
+            {
+            dab::overload_controller controller{};
+            attach(controller);
+            step(controller, 100, [](std::size_t step){ return 100 + step * 50; });
+
+            ASSERT_EQUAL(3u, controller.level());
+            ASSERT_EQUAL(3u, m_events.size());
+            ASSERT(m_events[0].action == shed_action::monitoring_taps);
+            ASSERT(m_events[1].action == shed_action::unsubscribed_subchannels);
+            ASSERT(m_events[2].action == shed_action::hard_decision_viterbi);
+            ASSERT(m_events[2].degraded);
+            ASSERT(controller.shedding(shed_action::hard_decision_viterbi));
+            }
+
+          void degradation_waits_for_the_hold_time()
+            {
+            dab::overload_controller controller{};
+            attach(controller);
+            step(controller, 5, [](std::size_t step){ return 100 + step * 50; });
+
+            ASSERT_EQUAL(0u, controller.level());
+
+            step(controller, 1, [](std::size_t step){ return 400 + step * 50; });
+            ASSERT_EQUAL(1u, controller.level());
+            ASSERT(controller.shedding(shed_action::monitoring_taps));
+            ASSERT(!controller.shedding(shed_action::unsubscribed_subchannels));
+            }
+
+          void relaxed_queues_restore_in_reverse_order()
+            {
+            dab::overload_controller controller{};
+            attach(controller);
+            step(controller, 12, [](std::size_t step){ return 100 + step * 50; });
+            ASSERT_EQUAL(2u, controller.level());
+
+            step(controller, 20, [](std::size_t){ return 0; });
+            ASSERT_EQUAL(2u, controller.level());
+
+            step(controller, 100, [](std::size_t){ return 0; });
+            ASSERT_EQUAL(0u, controller.level());
+            ASSERT_EQUAL(4u, m_events.size());
+            ASSERT(m_events[2].action == shed_action::unsubscribed_subchannels);
+            ASSERT(!m_events[2].degraded);
+            ASSERT_EQUAL(1u, m_events[2].level);
+            ASSERT(m_events[3].action == shed_action::monitoring_taps);
+            ASSERT(!controller.shedding(shed_action::monitoring_taps));
+            }
+
+          void plateaued_queue_restores_measures()
+            {
+            dab::overload_controller controller{};
+            attach(controller);
+            step(controller, 6, [](std::size_t step){ return 100 + step * 50; });
+            ASSERT_EQUAL(1u, controller.level());
+
+            step(controller, 20, [](std::size_t){ return 0; });
+            ASSERT_EQUAL(1u, controller.level());
+
+            step(controller, 60, [](std::size_t){ return 5; });
+
+            ASSERT(controller.trends()[0] > 0.0);
+            ASSERT_EQUAL(0u, controller.level());
+            ASSERT(!controller.shedding(shed_action::monitoring_taps));
+            }
+
+          void queue_plateaued_between_the_watermarks_causes_no_degradation()
+            {
+            dab::overload_controller controller{};
+            attach(controller);
+            step(controller, 100, [](std::size_t step){ return std::min<std::size_t>(step * 50, 200); });
+
+            ASSERT(controller.trends()[0] > 0.0);
+            ASSERT_EQUAL(0u, controller.level());
+            ASSERT(m_events.empty());
+            }
+
+          void deep_queue_is_overloaded_without_growth()
+            {
+            dab::overload_controller controller{};
+            attach(controller);
+            step(controller, 10, [](std::size_t){ return 5000; });
+
+            ASSERT_EQUAL(1u, controller.level());
+            }
+
+          void custom_order_is_respected()
+            {
+            dab::overload_controller controller{std::vector<shed_action>{shed_action::hard_decision_viterbi}};
+            attach(controller);
+            step(controller, 100, [](std::size_t step){ return 100 + step * 50; });
+
+            ASSERT_EQUAL(1u, controller.level());
+            ASSERT(controller.shedding(shed_action::hard_decision_viterbi));
+            ASSERT(!controller.shedding(shed_action::monitoring_taps));
+            }
+
+          void duplicate_measures_are_rejected()
+            {
+            ASSERT_THROWS(dab::overload_controller({shed_action::monitoring_taps, shed_action::monitoring_taps}), std::invalid_argument);
+            }
+
+          void queues_are_watched_by_their_size()
+            {
+            dab::sample_queue_t queue{};
+            dab::overload_controller controller{};
+            controller.watch(queue);
+
+            auto now = clock::now();
+            controller.update(now);
+            queue.enqueue(std::vector<sample_t>(512));
+            controller.update(now + std::chrono::milliseconds{100});
+
+            ASSERT(controller.trends()[0] > 0.0);
+            }
+
+          private:
+            template<typename DepthFunction>
+            void step(dab::overload_controller & controller, std::size_t const steps, DepthFunction depth)
+              {
+              for(std::size_t index{}; index < steps; ++index, ++m_step)
+                {
+                m_depth = depth(m_step);
+                controller.update(m_start + std::chrono::milliseconds{100} * m_step);
+                }
+              }
+
+            void attach(dab::overload_controller & controller)
+              {
+              controller.watch_depth([this]{ return m_depth; });
+              controller.on_change([this](overload_event const & event){ m_events.push_back(event); });
+              }
+
+            std::vector<overload_event> m_events{};
+            std::size_t m_depth{};
+            std::size_t m_step{};
+            clock::time_point const m_start{clock::now()};
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
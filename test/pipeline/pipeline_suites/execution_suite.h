@@ -0,0 +1,295 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_PIPELINE_PIPELINE__EXECUTION_SUITE
+#define DABCOMMON_TEST_PIPELINE_PIPELINE__EXECUTION_SUITE
+
+#include <dab/pipeline/pipeline.h>
+#include <dab/types/queue.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace pipeline
+      {
+
+      namespace internal
+        {
+        static auto const kElements = 1000;
+        }
+
+      CUTE_DESCRIPTIVE_STRUCT(execution_tests)
+        {
+        static cute::suite suite()
+          {
+          auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(execution_tests, Test)
+          suite += LOCAL_TEST(dedicated_stages_process_all_elements_in_order);
+          suite += LOCAL_TEST(pooled_stages_process_all_elements_in_order);
+          suite += LOCAL_TEST(stopping_a_pipeline_terminates_all_stages);
+          suite += LOCAL_TEST(negotiate_matches_output_batch_to_successor_input_batch);
+          suite += LOCAL_TEST(statistics_count_processed_items);
+          suite += LOCAL_TEST(negotiate_rejects_batches_exceeding_a_pinned_input_queue);
+          suite += LOCAL_TEST(results_exceeding_a_pinned_output_queue_are_forwarded_in_chunks);
+          suite += LOCAL_TEST(pooled_stages_do_not_block_on_a_full_pinned_queue);
+          suite += LOCAL_TEST(failing_dedicated_stage_stops_the_pipeline);
+          suite += LOCAL_TEST(failing_pooled_stage_stops_the_pipeline);
+#undef LOCAL_TEST
+
+          return suite;
+          }
+
+        void dedicated_stages_process_all_elements_in_order()
+          {
+          run(dab::stage_scheduling::dedicated);
+
+          ASSERT_EQUAL(expected(), m_received);
+          }
+
+        void pooled_stages_process_all_elements_in_order()
+          {
+          run(dab::stage_scheduling::pooled);
+
+          ASSERT_EQUAL(expected(), m_received);
+          }
+
+        void stopping_a_pipeline_terminates_all_stages()
+          {
+          auto counter = 0;
+          dab::pipeline graph{};
+
+          auto & source = graph.add<dab::source_stage<int>>("source", m_input, [&](std::vector<int> & out){
+            out.push_back(counter++);
+            return true;
+          });
+          auto & sink = graph.add<dab::sink_stage<int>>("sink", m_input, [](std::vector<int> &){}, 4);
+
+          graph.start();
+          graph.stop();
+          graph.join();
+
+          ASSERT(source.finished());
+          ASSERT(sink.finished());
+          }
+
+        void negotiate_matches_output_batch_to_successor_input_batch()
+          {
+          dab::pipeline graph{};
+
+          auto & source = graph.add<dab::source_stage<int>>("source", m_input, [](std::vector<int> &){ return false; });
+          graph.add<dab::sink_stage<int>>("sink", m_input, [](std::vector<int> &){}, 16);
+          graph.negotiate();
+
+          ASSERT_EQUAL(16, source.output_batch());
+          }
+
+        void statistics_count_processed_items()
+          {
+          run(dab::stage_scheduling::dedicated);
+
+          auto const statistics = m_graph.statistics();
+
+          ASSERT_EQUAL(3, statistics.size());
+          ASSERT_EQUAL("double", statistics[1].first);
+          ASSERT_EQUAL(internal::kElements, statistics[1].second.items);
+          }
+
+        void negotiate_rejects_batches_exceeding_a_pinned_input_queue()
+          {
+          dab::internal::queue<int> pinned{1, dab::internal::queue_memory::pinned};
+          dab::pipeline graph{};
+
+          graph.add<dab::source_stage<int>>("source", pinned, [](std::vector<int> &){ return false; });
+          graph.add<dab::sink_stage<int>>("sink", pinned, [](std::vector<int> &){}, pinned.capacity() + 1);
+
+          ASSERT_THROWS(graph.negotiate(), std::length_error);
+          }
+
+        void results_exceeding_a_pinned_output_queue_are_forwarded_in_chunks()
+          {
+          dab::internal::queue<int> pinned{1, dab::internal::queue_memory::pinned};
+          dab::pipeline graph{};
+
+          graph.add<dab::source_stage<int>>("source", pinned, [](std::vector<int> & out){
+            out.resize(internal::kElements);
+            std::iota(out.begin(), out.end(), 0);
+            return false;
+          });
+          graph.add<dab::sink_stage<int>>("sink", pinned, [&](std::vector<int> & in){
+            m_received.insert(m_received.end(), in.begin(), in.end());
+          });
+
+          graph.start();
+          graph.join();
+
+          auto expected = std::vector<int>(internal::kElements);
+          std::iota(expected.begin(), expected.end(), 0);
+          ASSERT_EQUAL(expected, m_received);
+          }
+
+        void pooled_stages_do_not_block_on_a_full_pinned_queue()
+          {
+          dab::internal::queue<int> pinned{1, dab::internal::queue_memory::pinned};
+          auto steps = 0;
+          dab::pipeline graph{};
+
+          graph.add<dab::source_stage<int>>("source", pinned, [&](std::vector<int> & out){
+            for(auto element = 0; element < kResultsPerStep; ++element)
+              {
+              out.push_back(steps * kResultsPerStep + element);
+              }
+            return ++steps < kSteps;
+          }).schedule(dab::stage_scheduling::pooled);
+
+          graph.add<dab::sink_stage<int>>("sink", pinned, [&](std::vector<int> & in){
+            m_received.insert(m_received.end(), in.begin(), in.end());
+          }).schedule(dab::stage_scheduling::pooled);
+
+          graph.negotiate();
+          graph.start();
+          graph.join();
+
+          auto expected = std::vector<int>(kSteps * kResultsPerStep);
+          std::iota(expected.begin(), expected.end(), 0);
+          ASSERT_EQUAL(expected, m_received);
+          }
+
+        void failing_dedicated_stage_stops_the_pipeline()
+          {
+          fail(dab::stage_scheduling::dedicated);
+          }
+
+        void failing_pooled_stage_stops_the_pipeline()
+          {
+          fail(dab::stage_scheduling::pooled);
+          }
+
+        private:
+          static auto constexpr kSteps = 10;
+          static auto constexpr kResultsPerStep = 40;
+
+          void fail(dab::stage_scheduling const scheduling)
+            {
+            dab::internal::queue<int> pinned{1, dab::internal::queue_memory::pinned};
+            auto next = 0;
+            dab::pipeline graph{};
+
+            auto & source = graph.add<dab::source_stage<int>>("source", pinned, [&](std::vector<int> & out){
+              out.push_back(next++);
+              return true;
+            });
+            source.schedule(scheduling);
+
+            auto & failing = graph.add<dab::stage<int, int>>("fail", pinned, m_output, [](std::vector<int> & in, std::vector<int> &){
+              if(in.front() == internal::kElements)
+                {
+                throw std::runtime_error{"processing failed"};
+                }
+            });
+            failing.schedule(scheduling);
+
+            auto & sink = graph.add<dab::sink_stage<int>>("sink", m_output, [](std::vector<int> &){});
+            sink.schedule(scheduling);
+
+            graph.negotiate();
+            graph.start(2);
+
+            ASSERT_THROWS(graph.join(), std::runtime_error);
+            ASSERT(source.finished());
+            ASSERT(failing.finished());
+            ASSERT(failing.error());
+            ASSERT(sink.finished());
+            ASSERT(!sink.error());
+            }
+
+          void run(dab::stage_scheduling const scheduling)
+            {
+            auto next = 0;
+
+            m_graph.add<dab::source_stage<int>>("source", m_input, [&](std::vector<int> & out){
+              out.push_back(next++);
+              return next < internal::kElements;
+            }).schedule(scheduling);
+
+            m_graph.add<dab::stage<int, int>>("double", m_input, m_output, [](std::vector<int> & in, std::vector<int> & out){
+              for(auto element : in)
+                {
+                out.push_back(element * 2);
+                }
+            }, 7).schedule(scheduling);
+
+            m_graph.add<dab::sink_stage<int>>("sink", m_output, [&](std::vector<int> & in){
+              m_received.insert(m_received.end(), in.begin(), in.end());
+            }, 3).schedule(scheduling);
+
+            m_graph.negotiate();
+            m_graph.start(2);
+            m_graph.join();
+            }
+
+          std::vector<int> expected() const
+            {
+            auto result = std::vector<int>(internal::kElements);
+            std::iota(result.begin(), result.end(), 0);
+
+            for(auto & element : result)
+              {
+              element *= 2;
+              }
+
+            return result;
+            }
+
+          dab::internal::queue<int> m_input{};
+          dab::internal::queue<int> m_output{};
+          dab::pipeline m_graph{};
+          std::vector<int> m_received{};
+        };
+
+      }
+
+    }
+
+  }
+
+#endif
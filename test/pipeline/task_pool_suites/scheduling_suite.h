@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_PIPELINE_TASK_POOL__SCHEDULING_SUITE
+#define DABCOMMON_TEST_PIPELINE_TASK_POOL__SCHEDULING_SUITE
+
+#include <dab/constants/transmission_modes.h>
+#include <dab/pipeline/task_pool.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace pipeline
+      {
+
+      namespace task_pool
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(scheduling_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(scheduling_tests, Test)
+            suite += LOCAL_TEST(cif_duration_is_24ms_in_all_modes);
+            suite += LOCAL_TEST(pool_has_requested_number_of_workers);
+            suite += LOCAL_TEST(all_jobs_of_a_group_are_executed);
+            suite += LOCAL_TEST(continuation_runs_after_all_jobs);
+            suite += LOCAL_TEST(continuation_set_after_completion_still_runs);
+            suite += LOCAL_TEST(nested_jobs_are_executed);
+            suite += LOCAL_TEST(group_finishing_in_time_does_not_miss_its_deadline);
+            suite += LOCAL_TEST(droppable_jobs_are_skipped_after_the_deadline);
+            suite += LOCAL_TEST(late_continuation_misses_the_deadline);
+            suite += LOCAL_TEST(exception_of_a_job_is_rethrown_by_wait);
+            suite += LOCAL_TEST(exception_of_the_continuation_is_rethrown_by_wait);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void cif_duration_is_24ms_in_all_modes()
+            {
+            ASSERT_EQUAL(24000, dab::cif_duration(kTransmissionMode1).count());
+            ASSERT_EQUAL(24000, dab::cif_duration(kTransmissionMode2).count());
+            ASSERT_EQUAL(24000, dab::cif_duration(kTransmissionMode3).count());
+            ASSERT_EQUAL(24000, dab::cif_duration(kTransmissionMode4).count());
+            }
+
+          void pool_has_requested_number_of_workers()
+            {
+            ASSERT_EQUAL(4, m_pool.size());
+            }
+
+          void all_jobs_of_a_group_are_executed()
+            {
+            std::atomic_int executed{};
+
+              {
+              dab::task_group group{m_pool};
+              for(int job{}; job < 64; ++job)
+                {
+                group.run([&]{ ++executed; });
+                }
+              }
+
+            ASSERT_EQUAL(64, executed.load());
+            }
+
+          void continuation_runs_after_all_jobs()
+            {
+            std::atomic_int executed{};
+            auto seen = -1;
+
+            dab::task_group group{m_pool};
+            for(int job{}; job < 16; ++job)
+              {
+              group.run([&]{ std::this_thread::sleep_for(std::chrono::milliseconds{1}); ++executed; });
+              }
+            group.then([&]{ seen = executed; });
+            group.wait();
+
+            ASSERT_EQUAL(16, seen);
+            }
+
+          void continuation_set_after_completion_still_runs()
+            {
+            std::atomic_bool ran{};
+
+            dab::task_group group{m_pool};
+            group.run([]{});
+            group.wait();
+            group.then([&]{ ran = true; });
+            group.wait();
+
+            ASSERT(ran.load());
+            }
+
+          void nested_jobs_are_executed()
+            {
+            std::atomic_int executed{};
+
+            dab::task_group outer{m_pool};
+            for(int job{}; job < 8; ++job)
+              {
+              outer.run([&]{
+                dab::task_group inner{m_pool};
+                for(int nested{}; nested < 8; ++nested)
+                  {
+                  inner.run([&]{ ++executed; });
+                  }
+              });
+              }
+            outer.wait();
+
+            ASSERT_EQUAL(64, executed.load());
+            }
+
+          void group_finishing_in_time_does_not_miss_its_deadline()
+            {
+            dab::task_group group{m_pool, std::chrono::steady_clock::now() + std::chrono::seconds{10}};
+            group.run([]{});
+            group.wait();
+
+            ASSERT(!group.deadline_missed());
+            }
+
+          void droppable_jobs_are_skipped_after_the_deadline()
+            {
+            std::atomic_int executed{};
+
+            dab::task_group group{m_pool, std::chrono::steady_clock::now() - std::chrono::milliseconds{1}};
+            group.run_before_deadline([&]{ ++executed; });
+            group.run([&]{ ++executed; });
+            group.wait();
+
+            ASSERT_EQUAL(1, executed.load());
+            ASSERT_EQUAL(1, group.dropped());
+            ASSERT(group.deadline_missed());
+            }
+
+          void late_continuation_misses_the_deadline()
+            {
+            for(int repetition{}; repetition < 20000; ++repetition)
+              {
+              dab::task_group group{m_pool, std::chrono::steady_clock::now()};
+              group.run([]{});
+              group.then([]{});
+              group.wait();
+
+              ASSERT(group.deadline_missed());
+              }
+            }
+
+          void exception_of_a_job_is_rethrown_by_wait()
+            {
+            std::atomic_int executed{};
+            std::atomic_bool continued{};
+
+            dab::task_group group{m_pool};
+            group.run([]{ throw std::runtime_error{"job failed"}; });
+            for(int job{}; job < 8; ++job)
+              {
+              group.run([&]{ ++executed; });
+              }
+            group.then([&]{ continued = true; });
+
+            ASSERT_THROWS(group.wait(), std::runtime_error);
+            ASSERT_EQUAL(8, executed.load());
+            ASSERT(!continued.load());
+
+            group.wait();
+            }
+
+          void exception_of_the_continuation_is_rethrown_by_wait()
+            {
+            dab::task_group group{m_pool};
+            group.run([]{});
+            group.then([]{ throw std::logic_error{"continuation failed"}; });
+
+            ASSERT_THROWS(group.wait(), std::logic_error);
+            }
+
+          private:
+            dab::task_pool m_pool{4};
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_SCAN_BAND_SCANNER__DETECTION_SUITE
+#define DABCOMMON_TEST_SCAN_BAND_SCANNER__DETECTION_SUITE
+
+#include <dab/constants/transmission_modes.h>
+#include <dab/ofdm/fft.h>
+#include <dab/ofdm/signal_detector.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <complex>
+#include <random>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace scan
+      {
+
+      namespace band_scanner
+        {
+
+        namespace internal
+          {
+
+          inline std::vector<sample_t> noise(std::size_t const samples, std::mt19937 & generator, float const deviation)
+            {
+            auto distribution = std::normal_distribution<float>{0.0f, deviation};
+            auto block = std::vector<sample_t>(samples);
+
+            for(auto & sample : block)
+              {
+              sample = {distribution(generator), distribution(generator)};
+              }
+
+            return block;
+            }
+
+          inline std::vector<sample_t> transmission(dab::internal::types::transmission_mode const & mode,
+                                                    std::size_t const frames,
+                                                    std::mt19937 & generator)
+            {
+            auto const transform = dab::fft{mode.fft_length};
+            auto const size = static_cast<int>(mode.fft_length);
+            auto const half = static_cast<int>(mode.carriers / 2);
+            auto samples = noise(frames * mode.frame_duration, generator, 0.01f);
+            auto symbol = std::vector<sample_t>(mode.fft_length);
+
+            for(std::size_t frame{}; frame < frames; ++frame)
+              {
+              auto position = frame * mode.frame_duration + mode.null_duration;
+              for(std::size_t index{}; index <= mode.frame_symbols; ++index)
+                {
+                std::fill(symbol.begin(), symbol.end(), sample_t{});
+                for(auto carrier = -half; carrier <= half; ++carrier)
+                  {
+                  if(carrier)
+                    {
+                    symbol[(carrier + size) % size] = {generator() % 2 ? 1.0f : -1.0f, generator() % 2 ? 1.0f : -1.0f};
+                    }
+                  }
+
+                transform.inverse(symbol);
+                for(std::size_t sample{}; sample < mode.symbol_duration; ++sample)
+                  {
+                  samples[position + sample] += symbol[(sample + mode.useful_duration - mode.guard_duration) % mode.useful_duration] * 0.05f;
+                  }
+                position += mode.symbol_duration;
+                }
+              }
+
+            return samples;
+            }
+
+          }
+
+        CUTE_DESCRIPTIVE_STRUCT(detection_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(detection_tests, Test)
+            suite += LOCAL_TEST(silence_is_empty);
+            suite += LOCAL_TEST(noise_is_empty);
+            suite += LOCAL_TEST(transmission_mode_1_is_detected);
+            suite += LOCAL_TEST(transmission_mode_2_is_detected);
+            suite += LOCAL_TEST(transmission_mode_3_is_detected);
+            suite += LOCAL_TEST(null_symbol_without_ofdm_is_not_confirmed);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void silence_is_empty()
+            {
+            signal_detector detector{};
+
+            ASSERT(detector.analyze(std::vector<sample_t>(10000)).status == detection_status::empty);
+            }
+
+          void noise_is_empty()
+            {
+            signal_detector detector{};
+
+            ASSERT(detector.analyze(internal::noise(signal_detector::window(), m_generator, 1.0f)).status == detection_status::empty);
+            }
+
+          void transmission_mode_1_is_detected()
+            {
+            signal_detector detector{};
+            auto const detected = detector.analyze(internal::transmission(kTransmissionMode1, 2, m_generator));
+
+            ASSERT(detected.status == detection_status::signal);
+            ASSERT_EQUAL(1, detected.mode);
+            ASSERT(detected.correlation > 0.9f);
+            }
+
+          void transmission_mode_2_is_detected()
+            {
+            signal_detector detector{};
+            auto samples = internal::transmission(kTransmissionMode2, 3, m_generator);
+            samples.erase(samples.begin(), samples.begin() + 1000);
+
+            auto const detected = detector.analyze(samples);
+
+            ASSERT(detected.status == detection_status::signal);
+            ASSERT_EQUAL(2, detected.mode);
+            ASSERT_EQUAL_DELTA(static_cast<long>(kTransmissionMode2.frame_duration) - 1000, static_cast<long>(detected.null_symbol), 16L);
+            }
+
+          void transmission_mode_3_is_detected()
+            {
+            signal_detector detector{};
+            auto samples = internal::transmission(kTransmissionMode3, 3, m_generator);
+            samples.erase(samples.begin(), samples.begin() + 1000);
+
+            ASSERT_EQUAL(3, detector.analyze(samples).mode);
+            }
+
+          void null_symbol_without_ofdm_is_not_confirmed()
+            {
+            signal_detector detector{};
+            auto samples = internal::noise(100000, m_generator, 1.0f);
+            std::fill(samples.begin() + 50000, samples.begin() + 50000 + kTransmissionMode2.null_duration, sample_t{});
+
+            ASSERT(detector.analyze(samples).status == detection_status::undecided);
+            }
+
+          private:
+            std::mt19937 m_generator{3};
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
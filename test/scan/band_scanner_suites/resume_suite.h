@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_SCAN_BAND_SCANNER__RESUME_SUITE
+#define DABCOMMON_TEST_SCAN_BAND_SCANNER__RESUME_SUITE
+
+#include "detection_suite.h"
+
+#include <dab/constants/transmission_modes.h>
+#include <dab/ofdm/signal_detector.h>
+#include <dab/ofdm/sync_state.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <random>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace scan
+      {
+
+      namespace band_scanner
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(resume_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(resume_tests, Test)
+            suite += LOCAL_TEST(known_ensemble_is_confirmed_at_the_predicted_frame);
+            suite += LOCAL_TEST(small_timing_deviation_is_tracked);
+            suite += LOCAL_TEST(wrong_frame_phase_is_not_confirmed);
+            suite += LOCAL_TEST(noise_is_not_confirmed);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void known_ensemble_is_confirmed_at_the_predicted_frame()
+            {
+            auto generator = std::mt19937{11};
+            auto const samples = internal::transmission(kTransmissionMode2, 3, generator);
+            auto const detector = signal_detector{};
+
+            auto const result = detector.resume(samples, 10 * kTransmissionMode2.frame_duration, {2, 0.0f, 0.0f, 0});
+
+            ASSERT(result.status == detection_status::signal);
+            ASSERT_EQUAL(2, static_cast<int>(result.mode));
+            ASSERT_EQUAL(static_cast<long>(kTransmissionMode2.frame_duration), static_cast<long>(result.null_symbol));
+            }
+
+          void small_timing_deviation_is_tracked()
+            {
+            auto generator = std::mt19937{12};
+            auto const samples = internal::transmission(kTransmissionMode2, 3, generator);
+            auto const detector = signal_detector{};
+
+            auto const result = detector.resume(samples, 0, {2, 0.0f, 0.0f, 20});
+
+            ASSERT(result.status == detection_status::signal);
+            ASSERT_EQUAL_DELTA(static_cast<long>(kTransmissionMode2.frame_duration), static_cast<long>(result.null_symbol), 2l);
+            }
+
+          void wrong_frame_phase_is_not_confirmed()
+            {
+            auto generator = std::mt19937{13};
+            auto const samples = internal::transmission(kTransmissionMode2, 3, generator);
+            auto const detector = signal_detector{};
+
+            auto const result = detector.resume(samples, 100, {2, 0.0f, 0.0f, 20000});
+
+            ASSERT(result.status == detection_status::undecided);
+            }
+
+          void noise_is_not_confirmed()
+            {
+            auto generator = std::mt19937{14};
+            auto const samples = internal::noise(3 * kTransmissionMode2.frame_duration, generator, 0.05f);
+            auto const detector = signal_detector{};
+
+            auto const result = detector.resume(samples, 0, {2, 0.0f, 0.0f, 1000});
+
+            ASSERT(result.status == detection_status::undecided);
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_SCAN_BAND_SCANNER__SCANNING_SUITE
+#define DABCOMMON_TEST_SCAN_BAND_SCANNER__SCANNING_SUITE
+
+#include "detection_suite.h"
+
+#include <dab/constants/band_iii.h>
+#include <dab/constants/transmission_modes.h>
+#include <dab/scan/band_scanner.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace scan
+      {
+
+      namespace band_scanner
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(scanning_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(scanning_tests, Test)
+            suite += LOCAL_TEST(band_iii_has_38_ascending_blocks);
+            suite += LOCAL_TEST(recording_replays_in_a_loop);
+            suite += LOCAL_TEST(blocks_missing_from_the_recording_are_skipped);
+            suite += LOCAL_TEST(empty_blocks_are_rejected_after_one_window);
+            suite += LOCAL_TEST(acquisition_only_runs_where_a_signal_exists);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void band_iii_has_38_ascending_blocks()
+            {
+            ASSERT_EQUAL(38u, kBandIIIBlocks.size());
+            ASSERT_EQUAL(std::string{"5A"}, kBandIIIBlocks.front().label);
+            ASSERT_EQUAL(239200u, kBandIIIBlocks.back().frequency);
+
+            for(std::size_t index{1}; index < kBandIIIBlocks.size(); ++index)
+              {
+              ASSERT(kBandIIIBlocks[index - 1].frequency < kBandIIIBlocks[index].frequency);
+              }
+            }
+
+          void recording_replays_in_a_loop()
+            {
+            band_recording recording{};
+            recording.add("5A", {{1.0f, 0.0f}, {2.0f, 0.0f}, {3.0f, 0.0f}});
+
+            auto samples = std::vector<sample_t>(5);
+            ASSERT(recording.tune(kBandIIIBlocks[0]));
+            ASSERT(recording.read(samples));
+            ASSERT_EQUAL(2.0f, samples[4].real());
+            }
+
+          void blocks_missing_from_the_recording_are_skipped()
+            {
+            band_recording recording{};
+            dab::band_scanner scanner{};
+
+            auto const result = scanner.scan(recording, kBandIIIBlocks[3], [](band_iii_block const &, dab::internal::types::transmission_mode const &){ return true; });
+
+            ASSERT_EQUAL(0, result.mode);
+            ASSERT_EQUAL(0u, result.samples);
+            }
+
+          void empty_blocks_are_rejected_after_one_window()
+            {
+            band_recording recording{};
+            recording.add("12C", internal::noise(100000, m_generator, 1.0f));
+            dab::band_scanner scanner{};
+
+            auto const result = scanner.scan(recording, kBandIIIBlocks[30], [](band_iii_block const &, dab::internal::types::transmission_mode const &){ return true; });
+
+            ASSERT_EQUAL(0, result.mode);
+            ASSERT(!result.acquired);
+            ASSERT_EQUAL(signal_detector::window(), result.samples);
+            }
+
+          void acquisition_only_runs_where_a_signal_exists()
+            {
+            band_recording recording{};
+            recording.add("5C", internal::transmission(kTransmissionMode2, 2, m_generator));
+            recording.add("8A", internal::noise(50000, m_generator, 0.5f));
+            recording.add("11D", internal::transmission(kTransmissionMode1, 1, m_generator));
+            recording.add("12C", internal::noise(50000, m_generator, 0.5f));
+            dab::band_scanner scanner{};
+
+            auto acquired = std::vector<std::string>{};
+            auto const results = scanner.scan(recording, [&](band_iii_block const & block, dab::internal::types::transmission_mode const & mode){
+              acquired.push_back(block.label + std::string{":"} + std::to_string(mode.id));
+              return true;
+            });
+
+            ASSERT_EQUAL(38u, results.size());
+            ASSERT_EQUAL((std::vector<std::string>{"5C:2", "11D:1"}), acquired);
+            ASSERT_EQUAL(2, results[2].mode);
+            ASSERT(results[2].acquired);
+            ASSERT_EQUAL(0, results[12].mode);
+            }
+
+          private:
+            std::mt19937 m_generator{17};
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
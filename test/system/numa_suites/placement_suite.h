@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_SYSTEM_NUMA__PLACEMENT_SUITE
+#define DABCOMMON_TEST_SYSTEM_NUMA__PLACEMENT_SUITE
+
+#include <dab/system/memory.h>
+#include <dab/system/numa.h>
+#include <dab/types/frame_arena.h>
+#include <dab/types/queue.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace system
+      {
+
+      namespace numa
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(placement_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(placement_tests, Test)
+            suite += LOCAL_TEST(pinning_to_no_cpus_fails);
+            suite += LOCAL_TEST(pinning_to_unknown_cpus_fails);
+            suite += LOCAL_TEST(pinning_to_the_cpus_of_a_node_keeps_the_thread_on_the_node);
+            suite += LOCAL_TEST(binding_to_a_node_outside_the_mask_fails);
+            suite += LOCAL_TEST(binding_less_than_a_page_fails);
+            suite += LOCAL_TEST(binding_to_an_online_node_keeps_memory_usable);
+            suite += LOCAL_TEST(queue_placed_on_unknown_node_keeps_working);
+            suite += LOCAL_TEST(queue_placement_survives_growth);
+            suite += LOCAL_TEST(arena_placed_on_unknown_node_keeps_working);
+            suite += LOCAL_TEST(colocate_places_threads_and_queue);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void pinning_to_no_cpus_fails()
+            {
+            ASSERT(!dab::pin_current_thread({}));
+            }
+
+          void pinning_to_unknown_cpus_fails()
+            {
+            ASSERT(!dab::pin_current_thread({1u << 20}));
+            }
+
+          void pinning_to_the_cpus_of_a_node_keeps_the_thread_on_the_node()
+            {
+            auto const node = dab::numa_nodes().front();
+            auto const cpus = dab::numa_node_cpus(node);
+
+            auto worker = std::thread{[&]{
+              if(dab::pin_current_thread(cpus))
+                {
+                ASSERT_EQUAL(static_cast<int>(node), dab::numa_node_of_cpu(static_cast<unsigned>(dab::current_cpu())));
+                }
+            }};
+            worker.join();
+            }
+
+          void binding_to_a_node_outside_the_mask_fails()
+            {
+            auto const size = 4 * dab::internal::page_size();
+            auto memory = std::unique_ptr<char[]>{new char[size]};
+
+            ASSERT(!dab::bind_to_node(memory.get(), size, 4096));
+            }
+
+          void binding_less_than_a_page_fails()
+            {
+            char memory[64]{};
+
+            ASSERT(!dab::bind_to_node(memory, sizeof(memory), dab::numa_nodes().front()));
+            }
+
+          void binding_to_an_online_node_keeps_memory_usable()
+            {
+            auto const size = 4 * dab::internal::page_size();
+            auto memory = std::unique_ptr<char[]>{new char[size]};
+            dab::bind_to_node(memory.get(), size, dab::numa_nodes().front());
+
+            for(std::size_t index{}; index < size; ++index)
+              {
+              memory[index] = static_cast<char>(index);
+              }
+
+            ASSERT_EQUAL(static_cast<char>(size - 1), memory[size - 1]);
+            }
+
+          void queue_placed_on_unknown_node_keeps_working()
+            {
+            dab::internal::queue<int> queue{};
+
+            ASSERT(!queue.place_on_node(63));
+
+            queue.enqueue(std::vector<int>(1000, 7));
+            auto block = std::vector<int>(1000);
+
+            ASSERT(queue.try_dequeue(block));
+            ASSERT_EQUAL(7, block.back());
+            }
+
+          void queue_placement_survives_growth()
+            {
+            dab::internal::queue<int> queue{};
+            queue.place_on_node(dab::numa_nodes().front());
+
+            auto const elements = 4 * dab::internal::page_size();
+            queue.enqueue(std::vector<int>(elements, 3));
+            auto block = std::vector<int>(elements);
+
+            ASSERT(queue.capacity() >= elements);
+            ASSERT(queue.try_dequeue(block));
+            ASSERT_EQUAL(3, block.front());
+            }
+
+          void arena_placed_on_unknown_node_keeps_working()
+            {
+            dab::frame_arena arena{1 << 16};
+
+            ASSERT(!arena.place_on_node(63));
+            ASSERT(arena.allocate(128) != nullptr);
+            }
+
+          void colocate_places_threads_and_queue()
+            {
+            auto const node = dab::numa_nodes().front();
+            auto release = std::promise<void>{};
+            auto released = release.get_future().share();
+            auto wait = [released]{ released.wait(); };
+
+            auto producer = std::thread{wait};
+            auto consumer = std::thread{wait};
+            dab::frame_arena arena{1 << 16};
+
+            auto const placed = dab::colocate(producer, consumer, arena, node);
+            release.set_value();
+            producer.join();
+            consumer.join();
+
+            ASSERT(!placed || arena.place_on_node(node));
+            ASSERT(placed || dab::numa_node_cpus(node).empty() || !arena.place_on_node(node) || !pinnable(node));
+            }
+
+          private:
+            static bool pinnable(unsigned const node)
+              {
+              auto pinned = false;
+              auto worker = std::thread{[&]{ pinned = dab::pin_current_thread(dab::numa_node_cpus(node)); }};
+              worker.join();
+              return pinned;
+              }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_SYSTEM_NUMA__TOPOLOGY_SUITE
+#define DABCOMMON_TEST_SYSTEM_NUMA__TOPOLOGY_SUITE
+
+#include <dab/system/numa.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace system
+      {
+
+      namespace numa
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(topology_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(topology_tests, Test)
+            suite += LOCAL_TEST(single_cpu_is_parsed);
+            suite += LOCAL_TEST(ranges_and_single_cpus_are_parsed);
+            suite += LOCAL_TEST(empty_list_yields_no_cpus);
+            suite += LOCAL_TEST(trailing_newline_is_ignored);
+            suite += LOCAL_TEST(malformed_entries_are_skipped);
+            suite += LOCAL_TEST(at_least_one_node_is_reported);
+            suite += LOCAL_TEST(unknown_node_has_no_cpus);
+            suite += LOCAL_TEST(current_cpu_belongs_to_a_reported_node);
+            suite += LOCAL_TEST(unknown_cpu_has_no_node);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void single_cpu_is_parsed()
+            {
+            ASSERT_EQUAL((std::vector<unsigned>{5}), dab::internal::parse_cpu_list("5"));
+            }
+
+          void ranges_and_single_cpus_are_parsed()
+            {
+            ASSERT_EQUAL((std::vector<unsigned>{0, 1, 2, 3, 8, 10, 11}), dab::internal::parse_cpu_list("0-3,8,10-11"));
+            }
+
+          void empty_list_yields_no_cpus()
+            {
+            ASSERT(dab::internal::parse_cpu_list("").empty());
+            }
+
+          void trailing_newline_is_ignored()
+            {
+            ASSERT_EQUAL((std::vector<unsigned>{0, 1}), dab::internal::parse_cpu_list("0-1\n"));
+            }
+
+          void malformed_entries_are_skipped()
+            {
+            ASSERT_EQUAL((std::vector<unsigned>{2, 7}), dab::internal::parse_cpu_list(",x,-3,2,,7"));
+            ASSERT(dab::internal::parse_cpu_list("4-1").empty());
+            ASSERT_EQUAL((std::vector<unsigned>{1}), dab::internal::parse_cpu_list("0-x,1,2-,3-4-5,99999999999"));
+            }
+
+          void at_least_one_node_is_reported()
+            {
+            ASSERT(!dab::numa_nodes().empty());
+            }
+
+          void unknown_node_has_no_cpus()
+            {
+            ASSERT(dab::numa_node_cpus(4096).empty());
+            }
+
+          void current_cpu_belongs_to_a_reported_node()
+            {
+            auto const cpu = dab::current_cpu();
+            if(cpu < 0)
+              {
+              return;
+              }
+
+            auto const node = dab::numa_node_of_cpu(static_cast<unsigned>(cpu));
+            if(node < 0)
+              {
+              return;
+              }
+
+            auto const nodes = dab::numa_nodes();
+            auto const cpus = dab::numa_node_cpus(static_cast<unsigned>(node));
+
+            ASSERT(std::find(nodes.begin(), nodes.end(), static_cast<unsigned>(node)) != nodes.end());
+            ASSERT(std::find(cpus.begin(), cpus.end(), static_cast<unsigned>(cpu)) != cpus.end());
+            }
+
+          void unknown_cpu_has_no_node()
+            {
+            ASSERT_EQUAL(-1, dab::numa_node_of_cpu(1u << 20));
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
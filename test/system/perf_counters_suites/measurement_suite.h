@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_SYSTEM_PERF_COUNTERS__MEASUREMENT_SUITE
+#define DABCOMMON_TEST_SYSTEM_PERF_COUNTERS__MEASUREMENT_SUITE
+
+#include <dab/pipeline/stage.h>
+#include <dab/system/perf_counters.h>
+#include <dab/types/queue.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace system
+      {
+
+      namespace perf_counters
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(measurement_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(measurement_tests, Test)
+            suite += LOCAL_TEST(read_reports_exactly_the_available_counters);
+            suite += LOCAL_TEST(scope_adds_one_sample);
+            suite += LOCAL_TEST(scope_counts_work_when_available);
+            suite += LOCAL_TEST(empty_accumulator_has_no_counters);
+            suite += LOCAL_TEST(reset_forgets_samples);
+            suite += LOCAL_TEST(thread_counters_are_reused);
+            suite += LOCAL_TEST(measured_stage_samples_worked_steps);
+            suite += LOCAL_TEST(unmeasured_stage_samples_nothing);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void read_reports_exactly_the_available_counters()
+            {
+            auto & counters = thread_perf_counters();
+            auto const sample = counters.read();
+
+            for(std::size_t index{}; index < kPerfCounters; ++index)
+              {
+              auto const counter = static_cast<perf_counter>(index);
+              ASSERT(!sample.has(counter) || counters.available(counter));
+              }
+            }
+
+          void scope_adds_one_sample()
+            {
+            perf_accumulator accumulator{};
+              {
+              perf_scope region{accumulator};
+              }
+
+            ASSERT_EQUAL(1u, accumulator.statistics().samples);
+            }
+
+          void scope_counts_work_when_available()
+            {
+            perf_accumulator accumulator{};
+              {
+              perf_scope region{accumulator};
+              work();
+              }
+
+            auto const statistics = accumulator.statistics();
+
+            if(thread_perf_counters().available(perf_counter::instructions))
+              {
+              ASSERT(statistics.total[perf_counter::instructions] > 10000u);
+              }
+            else
+              {
+              ASSERT(!statistics.total.has(perf_counter::instructions));
+              }
+            }
+
+          void empty_accumulator_has_no_counters()
+            {
+            perf_accumulator accumulator{};
+            auto const statistics = accumulator.statistics();
+
+            ASSERT_EQUAL(0u, statistics.samples);
+            ASSERT_EQUAL(0u, static_cast<unsigned>(statistics.total.available));
+            }
+
+          void reset_forgets_samples()
+            {
+            perf_accumulator accumulator{};
+            auto sample = perf_sample{};
+            sample.values[0] = 10;
+            accumulator.add(sample);
+            accumulator.reset();
+
+            auto const statistics = accumulator.statistics();
+
+            ASSERT_EQUAL(0u, statistics.samples);
+            ASSERT_EQUAL(0u, statistics.total.values[0]);
+            }
+
+          void thread_counters_are_reused()
+            {
+            ASSERT_EQUAL(&thread_perf_counters(), &thread_perf_counters());
+            }
+
+          void measured_stage_samples_worked_steps()
+            {
+            internal::queue<int> input{};
+            dab::sink_stage<int> sink{"sink", input, [](std::vector<int> &){ work(); }, 2};
+            sink.measure(true);
+
+            input.enqueue(std::vector<int>{1, 2, 3, 4});
+            sink.step(false);
+            sink.step(false);
+            sink.step(false);
+
+            ASSERT_EQUAL(2u, sink.performance().samples);
+            }
+
+          void unmeasured_stage_samples_nothing()
+            {
+            internal::queue<int> input{};
+            dab::sink_stage<int> sink{"sink", input, [](std::vector<int> &){}, 2};
+
+            input.enqueue(std::vector<int>{1, 2});
+            sink.step(false);
+
+            ASSERT_EQUAL(0u, sink.performance().samples);
+            }
+
+          private:
+            static void work()
+              {
+              auto volatile sum = std::uint64_t{};
+              for(std::uint64_t index{}; index < 10000; ++index)
+                {
+                sum = sum + index;
+                }
+              }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
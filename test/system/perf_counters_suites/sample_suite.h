@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_SYSTEM_PERF_COUNTERS__SAMPLE_SUITE
+#define DABCOMMON_TEST_SYSTEM_PERF_COUNTERS__SAMPLE_SUITE
+
+#include <dab/system/perf_counters.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstdint>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace system
+      {
+
+      namespace perf_counters
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(sample_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(sample_tests, Test)
+            suite += LOCAL_TEST(empty_sample_has_no_counters);
+            suite += LOCAL_TEST(unavailable_counters_read_as_zero);
+            suite += LOCAL_TEST(ipc_divides_instructions_by_cycles);
+            suite += LOCAL_TEST(ipc_without_cycles_is_zero);
+            suite += LOCAL_TEST(difference_keeps_common_counters);
+            suite += LOCAL_TEST(difference_never_underflows);
+            suite += LOCAL_TEST(addition_keeps_common_counters);
+            suite += LOCAL_TEST(statistics_average_per_sample);
+            suite += LOCAL_TEST(statistics_without_samples_are_zero);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void empty_sample_has_no_counters()
+            {
+            auto const sample = perf_sample{};
+
+            ASSERT(!sample.has(perf_counter::cycles));
+            ASSERT(!sample.has(perf_counter::branch_misses));
+            }
+
+          void unavailable_counters_read_as_zero()
+            {
+            auto sample = make(1000, 2000, 10, 5);
+            sample.available &= static_cast<std::uint8_t>(~perf_sample::bit(perf_counter::cache_misses));
+
+            ASSERT_EQUAL(0u, sample[perf_counter::cache_misses]);
+            ASSERT_EQUAL(5u, sample[perf_counter::branch_misses]);
+            }
+
+          void ipc_divides_instructions_by_cycles()
+            {
+            ASSERT_EQUAL_DELTA(2.0, make(1000, 2000, 0, 0).ipc(), 1e-9);
+            }
+
+          void ipc_without_cycles_is_zero()
+            {
+            auto sample = make(1000, 2000, 0, 0);
+            sample.available &= static_cast<std::uint8_t>(~perf_sample::bit(perf_counter::cycles));
+
+            ASSERT_EQUAL_DELTA(0.0, sample.ipc(), 1e-9);
+            ASSERT_EQUAL_DELTA(0.0, make(0, 2000, 0, 0).ipc(), 1e-9);
+            }
+
+          void difference_keeps_common_counters()
+            {
+            auto before = make(100, 200, 3, 4);
+            before.available &= static_cast<std::uint8_t>(~perf_sample::bit(perf_counter::branch_misses));
+            auto const difference = make(1100, 2200, 13, 24) - before;
+
+            ASSERT_EQUAL(1000u, difference[perf_counter::cycles]);
+            ASSERT_EQUAL(2000u, difference[perf_counter::instructions]);
+            ASSERT_EQUAL(10u, difference[perf_counter::cache_misses]);
+            ASSERT(!difference.has(perf_counter::branch_misses));
+            }
+
+          void difference_never_underflows()
+            {
+            auto const difference = make(100, 100, 100, 100) - make(200, 50, 100, 100);
+
+            ASSERT_EQUAL(0u, difference[perf_counter::cycles]);
+            ASSERT_EQUAL(50u, difference[perf_counter::instructions]);
+            }
+
+          void addition_keeps_common_counters()
+            {
+            auto sum = make(1, 2, 3, 4);
+            auto other = make(10, 20, 30, 40);
+            other.available &= static_cast<std::uint8_t>(~perf_sample::bit(perf_counter::cycles));
+            sum += other;
+
+            ASSERT(!sum.has(perf_counter::cycles));
+            ASSERT_EQUAL(22u, sum[perf_counter::instructions]);
+            ASSERT_EQUAL(44u, sum[perf_counter::branch_misses]);
+            }
+
+          void statistics_average_per_sample()
+            {
+            auto const statistics = perf_statistics{4, make(4000, 6000, 8, 2)};
+
+            ASSERT_EQUAL_DELTA(1.5, statistics.ipc(), 1e-9);
+            ASSERT_EQUAL_DELTA(2.0, statistics.per_sample(perf_counter::cache_misses), 1e-9);
+            ASSERT_EQUAL_DELTA(0.5, statistics.per_sample(perf_counter::branch_misses), 1e-9);
+            }
+
+          void statistics_without_samples_are_zero()
+            {
+            auto const statistics = perf_statistics{0, perf_sample{}};
+
+            ASSERT_EQUAL_DELTA(0.0, statistics.ipc(), 1e-9);
+            ASSERT_EQUAL_DELTA(0.0, statistics.per_sample(perf_counter::cycles), 1e-9);
+            }
+
+          private:
+            static perf_sample make(std::uint64_t const cycles, std::uint64_t const instructions,
+                                    std::uint64_t const cacheMisses, std::uint64_t const branchMisses)
+              {
+              auto sample = perf_sample{};
+              sample.values = {{cycles, instructions, cacheMisses, branchMisses}};
+              sample.available = 0x0f;
+              return sample;
+              }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_SYSTEM_SCHEDULING__PRIORITY_SUITE
+#define DABCOMMON_TEST_SYSTEM_SCHEDULING__PRIORITY_SUITE
+
+#include <dab/system/scheduling.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <future>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace system
+      {
+
+      namespace scheduling
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(priority_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(priority_tests, Test)
+            suite += LOCAL_TEST(lowering_the_priority_switches_to_the_idle_class);
+            suite += LOCAL_TEST(lowering_the_priority_leaves_other_threads_alone);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void lowering_the_priority_switches_to_the_idle_class()
+            {
+            auto lowered = std::async(std::launch::async, []{
+              auto const changed = lower_current_thread_priority();
+              return changed == (policy() == kIdlePolicy);
+            });
+
+            ASSERT(lowered.get());
+            }
+
+          void lowering_the_priority_leaves_other_threads_alone()
+            {
+            auto const before = policy();
+            std::async(std::launch::async, []{ lower_current_thread_priority(); }).wait();
+
+            ASSERT_EQUAL(before, policy());
+            }
+
+          private:
+#ifdef DABCOMMON_HAS_SCHED_IDLE
+            static auto constexpr kIdlePolicy = SCHED_IDLE;
+
+            static int policy()
+              {
+              auto parameters = sched_param{};
+              auto current = 0;
+              pthread_getschedparam(pthread_self(), &current, &parameters);
+              return current;
+              }
+#else
+            static auto constexpr kIdlePolicy = -1;
+
+            static int policy()
+              {
+              return 0;
+              }
+#endif
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
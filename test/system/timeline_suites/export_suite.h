@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_SYSTEM_TIMELINE__EXPORT_SUITE
+#define DABCOMMON_TEST_SYSTEM_TIMELINE__EXPORT_SUITE
+
+#include <dab/system/timeline.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <chrono>
+#include <sstream>
+#include <string>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace system
+      {
+
+      namespace timeline
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(export_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(export_tests, Test)
+            suite += LOCAL_TEST(empty_timeline_exports_empty_trace);
+            suite += LOCAL_TEST(spans_are_exported_as_complete_events);
+            suite += LOCAL_TEST(frames_are_exported_as_arguments);
+            suite += LOCAL_TEST(named_threads_are_exported_as_metadata);
+            suite += LOCAL_TEST(names_are_escaped);
+            suite += LOCAL_TEST(ticks_are_converted_to_microseconds);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void empty_timeline_exports_empty_trace()
+            {
+            dab::timeline target{};
+
+            ASSERT_EQUAL(std::string{"{\"traceEvents\":[],\"displayTimeUnit\":\"ns\"}"}, trace(target));
+            }
+
+          void spans_are_exported_as_complete_events()
+            {
+            dab::timeline target{};
+            auto const now = dab::timeline::now();
+            target.record("fft", now, now + 10);
+
+            auto const json = trace(target);
+
+            ASSERT(contains(json, "{\"name\":\"fft\",\"cat\":\"dab\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":"));
+            ASSERT(contains(json, ",\"dur\":"));
+            ASSERT(!contains(json, "\"args\""));
+            }
+
+          void frames_are_exported_as_arguments()
+            {
+            dab::timeline target{};
+            auto const now = dab::timeline::now();
+            target.record("sync", now, now, 42);
+
+            ASSERT(contains(trace(target), ",\"args\":{\"frame\":42}}"));
+            }
+
+          void named_threads_are_exported_as_metadata()
+            {
+            dab::timeline target{};
+            target.name_thread("fic");
+
+            ASSERT(contains(trace(target), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"fic\"}}"));
+            }
+
+          void names_are_escaped()
+            {
+            dab::timeline target{};
+            target.record("a\"b\\c\n", 0, 0);
+
+            ASSERT(contains(trace(target), "\"name\":\"a\\\"b\\\\c \""));
+            }
+
+          void ticks_are_converted_to_microseconds()
+            {
+            dab::timeline target{};
+            auto const begin = dab::timeline::now();
+            auto const start = std::chrono::steady_clock::now();
+            while(std::chrono::steady_clock::now() - start < std::chrono::milliseconds{2})
+              {
+              }
+            auto const elapsed = target.to_microseconds(dab::timeline::now() - begin);
+
+            ASSERT(elapsed >= 1500.0);
+            ASSERT(elapsed < 1000000.0);
+            }
+
+          private:
+            static std::string trace(dab::timeline const & target)
+              {
+              std::ostringstream out{};
+              target.write_chrome_trace(out);
+              return out.str();
+              }
+
+            static bool contains(std::string const & text, std::string const & part)
+              {
+              return text.find(part) != std::string::npos;
+              }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
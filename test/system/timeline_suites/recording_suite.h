@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_SYSTEM_TIMELINE__RECORDING_SUITE
+#define DABCOMMON_TEST_SYSTEM_TIMELINE__RECORDING_SUITE
+
+#include <dab/pipeline/stage.h>
+#include <dab/system/timeline.h>
+#include <dab/types/queue.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace system
+      {
+
+      namespace timeline
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(recording_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(recording_tests, Test)
+            suite += LOCAL_TEST(recorded_spans_are_collected_in_order);
+            suite += LOCAL_TEST(scoped_span_covers_its_scope);
+            suite += LOCAL_TEST(moved_span_is_recorded_once);
+            suite += LOCAL_TEST(long_names_are_truncated);
+            suite += LOCAL_TEST(disabled_timeline_records_nothing);
+            suite += LOCAL_TEST(threads_record_into_separate_buffers);
+            suite += LOCAL_TEST(thread_records_into_several_timelines);
+            suite += LOCAL_TEST(full_buffer_keeps_newest_spans);
+            suite += LOCAL_TEST(spans_collected_while_recording_are_consistent);
+            suite += LOCAL_TEST(threads_can_be_named);
+            suite += LOCAL_TEST(traced_stage_records_its_steps);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void recorded_spans_are_collected_in_order()
+            {
+            dab::timeline target{};
+            target.record("sync", 10, 20, 1);
+            target.record("fft", 20, 30, 1);
+
+            auto const threads = target.collect();
+
+            ASSERT_EQUAL(1u, threads.size());
+            ASSERT_EQUAL(2u, threads[0].events.size());
+            ASSERT_EQUAL(std::string{"sync"}, threads[0].events[0].name);
+            ASSERT_EQUAL(std::string{"fft"}, threads[0].events[1].name);
+            ASSERT_EQUAL(20u, threads[0].events[1].begin);
+            ASSERT_EQUAL(30u, threads[0].events[1].end);
+            ASSERT_EQUAL(1u, threads[0].events[1].frame);
+            }
+
+          void scoped_span_covers_its_scope()
+            {
+            dab::timeline target{};
+            auto const before = dab::timeline::now();
+              {
+              auto span = target.span("demod", 7);
+              }
+            auto const after = dab::timeline::now();
+
+            auto const events = target.collect()[0].events;
+
+            ASSERT_EQUAL(1u, events.size());
+            ASSERT(events[0].begin >= before);
+            ASSERT(events[0].end >= events[0].begin);
+            ASSERT(events[0].end <= after);
+            ASSERT_EQUAL(7u, events[0].frame);
+            }
+
+          void moved_span_is_recorded_once()
+            {
+            dab::timeline target{};
+              {
+              auto span = target.span("fic decode");
+              auto moved = std::move(span);
+              }
+
+            auto const events = target.collect()[0].events;
+
+            ASSERT_EQUAL(1u, events.size());
+            ASSERT(events[0].frame == dab::kNoFrame);
+            }
+
+          void long_names_are_truncated()
+            {
+            dab::timeline target{};
+            target.record("subchannel decode of a very long name", 0, 1);
+
+            auto const name = std::string{target.collect()[0].events[0].name};
+
+            ASSERT_EQUAL(dab::kTimelineNameLength, name.size());
+            ASSERT_EQUAL(std::string{"subchannel decode of a "}, name);
+            }
+
+          void disabled_timeline_records_nothing()
+            {
+            dab::timeline target{};
+            target.enable(false);
+            target.record("sync", 0, 1);
+              {
+              auto span = target.span("fft");
+              }
+
+            ASSERT(!target.enabled());
+            ASSERT(target.collect().empty());
+            }
+
+          void threads_record_into_separate_buffers()
+            {
+            dab::timeline target{};
+            target.record("main", 0, 1);
+
+            auto worker = std::thread{[&]{
+              for(std::uint64_t frame{}; frame < 3; ++frame)
+                {
+                target.record("worker", frame, frame + 1, frame);
+                }
+            }};
+            worker.join();
+
+            auto const threads = target.collect();
+
+            ASSERT_EQUAL(2u, threads.size());
+            ASSERT_EQUAL(1u, threads[0].events.size());
+            ASSERT_EQUAL(3u, threads[1].events.size());
+            ASSERT_EQUAL(std::string{"worker"}, threads[1].events[2].name);
+            ASSERT_EQUAL(1u, threads[1].id);
+            }
+
+          void thread_records_into_several_timelines()
+            {
+            auto targets = std::vector<std::unique_ptr<dab::timeline>>{};
+            for(std::size_t index{}; index <= dab::internal::kTimelineCacheEntries; ++index)
+              {
+              targets.emplace_back(new dab::timeline{});
+              }
+
+            for(std::uint64_t frame{}; frame < 3; ++frame)
+              {
+              for(auto & target : targets)
+                {
+                target->record("step", frame, frame + 1, frame);
+                }
+              }
+
+            for(auto & target : targets)
+              {
+              auto const threads = target->collect();
+
+              ASSERT_EQUAL(1u, threads.size());
+              ASSERT_EQUAL(3u, threads[0].events.size());
+              ASSERT_EQUAL(2u, threads[0].events[2].frame);
+              }
+            }
+
+          void full_buffer_keeps_newest_spans()
+            {
+            dab::timeline target{3};
+            for(std::uint64_t frame{}; frame < 10; ++frame)
+              {
+              target.record("frame", frame, frame + 1, frame);
+              }
+
+            auto const thread = target.collect()[0];
+
+            ASSERT_EQUAL(4u, thread.events.size());
+            ASSERT_EQUAL(6u, thread.events[0].frame);
+            ASSERT_EQUAL(9u, thread.events[3].frame);
+            ASSERT_EQUAL(6u, thread.dropped);
+            }
+
+          void spans_collected_while_recording_are_consistent()
+            {
+            static auto constexpr kFrames = std::uint64_t{5000000};
+
+            dab::timeline target{3};
+            std::atomic<bool> recorded{};
+
+            auto worker = std::thread{[&]{
+              for(std::uint64_t frame{}; frame < kFrames; ++frame)
+                {
+                target.record("frame", frame, frame + 1, frame);
+                }
+              recorded = true;
+            }};
+
+            auto consistent = true;
+            while(!recorded)
+              {
+              for(auto const & thread : target.collect())
+                {
+                for(auto const & event : thread.events)
+                  {
+                  consistent &= event.begin == event.frame && event.end == event.frame + 1;
+                  }
+                }
+              }
+            worker.join();
+
+            ASSERT(consistent);
+            }
+
+          void threads_can_be_named()
+            {
+            dab::timeline target{};
+            target.name_thread("demodulator");
+
+            auto const threads = target.collect();
+
+            ASSERT_EQUAL(1u, threads.size());
+            ASSERT_EQUAL(std::string{"demodulator"}, threads[0].name);
+            ASSERT(threads[0].events.empty());
+            }
+
+          void traced_stage_records_its_steps()
+            {
+            dab::timeline target{};
+            internal::queue<int> input{};
+            dab::sink_stage<int> sink{"fic decode", input, [](std::vector<int> &){}, 2};
+            sink.trace(target);
+
+            input.enqueue(std::vector<int>{1, 2, 3, 4});
+            sink.step(false);
+            sink.step(false);
+            sink.step(false);
+
+            auto const events = target.collect()[0].events;
+
+            ASSERT_EQUAL(2u, events.size());
+            ASSERT_EQUAL(std::string{"fic decode"}, events[0].name);
+            ASSERT(events[1].begin >= events[0].end);
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_TYPES_BYTE_VIEW__VIEW_SUITE
+#define DABCOMMON_TEST_TYPES_BYTE_VIEW__VIEW_SUITE
+
+#include <dab/types/byte_view.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace type
+      {
+
+      namespace byte_view
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(view_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(view_tests, Test)
+            suite += LOCAL_TEST(default_view_is_empty);
+            suite += LOCAL_TEST(view_of_vector_does_not_copy);
+            suite += LOCAL_TEST(view_is_iterable);
+            suite += LOCAL_TEST(subview_points_into_view);
+            suite += LOCAL_TEST(subview_outside_view_throws);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void default_view_is_empty()
+            {
+            auto const view = dab::byte_view{};
+
+            ASSERT(view.empty());
+            ASSERT_EQUAL(view.begin(), view.end());
+            }
+
+          void view_of_vector_does_not_copy()
+            {
+            auto const bytes = std::vector<std::uint8_t>{1, 2, 3};
+            auto const view = dab::byte_view{bytes};
+
+            ASSERT_EQUAL(bytes.data(), view.data());
+            ASSERT_EQUAL(3u, view.size());
+            ASSERT_EQUAL(2, static_cast<int>(view[1]));
+            }
+
+          void view_is_iterable()
+            {
+            auto const bytes = std::vector<std::uint8_t>{1, 2, 3, 4};
+            auto const view = dab::byte_view{bytes};
+
+            ASSERT_EQUAL(10, std::accumulate(view.begin(), view.end(), 0));
+            }
+
+          void subview_points_into_view()
+            {
+            auto const bytes = std::vector<std::uint8_t>{1, 2, 3, 4};
+            auto const view = dab::byte_view{bytes}.subview(1, 3);
+
+            ASSERT_EQUAL(bytes.data() + 1, view.data());
+            ASSERT_EQUAL(3u, view.size());
+            ASSERT(dab::byte_view{bytes}.subview(4, 0).empty());
+            }
+
+          void subview_outside_view_throws()
+            {
+            auto const bytes = std::vector<std::uint8_t>{1, 2, 3, 4};
+
+            ASSERT_THROWS(dab::byte_view{bytes}.subview(2, 3), std::out_of_range);
+            ASSERT_THROWS(dab::byte_view{bytes}.subview(5, 0), std::out_of_range);
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
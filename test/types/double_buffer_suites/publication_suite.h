@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_TYPES_DOUBLE_BUFFER__PUBLICATION_SUITE
+#define DABCOMMON_TEST_TYPES_DOUBLE_BUFFER__PUBLICATION_SUITE
+
+#include <dab/types/double_buffer.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace type
+      {
+
+      namespace double_buffer
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(publication_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(publication_tests, Test)
+            suite += LOCAL_TEST(reading_before_publication_yields_nothing);
+            suite += LOCAL_TEST(published_block_is_read);
+            suite += LOCAL_TEST(publishing_returns_storage_for_reuse);
+            suite += LOCAL_TEST(concurrent_readers_see_complete_blocks);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void reading_before_publication_yields_nothing()
+            {
+            dab::double_buffer<int> buffer{};
+            auto block = std::vector<int>{1};
+
+            ASSERT_EQUAL(0u, buffer.read(block));
+            ASSERT(block.empty());
+            }
+
+          void published_block_is_read()
+            {
+            dab::double_buffer<int> buffer{};
+            auto block = std::vector<int>{1, 2, 3};
+            auto copy = std::vector<int>{};
+
+            ASSERT(buffer.publish(block));
+            ASSERT_EQUAL(1u, buffer.read(copy));
+            ASSERT_EQUAL((std::vector<int>{1, 2, 3}), copy);
+            }
+
+          void publishing_returns_storage_for_reuse()
+            {
+            dab::double_buffer<int> buffer{};
+            auto block = std::vector<int>{1, 2};
+            buffer.publish(block);
+            block = {3, 4};
+            buffer.publish(block);
+            block = {5, 6};
+            buffer.publish(block);
+
+            ASSERT_EQUAL((std::vector<int>{1, 2}), block);
+            ASSERT_EQUAL(3u, buffer.version());
+            }
+
+          void concurrent_readers_see_complete_blocks()
+            {
+            dab::double_buffer<int> buffer{};
+            std::atomic_bool done{false};
+            std::atomic_bool consistent{true};
+
+            auto reader = std::thread{[&]{
+              auto block = std::vector<int>{};
+              while(!done)
+                {
+                buffer.read(block);
+                for(auto const value : block)
+                  {
+                  if(value != block.front())
+                    {
+                    consistent = false;
+                    }
+                  }
+                }
+            }};
+
+            auto block = std::vector<int>{};
+            for(auto value = 0; value < 20000; ++value)
+              {
+              block.assign(64, value);
+              buffer.publish(block);
+              }
+
+            done = true;
+            reader.join();
+
+            ASSERT(consistent.load());
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_TYPES_FRAME_ARENA__ALLOCATION_SUITE
+#define DABCOMMON_TEST_TYPES_FRAME_ARENA__ALLOCATION_SUITE
+
+#include <dab/constants/transmission_modes.h>
+#include <dab/types/common_types.h>
+#include <dab/types/frame_arena.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <cstdint>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace type
+      {
+
+      namespace frame_arena
+        {
+
+        CUTE_DESCRIPTIVE_STRUCT(allocation_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(allocation_tests, Test)
+            suite += LOCAL_TEST(capacity_is_derived_from_frame_duration);
+            suite += LOCAL_TEST(used_is_0_after_construction);
+            suite += LOCAL_TEST(allocations_are_suitably_aligned);
+            suite += LOCAL_TEST(consecutive_allocations_do_not_overlap);
+            suite += LOCAL_TEST(reset_reclaims_all_memory);
+            suite += LOCAL_TEST(reset_returns_the_same_memory_again);
+            suite += LOCAL_TEST(exhausted_arena_falls_back_to_overflow_chunks);
+            suite += LOCAL_TEST(reset_releases_overflow_chunks);
+            suite += LOCAL_TEST(high_water_survives_reset);
+            suite += LOCAL_TEST(advance_resets_at_frame_boundary);
+            suite += LOCAL_TEST(arena_byte_vector_allocates_from_arena);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void capacity_is_derived_from_frame_duration()
+            {
+            ASSERT_EQUAL(kTransmissionMode1.frame_duration * kFrameArenaBytesPerSample, m_arena.capacity());
+            }
+
+          void used_is_0_after_construction()
+            {
+            ASSERT_EQUAL(0, m_arena.used());
+            }
+
+          void allocations_are_suitably_aligned()
+            {
+            m_arena.allocate(1, 1);
+            auto const pointer = m_arena.allocate(sizeof(double), alignof(double));
+
+            ASSERT_EQUAL(0, reinterpret_cast<std::uintptr_t>(pointer) % alignof(double));
+            }
+
+          void consecutive_allocations_do_not_overlap()
+            {
+            auto const first = static_cast<char *>(m_arena.allocate(16, 1));
+            auto const second = static_cast<char *>(m_arena.allocate(16, 1));
+
+            ASSERT(second >= first + 16);
+            }
+
+          void reset_reclaims_all_memory()
+            {
+            m_arena.allocate(1024);
+            m_arena.reset();
+
+            ASSERT_EQUAL(0, m_arena.used());
+            }
+
+          void reset_returns_the_same_memory_again()
+            {
+            auto const before = m_arena.allocate(64);
+            m_arena.reset();
+
+            ASSERT_EQUAL(before, m_arena.allocate(64));
+            }
+
+          void exhausted_arena_falls_back_to_overflow_chunks()
+            {
+            dab::frame_arena small{64};
+            small.allocate(48, 1);
+            auto const pointer = small.allocate(48, 1);
+
+            ASSERT(pointer);
+            ASSERT(small.overflowed());
+            }
+
+          void reset_releases_overflow_chunks()
+            {
+            dab::frame_arena small{64};
+            small.allocate(128, 1);
+            small.reset();
+
+            ASSERT(!small.overflowed());
+            }
+
+          void high_water_survives_reset()
+            {
+            m_arena.allocate(100, 1);
+            m_arena.reset();
+            m_arena.allocate(10, 1);
+
+            ASSERT_EQUAL(100, m_arena.high_water());
+            }
+
+          void advance_resets_at_frame_boundary()
+            {
+            m_arena.allocate(100, 1);
+
+            ASSERT(!m_arena.advance(kTransmissionMode1.frame_duration - 1));
+            ASSERT_EQUAL(100, m_arena.used());
+            ASSERT(m_arena.advance(1));
+            ASSERT_EQUAL(0, m_arena.used());
+            }
+
+          void arena_byte_vector_allocates_from_arena()
+            {
+            auto bytes = arena_byte_vector_t{arena_allocator<std::uint8_t>{m_arena}};
+            bytes.resize(32);
+
+            ASSERT(m_arena.used() >= 32);
+            }
+
+          private:
+            dab::frame_arena m_arena{kTransmissionMode1};
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
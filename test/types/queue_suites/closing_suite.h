@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_TYPES_QUEUE__CLOSING_SUITE
+#define DABCOMMON_TEST_TYPES_QUEUE__CLOSING_SUITE
+
+#include <dab/types/queue.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <chrono>
+#include <future>
+#include <vector>
+
+namespace dabi = dab::internal;
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace type
+      {
+
+      namespace queue
+        {
+
+        namespace internal
+          {
+          static const auto kClosingTimeoutTime = std::chrono::milliseconds{500};
+          }
+
+        CUTE_DESCRIPTIVE_STRUCT(closing_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(closing_tests, Test)
+            suite += LOCAL_TEST(queue_is_open_after_construction);
+            suite += LOCAL_TEST(queue_is_closed_after_closing);
+            suite += LOCAL_TEST(closing_wakes_up_a_blocked_dequeue);
+            suite += LOCAL_TEST(dequeueing_an_element_from_a_closed_empty_queue_returns_false);
+            suite += LOCAL_TEST(dequeueing_an_element_from_a_closed_queue_returns_remaining_elements);
+            suite += LOCAL_TEST(dequeueing_a_too_large_block_from_a_closed_queue_returns_false);
+            suite += LOCAL_TEST(closing_wakes_up_an_enqueue_blocked_on_a_full_pinned_queue);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void queue_is_open_after_construction()
+            {
+            ASSERT(!m_queue.closed());
+            }
+
+          void queue_is_closed_after_closing()
+            {
+            m_queue.close();
+
+            ASSERT(m_queue.closed());
+            }
+
+          void closing_wakes_up_a_blocked_dequeue()
+            {
+            int target{};
+
+            auto op = std::async(std::launch::async, [&]{ return m_queue.dequeue(target); });
+            m_queue.close();
+
+            ASSERT_EQUAL(std::future_status::ready, op.wait_for(internal::kClosingTimeoutTime));
+            ASSERT(!op.get());
+            }
+
+          void dequeueing_an_element_from_a_closed_empty_queue_returns_false()
+            {
+            int target{};
+            m_queue.close();
+
+            ASSERT(!m_queue.dequeue(target));
+            }
+
+          void dequeueing_an_element_from_a_closed_queue_returns_remaining_elements()
+            {
+            int target{};
+            m_queue.enqueue(42);
+            m_queue.close();
+
+            ASSERT(m_queue.dequeue(target));
+            ASSERT_EQUAL(42, target);
+            }
+
+          void dequeueing_a_too_large_block_from_a_closed_queue_returns_false()
+            {
+            std::vector<int> block(3);
+            m_queue.enqueue(std::vector<int>{1, 2});
+            m_queue.close();
+
+            ASSERT(!m_queue.dequeue(block));
+            ASSERT_EQUAL(2, m_queue.size());
+            }
+
+          void closing_wakes_up_an_enqueue_blocked_on_a_full_pinned_queue()
+            {
+            dabi::queue<int, 2, 1> pinned{1, dabi::queue_memory::pinned};
+            pinned.enqueue(std::vector<int>{1, 2});
+
+            auto op = std::async(std::launch::async, [&]{ pinned.enqueue(3); });
+            pinned.close();
+
+            ASSERT_EQUAL(std::future_status::ready, op.wait_for(internal::kClosingTimeoutTime));
+            ASSERT_EQUAL(2, pinned.size());
+            }
+
+          private:
+            dab::internal::queue<int, 2, 1> m_queue{};
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
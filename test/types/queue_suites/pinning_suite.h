@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_TYPES_QUEUE__PINNING_SUITE
+#define DABCOMMON_TEST_TYPES_QUEUE__PINNING_SUITE
+
+#include <dab/types/queue.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+namespace dabi = dab::internal;
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace type
+      {
+
+      namespace queue
+        {
+
+        namespace internal
+          {
+          static const auto kPinnedTimeoutTime = std::chrono::milliseconds{200};
+          }
+
+        CUTE_DESCRIPTIVE_STRUCT(pinning_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(pinning_tests, Test)
+            suite += LOCAL_TEST(queue_is_not_pinned_by_default);
+            suite += LOCAL_TEST(queue_is_pinned_after_construction_with_pinned_memory);
+            suite += LOCAL_TEST(pinned_queue_does_not_grow);
+            suite += LOCAL_TEST(pinning_preserves_the_contents);
+            suite += LOCAL_TEST(enqueueing_on_a_full_pinned_queue_blocks);
+            suite += LOCAL_TEST(enqueueing_a_block_larger_than_a_pinned_queue_throws);
+            suite += LOCAL_TEST(dequeueing_a_block_larger_than_a_pinned_queue_throws);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void queue_is_not_pinned_by_default()
+            {
+            ASSERT(!m_queue.pinned());
+            }
+
+          void queue_is_pinned_after_construction_with_pinned_memory()
+            {
+            dabi::queue<int, 2, 1> pinned{1, dabi::queue_memory::pinned};
+
+            ASSERT(pinned.pinned());
+            }
+
+          void pinned_queue_does_not_grow()
+            {
+            dabi::queue<int, 2, 1> pinned{2, dabi::queue_memory::pinned};
+            auto const before = pinned.capacity();
+
+            for(int element{}; element < 16; ++element)
+              {
+              pinned.enqueue(element);
+              int target{};
+              pinned.dequeue(target);
+              }
+
+            ASSERT_EQUAL(before, pinned.capacity());
+            }
+
+          void pinning_preserves_the_contents()
+            {
+            m_queue.enqueue(std::vector<int>{1, 2});
+            m_queue.pin();
+
+            std::vector<int> target(2);
+            m_queue.dequeue(target);
+
+            ASSERT_EQUAL((std::vector<int>{1, 2}), target);
+            }
+
+          void enqueueing_on_a_full_pinned_queue_blocks()
+            {
+            dabi::queue<int, 2, 1> pinned{1, dabi::queue_memory::pinned};
+            pinned.enqueue(std::vector<int>{1, 2});
+
+            auto op = std::async(std::launch::async, [&]{ pinned.enqueue(3); });
+            auto status = op.wait_for(internal::kPinnedTimeoutTime);
+
+            ASSERT_EQUAL(std::future_status::timeout, status);
+
+            int target{};
+            pinned.dequeue(target);
+            status = op.wait_for(internal::kPinnedTimeoutTime);
+
+            ASSERT_EQUAL(std::future_status::ready, status);
+            ASSERT_EQUAL(2, pinned.size());
+            }
+
+          void enqueueing_a_block_larger_than_a_pinned_queue_throws()
+            {
+            dabi::queue<int, 2, 1> pinned{1, dabi::queue_memory::pinned};
+
+            ASSERT_THROWS(pinned.enqueue(std::vector<int>{1, 2, 3}), std::length_error);
+            }
+
+          void dequeueing_a_block_larger_than_a_pinned_queue_throws()
+            {
+            dabi::queue<int, 2, 1> pinned{1, dabi::queue_memory::pinned};
+            std::vector<int> target(3);
+
+            ASSERT_THROWS(pinned.dequeue(target), std::length_error);
+            ASSERT_THROWS(pinned.try_dequeue(target), std::length_error);
+            }
+
+          private:
+            dab::internal::queue<int, 2, 1> m_queue{};
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
@@ -31,6 +31,8 @@
 
 #include "queue_suites/enqueueing_suite.h"
 #include "queue_suites/dequeueing_suite.h"
+#include "queue_suites/pinning_suite.h"
+#include "queue_suites/closing_suite.h"
 
 #include <cute/cute_runner.h>
 #include <cute/cute_suite.h>
@@ -52,6 +54,8 @@ int main(int argc, char * * argv)
 
   success &= cute::extensions::runSelfDescriptive<enqueueing_tests>(runner);
   success &= cute::extensions::runSelfDescriptive<dequeueing_tests>(runner);
+  success &= cute::extensions::runSelfDescriptive<pinning_tests>(runner);
+  success &= cute::extensions::runSelfDescriptive<closing_tests>(runner);
 
   return !success;
   }
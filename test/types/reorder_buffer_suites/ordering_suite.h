@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_TYPES_REORDER_BUFFER__ORDERING_SUITE
+#define DABCOMMON_TEST_TYPES_REORDER_BUFFER__ORDERING_SUITE
+
+#include <dab/types/parse_status.h>
+#include <dab/types/reorder_buffer.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace type
+      {
+
+      namespace reorder_buffer
+        {
+
+        namespace internal
+          {
+          static const auto kLossTimeout = std::chrono::milliseconds{50};
+          static const auto kTimeoutTime = std::chrono::milliseconds{500};
+          }
+
+        CUTE_DESCRIPTIVE_STRUCT(ordering_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(ordering_tests, Test)
+            suite += LOCAL_TEST(results_pushed_in_order_are_released_in_order);
+            suite += LOCAL_TEST(results_pushed_out_of_order_are_released_in_order);
+            suite += LOCAL_TEST(missing_result_is_reported_as_segment_lost);
+            suite += LOCAL_TEST(result_arriving_after_being_lost_is_rejected);
+            suite += LOCAL_TEST(duplicate_result_is_rejected);
+            suite += LOCAL_TEST(try_push_outside_the_window_fails);
+            suite += LOCAL_TEST(push_outside_the_window_blocks_until_there_is_room);
+            suite += LOCAL_TEST(closing_releases_blocked_push_without_inserting);
+            suite += LOCAL_TEST(closed_empty_buffer_reports_incomplete);
+            suite += LOCAL_TEST(results_from_many_producers_are_released_in_order);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void results_pushed_in_order_are_released_in_order()
+            {
+            m_buffer.push(0, 10);
+            m_buffer.push(1, 11);
+
+            ASSERT_EQUAL(11, pop_two().back());
+            }
+
+          void results_pushed_out_of_order_are_released_in_order()
+            {
+            m_buffer.push(1, 11);
+            m_buffer.push(0, 10);
+
+            ASSERT_EQUAL((std::vector<int>{10, 11}), pop_two());
+            }
+
+          void missing_result_is_reported_as_segment_lost()
+            {
+            m_buffer.push(1, 11);
+
+            int target{};
+            ASSERT_EQUAL(dab::parse_status::segment_lost, m_buffer.pop(target));
+            ASSERT_EQUAL(dab::parse_status::ok, m_buffer.pop(target));
+            ASSERT_EQUAL(11, target);
+            ASSERT_EQUAL(1, m_buffer.lost());
+            }
+
+          void result_arriving_after_being_lost_is_rejected()
+            {
+            m_buffer.push(1, 11);
+
+            int target{};
+            m_buffer.pop(target);
+
+            ASSERT(!m_buffer.push(0, 10));
+            ASSERT_EQUAL(1, m_buffer.late());
+            }
+
+          void duplicate_result_is_rejected()
+            {
+            m_buffer.push(0, 10);
+
+            ASSERT(!m_buffer.push(0, 10));
+            }
+
+          void try_push_outside_the_window_fails()
+            {
+            ASSERT(!m_buffer.try_push(4, 14));
+            }
+
+          void push_outside_the_window_blocks_until_there_is_room()
+            {
+            auto op = std::async(std::launch::async, [&]{ return m_buffer.push(4, 14); });
+
+            ASSERT_EQUAL(std::future_status::timeout, op.wait_for(internal::kLossTimeout));
+
+            int target{};
+            m_buffer.push(0, 10);
+            m_buffer.pop(target);
+
+            ASSERT_EQUAL(std::future_status::ready, op.wait_for(internal::kTimeoutTime));
+            ASSERT(op.get());
+            }
+
+          void closing_releases_blocked_push_without_inserting()
+            {
+            auto op = std::async(std::launch::async, [&]{ return m_buffer.push(4, 14); });
+
+            ASSERT_EQUAL(std::future_status::timeout, op.wait_for(internal::kLossTimeout));
+
+            m_buffer.close();
+
+            ASSERT_EQUAL(std::future_status::ready, op.wait_for(internal::kTimeoutTime));
+            ASSERT(!op.get());
+            ASSERT(m_buffer.push(0, 10));
+
+            int target{};
+            ASSERT_EQUAL(dab::parse_status::ok, m_buffer.pop(target));
+            ASSERT_EQUAL(10, target);
+            ASSERT_EQUAL(dab::parse_status::incomplete, m_buffer.pop(target));
+            }
+
+          void closed_empty_buffer_reports_incomplete()
+            {
+            int target{};
+            m_buffer.close();
+
+            ASSERT_EQUAL(dab::parse_status::incomplete, m_buffer.pop(target));
+            }
+
+          void results_from_many_producers_are_released_in_order()
+            {
+            auto producers = std::vector<std::thread>{};
+
+            for(int producer{}; producer < 4; ++producer)
+              {
+              producers.emplace_back([this, producer]{
+                for(int sequence = producer; sequence < 400; sequence += 4)
+                  {
+                  m_buffer.push(static_cast<std::uint64_t>(sequence), sequence);
+                  }
+              });
+              }
+
+            auto released = std::vector<int>{};
+            for(int sequence{}; sequence < 400; ++sequence)
+              {
+              int target{};
+              if(m_buffer.pop(target) == dab::parse_status::ok)
+                {
+                released.push_back(target);
+                }
+              }
+
+            for(auto & producer : producers)
+              {
+              producer.join();
+              }
+
+            ASSERT_EQUAL(400, released.size());
+            for(int sequence{}; sequence < 400; ++sequence)
+              {
+              ASSERT_EQUAL(sequence, released[sequence]);
+              }
+            }
+
+          private:
+            std::vector<int> pop_two()
+              {
+              auto result = std::vector<int>(2);
+              m_buffer.pop(result[0]);
+              m_buffer.pop(result[1]);
+              return result;
+              }
+
+            dab::reorder_buffer<int> m_buffer{4, internal::kLossTimeout};
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif
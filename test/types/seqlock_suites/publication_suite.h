@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2017 Opendigitalradio (http://www.opendigitalradio.org/)
+ * Copyright (C) 2017 Felix Morgner <felix.morgner@hsr.ch>
+ * Copyright (C) 2017 Tobias Stauber <tobias.stauber@hsr.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DABCOMMON_TEST_TYPES_SEQLOCK__PUBLICATION_SUITE
+#define DABCOMMON_TEST_TYPES_SEQLOCK__PUBLICATION_SUITE
+
+#include <dab/types/seqlock.h>
+
+#include <cute/cute.h>
+#include <cute/cute_suite.h>
+#include <cutex/descriptive_suite.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace dab
+  {
+
+  namespace test
+    {
+
+    namespace type
+      {
+
+      namespace seqlock
+        {
+
+        namespace internal
+          {
+
+          struct sample
+            {
+            std::uint32_t first;
+            double second;
+            std::uint16_t third;
+            };
+
+          }
+
+        CUTE_DESCRIPTIVE_STRUCT(publication_tests)
+          {
+          static cute::suite suite()
+            {
+            auto suite = cute::suite{};
+
+#define LOCAL_TEST(Test) CUTE_SMEMFUN(publication_tests, Test)
+            suite += LOCAL_TEST(initial_value_is_published);
+            suite += LOCAL_TEST(stored_value_is_loaded);
+            suite += LOCAL_TEST(version_counts_stores);
+            suite += LOCAL_TEST(concurrent_readers_see_consistent_values);
+#undef LOCAL_TEST
+
+            return suite;
+            }
+
+          void initial_value_is_published()
+            {
+            dab::seqlock<internal::sample> published{{1, 2.5, 3}};
+
+            ASSERT_EQUAL(1u, published.load().first);
+            ASSERT_EQUAL(2.5, published.load().second);
+            ASSERT_EQUAL(3u, published.load().third);
+            }
+
+          void stored_value_is_loaded()
+            {
+            dab::seqlock<internal::sample> published{};
+            published.store({7, 8.0, 9});
+
+            ASSERT_EQUAL(7u, published.load().first);
+            ASSERT_EQUAL(9u, published.load().third);
+            }
+
+          void version_counts_stores()
+            {
+            dab::seqlock<std::uint8_t> published{};
+            published.store(1);
+            published.store(2);
+
+            ASSERT_EQUAL(3u, published.version());
+            }
+
+          void concurrent_readers_see_consistent_values()
+            {
+            dab::seqlock<internal::sample> published{};
+            std::atomic_bool done{false};
+            std::atomic_bool consistent{true};
+
+            auto reader = std::thread{[&]{
+              while(!done)
+                {
+                auto const value = published.load();
+                if(value.second != value.first * 2.0 || value.third != static_cast<std::uint16_t>(value.first))
+                  {
+                  consistent = false;
+                  }
+                }
+            }};
+
+            for(std::uint32_t value{}; value < 100000; ++value)
+              {
+              published.store({value, value * 2.0, static_cast<std::uint16_t>(value)});
+              }
+
+            done = true;
+            reader.join();
+
+            ASSERT(consistent.load());
+            }
+          };
+
+        }
+
+      }
+
+    }
+
+  }
+
+#endif